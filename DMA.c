@@ -14,6 +14,7 @@
  */
 
 #include "DMA.h"
+#include <string.h>
 
 // DMA Flags for each stream of DMA1 and DMA2
 DMA_Flags_Typedef DMA1_Stream0_Flag;
@@ -34,6 +35,102 @@ DMA_Flags_Typedef DMA2_Stream5_Flag;
 DMA_Flags_Typedef DMA2_Stream6_Flag;
 DMA_Flags_Typedef DMA2_Stream7_Flag;
 
+// Event callbacks for each stream, indexed 0-7 for DMA1 and 8-15 for DMA2
+static DMA_Callback_Typedef DMA_Callbacks[16];
+static void *DMA_Callback_Contexts[16];
+
+// Sleep primitive of DMA_Wait (NULL for WFE) and transfer errors not yet reported by it
+static const DMA_Wait_Shim *DMA_Wait_OS;
+static volatile uint8_t DMA_Wait_Error[16];
+
+// State of the 2D memory-to-memory transfer running on DMA2 Stream 0
+static DMA_2D_Config *DMA_2D_Active;
+static uint32_t DMA_2D_Source;
+static uint32_t DMA_2D_Destination;
+static uint16_t DMA_2D_Rows_Remaining;
+static uint16_t DMA_2D_Rows_Per_Run;
+
+// Streams claimed by drivers, one bit per stream index
+static volatile uint16_t DMA_Claimed_Streams;
+
+// Streams holding their controller's clock through DMA_Clock_Enable, one bit per stream index
+static volatile uint16_t DMA_Clocked_Streams;
+
+// Time allowed to DMA_Memory_To_Memory_Transfer before it aborts: a generous per-item bound
+// (a memory-to-memory item takes a few AHB cycles) plus 1 ms for bus contention
+#define DMA_M2M_CYCLES_PER_ITEM     64U
+#define DMA_M2M_TIMEOUT_MARGIN      (SystemCoreClock / 1000U)
+
+/**
+ * @brief Returns the index of a DMA stream.
+ *
+ * @param[in] stream Pointer to the DMA stream.
+ *
+ * @return int8_t Stream index (0-7 for DMA1, 8-15 for DMA2), or -1 for an invalid stream.
+ */
+static int8_t DMA_Stream_Index(DMA_Stream_TypeDef *stream)
+{
+	if(stream >= DMA1_Stream0 && stream <= DMA1_Stream7) return stream - DMA1_Stream0;
+	if(stream >= DMA2_Stream0 && stream <= DMA2_Stream7) return 8 + (stream - DMA2_Stream0);
+	return -1;
+}
+
+/**
+ * @brief Gates the clock of every DMA controller nothing refers to.
+ *
+ * A controller is in use while one of its streams is claimed, holds a
+ * reference through `DMA_Clock_Enable`, or is enabled (e.g. a polled
+ * memory-to-memory transfer). Must be called with interrupts masked.
+ */
+static void DMA_Clock_Gate_Unused(void)
+{
+    uint16_t used = DMA_Claimed_Streams | DMA_Clocked_Streams;
+    uint8_t i;
+
+    // Register reads of a gated controller return 0, so only clocked streams show up
+    for(i = 0; i < 8; i++)
+    {
+        if((DMA1_Stream0 + i)->CR & DMA_SxCR_EN) used |= (uint16_t)(1U << i);
+        if((DMA2_Stream0 + i)->CR & DMA_SxCR_EN) used |= (uint16_t)(1U << (i + 8));
+    }
+
+    if((used & 0x00FFU) == 0) RCC -> AHB1ENR &= ~RCC_AHB1ENR_DMA1EN;
+    if((used & 0xFF00U) == 0) RCC -> AHB1ENR &= ~RCC_AHB1ENR_DMA2EN;
+}
+
+/**
+ * @brief Enables the clock of the controller of a stream index.
+ */
+static void DMA_Clock_Ungate(int8_t index)
+{
+    RCC -> AHB1ENR |= (index < 8) ? RCC_AHB1ENR_DMA1EN : RCC_AHB1ENR_DMA2EN;
+    (void)RCC -> AHB1ENR;
+}
+
+/**
+ * @brief Forwards a handled stream event to its registered callback.
+ *
+ * @param[in] index Stream index (0-7 for DMA1, 8-15 for DMA2).
+ * @param[in] stream Pointer to the DMA stream that raised the interrupt.
+ * @param[in] event The `DMA_Configuration.DMA_Interrupts` value of the handled event, or 0 if none.
+ */
+static inline void DMA_Dispatch_Callback(uint8_t index, DMA_Stream_TypeDef *stream, uint32_t event)
+{
+	if((event != 0) && (DMA_Callbacks[index] != NULL))
+	{
+		DMA_Callbacks[index](stream, event, DMA_Callback_Contexts[index]);
+	}
+
+	// Wake DMA_Wait; the callback may already have restarted the stream
+	if(event != 0)
+	{
+		if(event == DMA_Configuration.DMA_Interrupts.Transfer_Error) DMA_Wait_Error[index] = 1;
+
+		if(DMA_Wait_OS != NULL) DMA_Wait_OS->signal(index, DMA_Wait_OS->context);
+		else __SEV();
+	}
+}
+
 /**
  * @brief DMA1 Stream 0 Interrupt Handler
  *
@@ -41,38 +138,50 @@ DMA_Flags_Typedef DMA2_Stream7_Flag;
  * status flags for FIFO error, direct mode error, transfer error, half
  * transfer complete, and transfer complete, and clears the respective
  * interrupt flag after handling it.
+ *
+ * The handled event is then forwarded to the callback registered for the
+ * stream with `DMA_Register_Callback`, if any.
  */
 void DMA1_Stream0_IRQHandler(void)
 {
+	uint32_t event = 0;
+
 	if(DMA1 -> LISR & DMA_LISR_FEIF0)
 	{
 		DMA1_Stream0_Flag.Fifo_Error_Flag = true;
+		event = DMA_Configuration.DMA_Interrupts.Fifo_Error;
 		DMA1 -> LIFCR |= DMA_LIFCR_CFEIF0;
 	}
 	/************************************************************************************************************/
 	else if(DMA1 -> LISR & DMA_LISR_DMEIF0)
 	{
 		DMA1_Stream0_Flag.Direct_Mode_Error_Flag = true;
+		event = DMA_Configuration.DMA_Interrupts.Direct_Mode_Error;
 		DMA1 -> LIFCR |= DMA_LIFCR_CDMEIF0;
 	}
 	/************************************************************************************************************/
 	else if(DMA1 -> LISR & DMA_LISR_TEIF0)
 	{
 		DMA1_Stream0_Flag.Transfer_Error_Flag = true;
+		event = DMA_Configuration.DMA_Interrupts.Transfer_Error;
 		DMA1 -> LIFCR |= DMA_LIFCR_CTEIF0;
 	}
 	/************************************************************************************************************/
 	else if(DMA1 -> LISR & DMA_LISR_HTIF0)
 	{
 		DMA1_Stream0_Flag.Half_Transfer_Complete_Flag = true;
+		event = DMA_Configuration.DMA_Interrupts.Half_Transfer_Complete;
 		DMA1 -> LIFCR |= DMA_LIFCR_CHTIF0;
 	}
 	/************************************************************************************************************/
 	else if(DMA1 -> LISR & DMA_LISR_TCIF0)
 	{
 		DMA1_Stream0_Flag.Transfer_Complete_Flag = true;
+		event = DMA_Configuration.DMA_Interrupts.Transfer_Complete;
 		DMA1 -> LIFCR |= DMA_LIFCR_CTCIF0;
 	}
+
+	DMA_Dispatch_Callback(0, DMA1_Stream0, event);
 }
 
 /**
@@ -83,38 +192,50 @@ void DMA1_Stream0_IRQHandler(void)
  * transfer error, half transfer complete, and transfer complete. For each
  * event, it sets the corresponding flag in the `DMA1_Stream1_Flag` structure
  * and clears the respective interrupt flag in the DMA interrupt flag clear register.
+ *
+ * The handled event is then forwarded to the callback registered for the
+ * stream with `DMA_Register_Callback`, if any.
  */
 void DMA1_Stream1_IRQHandler(void)
 {
+	uint32_t event = 0;
+
 	if(DMA1 -> LISR & DMA_LISR_FEIF1)
 	{
 		DMA1_Stream1_Flag.Fifo_Error_Flag = true;
+		event = DMA_Configuration.DMA_Interrupts.Fifo_Error;
 		DMA1 -> LIFCR |= DMA_LIFCR_CFEIF1;
 	}
 	/************************************************************************************************************/
 	else if(DMA1 -> LISR & DMA_LISR_DMEIF1)
 	{
 		DMA1_Stream1_Flag.Direct_Mode_Error_Flag = true;
+		event = DMA_Configuration.DMA_Interrupts.Direct_Mode_Error;
 		DMA1 -> LIFCR |= DMA_LIFCR_CDMEIF1;
 	}
 	/************************************************************************************************************/
 	else if(DMA1 -> LISR & DMA_LISR_TEIF1)
 	{
 		DMA1_Stream1_Flag.Transfer_Error_Flag = true;
+		event = DMA_Configuration.DMA_Interrupts.Transfer_Error;
 		DMA1 -> LIFCR |= DMA_LIFCR_CTEIF1;
 	}
 	/************************************************************************************************************/
 	else if(DMA1 -> LISR & DMA_LISR_HTIF1)
 	{
 		DMA1_Stream1_Flag.Half_Transfer_Complete_Flag = true;
+		event = DMA_Configuration.DMA_Interrupts.Half_Transfer_Complete;
 		DMA1 -> LIFCR |= DMA_LIFCR_CHTIF1;
 	}
 	/************************************************************************************************************/
 	else if(DMA1 -> LISR & DMA_LISR_TCIF1)
 	{
 		DMA1_Stream1_Flag.Transfer_Complete_Flag = true;
+		event = DMA_Configuration.DMA_Interrupts.Transfer_Complete;
 		DMA1 -> LIFCR |= DMA_LIFCR_CTCIF1;
 	}
+
+	DMA_Dispatch_Callback(1, DMA1_Stream1, event);
 }
 /**
  * @brief DMA1 Stream 2 Interrupt Handler
@@ -124,38 +245,50 @@ void DMA1_Stream1_IRQHandler(void)
  * transfer error, half transfer complete, and transfer complete. For each
  * event, it sets the corresponding flag in the `DMA1_Stream2_Flag` structure
  * and clears the respective interrupt flag in the DMA interrupt flag clear register.
+ *
+ * The handled event is then forwarded to the callback registered for the
+ * stream with `DMA_Register_Callback`, if any.
  */
 void DMA1_Stream2_IRQHandler(void)
 {
+	uint32_t event = 0;
+
 	if(DMA1 -> LISR & DMA_LISR_FEIF2)
 	{
 		DMA1_Stream2_Flag.Fifo_Error_Flag = true;
+		event = DMA_Configuration.DMA_Interrupts.Fifo_Error;
 		DMA1 -> LIFCR |= DMA_LIFCR_CFEIF2;
 	}
 	/************************************************************************************************************/
 	else if(DMA1 -> LISR & DMA_LISR_DMEIF2)
 	{
 		DMA1_Stream2_Flag.Direct_Mode_Error_Flag = true;
+		event = DMA_Configuration.DMA_Interrupts.Direct_Mode_Error;
 		DMA1 -> LIFCR |= DMA_LIFCR_CDMEIF2;
 	}
 	/************************************************************************************************************/
 	else if(DMA1 -> LISR & DMA_LISR_TEIF2)
 	{
 		DMA1_Stream2_Flag.Transfer_Error_Flag = true;
+		event = DMA_Configuration.DMA_Interrupts.Transfer_Error;
 		DMA1 -> LIFCR |= DMA_LIFCR_CTEIF2;
 	}
 	/************************************************************************************************************/
 	else if(DMA1 -> LISR & DMA_LISR_HTIF2)
 	{
 		DMA1_Stream2_Flag.Half_Transfer_Complete_Flag = true;
+		event = DMA_Configuration.DMA_Interrupts.Half_Transfer_Complete;
 		DMA1 -> LIFCR |= DMA_LIFCR_CHTIF2;
 	}
 	/************************************************************************************************************/
 	else if(DMA1 -> LISR & DMA_LISR_TCIF2)
 	{
 		DMA1_Stream2_Flag.Transfer_Complete_Flag = true;
+		event = DMA_Configuration.DMA_Interrupts.Transfer_Complete;
 		DMA1 -> LIFCR |= DMA_LIFCR_CTCIF2;
 	}
+
+	DMA_Dispatch_Callback(2, DMA1_Stream2, event);
 }
 
 /**
@@ -166,38 +299,50 @@ void DMA1_Stream2_IRQHandler(void)
  * transfer error, half transfer complete, and transfer complete. For each
  * event, it sets the corresponding flag in the `DMA1_Stream3_Flag` structure
  * and clears the respective interrupt flag in the DMA interrupt flag clear register.
+ *
+ * The handled event is then forwarded to the callback registered for the
+ * stream with `DMA_Register_Callback`, if any.
  */
 void DMA1_Stream3_IRQHandler(void)
 {
+	uint32_t event = 0;
+
 	if(DMA1 -> LISR & DMA_LISR_FEIF3)
 	{
 		DMA1_Stream3_Flag.Fifo_Error_Flag = true;
+		event = DMA_Configuration.DMA_Interrupts.Fifo_Error;
 		DMA1 -> LIFCR |= DMA_LIFCR_CFEIF3;
 	}
 	/************************************************************************************************************/
 	else if(DMA1 -> LISR & DMA_LISR_DMEIF3)
 	{
 		DMA1_Stream3_Flag.Direct_Mode_Error_Flag = true;
+		event = DMA_Configuration.DMA_Interrupts.Direct_Mode_Error;
 		DMA1 -> LIFCR |= DMA_LIFCR_CDMEIF3;
 	}
 	/************************************************************************************************************/
 	else if(DMA1 -> LISR & DMA_LISR_TEIF3)
 	{
 		DMA1_Stream3_Flag.Transfer_Error_Flag = true;
+		event = DMA_Configuration.DMA_Interrupts.Transfer_Error;
 		DMA1 -> LIFCR |= DMA_LIFCR_CTEIF3;
 	}
 	/************************************************************************************************************/
 	else if(DMA1 -> LISR & DMA_LISR_HTIF3)
 	{
 		DMA1_Stream3_Flag.Half_Transfer_Complete_Flag = true;
+		event = DMA_Configuration.DMA_Interrupts.Half_Transfer_Complete;
 		DMA1 -> LIFCR |= DMA_LIFCR_CHTIF3;
 	}
 	/************************************************************************************************************/
 	else if(DMA1 -> LISR & DMA_LISR_TCIF3)
 	{
 		DMA1_Stream3_Flag.Transfer_Complete_Flag = true;
+		event = DMA_Configuration.DMA_Interrupts.Transfer_Complete;
 		DMA1 -> LIFCR |= DMA_LIFCR_CTCIF3;
 	}
+
+	DMA_Dispatch_Callback(3, DMA1_Stream3, event);
 }
 
 /**
@@ -208,38 +353,50 @@ void DMA1_Stream3_IRQHandler(void)
  * transfer error, half transfer complete, and transfer complete. For each
  * event, it sets the corresponding flag in the `DMA1_Stream4_Flag` structure
  * and clears the respective interrupt flag in the DMA interrupt flag clear register.
+ *
+ * The handled event is then forwarded to the callback registered for the
+ * stream with `DMA_Register_Callback`, if any.
  */
 void DMA1_Stream4_IRQHandler(void)
 {
+	uint32_t event = 0;
+
 	if(DMA1 -> HISR & DMA_HISR_FEIF4)
 	{
 		DMA1_Stream4_Flag.Fifo_Error_Flag = true;
+		event = DMA_Configuration.DMA_Interrupts.Fifo_Error;
 		DMA1 -> HIFCR |= DMA_HIFCR_CFEIF4;
 	}
 	/************************************************************************************************************/
 	else if(DMA1 -> HISR & DMA_HISR_DMEIF4)
 	{
 		DMA1_Stream4_Flag.Direct_Mode_Error_Flag = true;
+		event = DMA_Configuration.DMA_Interrupts.Direct_Mode_Error;
 		DMA1 -> HIFCR |= DMA_HIFCR_CDMEIF4;
 	}
 	/************************************************************************************************************/
 	else if(DMA1 -> HISR & DMA_HISR_TEIF4)
 	{
 		DMA1_Stream4_Flag.Transfer_Error_Flag = true;
+		event = DMA_Configuration.DMA_Interrupts.Transfer_Error;
 		DMA1 -> HIFCR |= DMA_HIFCR_CTEIF4;
 	}
 	/************************************************************************************************************/
 	else if(DMA1 -> HISR & DMA_HISR_HTIF4)
 	{
 		DMA1_Stream4_Flag.Half_Transfer_Complete_Flag = true;
+		event = DMA_Configuration.DMA_Interrupts.Half_Transfer_Complete;
 		DMA1 -> HIFCR |= DMA_HIFCR_CHTIF4;
 	}
 	/************************************************************************************************************/
 	else if(DMA1 -> HISR & DMA_HISR_TCIF4)
 	{
 		DMA1_Stream4_Flag.Transfer_Complete_Flag = true;
+		event = DMA_Configuration.DMA_Interrupts.Transfer_Complete;
 		DMA1 -> HIFCR |= DMA_HIFCR_CTCIF4;
 	}
+
+	DMA_Dispatch_Callback(4, DMA1_Stream4, event);
 }
 
 /**
@@ -250,38 +407,50 @@ void DMA1_Stream4_IRQHandler(void)
  * transfer error, half transfer complete, and transfer complete. For each
  * event, it sets the corresponding flag in the `DMA1_Stream5_Flag` structure
  * and clears the respective interrupt flag in the DMA interrupt flag clear register.
+ *
+ * The handled event is then forwarded to the callback registered for the
+ * stream with `DMA_Register_Callback`, if any.
  */
 void DMA1_Stream5_IRQHandler(void)
 {
+	uint32_t event = 0;
+
 	if(DMA1 -> HISR & DMA_HISR_FEIF5)
 	{
 		DMA1_Stream5_Flag.Fifo_Error_Flag = true;
+		event = DMA_Configuration.DMA_Interrupts.Fifo_Error;
 		DMA1 -> HIFCR |= DMA_HIFCR_CFEIF5;
 	}
 	/************************************************************************************************************/
 	else if(DMA1 -> HISR & DMA_HISR_DMEIF5)
 	{
 		DMA1_Stream5_Flag.Direct_Mode_Error_Flag = true;
+		event = DMA_Configuration.DMA_Interrupts.Direct_Mode_Error;
 		DMA1 -> HIFCR |= DMA_HIFCR_CDMEIF5;
 	}
 	/************************************************************************************************************/
 	else if(DMA1 -> HISR & DMA_HISR_TEIF5)
 	{
 		DMA1_Stream5_Flag.Transfer_Error_Flag = true;
+		event = DMA_Configuration.DMA_Interrupts.Transfer_Error;
 		DMA1 -> HIFCR |= DMA_HIFCR_CTEIF5;
 	}
 	/************************************************************************************************************/
 	else if(DMA1 -> HISR & DMA_HISR_HTIF5)
 	{
 		DMA1_Stream5_Flag.Half_Transfer_Complete_Flag = true;
+		event = DMA_Configuration.DMA_Interrupts.Half_Transfer_Complete;
 		DMA1 -> HIFCR |= DMA_HIFCR_CHTIF5;
 	}
 	/************************************************************************************************************/
 	else if(DMA1 -> HISR & DMA_HISR_TCIF5)
 	{
 		DMA1_Stream5_Flag.Transfer_Complete_Flag = true;
+		event = DMA_Configuration.DMA_Interrupts.Transfer_Complete;
 		DMA1 -> HIFCR |= DMA_HIFCR_CTCIF5;
 	}
+
+	DMA_Dispatch_Callback(5, DMA1_Stream5, event);
 }
 
 /**
@@ -292,38 +461,50 @@ void DMA1_Stream5_IRQHandler(void)
  * transfer error, half transfer complete, and transfer complete. For each
  * event, it sets the corresponding flag in the `DMA1_Stream6_Flag` structure
  * and clears the respective interrupt flag in the DMA interrupt flag clear register.
+ *
+ * The handled event is then forwarded to the callback registered for the
+ * stream with `DMA_Register_Callback`, if any.
  */
 void DMA1_Stream6_IRQHandler(void)
 {
+	uint32_t event = 0;
+
 	if(DMA1 -> HISR & DMA_HISR_FEIF6)
 	{
 		DMA1_Stream6_Flag.Fifo_Error_Flag = true;
+		event = DMA_Configuration.DMA_Interrupts.Fifo_Error;
 		DMA1 -> HIFCR |= DMA_HIFCR_CFEIF6;
 	}
 	/************************************************************************************************************/
 	else if(DMA1 -> HISR & DMA_HISR_DMEIF6)
 	{
 		DMA1_Stream6_Flag.Direct_Mode_Error_Flag = true;
+		event = DMA_Configuration.DMA_Interrupts.Direct_Mode_Error;
 		DMA1 -> HIFCR |= DMA_HIFCR_CDMEIF6;
 	}
 	/************************************************************************************************************/
 	else if(DMA1 -> HISR & DMA_HISR_TEIF6)
 	{
 		DMA1_Stream6_Flag.Transfer_Error_Flag = true;
+		event = DMA_Configuration.DMA_Interrupts.Transfer_Error;
 		DMA1 -> HIFCR |= DMA_HIFCR_CTEIF6;
 	}
 	/************************************************************************************************************/
 	else if(DMA1 -> HISR & DMA_HISR_HTIF6)
 	{
 		DMA1_Stream6_Flag.Half_Transfer_Complete_Flag = true;
+		event = DMA_Configuration.DMA_Interrupts.Half_Transfer_Complete;
 		DMA1 -> HIFCR |= DMA_HIFCR_CHTIF6;
 	}
 	/************************************************************************************************************/
 	else if(DMA1 -> HISR & DMA_HISR_TCIF6)
 	{
 		DMA1_Stream6_Flag.Transfer_Complete_Flag = true;
+		event = DMA_Configuration.DMA_Interrupts.Transfer_Complete;
 		DMA1 -> HIFCR |= DMA_HIFCR_CTCIF6;
 	}
+
+	DMA_Dispatch_Callback(6, DMA1_Stream6, event);
 }
 
 /**
@@ -334,38 +515,50 @@ void DMA1_Stream6_IRQHandler(void)
  * transfer error, half transfer complete, and transfer complete. For each
  * event, it sets the corresponding flag in the `DMA1_Stream7_Flag` structure
  * and clears the respective interrupt flag in the DMA interrupt flag clear register.
+ *
+ * The handled event is then forwarded to the callback registered for the
+ * stream with `DMA_Register_Callback`, if any.
  */
 void DMA1_Stream7_IRQHandler(void)
 {
+	uint32_t event = 0;
+
 	if(DMA1 -> HISR & DMA_HISR_FEIF7)
 	{
 		DMA1_Stream7_Flag.Fifo_Error_Flag = true;
+		event = DMA_Configuration.DMA_Interrupts.Fifo_Error;
 		DMA1 -> HIFCR |= DMA_HIFCR_CFEIF7;
 	}
 	/************************************************************************************************************/
 	else if(DMA1 -> HISR & DMA_HISR_DMEIF7)
 	{
 		DMA1_Stream7_Flag.Direct_Mode_Error_Flag = true;
+		event = DMA_Configuration.DMA_Interrupts.Direct_Mode_Error;
 		DMA1 -> HIFCR |= DMA_HIFCR_CDMEIF7;
 	}
 	/************************************************************************************************************/
 	else if(DMA1 -> HISR & DMA_HISR_TEIF7)
 	{
 		DMA1_Stream7_Flag.Transfer_Error_Flag = true;
+		event = DMA_Configuration.DMA_Interrupts.Transfer_Error;
 		DMA1 -> HIFCR |= DMA_HIFCR_CTEIF7;
 	}
 	/************************************************************************************************************/
 	else if(DMA1 -> HISR & DMA_HISR_HTIF7)
 	{
 		DMA1_Stream7_Flag.Half_Transfer_Complete_Flag = true;
+		event = DMA_Configuration.DMA_Interrupts.Half_Transfer_Complete;
 		DMA1 -> HIFCR |= DMA_HIFCR_CHTIF7;
 	}
 	/************************************************************************************************************/
 	else if(DMA1 -> HISR & DMA_HISR_TCIF7)
 	{
 		DMA1_Stream7_Flag.Transfer_Complete_Flag = true;
+		event = DMA_Configuration.DMA_Interrupts.Transfer_Complete;
 		DMA1 -> HIFCR |= DMA_HIFCR_CTCIF7;
 	}
+
+	DMA_Dispatch_Callback(7, DMA1_Stream7, event);
 }
 
 /**
@@ -376,38 +569,50 @@ void DMA1_Stream7_IRQHandler(void)
  * transfer error, half transfer complete, and transfer complete. For each
  * event, it sets the corresponding flag in the `DMA2_Stream0_Flag` structure
  * and clears the respective interrupt flag in the DMA interrupt flag clear register.
+ *
+ * The handled event is then forwarded to the callback registered for the
+ * stream with `DMA_Register_Callback`, if any.
  */
 void DMA2_Stream0_IRQHandler(void)
 {
+	uint32_t event = 0;
+
 	if(DMA2 -> LISR & DMA_LISR_FEIF0)
 	{
 		DMA2_Stream0_Flag.Fifo_Error_Flag = true;
+		event = DMA_Configuration.DMA_Interrupts.Fifo_Error;
 		DMA2 -> LIFCR |= DMA_LIFCR_CFEIF0;
 	}
 	/************************************************************************************************************/
 	else if(DMA2 -> LISR & DMA_LISR_DMEIF0)
 	{
 		DMA2_Stream0_Flag.Direct_Mode_Error_Flag = true;
+		event = DMA_Configuration.DMA_Interrupts.Direct_Mode_Error;
 		DMA2 -> LIFCR |= DMA_LIFCR_CDMEIF0;
 	}
 	/************************************************************************************************************/
 	else if(DMA2 -> LISR & DMA_LISR_TEIF0)
 	{
 		DMA2_Stream0_Flag.Transfer_Error_Flag = true;
+		event = DMA_Configuration.DMA_Interrupts.Transfer_Error;
 		DMA2 -> LIFCR |= DMA_LIFCR_CTEIF0;
 	}
 	/************************************************************************************************************/
 	else if(DMA2 -> LISR & DMA_LISR_HTIF0)
 	{
 		DMA2_Stream0_Flag.Half_Transfer_Complete_Flag = true;
+		event = DMA_Configuration.DMA_Interrupts.Half_Transfer_Complete;
 		DMA2 -> LIFCR |= DMA_LIFCR_CHTIF0;
 	}
 	/************************************************************************************************************/
 	else if(DMA2 -> LISR & DMA_LISR_TCIF0)
 	{
 		DMA2_Stream0_Flag.Transfer_Complete_Flag = true;
+		event = DMA_Configuration.DMA_Interrupts.Transfer_Complete;
 		DMA2 -> LIFCR |= DMA_LIFCR_CTCIF0;
 	}
+
+	DMA_Dispatch_Callback(8, DMA2_Stream0, event);
 }
 
 /**
@@ -418,38 +623,50 @@ void DMA2_Stream0_IRQHandler(void)
  * transfer error, half transfer complete, and transfer complete. For each
  * event, it sets the corresponding flag in the `DMA2_Stream1_Flag` structure
  * and clears the respective interrupt flag in the DMA interrupt flag clear register.
+ *
+ * The handled event is then forwarded to the callback registered for the
+ * stream with `DMA_Register_Callback`, if any.
  */
 void DMA2_Stream1_IRQHandler(void)
 {
+	uint32_t event = 0;
+
 	if(DMA2 -> LISR & DMA_LISR_FEIF1)
 	{
 		DMA2_Stream1_Flag.Fifo_Error_Flag = true;
+		event = DMA_Configuration.DMA_Interrupts.Fifo_Error;
 		DMA2 -> LIFCR |= DMA_LIFCR_CFEIF1;
 	}
 	/************************************************************************************************************/
 	else if(DMA2 -> LISR & DMA_LISR_DMEIF1)
 	{
 		DMA2_Stream1_Flag.Direct_Mode_Error_Flag = true;
+		event = DMA_Configuration.DMA_Interrupts.Direct_Mode_Error;
 		DMA2 -> LIFCR |= DMA_LIFCR_CDMEIF1;
 	}
 	/************************************************************************************************************/
 	else if(DMA2 -> LISR & DMA_LISR_TEIF1)
 	{
 		DMA2_Stream1_Flag.Transfer_Error_Flag = true;
+		event = DMA_Configuration.DMA_Interrupts.Transfer_Error;
 		DMA2 -> LIFCR |= DMA_LIFCR_CTEIF1;
 	}
 	/************************************************************************************************************/
 	else if(DMA2 -> LISR & DMA_LISR_HTIF1)
 	{
 		DMA2_Stream1_Flag.Half_Transfer_Complete_Flag = true;
+		event = DMA_Configuration.DMA_Interrupts.Half_Transfer_Complete;
 		DMA2 -> LIFCR |= DMA_LIFCR_CHTIF1;
 	}
 	/************************************************************************************************************/
 	else if(DMA2 -> LISR & DMA_LISR_TCIF1)
 	{
 		DMA2_Stream1_Flag.Transfer_Complete_Flag = true;
+		event = DMA_Configuration.DMA_Interrupts.Transfer_Complete;
 		DMA2 -> LIFCR |= DMA_LIFCR_CTCIF1;
 	}
+
+	DMA_Dispatch_Callback(9, DMA2_Stream1, event);
 }
 
 /**
@@ -460,38 +677,50 @@ void DMA2_Stream1_IRQHandler(void)
  * transfer error, half transfer complete, and transfer complete. For each
  * event, it sets the corresponding flag in the `DMA2_Stream2_Flag` structure
  * and clears the respective interrupt flag in the DMA interrupt flag clear register.
+ *
+ * The handled event is then forwarded to the callback registered for the
+ * stream with `DMA_Register_Callback`, if any.
  */
 void DMA2_Stream2_IRQHandler(void)
 {
+	uint32_t event = 0;
+
 	if(DMA2 -> LISR & DMA_LISR_FEIF2)
 	{
 		DMA2_Stream2_Flag.Fifo_Error_Flag = true;
+		event = DMA_Configuration.DMA_Interrupts.Fifo_Error;
 		DMA2 -> LIFCR |= DMA_LIFCR_CFEIF2;
 	}
 	/************************************************************************************************************/
 	else if(DMA2 -> LISR & DMA_LISR_DMEIF2)
 	{
 		DMA2_Stream2_Flag.Direct_Mode_Error_Flag = true;
+		event = DMA_Configuration.DMA_Interrupts.Direct_Mode_Error;
 		DMA2 -> LIFCR |= DMA_LIFCR_CDMEIF2;
 	}
 	/************************************************************************************************************/
 	else if(DMA2 -> LISR & DMA_LISR_TEIF2)
 	{
 		DMA2_Stream2_Flag.Transfer_Error_Flag = true;
+		event = DMA_Configuration.DMA_Interrupts.Transfer_Error;
 		DMA2 -> LIFCR |= DMA_LIFCR_CTEIF2;
 	}
 	/************************************************************************************************************/
 	else if(DMA2 -> LISR & DMA_LISR_HTIF2)
 	{
 		DMA2_Stream2_Flag.Half_Transfer_Complete_Flag = true;
+		event = DMA_Configuration.DMA_Interrupts.Half_Transfer_Complete;
 		DMA2 -> LIFCR |= DMA_LIFCR_CHTIF2;
 	}
 	/************************************************************************************************************/
 	else if(DMA2 -> LISR & DMA_LISR_TCIF2)
 	{
 		DMA2_Stream2_Flag.Transfer_Complete_Flag = true;
+		event = DMA_Configuration.DMA_Interrupts.Transfer_Complete;
 		DMA2 -> LIFCR |= DMA_LIFCR_CTCIF2;
 	}
+
+	DMA_Dispatch_Callback(10, DMA2_Stream2, event);
 }
 
 /**
@@ -502,38 +731,50 @@ void DMA2_Stream2_IRQHandler(void)
  * transfer error, half transfer complete, and transfer complete. For each
  * event, it sets the corresponding flag in the `DMA2_Stream3_Flag` structure
  * and clears the respective interrupt flag in the DMA interrupt flag clear register.
+ *
+ * The handled event is then forwarded to the callback registered for the
+ * stream with `DMA_Register_Callback`, if any.
  */
 void DMA2_Stream3_IRQHandler(void)
 {
+	uint32_t event = 0;
+
 	if(DMA2 -> LISR & DMA_LISR_FEIF3)
 	{
 		DMA2_Stream3_Flag.Fifo_Error_Flag = true;
+		event = DMA_Configuration.DMA_Interrupts.Fifo_Error;
 		DMA2 -> LIFCR |= DMA_LIFCR_CFEIF3;
 	}
 	/************************************************************************************************************/
 	else if(DMA2 -> LISR & DMA_LISR_DMEIF3)
 	{
 		DMA2_Stream3_Flag.Direct_Mode_Error_Flag = true;
+		event = DMA_Configuration.DMA_Interrupts.Direct_Mode_Error;
 		DMA2 -> LIFCR |= DMA_LIFCR_CDMEIF3;
 	}
 	/************************************************************************************************************/
 	else if(DMA2 -> LISR & DMA_LISR_TEIF3)
 	{
 		DMA2_Stream3_Flag.Transfer_Error_Flag = true;
+		event = DMA_Configuration.DMA_Interrupts.Transfer_Error;
 		DMA2 -> LIFCR |= DMA_LIFCR_CTEIF3;
 	}
 	/************************************************************************************************************/
 	else if(DMA2 -> LISR & DMA_LISR_HTIF3)
 	{
 		DMA2_Stream3_Flag.Half_Transfer_Complete_Flag = true;
+		event = DMA_Configuration.DMA_Interrupts.Half_Transfer_Complete;
 		DMA2 -> LIFCR |= DMA_LIFCR_CHTIF3;
 	}
 	/************************************************************************************************************/
 	else if(DMA2 -> LISR & DMA_LISR_TCIF3)
 	{
 		DMA2_Stream3_Flag.Transfer_Complete_Flag = true;
+		event = DMA_Configuration.DMA_Interrupts.Transfer_Complete;
 		DMA2 -> LIFCR |= DMA_LIFCR_CTCIF3;
 	}
+
+	DMA_Dispatch_Callback(11, DMA2_Stream3, event);
 }
 
 /**
@@ -544,38 +785,50 @@ void DMA2_Stream3_IRQHandler(void)
  * transfer error, half transfer complete, and transfer complete. For each
  * event, it sets the corresponding flag in the `DMA2_Stream4_Flag` structure
  * and clears the respective interrupt flag in the DMA interrupt flag clear register.
+ *
+ * The handled event is then forwarded to the callback registered for the
+ * stream with `DMA_Register_Callback`, if any.
  */
 void DMA2_Stream4_IRQHandler(void)
 {
+	uint32_t event = 0;
+
 	if(DMA2 -> HISR & DMA_HISR_FEIF4)
 	{
 		DMA2_Stream4_Flag.Fifo_Error_Flag = true;
+		event = DMA_Configuration.DMA_Interrupts.Fifo_Error;
 		DMA2 -> HIFCR |= DMA_HIFCR_CFEIF4;
 	}
 	/************************************************************************************************************/
 	else if(DMA2 -> HISR & DMA_HISR_DMEIF4)
 	{
 		DMA2_Stream4_Flag.Direct_Mode_Error_Flag = true;
+		event = DMA_Configuration.DMA_Interrupts.Direct_Mode_Error;
 		DMA2 -> HIFCR |= DMA_HIFCR_CDMEIF4;
 	}
 	/************************************************************************************************************/
 	else if(DMA2 -> HISR & DMA_HISR_TEIF4)
 	{
 		DMA2_Stream4_Flag.Transfer_Error_Flag = true;
+		event = DMA_Configuration.DMA_Interrupts.Transfer_Error;
 		DMA2 -> HIFCR |= DMA_HIFCR_CTEIF4;
 	}
 	/************************************************************************************************************/
 	else if(DMA2 -> HISR & DMA_HISR_HTIF4)
 	{
 		DMA2_Stream4_Flag.Half_Transfer_Complete_Flag = true;
+		event = DMA_Configuration.DMA_Interrupts.Half_Transfer_Complete;
 		DMA2 -> HIFCR |= DMA_HIFCR_CHTIF4;
 	}
 	/************************************************************************************************************/
 	else if(DMA2 -> HISR & DMA_HISR_TCIF4)
 	{
 		DMA2_Stream4_Flag.Transfer_Complete_Flag = true;
+		event = DMA_Configuration.DMA_Interrupts.Transfer_Complete;
 		DMA2 -> HIFCR |= DMA_HIFCR_CTCIF4;
 	}
+
+	DMA_Dispatch_Callback(12, DMA2_Stream4, event);
 }
 
 /**
@@ -586,38 +839,50 @@ void DMA2_Stream4_IRQHandler(void)
  * transfer error, half transfer complete, and transfer complete. For each
  * event, it sets the corresponding flag in the `DMA2_Stream5_Flag` structure
  * and clears the respective interrupt flag in the DMA interrupt flag clear register.
+ *
+ * The handled event is then forwarded to the callback registered for the
+ * stream with `DMA_Register_Callback`, if any.
  */
 void DMA2_Stream5_IRQHandler(void)
 {
+	uint32_t event = 0;
+
 	if(DMA2 -> HISR & DMA_HISR_FEIF5)
 	{
 		DMA2_Stream5_Flag.Fifo_Error_Flag = true;
+		event = DMA_Configuration.DMA_Interrupts.Fifo_Error;
 		DMA2 -> HIFCR |= DMA_HIFCR_CFEIF5;
 	}
 	/************************************************************************************************************/
 	else if(DMA2 -> HISR & DMA_HISR_DMEIF5)
 	{
 		DMA2_Stream5_Flag.Direct_Mode_Error_Flag = true;
+		event = DMA_Configuration.DMA_Interrupts.Direct_Mode_Error;
 		DMA2 -> HIFCR |= DMA_HIFCR_CDMEIF5;
 	}
 	/************************************************************************************************************/
 	else if(DMA2 -> HISR & DMA_HISR_TEIF5)
 	{
 		DMA2_Stream5_Flag.Transfer_Error_Flag = true;
+		event = DMA_Configuration.DMA_Interrupts.Transfer_Error;
 		DMA2 -> HIFCR |= DMA_HIFCR_CTEIF5;
 	}
 	/************************************************************************************************************/
 	else if(DMA2 -> HISR & DMA_HISR_HTIF5)
 	{
 		DMA2_Stream5_Flag.Half_Transfer_Complete_Flag = true;
+		event = DMA_Configuration.DMA_Interrupts.Half_Transfer_Complete;
 		DMA2 -> HIFCR |= DMA_HIFCR_CHTIF5;
 	}
 	/************************************************************************************************************/
 	else if(DMA2 -> HISR & DMA_HISR_TCIF5)
 	{
 		DMA2_Stream5_Flag.Transfer_Complete_Flag = true;
+		event = DMA_Configuration.DMA_Interrupts.Transfer_Complete;
 		DMA2 -> HIFCR |= DMA_HIFCR_CTCIF5;
 	}
+
+	DMA_Dispatch_Callback(13, DMA2_Stream5, event);
 }
 
 /**
@@ -628,38 +893,50 @@ void DMA2_Stream5_IRQHandler(void)
  * transfer error, half transfer complete, and transfer complete. For each
  * event, it sets the corresponding flag in the `DMA2_Stream6_Flag` structure
  * and clears the respective interrupt flag in the DMA interrupt flag clear register.
+ *
+ * The handled event is then forwarded to the callback registered for the
+ * stream with `DMA_Register_Callback`, if any.
  */
 void DMA2_Stream6_IRQHandler(void)
 {
+	uint32_t event = 0;
+
 	if(DMA2 -> HISR & DMA_HISR_FEIF6)
 	{
 		DMA2_Stream6_Flag.Fifo_Error_Flag = true;
+		event = DMA_Configuration.DMA_Interrupts.Fifo_Error;
 		DMA2 -> HIFCR |= DMA_HIFCR_CFEIF6;
 	}
 	/************************************************************************************************************/
 	else if(DMA2 -> HISR & DMA_HISR_DMEIF6)
 	{
 		DMA2_Stream6_Flag.Direct_Mode_Error_Flag = true;
+		event = DMA_Configuration.DMA_Interrupts.Direct_Mode_Error;
 		DMA2 -> HIFCR |= DMA_HIFCR_CDMEIF6;
 	}
 	/************************************************************************************************************/
 	else if(DMA2 -> HISR & DMA_HISR_TEIF6)
 	{
 		DMA2_Stream6_Flag.Transfer_Error_Flag = true;
+		event = DMA_Configuration.DMA_Interrupts.Transfer_Error;
 		DMA2 -> HIFCR |= DMA_HIFCR_CTEIF6;
 	}
 	/************************************************************************************************************/
 	else if(DMA2 -> HISR & DMA_HISR_HTIF6)
 	{
 		DMA2_Stream6_Flag.Half_Transfer_Complete_Flag = true;
+		event = DMA_Configuration.DMA_Interrupts.Half_Transfer_Complete;
 		DMA2 -> HIFCR |= DMA_HIFCR_CHTIF6;
 	}
 	/************************************************************************************************************/
 	else if(DMA2 -> HISR & DMA_HISR_TCIF6)
 	{
 		DMA2_Stream6_Flag.Transfer_Complete_Flag = true;
+		event = DMA_Configuration.DMA_Interrupts.Transfer_Complete;
 		DMA2 -> HIFCR |= DMA_HIFCR_CTCIF6;
 	}
+
+	DMA_Dispatch_Callback(14, DMA2_Stream6, event);
 }
 
 /**
@@ -670,38 +947,50 @@ void DMA2_Stream6_IRQHandler(void)
  * transfer error, half transfer complete, and transfer complete. For each
  * event, it sets the corresponding flag in the `DMA2_Stream7_Flag` structure
  * and clears the respective interrupt flag in the DMA interrupt flag clear register.
+ *
+ * The handled event is then forwarded to the callback registered for the
+ * stream with `DMA_Register_Callback`, if any.
  */
 void DMA2_Stream7_IRQHandler(void)
 {
+	uint32_t event = 0;
+
 	if(DMA2 -> HISR & DMA_HISR_FEIF7)
 	{
 		DMA2_Stream7_Flag.Fifo_Error_Flag = true;
+		event = DMA_Configuration.DMA_Interrupts.Fifo_Error;
 		DMA2 -> HIFCR |= DMA_HIFCR_CFEIF7;
 	}
 	/************************************************************************************************************/
 	else if(DMA2 -> HISR & DMA_HISR_DMEIF7)
 	{
 		DMA2_Stream7_Flag.Direct_Mode_Error_Flag = true;
+		event = DMA_Configuration.DMA_Interrupts.Direct_Mode_Error;
 		DMA2 -> HIFCR |= DMA_HIFCR_CDMEIF7;
 	}
 	/************************************************************************************************************/
 	else if(DMA2 -> HISR & DMA_HISR_TEIF7)
 	{
 		DMA2_Stream7_Flag.Transfer_Error_Flag = true;
+		event = DMA_Configuration.DMA_Interrupts.Transfer_Error;
 		DMA2 -> HIFCR |= DMA_HIFCR_CTEIF7;
 	}
 	/************************************************************************************************************/
 	else if(DMA2 -> HISR & DMA_HISR_HTIF7)
 	{
 		DMA2_Stream7_Flag.Half_Transfer_Complete_Flag = true;
+		event = DMA_Configuration.DMA_Interrupts.Half_Transfer_Complete;
 		DMA2 -> HIFCR |= DMA_HIFCR_CHTIF7;
 	}
 	/************************************************************************************************************/
 	else if(DMA2 -> HISR & DMA_HISR_TCIF7)
 	{
 		DMA2_Stream7_Flag.Transfer_Complete_Flag = true;
+		event = DMA_Configuration.DMA_Interrupts.Transfer_Complete;
 		DMA2 -> HIFCR |= DMA_HIFCR_CTCIF7;
 	}
+
+	DMA_Dispatch_Callback(15, DMA2_Stream7, event);
 }
 
 /**
@@ -729,32 +1018,98 @@ void DMA_Reset_Flags(DMA_Flags_Typedef flag)
  * This function enables the clock for the DMA controller specified in the
  * `DMA_Config` structure. It checks whether the controller is `DMA1` or `DMA2`
  * and then enables the corresponding clock by setting the appropriate bit in
- * the RCC AHB1 peripheral clock enable register.
+ * the RCC AHB1 peripheral clock enable register. The configuration's stream
+ * holds a reference on the clock until `DMA_Clock_Disable`; enabling it again
+ * takes no further reference.
  *
  * @param[in] config Pointer to the `DMA_Config` structure that contains the DMA controller configuration.
  */
 void DMA_Clock_Enable(DMA_Config *config)
 {
-	if(config -> Request.Controller == DMA1) RCC -> AHB1ENR |= RCC_AHB1ENR_DMA1EN;
-	if(config -> Request.Controller == DMA2) RCC -> AHB1ENR |= RCC_AHB1ENR_DMA2EN;
+    int8_t index = DMA_Stream_Index(config -> Request.Stream);
+    uint32_t primask;
+
+    // Take the reference and ungate together, so a release in between cannot gate the controller again
+    primask = __get_PRIMASK();
+    __disable_irq();
+    if(index >= 0)
+    {
+        DMA_Clocked_Streams |= (uint16_t)(1U << index);
+        DMA_Clock_Ungate(index);
+    }
+    else
+    {
+        if(config -> Request.Controller == DMA1) RCC -> AHB1ENR |= RCC_AHB1ENR_DMA1EN;
+        if(config -> Request.Controller == DMA2) RCC -> AHB1ENR |= RCC_AHB1ENR_DMA2EN;
+    }
+    __set_PRIMASK(primask);
 }
 //
 
 /**
  * @brief Disables the clock for the specified DMA controller.
  *
- * This function disables the clock for the DMA controller specified in the
- * `DMA_Config` structure. It checks whether the controller is `DMA1` or `DMA2`
- * and then disables the corresponding clock by clearing the appropriate bit in
- * the RCC AHB1 peripheral clock enable register.
+ * This function drops the reference the configuration's stream holds on its
+ * controller's clock. The clock is gated, by clearing the appropriate bit in
+ * the RCC AHB1 peripheral clock enable register, only when no other stream of
+ * the controller is claimed, referenced or enabled. Register contents are
+ * kept while the clock is gated.
  *
  * @param[in] config Pointer to the `DMA_Config` structure that contains the DMA controller configuration.
  */
 void DMA_Clock_Disable(DMA_Config *config)
 {
+    int8_t index = DMA_Stream_Index(config -> Request.Stream);
+    uint32_t primask;
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+    if(index >= 0)
+    {
+        DMA_Clocked_Streams &= (uint16_t)~(1U << index);
+    }
+    DMA_Clock_Gate_Unused();
+    __set_PRIMASK(primask);
+}
+
+/**
+ * @brief Gates the clock of every DMA controller that is not in use.
+ *
+ * Drivers release their reference when they stop, so this is only needed
+ * after code that enabled a controller clock directly, e.g. the startup
+ * helper.
+ */
+void DMA_Clock_Power_Down(void)
+{
+    uint32_t primask;
 
-	if(config -> Request.Controller == DMA1) RCC -> AHB1ENR &= ~RCC_AHB1ENR_DMA1EN;
-	if(config -> Request.Controller == DMA2) RCC -> AHB1ENR &= ~RCC_AHB1ENR_DMA2EN;
+    primask = __get_PRIMASK();
+    __disable_irq();
+    DMA_Clock_Gate_Unused();
+    __set_PRIMASK(primask);
+}
+
+/**
+ * @brief Sleeps with WFI while DMA work is pending.
+ *
+ * The condition is checked with interrupts masked and the core sleeps before
+ * they are unmasked, so an interrupt that ends the work between the check
+ * and the WFI still wakes the core. Each wake-up lets the pending interrupts
+ * run and checks the condition again. Must be called with interrupts enabled.
+ *
+ * @param[in] pending Returns `true` while the work is pending (e.g. a wrapper of `DMA_Graph_Busy`).
+ * @param[in] context User pointer passed to `pending`.
+ */
+void DMA_Sleep_While(bool (*pending)(void *context), void *context)
+{
+    __disable_irq();
+    while(pending(context))
+    {
+        __WFI();
+        __enable_irq();
+        __disable_irq();
+    }
+    __enable_irq();
 }
 //
 
@@ -913,8 +1268,15 @@ void DMA_Set_Trigger(DMA_Config *config)
 
     DMA_TypeDef *controller = config->Request.Controller;
     DMA_Stream_TypeDef *stream = config->Request.Stream;
+    int8_t index = DMA_Stream_Index(stream);
     uint32_t shift;
 
+    // An error of the previous transfer is not reported by DMA_Wait for this one
+    if (index >= 0)
+    {
+        DMA_Wait_Error[index] = 0;
+    }
+
     if (controller == DMA1 || controller == DMA2)
     {
         // Determine the correct shift value and clear the corresponding flags in LIFCR or HIFCR
@@ -944,6 +1306,177 @@ void DMA_Set_Trigger(DMA_Config *config)
 }
 
 
+/**
+ * @brief Registers a callback for the events of a DMA stream.
+ *
+ * The callback is invoked from the stream's interrupt handler after the event
+ * has been recorded in the stream's flag structure and its status bit has been
+ * cleared, so it may reprogram and re-enable the stream directly. Passing a
+ * `NULL` callback removes the registration.
+ *
+ * @param[in] stream Pointer to the DMA stream (e.g. `config->Request.Stream`).
+ * @param[in] callback Function to call on each handled event, or `NULL`.
+ * @param[in] context User pointer passed back to the callback.
+ */
+void DMA_Register_Callback(DMA_Stream_TypeDef *stream, DMA_Callback_Typedef callback, void *context)
+{
+    int8_t index = DMA_Stream_Index(stream);
+
+    if (index < 0)
+    {
+        return;
+    }
+
+    // Clear the callback first so the handler never sees a new callback with a stale context
+    DMA_Callbacks[index] = NULL;
+    DMA_Callback_Contexts[index] = context;
+    DMA_Callbacks[index] = callback;
+}
+
+/**
+ * @brief Returns the flag clear register and mask of a DMA stream.
+ *
+ * Writing the returned mask to the returned register clears all five event
+ * flags of the stream in a single write. Drivers that restart a stream often
+ * can look these up once and avoid the read-modify-write of `DMA_Set_Trigger`.
+ *
+ * @param[in] stream Pointer to the DMA stream.
+ * @param[out] mask Receives the mask of the stream's flags in the returned register.
+ *
+ * @return volatile uint32_t* Pointer to LIFCR or HIFCR of the stream's controller, or NULL for an invalid stream.
+ */
+volatile uint32_t *DMA_Flag_Clear_Register(DMA_Stream_TypeDef *stream, uint32_t *mask)
+{
+    // Bit shift values for streams 0 to 3 (LIFCR) and 4 to 7 (HIFCR)
+    static const uint8_t Shifts[4] = {0, 6, 16, 22};
+    int8_t index = DMA_Stream_Index(stream);
+    DMA_TypeDef *controller;
+
+    if (index < 0)
+    {
+        return NULL;
+    }
+
+    controller = (index < 8) ? DMA1 : DMA2;
+    *mask = 0x3DUL << Shifts[index & 3];
+
+    return ((index & 4) == 0) ? &controller->LIFCR : &controller->HIFCR;
+}
+
+/**
+ * @brief Enables the NVIC interrupt of a DMA stream.
+ *
+ * `DMA_Init` does this for the single interrupt given in `DMA_Config`; drivers
+ * that program the stream registers themselves use this function instead.
+ *
+ * @param[in] stream Pointer to the DMA stream.
+ */
+void DMA_Stream_IRQ_Enable(DMA_Stream_TypeDef *stream)
+{
+    static const IRQn_Type IRQs[16] = {
+        DMA1_Stream0_IRQn, DMA1_Stream1_IRQn, DMA1_Stream2_IRQn, DMA1_Stream3_IRQn,
+        DMA1_Stream4_IRQn, DMA1_Stream5_IRQn, DMA1_Stream6_IRQn, DMA1_Stream7_IRQn,
+        DMA2_Stream0_IRQn, DMA2_Stream1_IRQn, DMA2_Stream2_IRQn, DMA2_Stream3_IRQn,
+        DMA2_Stream4_IRQn, DMA2_Stream5_IRQn, DMA2_Stream6_IRQn, DMA2_Stream7_IRQn,
+    };
+    int8_t index = DMA_Stream_Index(stream);
+
+    if (index >= 0)
+    {
+        NVIC_EnableIRQ(IRQs[index]);
+    }
+}
+
+/**
+ * @brief Enables the DWT cycle counter used for DMA timing measurements.
+ *
+ * Drivers that report latencies, deadline slack or skew read their timestamps
+ * with `DMA_Timestamp`, in CPU clock cycles. The counter wraps around every
+ * 2^32 cycles, so differences must be taken with unsigned arithmetic. It is
+ * zeroed only when it is started; once running it is shared by every user
+ * (drivers, profilers, an RTOS) and is never written again.
+ */
+void DMA_Timestamp_Enable(void)
+{
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    if((DWT->CTRL & DWT_CTRL_CYCCNTENA_Msk) == 0)
+    {
+        DWT->CYCCNT = 0;
+        DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    }
+}
+
+/**
+ * @brief Returns the current DWT cycle count.
+ *
+ * @return uint32_t CPU clock cycles since the counter was enabled (wrapping).
+ */
+uint32_t DMA_Timestamp(void)
+{
+    return DWT->CYCCNT;
+}
+
+/**
+ * @brief Claims a DMA stream for exclusive use by a driver.
+ *
+ * Several peripherals share each stream (e.g. SPI1_RX and ADC1 both use DMA2
+ * Stream 0). Drivers that own a stream for longer than a single call claim it,
+ * so that a second driver trying to use the same stream fails at
+ * initialization instead of corrupting a running transfer.
+ *
+ * @param[in] stream Pointer to the DMA stream.
+ *
+ * @return int8_t Returns 1 if the stream was claimed, or -1 if it is invalid or already claimed.
+ */
+int8_t DMA_Stream_Claim(DMA_Stream_TypeDef *stream)
+{
+    int8_t index = DMA_Stream_Index(stream);
+    uint32_t primask;
+    int8_t result = -1;
+
+    if (index < 0)
+    {
+        return -1;
+    }
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+
+    if ((DMA_Claimed_Streams & (1U << index)) == 0)
+    {
+        DMA_Claimed_Streams |= (uint16_t)(1U << index);
+        DMA_Clock_Ungate(index);
+        result = 1;
+    }
+
+    __set_PRIMASK(primask);
+
+    return result;
+}
+
+/**
+ * @brief Releases a DMA stream claimed with `DMA_Stream_Claim`.
+ *
+ * @param[in] stream Pointer to the DMA stream.
+ */
+void DMA_Stream_Release(DMA_Stream_TypeDef *stream)
+{
+    int8_t index = DMA_Stream_Index(stream);
+    uint32_t primask;
+
+    if (index < 0)
+    {
+        return;
+    }
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+    DMA_Claimed_Streams &= (uint16_t)~(1U << index);
+    DMA_Clock_Gate_Unused();
+    __set_PRIMASK(primask);
+}
+
+
 
 
 /**
@@ -952,7 +1485,16 @@ void DMA_Set_Trigger(DMA_Config *config)
  * This function configures and initiates a DMA transfer from a source memory
  * location to a destination memory location. It sets up the data size,
  * increment modes, and the length of the transfer. The function enables the
- * DMA stream, waits for the transfer to complete, and then disables the stream.
+ * DMA stream, waits for the transfer to end, and then disables the stream.
+ *
+ * The wait is bounded by the DWT cycle counter to `DMA_M2M_CYCLES_PER_ITEM`
+ * cycles per item plus `DMA_M2M_TIMEOUT_MARGIN`. A transfer that has not ended
+ * by then is aborted: the stream is disabled, the function waits for it to
+ * stop and clears all of its flags, so the stream is ready for the next call.
+ *
+ * DMA2 Stream 0 is claimed for the duration of the transfer, so the function
+ * fails at once, instead of reprogramming the stream or waiting, while a 2D
+ * transfer, a driver (e.g. ADC1 or SPI1_RX) or a graph node owns it.
  *
  * @param[in] source Pointer to the source memory location.
  * @param[in] source_data_size Size of the data at the source (8, 16, or 32 bits).
@@ -961,21 +1503,34 @@ void DMA_Set_Trigger(DMA_Config *config)
  * @param[in] source_increment If true, the source address will be incremented after each transfer.
  * @param[in] destination_increment If true, the destination address will be incremented after each transfer.
  * @param[in] length Number of data items to transfer.
+ *
+ * @return int8_t Returns 1 when the transfer completed, 0 if it was aborted after the timeout, or -1 on a
+ *         transfer error or if DMA2 Stream 0 is claimed (including by a running 2D transfer).
  */
-void DMA_Memory_To_Memory_Transfer(uint32_t *source,
+int8_t DMA_Memory_To_Memory_Transfer(uint32_t *source,
                           uint8_t source_data_size, uint8_t dest_data_size,
                           uint32_t *destination, bool source_increment,
                           bool destination_increment, uint16_t length)
 {
-    // Enable DMA2 clock
-    RCC -> AHB1ENR |= RCC_AHB1ENR_DMA2EN;
+    uint32_t start;
+    uint32_t timeout;
+    int8_t status = 1;
+
+    // Claim the stream for the transfer, which also holds the DMA2 clock; a running
+    // 2D transfer holds the claim, so it is reported instead of waited for without a bound
+    if(DMA_Stream_Claim(DMA2_Stream0) != 1)
+    {
+        return -1;
+    }
 
     // Clear the channel selection and set the transfer direction to memory-to-memory
     DMA2_Stream0->CR &= (DMA_SxCR_CHSEL);
     DMA2_Stream0->CR |= DMA_Configuration.Transfer_Direction.Memory_to_memory;
 
-    // Set the transfer complete interrupt and priority level
-    DMA2_Stream0->CR |= (DMA_SxCR_TCIE | DMA_SxCR_PL);
+    // Set the priority level. The transfer complete interrupt stays disabled because
+    // completion is polled below; with the stream IRQ enabled (e.g. after a 2D transfer)
+    // the handler would otherwise clear TCIF0 before the loop could see it.
+    DMA2_Stream0->CR |= DMA_SxCR_PL;
 
     // Set the peripheral data size based on the source data size
     if(source_data_size == 32)
@@ -1037,14 +1592,402 @@ void DMA_Memory_To_Memory_Transfer(uint32_t *source,
     DMA2_Stream0->NDTR = (uint16_t)length;
 
     // Enable the DMA stream
+    DMA_Timestamp_Enable();
+    timeout = ((uint32_t)length * DMA_M2M_CYCLES_PER_ITEM) + DMA_M2M_TIMEOUT_MARGIN;
+    start = DMA_Timestamp();
     DMA2_Stream0->CR |= DMA_SxCR_EN;
 
-    // Wait for the transfer to complete
-    while((DMA2->LISR & (DMA_LISR_TCIF0_Msk)) == 0) {}
+    // Wait for the transfer to complete or fail, up to the timeout
+    while((DMA2->LISR & (DMA_LISR_TCIF0_Msk | DMA_LISR_TEIF0_Msk)) == 0)
+    {
+        if((DMA_Timestamp() - start) >= timeout)
+        {
+            status = 0;
+            break;
+        }
+    }
+    if((status == 1) && ((DMA2->LISR & DMA_LISR_TEIF0_Msk) != 0))
+    {
+        status = -1;
+    }
+
+    // Disable the DMA stream, let it stop and clear all of its flags
+    DMA2_Stream0->CR &= ~DMA_SxCR_EN;
+    while(DMA2_Stream0->CR & DMA_SxCR_EN) {}
+    DMA2->LIFCR = DMA_LIFCR_CFEIF0 | DMA_LIFCR_CDMEIF0 | DMA_LIFCR_CTEIF0 | DMA_LIFCR_CHTIF0 | DMA_LIFCR_CTCIF0;
+
+    // Release the stream, gating DMA2 again unless other streams use it
+    DMA_Stream_Release(DMA2_Stream0);
+
+    return status;
+}
 
-    // Clear the transfer complete flag
-    DMA2->LIFCR |= DMA_LIFCR_CTCIF0;
 
-    // Disable the DMA stream
+/**
+ * @brief Loads the next run of rows of the active 2D transfer and enables DMA2 Stream 0.
+ *
+ * Only PAR, M0AR and NDTR are rewritten; the control register set up by
+ * `DMA_Memory_To_Memory_2D_Transfer` is reused for every run.
+ */
+static void DMA_2D_Load_Next_Run(void)
+{
+    DMA_2D_Config *config = DMA_2D_Active;
+    uint16_t rows = (DMA_2D_Rows_Remaining < DMA_2D_Rows_Per_Run) ? DMA_2D_Rows_Remaining : DMA_2D_Rows_Per_Run;
+
+    DMA2_Stream0->PAR = DMA_2D_Source;
+    DMA2_Stream0->M0AR = DMA_2D_Destination;
+    DMA2_Stream0->NDTR = (uint32_t)rows * config->width;
+
+    DMA_2D_Source += rows * config->source_stride;
+    DMA_2D_Destination += rows * config->destination_stride;
+    DMA_2D_Rows_Remaining -= rows;
+
+    DMA2_Stream0->CR |= DMA_SxCR_EN;
+}
+
+/**
+ * @brief DMA2 Stream 0 event callback that chains the rows of a 2D transfer.
+ *
+ * On transfer complete the next run is started straight from the interrupt.
+ * The `DMA2_Stream0_Flag.Transfer_Complete_Flag` is cleared again for
+ * intermediate runs so that it is only seen once the whole rectangle has been
+ * copied. A transfer error ends the transfer early; the error is left in
+ * `DMA2_Stream0_Flag.Transfer_Error_Flag`.
+ *
+ * @param[in] stream Pointer to DMA2 Stream 0.
+ * @param[in] event The handled `DMA_Configuration.DMA_Interrupts` event.
+ * @param[in] context Unused.
+ */
+static void DMA_2D_Callback(DMA_Stream_TypeDef *stream, uint32_t event, void *context)
+{
+    DMA_2D_Config *config = DMA_2D_Active;
+
+    (void)stream;
+    (void)context;
+
+    if(config == NULL)
+    {
+        return;
+    }
+
+    if(event == DMA_Configuration.DMA_Interrupts.Transfer_Complete)
+    {
+        if(DMA_2D_Rows_Remaining != 0)
+        {
+            DMA2_Stream0_Flag.Transfer_Complete_Flag = false;
+            DMA_2D_Load_Next_Run();
+            return;
+        }
+    }
+    else if(event != DMA_Configuration.DMA_Interrupts.Transfer_Error)
+    {
+        return;
+    }
+
+    DMA_2D_Active = NULL;
+
+    // Released before the callback, which may start the next transfer
+    DMA_Stream_Release(DMA2_Stream0);
+
+    if(config->callback != NULL)
+    {
+        config->callback(config);
+    }
+}
+
+/**
+ * @brief Starts a 2D (strided) memory-to-memory transfer using DMA.
+ *
+ * This function copies a rectangle of `height` rows of `width` elements each,
+ * where consecutive rows start `source_stride` bytes apart in the source and
+ * `destination_stride` bytes apart in the destination. The transfer runs on
+ * DMA2 Stream 0 (the same stream as `DMA_Memory_To_Memory_Transfer`) and is
+ * interrupt driven: each row is chained from the transfer complete interrupt by
+ * rewriting only PAR, M0AR and NDTR. When both sides are contiguous (the stride
+ * equals the row size, or is 0 for a non-incrementing side) consecutive rows are
+ * merged into a single run of up to 65535 elements.
+ *
+ * The function returns immediately. Completion is signalled through
+ * `config->callback` (called from the interrupt) and through
+ * `DMA2_Stream0_Flag.Transfer_Complete_Flag`; `DMA_Memory_To_Memory_2D_Busy`
+ * can be polled as well. The configuration structure must stay valid until the
+ * transfer has completed. The stream is claimed for the duration of the
+ * transfer and released before the callback runs.
+ *
+ * @param[in] config Pointer to the `DMA_2D_Config` structure describing the transfer.
+ *
+ * @return int8_t Returns 1 if the transfer was started, or -1 if a 2D transfer is
+ *         already running, DMA2 Stream 0 is claimed by a driver or the
+ *         configuration is invalid.
+ */
+int8_t DMA_Memory_To_Memory_2D_Transfer(DMA_2D_Config *config)
+{
+    uint32_t memory_data_size;
+    uint32_t peripheral_data_size;
+    uint32_t row_bytes;
+    bool source_contiguous;
+    bool destination_contiguous;
+
+    if((config == NULL) || (config->width == 0) || (config->height == 0) || (DMA_2D_Active != NULL))
+    {
+        return -1;
+    }
+
+    // The source is read through the peripheral port, so both sides use the same element size
+    if(config->data_size == 32)
+    {
+        memory_data_size = DMA_Configuration.Memory_Data_Size.word;
+        peripheral_data_size = DMA_Configuration.Peripheral_Data_Size.word;
+    }
+    else if(config->data_size == 16)
+    {
+        memory_data_size = DMA_Configuration.Memory_Data_Size.half_word;
+        peripheral_data_size = DMA_Configuration.Peripheral_Data_Size.half_word;
+    }
+    else if(config->data_size == 8)
+    {
+        memory_data_size = DMA_Configuration.Memory_Data_Size.byte;
+        peripheral_data_size = DMA_Configuration.Peripheral_Data_Size.byte;
+    }
+    else
+    {
+        return -1;
+    }
+
+    if(DMA_Stream_Claim(DMA2_Stream0) != 1)
+    {
+        return -1;
+    }
+
+    row_bytes = (uint32_t)config->width * (config->data_size / 8);
+
+    // Rows can be merged into one run when neither side has a gap between rows
+    source_contiguous = config->source_increment ? (config->source_stride == row_bytes) : (config->source_stride == 0);
+    destination_contiguous = config->destination_increment ? (config->destination_stride == row_bytes) : (config->destination_stride == 0);
+
+    DMA_2D_Rows_Per_Run = (source_contiguous && destination_contiguous) ? (uint16_t)(0xFFFF / config->width) : 1;
+    DMA_2D_Rows_Remaining = config->height;
+    DMA_2D_Source = config->source_address;
+    DMA_2D_Destination = config->destination_address;
+
+    // Make sure the stream is idle before it is reprogrammed
     DMA2_Stream0->CR &= ~DMA_SxCR_EN;
+    while(DMA2_Stream0->CR & DMA_SxCR_EN) {}
+
+    // Channel 0, memory-to-memory, same size on both sides, interrupt on completion and error
+    DMA2_Stream0->CR = DMA_Configuration.Transfer_Direction.Memory_to_memory |
+                       DMA_Configuration.Priority_Level.Very_high |
+                       memory_data_size |
+                       peripheral_data_size |
+                       (config->source_increment ? DMA_Configuration.Peripheral_Pointer_Increment.Enable : 0) |
+                       (config->destination_increment ? DMA_Configuration.Memory_Pointer_Increment.Enable : 0) |
+                       DMA_Configuration.DMA_Interrupts.Transfer_Complete |
+                       DMA_Configuration.DMA_Interrupts.Transfer_Error;
+
+    // Memory-to-memory transfers always go through the FIFO
+    DMA2_Stream0->FCR = DMA_SxFCR_DMDIS | DMA_SxFCR_FTH;
+
+    // Clear any stale flags of stream 0
+    DMA2->LIFCR = DMA_LIFCR_CFEIF0 | DMA_LIFCR_CDMEIF0 | DMA_LIFCR_CTEIF0 | DMA_LIFCR_CHTIF0 | DMA_LIFCR_CTCIF0;
+    DMA2_Stream0_Flag.Transfer_Complete_Flag = false;
+    DMA2_Stream0_Flag.Transfer_Error_Flag = false;
+
+    DMA_2D_Active = config;
+    DMA_Register_Callback(DMA2_Stream0, DMA_2D_Callback, NULL);
+    NVIC_EnableIRQ(DMA2_Stream0_IRQn);
+
+    DMA_2D_Load_Next_Run();
+
+    return 1;
+}
+
+/**
+ * @brief Reports whether a 2D memory-to-memory transfer is still running.
+ *
+ * @return bool `true` while rows of the last started 2D transfer are pending.
+ */
+bool DMA_Memory_To_Memory_2D_Busy(void)
+{
+    return DMA_2D_Active != NULL;
+}
+
+/**
+ * @brief Copies the rectangle of a 2D configuration with the CPU, row by row.
+ *
+ * Rows incrementing on both sides are copied with `memcpy`, as application
+ * code would. A fixed address (e.g. an FSMC data register) is accessed once
+ * per element through a volatile pointer, so no access is merged or dropped.
+ */
+static void DMA_2D_CPU_Copy(const DMA_2D_Config *config)
+{
+    uint32_t source = config->source_address;
+    uint32_t destination = config->destination_address;
+    uint32_t step = config->data_size / 8;
+    uint32_t source_step = config->source_increment ? step : 0;
+    uint32_t destination_step = config->destination_increment ? step : 0;
+    uint16_t row;
+    uint16_t i;
+
+    for(row = 0; row < config->height; row++)
+    {
+        if(config->source_increment && config->destination_increment)
+        {
+            memcpy((void *)destination, (const void *)source, (uint32_t)config->width * step);
+        }
+        else
+        {
+            for(i = 0; i < config->width; i++)
+            {
+                if(step == 4) *(volatile uint32_t *)(destination + i * destination_step) = *(volatile uint32_t *)(source + i * source_step);
+                else if(step == 2) *(volatile uint16_t *)(destination + i * destination_step) = *(volatile uint16_t *)(source + i * source_step);
+                else *(volatile uint8_t *)(destination + i * destination_step) = *(volatile uint8_t *)(source + i * source_step);
+            }
+        }
+        source += config->source_stride;
+        destination += config->destination_stride;
+    }
+}
+
+/**
+ * @brief Times a 2D transfer against the same copy done by a CPU row loop.
+ *
+ * Runs `DMA_Memory_To_Memory_2D_Transfer` and waits for it, then copies the
+ * same rectangle with the CPU: `memcpy` per row when both sides increment,
+ * one element at a time when one side is a fixed address. Both are timed
+ * with the DWT cycle counter, the DMA time from the start call to the end of
+ * the last row. The configuration's callback runs as for any 2D transfer.
+ *
+ * @param[in] config Pointer to the `DMA_2D_Config` structure describing the transfer.
+ * @param[out] dma_cycles CPU cycles of the DMA transfer.
+ * @param[out] cpu_cycles CPU cycles of the CPU copy.
+ *
+ * @return int8_t Returns 1 if the DMA transfer completed, or -1 if it could not be started or ended with a transfer error.
+ */
+int8_t DMA_Memory_To_Memory_2D_Benchmark(DMA_2D_Config *config, uint32_t *dma_cycles, uint32_t *cpu_cycles)
+{
+    uint32_t start;
+    int8_t status;
+
+    DMA_Timestamp_Enable();
+
+    start = DMA_Timestamp();
+    status = DMA_Memory_To_Memory_2D_Transfer(config);
+    while(DMA_Memory_To_Memory_2D_Busy()) {}
+    *dma_cycles = DMA_Timestamp() - start;
+
+    if((status == 1) && DMA2_Stream0_Flag.Transfer_Error_Flag)
+    {
+        status = -1;
+    }
+
+    start = DMA_Timestamp();
+    DMA_2D_CPU_Copy(config);
+    *cpu_cycles = DMA_Timestamp() - start;
+
+    return status;
+}
+
+/**
+ * @brief Installs the sleep primitive used by `DMA_Wait`.
+ *
+ * Without a shim `DMA_Wait` sleeps with WFE and every stream interrupt sends
+ * an event. An RTOS shim blocks the waiting task instead, e.g. on one binary
+ * semaphore per stream index:
+ *
+ * @code
+ * static void Wait(uint8_t index, uint32_t timeout, void *context)
+ * {
+ *     TickType_t ticks = (timeout == 0) ? portMAX_DELAY : (timeout / (SystemCoreClock / configTICK_RATE_HZ)) + 1;
+ *     xSemaphoreTake(semaphores[index], ticks);
+ * }
+ *
+ * static void Signal(uint8_t index, void *context)
+ * {
+ *     BaseType_t woken = pdFALSE;
+ *     xSemaphoreGiveFromISR(semaphores[index], &woken);
+ *     portYIELD_FROM_ISR(woken);
+ * }
+ * @endcode
+ *
+ * `host/DMA_Wait_Pthread.h` implements the same pattern with a condition
+ * variable for host builds.
+ *
+ * @param[in] shim Pointer to the shim, which must stay valid, or NULL to return to WFE.
+ */
+void DMA_Wait_Set_Shim(const DMA_Wait_Shim *shim)
+{
+    DMA_Wait_OS = shim;
+}
+
+/**
+ * @brief Sleeps until the current transfer of a stream has ended.
+ *
+ * The transfer has ended once the stream is disabled, which the hardware does
+ * after the last item of a normal transfer or on a transfer error. Streams
+ * that are restarted from their callback (e.g. chained runs) are waited for
+ * until they stay disabled. Each wake-up re-checks the stream, so a
+ * completion that happens before the call or before the sleep is not missed.
+ *
+ * The stream's transfer complete and error interrupts should be enabled so
+ * they wake the caller. The timeout is measured with the DWT cycle counter
+ * and checked at each wake-up: with the WFE default, some periodic interrupt
+ * (e.g. SysTick) must run for a stuck stream to time out. On a timeout the
+ * stream is disabled and its flags are cleared; the driver or application
+ * that owns the stream has to restart it.
+ *
+ * Streams in circular or double buffer mode run until they are stopped, so
+ * they are rejected with -1 instead of being waited for.
+ *
+ * @param[in] stream Pointer to the DMA stream.
+ * @param[in] timeout Timeout in CPU cycles (e.g. `SystemCoreClock / 1000` for 1 ms), or 0 to wait without limit.
+ *
+ * @return int8_t Returns 1 when the transfer completed, 0 if it was aborted after the timeout, or -1 on a transfer error, an invalid stream or a circular/double buffer stream.
+ */
+int8_t DMA_Wait(DMA_Stream_TypeDef *stream, uint32_t timeout)
+{
+    int8_t index = DMA_Stream_Index(stream);
+    const DMA_Wait_Shim *shim = DMA_Wait_OS;
+    volatile uint32_t *flag_clear;
+    uint32_t flag_mask;
+    uint32_t start;
+    uint32_t elapsed;
+
+    if (index < 0)
+    {
+        return -1;
+    }
+
+    // Circular and double buffer streams never disable themselves
+    if (stream->CR & (DMA_SxCR_CIRC | DMA_SxCR_DBM))
+    {
+        return -1;
+    }
+
+    DMA_Timestamp_Enable();
+    start = DMA_Timestamp();
+
+    while (stream->CR & DMA_SxCR_EN)
+    {
+        elapsed = DMA_Timestamp() - start;
+        if ((timeout != 0) && (elapsed >= timeout))
+        {
+            stream->CR &= ~DMA_SxCR_EN;
+            while (stream->CR & DMA_SxCR_EN) {}
+
+            flag_clear = DMA_Flag_Clear_Register(stream, &flag_mask);
+            *flag_clear = flag_mask;
+            return 0;
+        }
+
+        if (shim != NULL) shim->wait((uint8_t)index, (timeout != 0) ? (timeout - elapsed) : 0, shim->context);
+        else __WFE();
+    }
+
+    if (DMA_Wait_Error[index] != 0)
+    {
+        DMA_Wait_Error[index] = 0;
+        return -1;
+    }
+
+    return 1;
 }
@@ -16,6 +16,30 @@
  * - **Interrupt Handling**: Supports transfer complete, half transfer complete, transfer error, and FIFO error interrupts.
  * - **Priority Levels**: Configurable priority levels for managing multiple DMA streams.
  * - **Configurable Data Sizes**: Supports byte, half-word, and word data sizes for both memory and peripherals.
+ * - **2D Transfers**: Copies rectangles with independent source and destination strides, chaining rows from the interrupt.
+ * - **Stream Callbacks**: Forwards stream events from the interrupt handlers to registered callbacks.
+ * - **Display Flush** (`DMA_Display.h`): Streams coalesced dirty rectangles of a framebuffer to SPI or FSMC panels.
+ * - **SPI Transactions** (`DMA_SPI.h`): Queues full-duplex SPI transfers on paired RX/TX streams with a single completion.
+ * - **I2S Audio** (`DMA_I2S.h`): Streams double-buffered I2S playback/capture periods to a callback with underrun detection.
+ * - **ADC Acquisition** (`DMA_ADC.h`): Streams circular or double-buffered scans and delivers each block deinterleaved per channel; captures dual/triple interleaved modes through the common data register.
+ * - **DAC Waveforms** (`DMA_DAC.h`): Streams generator-filled double-buffered blocks to one DAC channel, or to both synchronously through `DHR12RD`.
+ * - **Camera Capture** (`DMA_DCMI.h`): Captures DCMI frames continuously into a frame buffer pool with line-block and frame events and dropped-frame counting.
+ * - **SD Card Blocks** (`DMA_SDIO.h`): Queues asynchronous multi-block SDIO reads/writes with peripheral flow control, FIFO bursts and read-ahead.
+ * - **Block Pipeline** (`DMA_Pipeline.h`): Hands fixed-size blocks from a producer stage to a consumer stage from their interrupts, with backpressure, drop accounting and latency/throughput counters; stages for DMA streams, SPI and SDIO in `DMA_Pipeline_Stages.h`.
+ * - **Timer Bursts** (`DMA_Timer.h`): Streams double-buffered multi-register frames into `TIMx->DMAR` on every update event, with a WS2812/DShot bit encoder driving up to four outputs.
+ * - **Parallel GPIO** (`DMA_GPIO.h`): Captures a GPIO port into a ring or double buffer, or replays patterns into `ODR`/`BSRR`, at the update rate of TIM1/TIM8, with trigger-on-pattern captures.
+ * - **Input Capture** (`DMA_Capture.h`): Streams timer capture timestamps into a ring and decodes edge intervals per half ring, or by polling, through a wraparound-aware delta iterator.
+ * - **Software UARTs** (`DMA_SoftUART.h`): Adds 8N1 UART channels on GPIO pins by playing TX bit streams into `BSRR` and oversampling `IDR`, with bytes encoded and decoded once per block.
+ * - **UART Packets** (`DMA_UART.h`): Receives variable-length frames into a circular ring and hands them over on the USART idle line as zero-copy views split at the wrap.
+ * - **COBS/SLIP Framing** (`DMA_Framing.h`): Decodes COBS or SLIP frames in place in the UART receive ring, across views and the wrap, and encodes frames straight into TX buffers, with per-link statistics.
+ * - **Log Backend** (`DMA_Log.h`): Lock-free multi-producer log ring writable from tasks and interrupts, drained over a USART TX stream in contiguous chunks, dropping with counters instead of blocking.
+ * - **CRC Engine** (`DMA_CRC.h`): CRC-32 of any buffer computed by the hardware CRC unit fed through a DMA2 memory-to-memory stream, asynchronous with completion callbacks, with a matching table-driven software CRC and a cycle-count benchmark.
+ * - **Startup Initialization** (`DMA_Startup.h`): `.data` copy and `.bss` zeroing with burst DMA2 memory-to-memory transfers, callable from the reset handler before the C runtime, with the time taken reported in CPU cycles.
+ * - **Flash Block Cache** (`DMA_Cache.h`, `DMA_SPI_Flash.h`): hardware-independent LRU block cache over external flash with asynchronous sequential read-ahead and hit/miss/prefetch counters, filled by DMA from a serial NOR flash on a `DMA_SPI_Bus`, or from an image file on a host (`DMA_Cache_File.h`, `host/`).
+ * - **Transfer Dependency Graph** (`DMA_Graph.h`): transfers on different streams run in dependency order, with each node armed from the transfer complete interrupt of its last predecessor.
+ * - **Synchronized Group Start** (`DMA_Group.h`): several streams across DMA1 and DMA2 pre-armed and enabled back-to-back with interrupts masked, after one flag clear write per register, with the measured start skew reported.
+ * - **Clock Gating** (`DMA.h`): controller clocks are reference-counted through stream claims and `DMA_Clock_Enable`/`DMA_Clock_Disable`, gated as soon as the last user goes idle, with `DMA_Sleep_While` to sleep in WFI while DMA-only work is pending.
+ * - **Sleeping Waits** (`DMA.h`): `DMA_Wait` sleeps until a stream's transfer ends, using WFE or a pluggable RTOS shim signalled from the stream interrupt, with a cycle-count timeout that aborts the stream cleanly; circular and double buffer streams are rejected. A POSIX threads shim and a simulated core run it on a host (`host/`).
  *
  * @section config_sec Configuration
  *
@@ -46,7 +70,12 @@
  * - `int8_t DMA_Init(DMA_Config *config)`: Initializes the DMA with the specified configuration.
  * - `void DMA_Set_Target(DMA_Config *config)`: Configures the target memory and peripheral for DMA transfers.
  * - `void DMA_Set_Trigger(DMA_Config *config)`: Sets up and enables the DMA stream for data transfer.
- * - `void DMA_Memory_To_Memory_Transfer(uint32_t *source, uint8_t source_data_size, uint8_t dest_data_size, uint32_t *destination, bool source_increment, bool destination_increment, uint16_t length)`: Performs a memory-to-memory data transfer using DMA.
+ * - `int8_t DMA_Memory_To_Memory_Transfer(uint32_t *source, uint8_t source_data_size, uint8_t dest_data_size, uint32_t *destination, bool source_increment, bool destination_increment, uint16_t length)`: Performs a memory-to-memory data transfer using DMA, with a timeout.
+ * - `void DMA_Register_Callback(DMA_Stream_TypeDef *stream, DMA_Callback_Typedef callback, void *context)`: Registers a callback for the events of a stream.
+ * - `int8_t DMA_Stream_Claim(DMA_Stream_TypeDef *stream)` / `void DMA_Stream_Release(DMA_Stream_TypeDef *stream)`: Claims and releases a stream for exclusive use.
+ * - `int8_t DMA_Memory_To_Memory_2D_Transfer(DMA_2D_Config *config)`: Starts a strided rectangle copy using DMA.
+ * - `bool DMA_Memory_To_Memory_2D_Busy(void)`: Reports whether a 2D transfer is still running.
+ * - `int8_t DMA_Memory_To_Memory_2D_Benchmark(DMA_2D_Config *config, uint32_t *dma_cycles, uint32_t *cpu_cycles)`: Times a 2D transfer against a CPU row loop.
  *
  * @section usage_sec Usage
  *
@@ -159,6 +188,51 @@ typedef struct DMA_Config
     uint16_t buffer_length;             /**< Number of data items to transfer */
 } DMA_Config;
 
+/**
+ * @brief DMA stream event callback.
+ *
+ * Called from the stream's interrupt handler with the handled event, given as one of
+ * the `DMA_Configuration.DMA_Interrupts` values (e.g. `Transfer_Complete`).
+ */
+typedef void (*DMA_Callback_Typedef)(DMA_Stream_TypeDef *stream, uint32_t event, void *context);
+
+/**
+ * @brief Sleep primitive of `DMA_Wait`, e.g. an RTOS semaphore per stream.
+ *
+ * `wait` blocks the caller until `signal` is called for the same stream index
+ * or about `timeout` CPU cycles have passed (0 for no limit); returning early
+ * is allowed. `signal` is called from the stream's interrupt handler after
+ * every handled event.
+ */
+typedef struct DMA_Wait_Shim
+{
+    void (*wait)(uint8_t index, uint32_t timeout, void *context);  /**< Sleeps until signalled or timed out */
+    void (*signal)(uint8_t index, void *context);                  /**< Wakes the waiter of a stream, from its interrupt */
+    void *context;                                                  /**< User pointer for both functions */
+} DMA_Wait_Shim;
+
+/**
+ * @brief 2D (strided) memory-to-memory transfer configuration structure.
+ *
+ * Describes a rectangle of `height` rows of `width` elements. Strides are given in
+ * bytes between the first elements of consecutive rows, so a sub-rectangle of a
+ * framebuffer uses the framebuffer's line pitch as its stride.
+ */
+typedef struct DMA_2D_Config
+{
+    uint32_t source_address;            /**< Address of the first element of the source rectangle */
+    uint32_t destination_address;       /**< Address of the first element of the destination rectangle */
+    uint16_t width;                     /**< Number of elements per row */
+    uint16_t height;                    /**< Number of rows */
+    uint32_t source_stride;             /**< Bytes between the starts of consecutive source rows */
+    uint32_t destination_stride;        /**< Bytes between the starts of consecutive destination rows */
+    uint8_t data_size;                  /**< Element size in bits (8, 16, or 32) */
+    bool source_increment;              /**< Increment the source address along a row */
+    bool destination_increment;         /**< Increment the destination address along a row */
+    void (*callback)(struct DMA_2D_Config *config); /**< Called from the DMA interrupt when the transfer ends (optional) */
+    void *context;                      /**< User pointer for the callback */
+} DMA_2D_Config;
+
 /**
  * @brief Enables the clock for the specified DMA controller.
  *
@@ -167,12 +241,25 @@ typedef struct DMA_Config
 void DMA_Clock_Enable(DMA_Config *config);
 
 /**
- * @brief Disables the clock for the specified DMA controller.
+ * @brief Drops the stream's clock reference; gates the controller if it is no longer in use.
  *
  * @param[in] config Pointer to the DMA_Config structure containing the DMA controller settings.
  */
 void DMA_Clock_Disable(DMA_Config *config);
 
+/**
+ * @brief Gates the clock of every DMA controller that is not in use.
+ */
+void DMA_Clock_Power_Down(void);
+
+/**
+ * @brief Sleeps with WFI while DMA work is pending.
+ *
+ * @param[in] pending Returns `true` while the work is pending.
+ * @param[in] context User pointer passed to `pending`.
+ */
+void DMA_Sleep_While(bool (*pending)(void *context), void *context);
+
 /**
  * @brief Resets the specified DMA controller.
  *
@@ -220,10 +307,116 @@ void DMA_Set_Trigger(DMA_Config *config);
  * @param[in] source_increment If true, the source address will be incremented after each transfer.
  * @param[in] destination_increment If true, the destination address will be incremented after each transfer.
  * @param[in] length Number of data items to transfer.
+ *
+ * @return int8_t Returns 1 when the transfer completed, 0 if it was aborted after the timeout, or -1 on a
+ *         transfer error or if DMA2 Stream 0 is claimed (including by a running 2D transfer).
  */
-void DMA_Memory_To_Memory_Transfer(uint32_t *source,
+int8_t DMA_Memory_To_Memory_Transfer(uint32_t *source,
                           uint8_t source_data_size, uint8_t dest_data_size,
                           uint32_t *destination, bool source_increment,
                           bool destination_increment, uint16_t length);
 
+/**
+ * @brief Registers a callback for the events of a DMA stream.
+ *
+ * @param[in] stream Pointer to the DMA stream.
+ * @param[in] callback Function called from the stream's interrupt handler, or `NULL` to remove it.
+ * @param[in] context User pointer passed back to the callback.
+ */
+void DMA_Register_Callback(DMA_Stream_TypeDef *stream, DMA_Callback_Typedef callback, void *context);
+
+/**
+ * @brief Returns the flag clear register and mask of a DMA stream.
+ *
+ * @param[in] stream Pointer to the DMA stream.
+ * @param[out] mask Receives the mask that clears all flags of the stream.
+ *
+ * @return volatile uint32_t* Pointer to the LIFCR or HIFCR register, or NULL for an invalid stream.
+ */
+volatile uint32_t *DMA_Flag_Clear_Register(DMA_Stream_TypeDef *stream, uint32_t *mask);
+
+/**
+ * @brief Enables the NVIC interrupt of a DMA stream.
+ *
+ * @param[in] stream Pointer to the DMA stream.
+ */
+void DMA_Stream_IRQ_Enable(DMA_Stream_TypeDef *stream);
+
+/**
+ * @brief Enables the DWT cycle counter used for DMA timing measurements.
+ *
+ * A counter that is already running is left untouched.
+ */
+void DMA_Timestamp_Enable(void);
+
+/**
+ * @brief Returns the current DWT cycle count.
+ *
+ * @return uint32_t CPU clock cycles since the counter was enabled (wrapping).
+ */
+uint32_t DMA_Timestamp(void);
+
+/**
+ * @brief Claims a DMA stream for exclusive use by a driver.
+ *
+ * @param[in] stream Pointer to the DMA stream.
+ *
+ * @return int8_t Returns 1 if the stream was claimed, or -1 if it is invalid or already claimed.
+ */
+int8_t DMA_Stream_Claim(DMA_Stream_TypeDef *stream);
+
+/**
+ * @brief Releases a DMA stream claimed with DMA_Stream_Claim.
+ *
+ * @param[in] stream Pointer to the DMA stream.
+ */
+void DMA_Stream_Release(DMA_Stream_TypeDef *stream);
+
+/**
+ * @brief Starts a 2D (strided) memory-to-memory transfer on DMA2 Stream 0.
+ *
+ * Rows are chained from the transfer complete interrupt. Completion is reported
+ * through `config->callback` and `DMA2_Stream0_Flag.Transfer_Complete_Flag`.
+ *
+ * @param[in] config Pointer to the DMA_2D_Config structure; must stay valid until completion.
+ *
+ * @return int8_t Returns 1 if the transfer was started, or -1 if busy, the stream is claimed or the configuration is invalid.
+ */
+int8_t DMA_Memory_To_Memory_2D_Transfer(DMA_2D_Config *config);
+
+/**
+ * @brief Reports whether a 2D memory-to-memory transfer is still running.
+ *
+ * @return bool `true` while the transfer started by DMA_Memory_To_Memory_2D_Transfer is pending.
+ */
+bool DMA_Memory_To_Memory_2D_Busy(void);
+
+/**
+ * @brief Times a 2D transfer against the same copy done by a CPU row loop.
+ *
+ * @param[in] config Pointer to the DMA_2D_Config structure describing the transfer.
+ * @param[out] dma_cycles CPU cycles of the DMA transfer.
+ * @param[out] cpu_cycles CPU cycles of the CPU copy (`memcpy` per row when both sides increment).
+ *
+ * @return int8_t Returns 1 if the DMA transfer completed, or -1 otherwise.
+ */
+int8_t DMA_Memory_To_Memory_2D_Benchmark(DMA_2D_Config *config, uint32_t *dma_cycles, uint32_t *cpu_cycles);
+
+/**
+ * @brief Installs the sleep primitive used by DMA_Wait.
+ *
+ * @param[in] shim Pointer to the shim, or NULL for WFE.
+ */
+void DMA_Wait_Set_Shim(const DMA_Wait_Shim *shim);
+
+/**
+ * @brief Sleeps until the current transfer of a stream has ended.
+ *
+ * @param[in] stream Pointer to the DMA stream.
+ * @param[in] timeout Timeout in CPU cycles, or 0 to wait without limit.
+ *
+ * @return int8_t Returns 1 when the transfer completed, 0 if it was aborted after the timeout, or -1 on a transfer error, an invalid stream or a circular/double buffer stream.
+ */
+int8_t DMA_Wait(DMA_Stream_TypeDef *stream, uint32_t timeout);
+
 #endif /* DMA_H_ */
@@ -0,0 +1,422 @@
+/**
+ * @file DMA_ADC.c
+ * @brief DMA ADC Acquisition Engine Implementation for STM32F407VGT6
+ *
+ * This file implements continuous ADC acquisition with per-block callbacks.
+ * The stream transfers the ADC data register into the raw buffers without CPU
+ * involvement; on each half transfer/transfer complete interrupt (circular
+ * mode) or transfer complete interrupt (double-buffer mode) the block the DMA
+ * has just finished is deinterleaved into the channel-major output block and
+ * passed to the block callback.
+ *
+ * @version 1.0
+ * @date 2024-08-22
+ *
+ * @author Kunal Salvi
+ * @copyright Copyright (c) 2024
+ */
+
+#include "DMA_ADC.h"
+
+/**
+ * @brief Deinterleaves scan results into a channel-major block.
+ *
+ * On Cortex-M4 builds with the DSP extension, an even number of channels and
+ * frames and word-aligned buffers, two channels of two consecutive scans are
+ * read as two words and repacked with PKHBT/PKHTB into one output word per
+ * channel, halving the memory accesses of the loop. Any other layout, and
+ * builds without the DSP extension, use the portable per-sample loop.
+ *
+ * @param[in] input Interleaved samples, `frames` scans of `channels` samples.
+ * @param[out] output Channel-major samples; channel `c` starts at `output[c * frames]`.
+ * @param[in] frames Number of scans.
+ * @param[in] channels Number of samples per scan.
+ */
+void DMA_ADC_Deinterleave(const uint16_t *input, uint16_t *output, uint16_t frames, uint8_t channels)
+{
+    uint32_t channel;
+    uint32_t frame;
+
+#if defined(__ARM_FEATURE_DSP)
+    if(((channels & 1U) == 0) && ((frames & 1U) == 0) && ((((uint32_t)input | (uint32_t)output) & 3U) == 0))
+    {
+        uint32_t half = channels / 2U;
+
+        for(channel = 0; channel < channels; channel += 2)
+        {
+            const uint32_t *source = (const uint32_t *)input + (channel / 2U);
+            uint32_t *first = (uint32_t *)(output + channel * frames);
+            uint32_t *second = (uint32_t *)(output + (channel + 1U) * frames);
+
+            for(frame = 0; frame < frames; frame += 2)
+            {
+                uint32_t scan0 = source[0];     // channel, channel + 1 of scan n
+                uint32_t scan1 = source[half];  // channel, channel + 1 of scan n + 1
+
+                *first++ = __PKHBT(scan0, scan1, 16);
+                *second++ = __PKHTB(scan1, scan0, 16);
+                source += channels;
+            }
+        }
+        return;
+    }
+#endif
+
+    for(channel = 0; channel < channels; channel++)
+    {
+        const uint16_t *source = input + channel;
+        uint16_t *destination = output + channel * frames;
+
+        for(frame = 0; frame < frames; frame++)
+        {
+            destination[frame] = *source;
+            source += channels;
+        }
+    }
+}
+
+/**
+ * @brief Stream event callback: deinterleaves and delivers the finished block.
+ *
+ * After deinterleaving, the stream position is checked: if the DMA has already
+ * moved back into the block that was just read, part of it was overwritten
+ * while it was being copied and the block is counted as an overrun.
+ */
+static void DMA_ADC_Callback(DMA_Stream_TypeDef *stream, uint32_t event, void *context)
+{
+    DMA_ADC_Acquisition *acquisition = (DMA_ADC_Acquisition *)context;
+    uint32_t length = (uint32_t)acquisition->block_frames * acquisition->channels;
+    const uint16_t *block;
+    uint32_t ct = 0;
+    bool overrun;
+
+    if(event == DMA_Configuration.DMA_Interrupts.Transfer_Error)
+    {
+        acquisition->errors++;
+        return;
+    }
+
+    if(acquisition->buffers[1] == NULL)
+    {
+        if(event == DMA_Configuration.DMA_Interrupts.Half_Transfer_Complete)
+        {
+            block = acquisition->buffers[0];
+        }
+        else if(event == DMA_Configuration.DMA_Interrupts.Transfer_Complete)
+        {
+            block = acquisition->buffers[0] + length;
+        }
+        else
+        {
+            return;
+        }
+    }
+    else
+    {
+        if(event != DMA_Configuration.DMA_Interrupts.Transfer_Complete)
+        {
+            return;
+        }
+        ct = stream->CR & DMA_SxCR_CT;
+        block = acquisition->buffers[ct ? 0 : 1];
+    }
+
+    DMA_ADC_Deinterleave(block, acquisition->output, acquisition->block_frames, acquisition->channels);
+
+    if(acquisition->buffers[1] == NULL)
+    {
+        // The first half is safe while NDTR counts down the second half, and vice versa
+        overrun = (block == acquisition->buffers[0]) ? (stream->NDTR > length) : (stream->NDTR <= length);
+    }
+    else
+    {
+        overrun = (stream->CR & DMA_SxCR_CT) != ct;
+    }
+    if(overrun)
+    {
+        acquisition->overruns++;
+    }
+
+    acquisition->blocks++;
+    if(acquisition->block != NULL)
+    {
+        acquisition->block(acquisition->output, acquisition->block_frames, acquisition->channels, acquisition->context);
+    }
+}
+
+/**
+ * @brief Starts continuous ADC acquisition.
+ *
+ * This function claims the stream, configures it for half-word transfers from
+ * the ADC data register in circular or double-buffer mode, enables its
+ * interrupts and sets the ADC's DMA and DDS bits so requests continue after
+ * each sequence. The ADC itself (scan sequence, sample times, trigger) is
+ * configured by the application, which starts the conversions after this
+ * function returns.
+ *
+ * @param[in] acquisition Pointer to the `DMA_ADC_Acquisition` structure.
+ *
+ * @return int8_t Returns 1 on success, or -1 if the configuration is invalid or the stream is already claimed.
+ */
+int8_t DMA_ADC_Start(DMA_ADC_Acquisition *acquisition)
+{
+    DMA_Stream_TypeDef *stream = acquisition->Request.Stream;
+    uint32_t length = (uint32_t)acquisition->block_frames * acquisition->channels;
+    bool circular = (acquisition->buffers[1] == NULL);
+    volatile uint32_t *flag_clear;
+    uint32_t flag_mask;
+    uint32_t interrupts = DMA_Configuration.DMA_Interrupts.Transfer_Complete | DMA_Configuration.DMA_Interrupts.Transfer_Error;
+
+    if((stream == NULL) || (acquisition->ADC == NULL) || (acquisition->buffers[0] == NULL) || (acquisition->output == NULL))
+    {
+        return -1;
+    }
+    if((length == 0) || ((circular ? 2 * length : length) > 0xFFFF))
+    {
+        return -1;
+    }
+    if(DMA_Stream_Claim(stream) != 1)
+    {
+        return -1;
+    }
+
+    acquisition->blocks = 0;
+    acquisition->overruns = 0;
+    acquisition->errors = 0;
+
+    stream->CR &= ~DMA_SxCR_EN;
+    while(stream->CR & DMA_SxCR_EN) {}
+
+    if(circular)
+    {
+        interrupts |= DMA_Configuration.DMA_Interrupts.Half_Transfer_Complete;
+    }
+
+    stream->CR = ((uint32_t)acquisition->Request.channel << DMA_SxCR_CHSEL_Pos) |
+                 DMA_Configuration.Transfer_Direction.Peripheral_to_memory |
+                 acquisition->priority_level |
+                 DMA_Configuration.Memory_Data_Size.half_word |
+                 DMA_Configuration.Peripheral_Data_Size.half_word |
+                 DMA_Configuration.Memory_Pointer_Increment.Enable |
+                 DMA_Configuration.Circular_Mode.Enable |
+                 (circular ? 0 : DMA_SxCR_DBM) |
+                 interrupts;
+    stream->FCR = 0;
+
+    stream->PAR = (uint32_t)&(acquisition->ADC->DR);
+    stream->M0AR = (uint32_t)acquisition->buffers[0];
+    stream->M1AR = (uint32_t)acquisition->buffers[1];
+    stream->NDTR = circular ? 2 * length : length;
+
+    flag_clear = DMA_Flag_Clear_Register(stream, &flag_mask);
+    *flag_clear = flag_mask;
+
+    DMA_Register_Callback(stream, DMA_ADC_Callback, acquisition);
+    DMA_Stream_IRQ_Enable(stream);
+    stream->CR |= DMA_SxCR_EN;
+
+    // A pending overrun blocks further DMA requests until it is cleared
+    acquisition->ADC->SR &= ~ADC_SR_OVR;
+    acquisition->ADC->CR2 |= ADC_CR2_DMA | ADC_CR2_DDS;
+
+    return 1;
+}
+
+/**
+ * @brief Stops ADC acquisition and releases the stream.
+ *
+ * The ADC keeps converting; only its DMA requests are disabled.
+ *
+ * @param[in] acquisition Pointer to the `DMA_ADC_Acquisition` structure.
+ */
+void DMA_ADC_Stop(DMA_ADC_Acquisition *acquisition)
+{
+    DMA_Stream_TypeDef *stream = acquisition->Request.Stream;
+
+    acquisition->ADC->CR2 &= ~(ADC_CR2_DMA | ADC_CR2_DDS);
+
+    stream->CR &= ~DMA_SxCR_EN;
+    while(stream->CR & DMA_SxCR_EN) {}
+
+    DMA_Register_Callback(stream, NULL, NULL);
+    DMA_Stream_Release(stream);
+}
+
+/**
+ * @brief Widens 8-bit samples to half-words.
+ *
+ * On Cortex-M4 builds with the DSP extension and word-aligned buffers, four
+ * samples are widened per word with UXTB16 and repacked with PKHBT/PKHTB;
+ * the remaining samples, and builds without the DSP extension, use the
+ * portable per-sample loop.
+ *
+ * @param[in] input Packed 8-bit samples.
+ * @param[out] output Receives one half-word per sample.
+ * @param[in] count Number of samples.
+ */
+void DMA_ADC_Unpack_Bytes(const uint8_t *input, uint16_t *output, uint16_t count)
+{
+    uint32_t index = 0;
+
+#if defined(__ARM_FEATURE_DSP)
+    if((((uint32_t)input | (uint32_t)output) & 3U) == 0)
+    {
+        const uint32_t *source = (const uint32_t *)input;
+        uint32_t *destination = (uint32_t *)output;
+
+        for(; index + 4 <= count; index += 4)
+        {
+            uint32_t packed = *source++;
+            uint32_t even = __UXTB16(packed);               // samples 0 and 2
+            uint32_t odd = __UXTB16(__ROR(packed, 8));      // samples 1 and 3
+
+            *destination++ = __PKHBT(even, odd, 16);
+            *destination++ = __PKHTB(odd, even, 16);
+        }
+    }
+#endif
+
+    for(; index < count; index++)
+    {
+        output[index] = input[index];
+    }
+}
+
+/**
+ * @brief Stream event callback: delivers the block the DMA has just finished.
+ */
+static void DMA_ADC_Multi_Callback(DMA_Stream_TypeDef *stream, uint32_t event, void *context)
+{
+    DMA_ADC_Multi_Acquisition *acquisition = (DMA_ADC_Multi_Acquisition *)context;
+    uint32_t ct;
+    const uint16_t *samples;
+
+    if((event == DMA_Configuration.DMA_Interrupts.Transfer_Error) || (event == DMA_Configuration.DMA_Interrupts.Fifo_Error))
+    {
+        acquisition->errors++;
+        return;
+    }
+    if(event != DMA_Configuration.DMA_Interrupts.Transfer_Complete)
+    {
+        return;
+    }
+
+    ct = stream->CR & DMA_SxCR_CT;
+    samples = (const uint16_t *)acquisition->buffers[ct ? 0 : 1];
+
+    if(acquisition->dma_mode == DMA_ADC_MULTI_MODE_3)
+    {
+        DMA_ADC_Unpack_Bytes((const uint8_t *)samples, acquisition->output, acquisition->block_samples);
+        samples = acquisition->output;
+    }
+
+    acquisition->blocks++;
+    if(acquisition->block != NULL)
+    {
+        acquisition->block(samples, acquisition->block_samples, acquisition->context);
+    }
+
+    // In modes 1 and 2 the callback reads the raw buffer itself, so it must finish within the block
+    if((stream->CR & DMA_SxCR_CT) != ct)
+    {
+        acquisition->overruns++;
+    }
+}
+
+/**
+ * @brief Starts multi-ADC capture through the common data register.
+ *
+ * This function claims the stream and configures it for the common data
+ * register in double-buffer mode. Mode 2 uses word transfers (two samples per
+ * request) and the others half-word transfers; in all modes the FIFO packs
+ * the data into 4-word memory bursts, which keeps the AHB load of the 7.2 MSPS
+ * interleaved modes to one burst per 8 samples. It then selects the DMA mode
+ * with DDS in the common control register. The multi-ADC mode (ADC_CCR MULTI),
+ * the ADCs and the trigger are configured by the application, which starts
+ * the conversions after this function returns.
+ *
+ * @param[in] acquisition Pointer to the `DMA_ADC_Multi_Acquisition` structure.
+ *
+ * @return int8_t Returns 1 on success, or -1 if the configuration is invalid or the stream is already claimed.
+ */
+int8_t DMA_ADC_Multi_Start(DMA_ADC_Multi_Acquisition *acquisition)
+{
+    DMA_Stream_TypeDef *stream = acquisition->Request.Stream;
+    bool bytes = (acquisition->dma_mode == DMA_ADC_MULTI_MODE_3);
+    bool words = (acquisition->dma_mode == DMA_ADC_MULTI_MODE_2);
+    uint32_t block_bytes = bytes ? acquisition->block_samples : 2U * acquisition->block_samples;
+    volatile uint32_t *flag_clear;
+    uint32_t flag_mask;
+
+    if((stream == NULL) || (acquisition->buffers[0] == NULL) || (acquisition->buffers[1] == NULL))
+    {
+        return -1;
+    }
+    if((acquisition->dma_mode != DMA_ADC_MULTI_MODE_1) && !words && !bytes)
+    {
+        return -1;
+    }
+    if((block_bytes == 0) || ((block_bytes % 16U) != 0) || (bytes && (acquisition->output == NULL)))
+    {
+        return -1;
+    }
+    if(DMA_Stream_Claim(stream) != 1)
+    {
+        return -1;
+    }
+
+    acquisition->blocks = 0;
+    acquisition->overruns = 0;
+    acquisition->errors = 0;
+
+    stream->CR &= ~DMA_SxCR_EN;
+    while(stream->CR & DMA_SxCR_EN) {}
+
+    stream->CR = ((uint32_t)acquisition->Request.channel << DMA_SxCR_CHSEL_Pos) |
+                 DMA_Configuration.Transfer_Direction.Peripheral_to_memory |
+                 acquisition->priority_level |
+                 DMA_Configuration.Memory_Data_Size.word |
+                 (words ? DMA_Configuration.Peripheral_Data_Size.word : DMA_Configuration.Peripheral_Data_Size.half_word) |
+                 DMA_Configuration.Memory_Pointer_Increment.Enable |
+                 DMA_Configuration.Circular_Mode.Enable |
+                 DMA_SxCR_DBM |
+                 DMA_SxCR_MBURST_0 |
+                 DMA_Configuration.DMA_Interrupts.Transfer_Complete |
+                 DMA_Configuration.DMA_Interrupts.Transfer_Error;
+    stream->FCR = DMA_SxFCR_DMDIS | DMA_SxFCR_FTH | DMA_Configuration.DMA_Interrupts.Fifo_Error;
+
+    stream->PAR = (uint32_t)&(ADC123_COMMON->CDR);
+    stream->M0AR = (uint32_t)acquisition->buffers[0];
+    stream->M1AR = (uint32_t)acquisition->buffers[1];
+    stream->NDTR = block_bytes / (words ? 4U : 2U);
+
+    flag_clear = DMA_Flag_Clear_Register(stream, &flag_mask);
+    *flag_clear = flag_mask;
+
+    DMA_Register_Callback(stream, DMA_ADC_Multi_Callback, acquisition);
+    DMA_Stream_IRQ_Enable(stream);
+    stream->CR |= DMA_SxCR_EN;
+
+    ADC1->SR &= ~ADC_SR_OVR;
+    ADC123_COMMON->CCR = (ADC123_COMMON->CCR & ~(ADC_CCR_DMA | ADC_CCR_DDS)) | acquisition->dma_mode | ADC_CCR_DDS;
+
+    return 1;
+}
+
+/**
+ * @brief Stops multi-ADC capture and releases the stream.
+ *
+ * @param[in] acquisition Pointer to the `DMA_ADC_Multi_Acquisition` structure.
+ */
+void DMA_ADC_Multi_Stop(DMA_ADC_Multi_Acquisition *acquisition)
+{
+    DMA_Stream_TypeDef *stream = acquisition->Request.Stream;
+
+    ADC123_COMMON->CCR &= ~(ADC_CCR_DMA | ADC_CCR_DDS);
+
+    stream->CR &= ~DMA_SxCR_EN;
+    while(stream->CR & DMA_SxCR_EN) {}
+
+    DMA_Register_Callback(stream, NULL, NULL);
+    DMA_Stream_Release(stream);
+}
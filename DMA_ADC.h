@@ -0,0 +1,148 @@
+/**
+ * @file DMA_ADC.h
+ * @author Kunal Salvi
+ * @brief Header file for the DMA ADC acquisition engine.
+ *
+ * This file contains the data structures and function prototypes for streaming
+ * ADC conversions continuously into memory. The stream runs either in circular
+ * mode over one buffer holding two blocks (split by the half transfer and
+ * transfer complete interrupts) or in double-buffer mode over two block
+ * buffers. For every completed block the interleaved scan results are
+ * deinterleaved into a channel-major block and handed to the application's
+ * block callback.
+ *
+ * The multi-ADC capture mode streams the dual/triple ADC modes through the
+ * common data register (`ADC->CDR`) on ADC1's DMA request, in double-buffer
+ * mode with FIFO bursts, and delivers the samples of each block as one
+ * contiguous stream in conversion order.
+ *
+ * @version 1.0
+ * @date 2024-08-22
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef DMA_ADC_H_
+#define DMA_ADC_H_
+
+#include "DMA.h"
+
+/**
+ * @brief ADC acquisition structure.
+ *
+ * The fields in the first group are set by the application before calling
+ * `DMA_ADC_Start`. A block holds `block_frames` scans of `channels` samples.
+ * With `buffers[1]` NULL the engine runs in circular mode and `buffers[0]` must
+ * hold two blocks; otherwise each buffer holds one block and the stream runs in
+ * double-buffer mode. `output` holds one deinterleaved block: channel `c` of
+ * the block starts at `output[c * block_frames]`. Buffers should be word
+ * aligned for the fast deinterleave path.
+ *
+ * `DMA_Configuration.Request._ADC1` uses DMA2 Stream 0, which is also used by
+ * the memory-to-memory transfers; ADC1 can use DMA2 Stream 4 channel 0 instead.
+ */
+typedef struct DMA_ADC_Acquisition
+{
+    ADC_TypeDef *ADC;                   /**< ADC in scan mode, configured by the application */
+    DMA_Request Request;                /**< DMA request of the ADC (e.g. `DMA_Configuration.Request._ADC1`) */
+    uint32_t priority_level;            /**< Priority level of the stream */
+    uint16_t *buffers[2];               /**< Raw interleaved sample buffers (second one NULL for circular mode) */
+    uint16_t block_frames;              /**< Scans per block */
+    uint8_t channels;                   /**< Conversions per scan (sequence length) */
+    uint16_t *output;                   /**< Channel-major block, `channels * block_frames` samples */
+    void (*block)(const uint16_t *samples, uint16_t frames, uint8_t channels, void *context); /**< Block callback, called from the DMA interrupt */
+    void *context;                      /**< User pointer for the callback */
+
+    volatile uint32_t blocks;           /**< Number of blocks delivered */
+    volatile uint32_t overruns;         /**< Blocks overwritten by the DMA before they were deinterleaved */
+    volatile uint32_t errors;           /**< Transfer errors */
+} DMA_ADC_Acquisition;
+
+/** @name Multi-ADC DMA modes (ADC_CCR DMA field)
+ * @{
+ */
+#define DMA_ADC_MULTI_MODE_1    ADC_CCR_DMA_0                   /**< One half-word per request (ADC1, ADC2, ADC3 in turn) */
+#define DMA_ADC_MULTI_MODE_2    ADC_CCR_DMA_1                   /**< Two 12/10-bit samples per word request (interleaved up to 7.2 MSPS) */
+#define DMA_ADC_MULTI_MODE_3    (ADC_CCR_DMA_0 | ADC_CCR_DMA_1) /**< Two 8/6-bit samples per half-word request */
+/** @} */
+
+/**
+ * @brief Multi-ADC acquisition structure.
+ *
+ * The fields in the first group are set by the application before calling
+ * `DMA_ADC_Multi_Start`. The raw buffers receive the common data register in
+ * double-buffer mode and must be word aligned. In modes 1 and 2 a buffer holds
+ * `block_samples` half-words, which are already in conversion order and are
+ * passed to the callback without copying. In mode 3 it holds `block_samples`
+ * bytes, which are widened into `output` first. The size of a raw block in
+ * bytes must be a multiple of 16 (one FIFO burst).
+ */
+typedef struct DMA_ADC_Multi_Acquisition
+{
+    DMA_Request Request;                /**< ADC1's DMA request (`DMA_Configuration.Request._ADC1`) */
+    uint32_t priority_level;            /**< Priority level of the stream */
+    uint32_t dma_mode;                  /**< `DMA_ADC_MULTI_MODE_1`, `_2` or `_3` */
+    uint32_t *buffers[2];               /**< Raw common data register blocks */
+    uint16_t block_samples;             /**< Samples per block, all ADCs together */
+    uint16_t *output;                   /**< Widened block, `block_samples` samples (mode 3 only) */
+    void (*block)(const uint16_t *samples, uint16_t count, void *context); /**< Block callback, called from the DMA interrupt */
+    void *context;                      /**< User pointer for the callback */
+
+    volatile uint32_t blocks;           /**< Number of blocks delivered */
+    volatile uint32_t overruns;         /**< Blocks the DMA switched back to before the callback returned */
+    volatile uint32_t errors;           /**< Transfer and FIFO errors */
+} DMA_ADC_Multi_Acquisition;
+
+/**
+ * @brief Deinterleaves scan results into a channel-major block.
+ *
+ * @param[in] input Interleaved samples, `frames` scans of `channels` samples.
+ * @param[out] output Channel-major samples; channel `c` starts at `output[c * frames]`.
+ * @param[in] frames Number of scans.
+ * @param[in] channels Number of samples per scan.
+ */
+void DMA_ADC_Deinterleave(const uint16_t *input, uint16_t *output, uint16_t frames, uint8_t channels);
+
+/**
+ * @brief Starts continuous ADC acquisition.
+ *
+ * @param[in] acquisition Pointer to the DMA_ADC_Acquisition structure.
+ *
+ * @return int8_t Returns 1 on success, or -1 if the configuration is invalid or the stream is already claimed.
+ */
+int8_t DMA_ADC_Start(DMA_ADC_Acquisition *acquisition);
+
+/**
+ * @brief Stops ADC acquisition and releases the stream.
+ *
+ * @param[in] acquisition Pointer to the DMA_ADC_Acquisition structure.
+ */
+void DMA_ADC_Stop(DMA_ADC_Acquisition *acquisition);
+
+/**
+ * @brief Widens 8-bit samples to half-words.
+ *
+ * @param[in] input Packed 8-bit samples.
+ * @param[out] output Receives one half-word per sample.
+ * @param[in] count Number of samples.
+ */
+void DMA_ADC_Unpack_Bytes(const uint8_t *input, uint16_t *output, uint16_t count);
+
+/**
+ * @brief Starts multi-ADC capture through the common data register.
+ *
+ * @param[in] acquisition Pointer to the DMA_ADC_Multi_Acquisition structure.
+ *
+ * @return int8_t Returns 1 on success, or -1 if the configuration is invalid or the stream is already claimed.
+ */
+int8_t DMA_ADC_Multi_Start(DMA_ADC_Multi_Acquisition *acquisition);
+
+/**
+ * @brief Stops multi-ADC capture and releases the stream.
+ *
+ * @param[in] acquisition Pointer to the DMA_ADC_Multi_Acquisition structure.
+ */
+void DMA_ADC_Multi_Stop(DMA_ADC_Multi_Acquisition *acquisition);
+
+#endif /* DMA_ADC_H_ */
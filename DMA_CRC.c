@@ -0,0 +1,380 @@
+/**
+ * @file DMA_CRC.c
+ * @brief DMA CRC Engine Implementation for STM32F407VGT6
+ *
+ * This file implements CRC-32 computation with the CRC unit fed by a DMA2
+ * memory-to-memory stream. The source is read through the stream's peripheral
+ * port with address increment and written to `CRC->DR` through the memory
+ * port with the address fixed, in 32-bit words. A word-aligned source is read
+ * in words; any other source is read in bytes and packed into words by the
+ * FIFO, so no alignment is required. Runs of up to 65535 items are chained
+ * from the transfer complete interrupt, and the CPU adds the 1 to 3 trailing
+ * bytes to the unit's result in software.
+ *
+ * @version 1.0
+ * @date 2024-08-22
+ *
+ * @author Kunal Salvi
+ * @copyright Copyright (c) 2024
+ */
+
+#include "DMA_CRC.h"
+
+#define DMA_CRC_POLYNOMIAL      0x04C11DB7U     /**< CRC-32 polynomial of the CRC unit */
+
+static uint32_t DMA_CRC_Table[256];             /**< Lookup table of `DMA_CRC_Software` */
+static bool DMA_CRC_Table_Ready = false;        /**< `DMA_CRC_Table` has been computed */
+
+/**
+ * @brief Adds bytes to a CRC, most significant bit of each byte first.
+ */
+static uint32_t DMA_CRC_Bytes(uint32_t crc, const uint8_t *data, uint32_t length)
+{
+    uint32_t i;
+
+    for(i = 0; i < length; i++)
+    {
+        crc = (crc << 8) ^ DMA_CRC_Table[((crc >> 24) ^ data[i]) & 0xFFU];
+    }
+
+    return crc;
+}
+
+/**
+ * @brief Computes the lookup table on first use.
+ */
+static void DMA_CRC_Table_Init(void)
+{
+    uint32_t crc;
+    uint32_t i;
+    uint8_t bit;
+
+    if(DMA_CRC_Table_Ready)
+    {
+        return;
+    }
+
+    for(i = 0; i < 256; i++)
+    {
+        crc = i << 24;
+        for(bit = 0; bit < 8; bit++)
+        {
+            crc = (crc & 0x80000000U) ? ((crc << 1) ^ DMA_CRC_POLYNOMIAL) : (crc << 1);
+        }
+        DMA_CRC_Table[i] = crc;
+    }
+
+    DMA_CRC_Table_Ready = true;
+}
+
+/**
+ * @brief Streams the next run of the active request into the CRC unit.
+ */
+static void DMA_CRC_Load_Next_Run(DMA_CRC_Unit *unit)
+{
+    DMA_CRC_Request *request = unit->active;
+    DMA_Stream_TypeDef *stream = unit->Stream;
+    bool aligned = (((uint32_t)request->next & 3U) == 0);
+    uint32_t run;
+
+    // Word reads of an aligned source, byte reads packed by the FIFO otherwise
+    if(aligned)
+    {
+        run = (request->remaining / 4U > 0xFFFFU) ? (0xFFFFU * 4U) : request->remaining;
+        stream->CR = (stream->CR & ~DMA_SxCR_PSIZE) | DMA_Configuration.Peripheral_Data_Size.word;
+        stream->NDTR = run / 4U;
+    }
+    else
+    {
+        run = (request->remaining > 0xFFFCU) ? 0xFFFCU : request->remaining;
+        stream->CR = (stream->CR & ~DMA_SxCR_PSIZE) | DMA_Configuration.Peripheral_Data_Size.byte;
+        stream->NDTR = run;
+    }
+
+    stream->PAR = (uint32_t)request->next;
+    request->next += run;
+    request->remaining -= run;
+
+    stream->CR |= DMA_SxCR_EN;
+}
+
+/**
+ * @brief Ends the active request and reports it.
+ */
+static void DMA_CRC_Finish(DMA_CRC_Unit *unit, int8_t status)
+{
+    DMA_CRC_Request *request = unit->active;
+    const uint8_t *data = (const uint8_t *)request->data;
+
+    if(status == 1)
+    {
+        request->result = DMA_CRC_Bytes(CRC->DR, data + (request->length & ~3U), request->length & 3U);
+        unit->computed++;
+    }
+    else
+    {
+        unit->errors++;
+    }
+
+    unit->active = NULL;
+    request->status = status;
+    if(request->complete != NULL)
+    {
+        request->complete(request);
+    }
+}
+
+/**
+ * @brief Stream event callback: chains the runs and completes the request.
+ */
+static void DMA_CRC_Callback(DMA_Stream_TypeDef *stream, uint32_t event, void *context)
+{
+    DMA_CRC_Unit *unit = (DMA_CRC_Unit *)context;
+
+    if(unit->active == NULL)
+    {
+        return;
+    }
+
+    if(event == DMA_Configuration.DMA_Interrupts.Transfer_Complete)
+    {
+        if(unit->active->remaining != 0)
+        {
+            DMA_CRC_Load_Next_Run(unit);
+        }
+        else
+        {
+            DMA_CRC_Finish(unit, 1);
+        }
+    }
+    else if(event == DMA_Configuration.DMA_Interrupts.Transfer_Error)
+    {
+        stream->CR &= ~DMA_SxCR_EN;
+        DMA_CRC_Finish(unit, -1);
+    }
+}
+
+/**
+ * @brief Claims the stream and enables the CRC unit.
+ *
+ * This function claims the stream and configures it once for
+ * memory-to-memory transfers into `CRC->DR` (word writes, destination fixed,
+ * source incremented, FIFO full threshold) with transfer complete and error
+ * interrupts. It also enables the CRC unit's clock and computes the software
+ * lookup table.
+ *
+ * @param[in] unit Pointer to the `DMA_CRC_Unit` structure.
+ *
+ * @return int8_t Returns 1 on success, or -1 if the stream is not a DMA2 stream or is already claimed.
+ */
+int8_t DMA_CRC_Init(DMA_CRC_Unit *unit)
+{
+    DMA_Stream_TypeDef *stream = unit->Stream;
+
+    if((stream == NULL) || ((uint32_t)stream < (uint32_t)DMA2_Stream0) || ((uint32_t)stream > (uint32_t)DMA2_Stream7))
+    {
+        return -1;
+    }
+    if(DMA_Stream_Claim(stream) != 1)
+    {
+        return -1;
+    }
+
+    unit->active = NULL;
+    unit->computed = 0;
+    unit->errors = 0;
+
+    DMA_CRC_Table_Init();
+
+    RCC -> AHB1ENR |= RCC_AHB1ENR_CRCEN;
+
+    stream->CR &= ~DMA_SxCR_EN;
+    while(stream->CR & DMA_SxCR_EN) {}
+
+    stream->CR = DMA_Configuration.Transfer_Direction.Memory_to_memory |
+                 unit->priority_level |
+                 DMA_Configuration.Memory_Data_Size.word |
+                 DMA_Configuration.Peripheral_Data_Size.word |
+                 DMA_Configuration.Peripheral_Pointer_Increment.Enable |
+                 DMA_Configuration.DMA_Interrupts.Transfer_Complete |
+                 DMA_Configuration.DMA_Interrupts.Transfer_Error;
+
+    // Memory-to-memory transfers always go through the FIFO
+    stream->FCR = DMA_SxFCR_DMDIS | DMA_SxFCR_FTH;
+    stream->M0AR = (uint32_t)&(CRC->DR);
+
+    DMA_Register_Callback(stream, DMA_CRC_Callback, unit);
+    DMA_Stream_IRQ_Enable(stream);
+
+    return 1;
+}
+
+/**
+ * @brief Releases the stream of an idle CRC engine.
+ *
+ * @param[in] unit Pointer to the `DMA_CRC_Unit` structure.
+ */
+void DMA_CRC_Deinit(DMA_CRC_Unit *unit)
+{
+    DMA_Register_Callback(unit->Stream, NULL, NULL);
+    DMA_Stream_Release(unit->Stream);
+}
+
+/**
+ * @brief Starts computing the CRC of a buffer.
+ *
+ * The CRC unit is reset and the whole words of the buffer are streamed into
+ * it; buffers shorter than 4 bytes are computed in software right away. The
+ * CRC unit must not be used by other code until the request completes.
+ *
+ * @param[in] unit Pointer to the `DMA_CRC_Unit` structure.
+ * @param[in] request Pointer to the request.
+ *
+ * @return int8_t Returns 1 if the computation was started, or -1 if the engine is busy.
+ */
+int8_t DMA_CRC_Submit(DMA_CRC_Unit *unit, DMA_CRC_Request *request)
+{
+    volatile uint32_t *flag_clear;
+    uint32_t flag_mask;
+    uint32_t primask;
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+    if(unit->active != NULL)
+    {
+        __set_PRIMASK(primask);
+        return -1;
+    }
+    unit->active = request;
+    __set_PRIMASK(primask);
+
+    request->status = 0;
+    request->next = (const uint8_t *)request->data;
+    request->remaining = request->length & ~3U;
+
+    CRC->CR = CRC_CR_RESET;
+
+    if(request->remaining == 0)
+    {
+        DMA_CRC_Finish(unit, 1);
+        return 1;
+    }
+
+    flag_clear = DMA_Flag_Clear_Register(unit->Stream, &flag_mask);
+    *flag_clear = flag_mask;
+    DMA_CRC_Load_Next_Run(unit);
+
+    return 1;
+}
+
+/**
+ * @brief Computes the CRC of a buffer and waits for the result.
+ *
+ * @param[in] unit Pointer to the `DMA_CRC_Unit` structure.
+ * @param[in] data Buffer to checksum.
+ * @param[in] length Length of the buffer in bytes.
+ * @param[out] result CRC of the buffer.
+ *
+ * @return int8_t Returns 1 on success, or -1 if the engine is busy or a transfer error occurred.
+ */
+int8_t DMA_CRC_Compute(DMA_CRC_Unit *unit, const void *data, uint32_t length, uint32_t *result)
+{
+    DMA_CRC_Request request;
+
+    request.data = data;
+    request.length = length;
+    request.complete = NULL;
+    request.context = NULL;
+
+    if(DMA_CRC_Submit(unit, &request) != 1)
+    {
+        return -1;
+    }
+
+    while(request.status == 0) {}
+
+    *result = request.result;
+
+    return request.status;
+}
+
+/**
+ * @brief Reports whether a computation is running.
+ *
+ * @param[in] unit Pointer to the `DMA_CRC_Unit` structure.
+ *
+ * @return bool `true` while a request is active.
+ */
+bool DMA_CRC_Busy(DMA_CRC_Unit *unit)
+{
+    return unit->active != NULL;
+}
+
+/**
+ * @brief Table-driven software CRC with the same definition as the CRC unit.
+ *
+ * Each whole word is taken little-endian, as the unit receives it, and fed
+ * from its most significant byte; trailing bytes follow in order. Passing the
+ * result of one call as `crc` continues the checksum over a following buffer
+ * when the first buffer's length is a multiple of 4.
+ *
+ * @param[in] crc Initial value (`DMA_CRC_INITIAL` for a new checksum).
+ * @param[in] data Buffer to checksum.
+ * @param[in] length Length of the buffer in bytes.
+ *
+ * @return uint32_t CRC of the buffer.
+ */
+uint32_t DMA_CRC_Software(uint32_t crc, const void *data, uint32_t length)
+{
+    const uint8_t *bytes = (const uint8_t *)data;
+    uint8_t word[4];
+    uint32_t i;
+
+    DMA_CRC_Table_Init();
+
+    for(i = 0; i + 4U <= length; i += 4U)
+    {
+        word[0] = bytes[i + 3U];
+        word[1] = bytes[i + 2U];
+        word[2] = bytes[i + 1U];
+        word[3] = bytes[i];
+        crc = DMA_CRC_Bytes(crc, word, 4);
+    }
+
+    return DMA_CRC_Bytes(crc, bytes + i, length - i);
+}
+
+/**
+ * @brief Measures the DMA and software CRC of a buffer against each other.
+ *
+ * Both timings are taken with `DMA_Timestamp` around a complete computation,
+ * so the DMA figure includes the wait for the transfer; the CPU is free for
+ * other work during that time when `DMA_CRC_Submit` is used instead.
+ *
+ * @param[in] unit Pointer to the `DMA_CRC_Unit` structure.
+ * @param[in] data Buffer to checksum.
+ * @param[in] length Length of the buffer in bytes.
+ * @param[out] hardware_cycles CPU cycles of `DMA_CRC_Compute`.
+ * @param[out] software_cycles CPU cycles of `DMA_CRC_Software`.
+ *
+ * @return int8_t Returns 1 if both results match, or -1 otherwise.
+ */
+int8_t DMA_CRC_Benchmark(DMA_CRC_Unit *unit, const void *data, uint32_t length, uint32_t *hardware_cycles, uint32_t *software_cycles)
+{
+    uint32_t hardware = 0;
+    uint32_t software;
+    uint32_t start;
+    int8_t status;
+
+    DMA_Timestamp_Enable();
+
+    start = DMA_Timestamp();
+    status = DMA_CRC_Compute(unit, data, length, &hardware);
+    *hardware_cycles = DMA_Timestamp() - start;
+
+    start = DMA_Timestamp();
+    software = DMA_CRC_Software(DMA_CRC_INITIAL, data, length);
+    *software_cycles = DMA_Timestamp() - start;
+
+    return ((status == 1) && (hardware == software)) ? 1 : -1;
+}
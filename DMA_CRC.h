@@ -0,0 +1,141 @@
+/**
+ * @file DMA_CRC.h
+ * @author Kunal Salvi
+ * @brief Header file for the DMA CRC engine.
+ *
+ * This file contains the data structures and function prototypes for
+ * computing CRC-32 checksums with the hardware CRC unit fed by a DMA2
+ * memory-to-memory stream. The buffer is streamed into `CRC->DR` with the
+ * destination address fixed and 32-bit writes; only the last 1 to 3 bytes of
+ * a length that is not a multiple of 4 are processed by the CPU. Computations
+ * run asynchronously and report completion through a callback.
+ *
+ * The checksum is the one of the CRC unit: polynomial 0x04C11DB7, initial
+ * value 0xFFFFFFFF, no reflection and no final XOR, with every 4 bytes taken
+ * as a little-endian word. `DMA_CRC_Software` computes the same value with a
+ * lookup table, as a reference and for comparison.
+ *
+ * @version 1.0
+ * @date 2024-08-22
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef DMA_CRC_H_
+#define DMA_CRC_H_
+
+#include "DMA.h"
+
+#define DMA_CRC_INITIAL     0xFFFFFFFFU     /**< CRC value after a reset of the unit */
+
+typedef struct DMA_CRC_Request DMA_CRC_Request;
+
+/**
+ * @brief CRC computation request.
+ *
+ * `data`, `length`, `complete` and `context` are set by the application; the
+ * remaining fields are managed by the engine. The request must stay valid
+ * until it completes.
+ */
+struct DMA_CRC_Request
+{
+    const void *data;                   /**< Buffer to checksum, any alignment */
+    uint32_t length;                    /**< Length of the buffer in bytes */
+    void (*complete)(DMA_CRC_Request *request); /**< Called from the stream interrupt on completion, or NULL */
+    void *context;                      /**< User pointer */
+
+    uint32_t result;                    /**< CRC of the buffer */
+    volatile int8_t status;             /**< 0 while running, 1 when done, -1 on a transfer error */
+    const uint8_t *next;                /**< Next byte to stream */
+    uint32_t remaining;                 /**< Bytes left for the DMA, a multiple of 4 */
+};
+
+/**
+ * @brief CRC engine structure.
+ *
+ * `Stream` and `priority_level` are set by the application before calling
+ * `DMA_CRC_Init`. The remaining fields are managed by the engine.
+ */
+typedef struct DMA_CRC_Unit
+{
+    DMA_Stream_TypeDef *Stream;         /**< DMA2 stream used for the transfers (memory-to-memory is DMA2 only) */
+    uint32_t priority_level;            /**< Priority level of the stream */
+
+    DMA_CRC_Request *active;            /**< Request being computed, or NULL */
+    volatile uint32_t computed;         /**< Requests completed */
+    volatile uint32_t errors;           /**< Requests ended by a transfer error */
+} DMA_CRC_Unit;
+
+/**
+ * @brief Claims the stream and enables the CRC unit.
+ *
+ * @param[in] unit Pointer to the DMA_CRC_Unit structure.
+ *
+ * @return int8_t Returns 1 on success, or -1 if the stream is not a DMA2 stream or is already claimed.
+ */
+int8_t DMA_CRC_Init(DMA_CRC_Unit *unit);
+
+/**
+ * @brief Releases the stream of an idle CRC engine.
+ *
+ * @param[in] unit Pointer to the DMA_CRC_Unit structure.
+ */
+void DMA_CRC_Deinit(DMA_CRC_Unit *unit);
+
+/**
+ * @brief Starts computing the CRC of a buffer.
+ *
+ * @param[in] unit Pointer to the DMA_CRC_Unit structure.
+ * @param[in] request Pointer to the request.
+ *
+ * @return int8_t Returns 1 if the computation was started, or -1 if the engine is busy.
+ */
+int8_t DMA_CRC_Submit(DMA_CRC_Unit *unit, DMA_CRC_Request *request);
+
+/**
+ * @brief Computes the CRC of a buffer and waits for the result.
+ *
+ * @param[in] unit Pointer to the DMA_CRC_Unit structure.
+ * @param[in] data Buffer to checksum.
+ * @param[in] length Length of the buffer in bytes.
+ * @param[out] result CRC of the buffer.
+ *
+ * @return int8_t Returns 1 on success, or -1 if the engine is busy or a transfer error occurred.
+ */
+int8_t DMA_CRC_Compute(DMA_CRC_Unit *unit, const void *data, uint32_t length, uint32_t *result);
+
+/**
+ * @brief Reports whether a computation is running.
+ *
+ * @param[in] unit Pointer to the DMA_CRC_Unit structure.
+ *
+ * @return bool `true` while a request is active.
+ */
+bool DMA_CRC_Busy(DMA_CRC_Unit *unit);
+
+/**
+ * @brief Table-driven software CRC with the same definition as the CRC unit.
+ *
+ * @param[in] crc Initial value (`DMA_CRC_INITIAL` for a new checksum).
+ * @param[in] data Buffer to checksum.
+ * @param[in] length Length of the buffer in bytes.
+ *
+ * @return uint32_t CRC of the buffer.
+ */
+uint32_t DMA_CRC_Software(uint32_t crc, const void *data, uint32_t length);
+
+/**
+ * @brief Measures the DMA and software CRC of a buffer against each other.
+ *
+ * @param[in] unit Pointer to the DMA_CRC_Unit structure.
+ * @param[in] data Buffer to checksum.
+ * @param[in] length Length of the buffer in bytes.
+ * @param[out] hardware_cycles CPU cycles of `DMA_CRC_Compute`.
+ * @param[out] software_cycles CPU cycles of `DMA_CRC_Software`.
+ *
+ * @return int8_t Returns 1 if both results match, or -1 otherwise.
+ */
+int8_t DMA_CRC_Benchmark(DMA_CRC_Unit *unit, const void *data, uint32_t length, uint32_t *hardware_cycles, uint32_t *software_cycles);
+
+#endif /* DMA_CRC_H_ */
@@ -0,0 +1,377 @@
+/**
+ * @file DMA_Cache.c
+ * @brief External Flash Block Cache Implementation
+ *
+ * This file implements the flash block cache. Reads run in task context:
+ * they look blocks up, pick victims and queue fills by moving blocks from
+ * EMPTY, FAILED or VALID to QUEUED. The backend's completion, usually an
+ * interrupt, only moves blocks from QUEUED to FILLING and from FILLING to
+ * VALID or FAILED, and starts the next queued fill. The two sides never
+ * change the same block in the same state, so no interrupt masking is
+ * needed and the cache builds unchanged on a host.
+ *
+ * Fills are serialized by `busy`. Only the task sets it, and only while it is
+ * clear, which means no fill and so no completion is in progress; the
+ * completion clears it when nothing is left to fill. A block queued while
+ * the completion was deciding to stop is started by the next kick, which
+ * every wait loop repeats.
+ *
+ * @version 1.0
+ * @date 2024-08-22
+ *
+ * @author Kunal Salvi
+ * @copyright Copyright (c) 2024
+ */
+
+#include "DMA_Cache.h"
+#include <string.h>
+
+/**
+ * @brief Finds the block holding or about to hold an address.
+ */
+static DMA_Cache_Block *DMA_Cache_Lookup(DMA_Cache *cache, uint32_t address)
+{
+    DMA_Cache_Block *block;
+    uint32_t i;
+
+    for(i = 0; i < cache->block_count; i++)
+    {
+        block = &cache->blocks[i];
+        if((block->state != DMA_CACHE_EMPTY) && (block->state != DMA_CACHE_FAILED) && (block->address == address))
+        {
+            return block;
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Picks the block to reuse: an empty one, else the least recently used valid one.
+ *
+ * @param[in] keep Block that must not be picked, or NULL.
+ *
+ * @return DMA_Cache_Block* The block, or NULL if every block is queued, filling or `keep`.
+ */
+static DMA_Cache_Block *DMA_Cache_Victim(DMA_Cache *cache, const DMA_Cache_Block *keep)
+{
+    DMA_Cache_Block *victim = NULL;
+    DMA_Cache_Block *block;
+    uint32_t oldest = 0;
+    uint32_t i;
+
+    for(i = 0; i < cache->block_count; i++)
+    {
+        block = &cache->blocks[i];
+        if(block == keep)
+        {
+            continue;
+        }
+        if((block->state == DMA_CACHE_EMPTY) || (block->state == DMA_CACHE_FAILED))
+        {
+            return block;
+        }
+        if((block->state == DMA_CACHE_VALID) && ((victim == NULL) || ((cache->clock - block->age) > oldest)))
+        {
+            victim = block;
+            oldest = cache->clock - block->age;
+        }
+    }
+
+    return victim;
+}
+
+/**
+ * @brief Assigns a block to an address and queues its fill.
+ *
+ * The state is written last, so the completion never sees a half-queued block.
+ */
+static void DMA_Cache_Queue(DMA_Cache *cache, DMA_Cache_Block *block, uint32_t address, bool demand)
+{
+    block->address = address;
+    block->demand = demand;
+    block->prefetched = !demand;
+    block->age = ++cache->clock;
+    block->state = DMA_CACHE_QUEUED;
+}
+
+/**
+ * @brief Starts the next queued fill, reads before read-ahead, oldest first.
+ *
+ * Called with `busy` set; clears it if nothing is queued.
+ */
+static void DMA_Cache_Start_Next(DMA_Cache *cache)
+{
+    DMA_Cache_Block *next = NULL;
+    DMA_Cache_Block *block;
+    uint32_t i;
+
+    for(i = 0; i < cache->block_count; i++)
+    {
+        block = &cache->blocks[i];
+        if(block->state != DMA_CACHE_QUEUED)
+        {
+            continue;
+        }
+        if((next == NULL) ||
+           (block->demand && !next->demand) ||
+           ((block->demand == next->demand) && ((int32_t)(block->age - next->age) < 0)))
+        {
+            next = block;
+        }
+    }
+
+    if(next == NULL)
+    {
+        cache->busy = 0;
+        return;
+    }
+
+    next->state = DMA_CACHE_FILLING;
+    if(cache->fill(cache, next) != 1)
+    {
+        DMA_Cache_Fill_Complete(cache, next, -1);
+    }
+}
+
+/**
+ * @brief Starts filling if no fill is in progress.
+ */
+static void DMA_Cache_Kick(DMA_Cache *cache)
+{
+    if(cache->busy != 0)
+    {
+        return;
+    }
+
+    cache->busy = 1;
+    DMA_Cache_Start_Next(cache);
+}
+
+/**
+ * @brief Queues the blocks following `address` that are not in the cache.
+ */
+static void DMA_Cache_Read_Ahead(DMA_Cache *cache, uint32_t address, const DMA_Cache_Block *keep)
+{
+    DMA_Cache_Block *victim;
+    uint32_t next = address;
+    uint32_t i;
+
+    for(i = 0; i < cache->prefetch_depth; i++)
+    {
+        next += cache->block_size;
+        if((next == 0) || ((cache->flash_size != 0) && (next >= cache->flash_size)))
+        {
+            return;
+        }
+        if(DMA_Cache_Lookup(cache, next) != NULL)
+        {
+            continue;
+        }
+
+        // Read-ahead never waits: with every block busy it is dropped
+        victim = DMA_Cache_Victim(cache, keep);
+        if(victim == NULL)
+        {
+            return;
+        }
+
+        DMA_Cache_Queue(cache, victim, next, false);
+        cache->prefetches++;
+    }
+}
+
+/**
+ * @brief Returns the valid block of an address, filling it if needed.
+ *
+ * @return DMA_Cache_Block* The block, or NULL if its fill failed.
+ */
+static DMA_Cache_Block *DMA_Cache_Touch(DMA_Cache *cache, uint32_t address)
+{
+    DMA_Cache_Block *block = DMA_Cache_Lookup(cache, address);
+
+    if(block != NULL)
+    {
+        cache->hits++;
+        if(block->prefetched)
+        {
+            block->prefetched = false;
+            cache->prefetch_hits++;
+        }
+
+        // A read now waits for it: fill it before older read-ahead
+        if(block->state == DMA_CACHE_QUEUED)
+        {
+            block->demand = true;
+        }
+    }
+    else
+    {
+        cache->misses++;
+        while((block = DMA_Cache_Victim(cache, NULL)) == NULL)
+        {
+            DMA_Cache_Kick(cache);
+        }
+        DMA_Cache_Queue(cache, block, address, true);
+    }
+
+    // Queued behind a missing block, the read-ahead fills while its data is used
+    DMA_Cache_Read_Ahead(cache, address, block);
+
+    do
+    {
+        DMA_Cache_Kick(cache);
+    } while((block->state == DMA_CACHE_QUEUED) || (block->state == DMA_CACHE_FILLING));
+
+    if(block->state != DMA_CACHE_VALID)
+    {
+        block->state = DMA_CACHE_EMPTY;
+        return NULL;
+    }
+
+    block->age = ++cache->clock;
+
+    return block;
+}
+
+/**
+ * @brief Initializes the cache with all blocks empty.
+ *
+ * Splits `memory` into the blocks and clears the counters. The memory must
+ * be reachable by the backend's DMA (not CCM RAM on the STM32F407).
+ *
+ * @param[in] cache Pointer to the `DMA_Cache` structure.
+ *
+ * @return int8_t Returns 1 on success, or -1 if the configuration is invalid.
+ */
+int8_t DMA_Cache_Init(DMA_Cache *cache)
+{
+    uint32_t i;
+
+    if((cache->fill == NULL) || (cache->memory == NULL) || (cache->blocks == NULL))
+    {
+        return -1;
+    }
+    if((cache->block_count < 2) || (cache->prefetch_depth >= cache->block_count))
+    {
+        return -1;
+    }
+    if((cache->block_size == 0) || ((cache->block_size & (cache->block_size - 1U)) != 0))
+    {
+        return -1;
+    }
+
+    for(i = 0; i < cache->block_count; i++)
+    {
+        cache->blocks[i].data = cache->memory + (i * cache->block_size);
+        cache->blocks[i].address = 0;
+        cache->blocks[i].age = 0;
+        cache->blocks[i].demand = false;
+        cache->blocks[i].prefetched = false;
+        cache->blocks[i].state = DMA_CACHE_EMPTY;
+    }
+
+    cache->busy = 0;
+    cache->clock = 0;
+    cache->hits = 0;
+    cache->misses = 0;
+    cache->prefetches = 0;
+    cache->prefetch_hits = 0;
+    cache->errors = 0;
+
+    return 1;
+}
+
+/**
+ * @brief Reads bytes from the flash through the cache.
+ *
+ * Each block the read touches counts as a hit or a miss, and queues
+ * `prefetch_depth` following blocks for read-ahead. The call waits only for
+ * the blocks it needs; read-ahead continues after it returns. Must be called
+ * from one task only.
+ *
+ * @param[in] cache Pointer to the `DMA_Cache` structure.
+ * @param[in] address Flash address of the first byte.
+ * @param[out] buffer Buffer for the bytes.
+ * @param[in] length Number of bytes.
+ *
+ * @return int8_t Returns 1 on success, or -1 if a fill failed.
+ */
+int8_t DMA_Cache_Read(DMA_Cache *cache, uint32_t address, void *buffer, uint32_t length)
+{
+    uint8_t *out = (uint8_t *)buffer;
+    DMA_Cache_Block *block;
+    uint32_t base;
+    uint32_t offset;
+    uint32_t count;
+
+    while(length != 0)
+    {
+        base = address & ~(cache->block_size - 1U);
+        offset = address - base;
+        count = cache->block_size - offset;
+        if(count > length)
+        {
+            count = length;
+        }
+
+        block = DMA_Cache_Touch(cache, base);
+        if(block == NULL)
+        {
+            return -1;
+        }
+        memcpy(out, block->data + offset, count);
+
+        out += count;
+        address += count;
+        length -= count;
+    }
+
+    return 1;
+}
+
+/**
+ * @brief Called by the backend when the fill of a block has finished.
+ *
+ * Marks the block and starts the next queued fill, so read-ahead runs
+ * back-to-back from the backend's interrupt.
+ *
+ * @param[in] cache Pointer to the `DMA_Cache` structure.
+ * @param[in] block The block that was filled.
+ * @param[in] status 1 if the block was filled, or -1 on error.
+ */
+void DMA_Cache_Fill_Complete(DMA_Cache *cache, DMA_Cache_Block *block, int8_t status)
+{
+    if(status == 1)
+    {
+        block->state = DMA_CACHE_VALID;
+    }
+    else
+    {
+        cache->errors++;
+        block->state = DMA_CACHE_FAILED;
+    }
+
+    DMA_Cache_Start_Next(cache);
+}
+
+/**
+ * @brief Waits for pending fills and empties the cache, e.g. after the flash was written.
+ *
+ * @param[in] cache Pointer to the `DMA_Cache` structure.
+ */
+void DMA_Cache_Invalidate(DMA_Cache *cache)
+{
+    uint32_t i;
+
+    do
+    {
+        DMA_Cache_Kick(cache);
+    } while(cache->busy != 0);
+
+    for(i = 0; i < cache->block_count; i++)
+    {
+        cache->blocks[i].prefetched = false;
+        cache->blocks[i].state = DMA_CACHE_EMPTY;
+    }
+}
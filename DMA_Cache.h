@@ -0,0 +1,127 @@
+/**
+ * @file DMA_Cache.h
+ * @author Kunal Salvi
+ * @brief Header file for the external flash block cache.
+ *
+ * This file contains the data structures and function prototypes for a read
+ * cache over external flash. The cache is a fixed set of RAM blocks with
+ * least-recently-used eviction. Blocks are filled by a backend, usually a DMA
+ * transfer (see `DMA_SPI_Flash.h`), and every block that is touched queues
+ * the following blocks for sequential read-ahead, which the backend fills in
+ * the background while the application works on the current block.
+ *
+ * The cache itself does not depend on the hardware and only includes the
+ * standard headers, so it can be built on a host with the file-backed
+ * stand-in backend of `DMA_Cache_File.h` to tune the block size and the
+ * prefetch depth against recorded access patterns (see `host/`).
+ *
+ * @version 1.0
+ * @date 2024-08-22
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef DMA_CACHE_H_
+#define DMA_CACHE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#define DMA_CACHE_EMPTY     0   /**< Block holds no data */
+#define DMA_CACHE_QUEUED    1   /**< Block is assigned to an address and waits for its fill */
+#define DMA_CACHE_FILLING   2   /**< Block is being filled by the backend */
+#define DMA_CACHE_VALID     3   /**< Block holds the data of its address */
+#define DMA_CACHE_FAILED    4   /**< The fill of the block failed */
+
+typedef struct DMA_Cache DMA_Cache;
+
+/**
+ * @brief Cache block, managed by the cache.
+ */
+typedef struct DMA_Cache_Block
+{
+    uint8_t *data;                      /**< `block_size` bytes of the cache's memory */
+    volatile uint32_t address;          /**< Flash address of the block, a multiple of `block_size` */
+    volatile uint32_t age;              /**< Use stamp for the LRU eviction, queue order while queued */
+    volatile uint8_t state;             /**< One of the `DMA_CACHE_` states */
+    volatile bool demand;               /**< Queued by a read that waits for it (filled before read-ahead) */
+    volatile bool prefetched;           /**< Filled by read-ahead and not read yet */
+} DMA_Cache_Block;
+
+/**
+ * @brief Backend function starting the fill of a block.
+ *
+ * Reads `cache->block_size` bytes at `block->address` into `block->data` and
+ * calls `DMA_Cache_Fill_Complete` when done, from any context, including
+ * before returning. Only one fill is started at a time.
+ *
+ * @return int8_t 1 if the fill was started, or -1 if it could not be.
+ */
+typedef int8_t (*DMA_Cache_Fill)(DMA_Cache *cache, DMA_Cache_Block *block);
+
+/**
+ * @brief Cache structure.
+ *
+ * The fields in the first group are set by the application before calling
+ * `DMA_Cache_Init`. The remaining fields are managed by the cache.
+ */
+struct DMA_Cache
+{
+    DMA_Cache_Fill fill;                /**< Backend fill function */
+    void *device;                       /**< Backend pointer (e.g. a `DMA_SPI_Flash`) */
+    uint8_t *memory;                    /**< `block_count * block_size` bytes for the block data */
+    DMA_Cache_Block *blocks;            /**< `block_count` blocks */
+    uint32_t block_count;               /**< Number of blocks, at least 2 */
+    uint32_t block_size;                /**< Size of a block in bytes, a power of two */
+    uint32_t prefetch_depth;            /**< Blocks read ahead after a touched block, less than `block_count` (0 disables read-ahead) */
+    uint32_t flash_size;                /**< Size of the flash in bytes, read-ahead stops at its end (0 for no limit) */
+
+    volatile uint32_t busy;             /**< A fill is in progress */
+    uint32_t clock;                     /**< Last use stamp */
+    volatile uint32_t hits;             /**< Block accesses found in the cache */
+    volatile uint32_t misses;           /**< Block accesses that had to be filled */
+    volatile uint32_t prefetches;       /**< Blocks queued for read-ahead */
+    volatile uint32_t prefetch_hits;    /**< Read-ahead blocks that were read afterwards */
+    volatile uint32_t errors;           /**< Failed fills */
+};
+
+/**
+ * @brief Initializes the cache with all blocks empty.
+ *
+ * @param[in] cache Pointer to the DMA_Cache structure.
+ *
+ * @return int8_t Returns 1 on success, or -1 if the configuration is invalid.
+ */
+int8_t DMA_Cache_Init(DMA_Cache *cache);
+
+/**
+ * @brief Reads bytes from the flash through the cache.
+ *
+ * @param[in] cache Pointer to the DMA_Cache structure.
+ * @param[in] address Flash address of the first byte.
+ * @param[out] buffer Buffer for the bytes.
+ * @param[in] length Number of bytes.
+ *
+ * @return int8_t Returns 1 on success, or -1 if a fill failed.
+ */
+int8_t DMA_Cache_Read(DMA_Cache *cache, uint32_t address, void *buffer, uint32_t length);
+
+/**
+ * @brief Called by the backend when the fill of a block has finished.
+ *
+ * @param[in] cache Pointer to the DMA_Cache structure.
+ * @param[in] block The block that was filled.
+ * @param[in] status 1 if the block was filled, or -1 on error.
+ */
+void DMA_Cache_Fill_Complete(DMA_Cache *cache, DMA_Cache_Block *block, int8_t status);
+
+/**
+ * @brief Waits for pending fills and empties the cache, e.g. after the flash was written.
+ *
+ * @param[in] cache Pointer to the DMA_Cache structure.
+ */
+void DMA_Cache_Invalidate(DMA_Cache *cache);
+
+#endif /* DMA_CACHE_H_ */
@@ -0,0 +1,89 @@
+/**
+ * @file DMA_Cache_File.c
+ * @brief File-Backed Flash Cache Backend Implementation for host builds
+ *
+ * This file implements cache block fills from a flash image file. Bytes past
+ * the end of the image read as erased flash (0xFF), so an image only needs to
+ * hold the programmed part of the device. A read error fails the fill, as a
+ * transfer error of the DMA backend would.
+ *
+ * @version 1.0
+ * @date 2024-08-22
+ *
+ * @author Kunal Salvi
+ * @copyright Copyright (c) 2024
+ */
+
+#include "DMA_Cache_File.h"
+#include <string.h>
+
+#define DMA_CACHE_FILE_ERASED       0xFF    /**< Value of erased flash */
+
+/**
+ * @brief Opens the flash image.
+ *
+ * @param[in] file Pointer to the `DMA_Cache_File` structure.
+ *
+ * @return int8_t Returns 1 on success, or -1 if the image cannot be opened.
+ */
+int8_t DMA_Cache_File_Open(DMA_Cache_File *file)
+{
+    file->fills = 0;
+    file->bytes = 0;
+
+    file->image = (file->path != NULL) ? fopen(file->path, "rb") : NULL;
+
+    return (file->image != NULL) ? 1 : -1;
+}
+
+/**
+ * @brief Closes the flash image.
+ *
+ * @param[in] file Pointer to the `DMA_Cache_File` structure.
+ */
+void DMA_Cache_File_Close(DMA_Cache_File *file)
+{
+    if(file->image != NULL)
+    {
+        fclose(file->image);
+        file->image = NULL;
+    }
+}
+
+/**
+ * @brief Cache fill function: reads a block from the image.
+ *
+ * The block is read and reported to the cache before the function returns,
+ * which the cache allows of any backend.
+ *
+ * @param[in] cache Pointer to the cache, with `device` pointing to a `DMA_Cache_File`.
+ * @param[in] block Block to fill.
+ *
+ * @return int8_t Returns 1; the fill has completed when it returns.
+ */
+int8_t DMA_Cache_File_Fill(DMA_Cache *cache, DMA_Cache_Block *block)
+{
+    DMA_Cache_File *file = (DMA_Cache_File *)cache->device;
+    size_t count = 0;
+    int8_t status = -1;
+
+    if((file->image != NULL) && (fseek(file->image, (long)block->address, SEEK_SET) == 0))
+    {
+        count = fread(block->data, 1, cache->block_size, file->image);
+        status = ferror(file->image) ? -1 : 1;
+        clearerr(file->image);
+    }
+    memset(block->data + count, DMA_CACHE_FILE_ERASED, cache->block_size - count);
+
+    file->fills++;
+    file->bytes += (uint32_t)count;
+
+    if(file->delay != NULL)
+    {
+        file->delay(block->address, cache->block_size, file->context);
+    }
+
+    DMA_Cache_Fill_Complete(cache, block, status);
+
+    return 1;
+}
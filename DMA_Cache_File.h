@@ -0,0 +1,79 @@
+/**
+ * @file DMA_Cache_File.h
+ * @author Kunal Salvi
+ * @brief Header file for the file-backed flash cache backend.
+ *
+ * This file contains the data structure and function prototypes for filling
+ * the blocks of a `DMA_Cache` from a flash image file on a host. It stands in
+ * for `DMA_SPI_Flash.h` when the cache is built on a PC to tune the block
+ * size and the prefetch depth against recorded access patterns. Each fill
+ * completes before the fill function returns; an optional per-block delay
+ * hook lets a harness model the flash's transfer time. A harness that ends
+ * fills later, as the DMA backend does, installs its own fill function and
+ * calls `DMA_Cache_File_Fill` when the fill ends.
+ *
+ * @code
+ * static DMA_Cache_File image = { .path = "flash.bin" };
+ * static DMA_Cache cache = { .fill = DMA_Cache_File_Fill, .device = &image, ... };
+ *
+ * DMA_Cache_File_Open(&image);
+ * DMA_Cache_Init(&cache);
+ * @endcode
+ *
+ * @version 1.0
+ * @date 2024-08-22
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef DMA_CACHE_FILE_H_
+#define DMA_CACHE_FILE_H_
+
+#include <stdio.h>
+#include "DMA_Cache.h"
+
+/**
+ * @brief File backend structure.
+ *
+ * The fields in the first group are set by the application before calling
+ * `DMA_Cache_File_Open`. The remaining fields are managed by the backend.
+ */
+typedef struct DMA_Cache_File
+{
+    const char *path;                   /**< Flash image file */
+    void (*delay)(uint32_t address, uint32_t length, void *context); /**< Called for each fill, e.g. to account for the transfer time (optional) */
+    void *context;                      /**< User pointer for `delay` */
+
+    FILE *image;                        /**< Open image */
+    uint32_t fills;                     /**< Blocks read from the image */
+    uint32_t bytes;                     /**< Bytes read from the image */
+} DMA_Cache_File;
+
+/**
+ * @brief Opens the flash image.
+ *
+ * @param[in] file Pointer to the DMA_Cache_File structure.
+ *
+ * @return int8_t Returns 1 on success, or -1 if the image cannot be opened.
+ */
+int8_t DMA_Cache_File_Open(DMA_Cache_File *file);
+
+/**
+ * @brief Closes the flash image.
+ *
+ * @param[in] file Pointer to the DMA_Cache_File structure.
+ */
+void DMA_Cache_File_Close(DMA_Cache_File *file);
+
+/**
+ * @brief Cache fill function: reads a block from the image.
+ *
+ * @param[in] cache Pointer to the cache, with `device` pointing to a DMA_Cache_File.
+ * @param[in] block Block to fill.
+ *
+ * @return int8_t Returns 1; the fill has completed when it returns.
+ */
+int8_t DMA_Cache_File_Fill(DMA_Cache *cache, DMA_Cache_Block *block);
+
+#endif /* DMA_CACHE_FILE_H_ */
@@ -0,0 +1,221 @@
+/**
+ * @file DMA_Capture.c
+ * @brief DMA Input Capture Engine Implementation for STM32F407VGT6
+ *
+ * This file implements timer input capture streaming. The channel's capture
+ * DMA request moves each `CCR` value into a circular ring; on each half
+ * transfer/transfer complete interrupt the decoder hook iterates over the
+ * timestamps up to the end of the finished half. The iterator turns
+ * timestamps into deltas modulo the counter period, so an edge interval is
+ * correct across one counter wrap.
+ *
+ * @version 1.0
+ * @date 2024-08-22
+ *
+ * @author Kunal Salvi
+ * @copyright Copyright (c) 2024
+ */
+
+#include "DMA_Capture.h"
+
+/**
+ * @brief Stream event callback: runs the decoder over the finished half of the ring.
+ *
+ * After decoding, the stream position is checked: if the DMA has already moved
+ * back into the half that was just read, it is counted as an overrun.
+ */
+static void DMA_Capture_Callback(DMA_Stream_TypeDef *stream, uint32_t event, void *context)
+{
+    DMA_Capture *capture = (DMA_Capture *)context;
+    uint16_t half = capture->ring_samples / 2U;
+    DMA_Capture_Iterator iterator;
+    uint32_t skipped;
+    bool overrun;
+
+    if(event == DMA_Configuration.DMA_Interrupts.Transfer_Error)
+    {
+        capture->errors++;
+        return;
+    }
+
+    if(event == DMA_Configuration.DMA_Interrupts.Half_Transfer_Complete) iterator.end = half;
+    else if(event == DMA_Configuration.DMA_Interrupts.Transfer_Complete) iterator.end = 0;
+    else return;
+
+    // Polled captures are read by the application alone
+    if(capture->decode == NULL)
+    {
+        return;
+    }
+
+    iterator.capture = capture;
+    capture->decode(&iterator, capture->context);
+
+    // Timestamps the decoder left unread are skipped, keeping the next delta correct
+    while(DMA_Capture_Next(&iterator, &skipped)) {}
+    capture->blocks++;
+
+    // The first half is safe while NDTR counts down the second half, and vice versa
+    overrun = (iterator.end == half) ? (stream->NDTR > half) : (stream->NDTR <= half);
+    if(overrun)
+    {
+        capture->overruns++;
+    }
+}
+
+/**
+ * @brief Starts streaming capture timestamps into the ring.
+ *
+ * This function claims the stream, configures it in circular mode from the
+ * channel's `CCR` register with half transfer, transfer complete and error
+ * interrupts, and enables the channel's capture DMA request (`CCxDE`). The
+ * channel's input, filter and edge polarity are configured by the
+ * application, which also starts the counter.
+ *
+ * @param[in] capture Pointer to the `DMA_Capture` structure.
+ *
+ * @return int8_t Returns 1 on success, or -1 if the configuration is invalid or the stream is already claimed.
+ */
+int8_t DMA_Capture_Start(DMA_Capture *capture)
+{
+    DMA_Stream_TypeDef *stream = capture->Request.Stream;
+    volatile uint32_t *flag_clear;
+    uint32_t flag_mask;
+
+    if((stream == NULL) || (capture->TIM == NULL) || (capture->ring == NULL))
+    {
+        return -1;
+    }
+    if((capture->channel < 1) || (capture->channel > 4) || (capture->ring_samples < 2) || ((capture->ring_samples & 1U) != 0))
+    {
+        return -1;
+    }
+    if(DMA_Stream_Claim(stream) != 1)
+    {
+        return -1;
+    }
+
+    capture->read = 0;
+    capture->last = 0;
+    capture->primed = false;
+    capture->blocks = 0;
+    capture->overruns = 0;
+    capture->errors = 0;
+
+    stream->CR &= ~DMA_SxCR_EN;
+    while(stream->CR & DMA_SxCR_EN) {}
+
+    stream->CR = ((uint32_t)capture->Request.channel << DMA_SxCR_CHSEL_Pos) |
+                 DMA_Configuration.Transfer_Direction.Peripheral_to_memory |
+                 capture->priority_level |
+                 (capture->word ? DMA_Configuration.Memory_Data_Size.word : DMA_Configuration.Memory_Data_Size.half_word) |
+                 (capture->word ? DMA_Configuration.Peripheral_Data_Size.word : DMA_Configuration.Peripheral_Data_Size.half_word) |
+                 DMA_Configuration.Memory_Pointer_Increment.Enable |
+                 DMA_Configuration.Circular_Mode.Enable |
+                 DMA_Configuration.DMA_Interrupts.Half_Transfer_Complete |
+                 DMA_Configuration.DMA_Interrupts.Transfer_Complete |
+                 DMA_Configuration.DMA_Interrupts.Transfer_Error;
+    stream->FCR = 0;
+
+    // CCR1 to CCR4 are consecutive registers
+    stream->PAR = (uint32_t)(&(capture->TIM->CCR1) + (capture->channel - 1U));
+    stream->M0AR = (uint32_t)capture->ring;
+    stream->NDTR = capture->ring_samples;
+
+    flag_clear = DMA_Flag_Clear_Register(stream, &flag_mask);
+    *flag_clear = flag_mask;
+
+    DMA_Register_Callback(stream, DMA_Capture_Callback, capture);
+    DMA_Stream_IRQ_Enable(stream);
+    stream->CR |= DMA_SxCR_EN;
+
+    capture->TIM->DIER |= (TIM_DIER_CC1DE << (capture->channel - 1U));
+
+    return 1;
+}
+
+/**
+ * @brief Stops the capture and releases the stream.
+ *
+ * @param[in] capture Pointer to the `DMA_Capture` structure.
+ */
+void DMA_Capture_Stop(DMA_Capture *capture)
+{
+    DMA_Stream_TypeDef *stream = capture->Request.Stream;
+
+    capture->TIM->DIER &= ~(TIM_DIER_CC1DE << (capture->channel - 1U));
+    stream->CR &= ~DMA_SxCR_EN;
+    while(stream->CR & DMA_SxCR_EN) {}
+
+    DMA_Register_Callback(stream, NULL, NULL);
+    DMA_Stream_Release(stream);
+}
+
+/**
+ * @brief Sets up an iterator over the timestamps captured since the last read.
+ *
+ * For captures without a decoder hook. The caller must read the ring before
+ * the DMA wraps around onto unread timestamps; data lost this way is not
+ * detected.
+ *
+ * @param[in] capture Pointer to the `DMA_Capture` structure.
+ * @param[out] iterator Iterator to set up.
+ */
+void DMA_Capture_Poll(DMA_Capture *capture, DMA_Capture_Iterator *iterator)
+{
+    uint32_t remaining = capture->Request.Stream->NDTR;
+
+    iterator->capture = capture;
+    iterator->end = (remaining >= capture->ring_samples) ? 0 : (uint16_t)(capture->ring_samples - remaining);
+}
+
+/**
+ * @brief Returns the time between the next edge and the edge before it.
+ *
+ * The very first timestamp after the start has no predecessor and only
+ * primes the iterator. Intervals longer than one counter period cannot be
+ * told apart from shorter ones and come out modulo the period.
+ *
+ * @param[in] iterator Pointer to the iterator.
+ * @param[out] delta Counter ticks between the two edges.
+ *
+ * @return bool `true` if a delta was returned, `false` at the end of the iteration.
+ */
+bool DMA_Capture_Next(DMA_Capture_Iterator *iterator, uint32_t *delta)
+{
+    DMA_Capture *capture = iterator->capture;
+    uint32_t sample;
+
+    while(capture->read != iterator->end)
+    {
+        if(capture->word) sample = ((const uint32_t *)capture->ring)[capture->read];
+        else sample = ((const uint16_t *)capture->ring)[capture->read];
+
+        capture->read++;
+        if(capture->read == capture->ring_samples)
+        {
+            capture->read = 0;
+        }
+
+        if(!capture->primed)
+        {
+            capture->last = sample;
+            capture->primed = true;
+            continue;
+        }
+
+        if(capture->period != 0)
+        {
+            *delta = (sample >= capture->last) ? (sample - capture->last) : (sample + capture->period - capture->last);
+        }
+        else
+        {
+            *delta = capture->word ? (sample - capture->last) : ((sample - capture->last) & 0xFFFFU);
+        }
+        capture->last = sample;
+
+        return true;
+    }
+
+    return false;
+}
@@ -0,0 +1,104 @@
+/**
+ * @file DMA_Capture.h
+ * @author Kunal Salvi
+ * @brief Header file for the DMA input capture engine.
+ *
+ * This file contains the data structures and function prototypes for
+ * streaming timer input capture timestamps into a ring buffer. Every captured
+ * edge is moved from the channel's `CCR` register into the ring by the DMA, so
+ * pulse trains (IR remotes, RC-PWM, encoders) are decoded per block of edges
+ * instead of with one interrupt per edge. Timestamps are read back as deltas
+ * between consecutive edges through an iterator that handles counter
+ * wraparound, either from a decoder hook run on every half of the ring or by
+ * polling.
+ *
+ * @version 1.0
+ * @date 2024-08-22
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef DMA_CAPTURE_H_
+#define DMA_CAPTURE_H_
+
+#include "DMA.h"
+
+typedef struct DMA_Capture DMA_Capture;
+
+/**
+ * @brief Iterator over captured edges.
+ *
+ * Each call to `DMA_Capture_Next` consumes one timestamp from the ring, so
+ * consecutive iterators continue where the previous one stopped.
+ */
+typedef struct DMA_Capture_Iterator
+{
+    DMA_Capture *capture;               /**< Capture the timestamps are read from */
+    uint16_t end;                       /**< Ring index the iteration stops at */
+} DMA_Capture_Iterator;
+
+/**
+ * @brief Input capture structure.
+ *
+ * The fields in the first group are set by the application before calling
+ * `DMA_Capture_Start`. The ring holds `ring_samples` timestamps, half-words for
+ * 16-bit timers or words for the 32-bit TIM2 and TIM5. The remaining fields
+ * are managed by the engine.
+ */
+struct DMA_Capture
+{
+    TIM_TypeDef *TIM;                   /**< Timer, with the channel configured for input capture by the application */
+    DMA_Request Request;                /**< Request of the capture channel (e.g. `DMA_Configuration.Request.TIM1_CH1`) */
+    uint8_t channel;                    /**< Capture channel (1 to 4) */
+    bool word;                          /**< Timestamps are words (32-bit timers) */
+    uint32_t priority_level;            /**< Priority level of the stream */
+    void *ring;                         /**< Timestamp ring */
+    uint16_t ring_samples;              /**< Timestamps in the ring (even) */
+    uint32_t period;                    /**< Counter period (`ARR` + 1), or 0 when the counter runs over its full range */
+    void (*decode)(DMA_Capture_Iterator *iterator, void *context); /**< Runs on every half of the ring, or NULL to poll */
+    void *context;                      /**< User pointer for the decoder */
+
+    uint16_t read;                      /**< Next ring index to read */
+    uint32_t last;                      /**< Last timestamp read */
+    bool primed;                        /**< `last` holds a timestamp */
+    volatile uint32_t blocks;           /**< Number of half rings decoded */
+    volatile uint32_t overruns;         /**< Half rings the DMA re-entered before the decoder returned */
+    volatile uint32_t errors;           /**< Transfer errors */
+};
+
+/**
+ * @brief Starts streaming capture timestamps into the ring.
+ *
+ * @param[in] capture Pointer to the DMA_Capture structure.
+ *
+ * @return int8_t Returns 1 on success, or -1 if the configuration is invalid or the stream is already claimed.
+ */
+int8_t DMA_Capture_Start(DMA_Capture *capture);
+
+/**
+ * @brief Stops the capture and releases the stream.
+ *
+ * @param[in] capture Pointer to the DMA_Capture structure.
+ */
+void DMA_Capture_Stop(DMA_Capture *capture);
+
+/**
+ * @brief Sets up an iterator over the timestamps captured since the last read.
+ *
+ * @param[in] capture Pointer to the DMA_Capture structure.
+ * @param[out] iterator Iterator to set up.
+ */
+void DMA_Capture_Poll(DMA_Capture *capture, DMA_Capture_Iterator *iterator);
+
+/**
+ * @brief Returns the time between the next edge and the edge before it.
+ *
+ * @param[in] iterator Pointer to the iterator.
+ * @param[out] delta Counter ticks between the two edges.
+ *
+ * @return bool `true` if a delta was returned, `false` at the end of the iteration.
+ */
+bool DMA_Capture_Next(DMA_Capture_Iterator *iterator, uint32_t *delta);
+
+#endif /* DMA_CAPTURE_H_ */
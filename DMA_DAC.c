@@ -0,0 +1,239 @@
+/**
+ * @file DMA_DAC.c
+ * @brief DMA DAC Waveform Generator Implementation for STM32F407VGT6
+ *
+ * This file implements block-wise waveform streaming to the DAC. The stream
+ * runs in double-buffer mode and each DAC trigger moves one sample (or one
+ * sample pair in dual mode) to the data holding register. On every transfer
+ * complete interrupt the block that has just been played is refilled by the
+ * generator callback. When the generator ends the waveform, the remainder of
+ * its last block holds the final level and the stream is stopped once that
+ * block has been played.
+ *
+ * @version 1.0
+ * @date 2024-08-22
+ *
+ * @author Kunal Salvi
+ * @copyright Copyright (c) 2024
+ */
+
+#include "DMA_DAC.h"
+
+/**
+ * @brief Fills one block from the generator, padding past the end of the waveform.
+ */
+static void DMA_DAC_Fill(DMA_DAC_Generator *generator, uint8_t index)
+{
+    void *block = generator->buffers[index];
+    uint16_t samples = generator->block_samples;
+    uint16_t produced = 0;
+    uint16_t i;
+
+    if(generator->end_buffer < 0)
+    {
+        produced = generator->generate(block, samples, generator->context);
+        if(produced > samples)
+        {
+            produced = samples;
+        }
+        if(produced < samples)
+        {
+            generator->end_buffer = (int8_t)index;
+        }
+        generator->blocks++;
+    }
+
+    if(generator->dual)
+    {
+        uint32_t *words = (uint32_t *)block;
+
+        if(produced > 0) generator->hold = words[produced - 1];
+        for(i = produced; i < samples; i++) words[i] = generator->hold;
+    }
+    else
+    {
+        uint16_t *half_words = (uint16_t *)block;
+
+        if(produced > 0) generator->hold = half_words[produced - 1];
+        for(i = produced; i < samples; i++) half_words[i] = (uint16_t)generator->hold;
+    }
+}
+
+/**
+ * @brief Stops the DAC requests and the stream; the outputs keep their last level.
+ */
+static void DMA_DAC_Halt(DMA_DAC_Generator *generator)
+{
+    DMA_Stream_TypeDef *stream = generator->Request.Stream;
+
+    DAC->CR &= ~((generator->channel == 1) ? DAC_CR_DMAEN1 : DAC_CR_DMAEN2);
+    stream->CR &= ~DMA_SxCR_EN;
+    generator->running = false;
+}
+
+/**
+ * @brief Stream event callback: refills the block that has just been played.
+ */
+static void DMA_DAC_Callback(DMA_Stream_TypeDef *stream, uint32_t event, void *context)
+{
+    DMA_DAC_Generator *generator = (DMA_DAC_Generator *)context;
+    uint32_t ct;
+    uint8_t finished;
+
+    if(event == DMA_Configuration.DMA_Interrupts.Transfer_Error)
+    {
+        DMA_DAC_Halt(generator);
+        return;
+    }
+    if((event != DMA_Configuration.DMA_Interrupts.Transfer_Complete) || !generator->running)
+    {
+        return;
+    }
+
+    ct = stream->CR & DMA_SxCR_CT;
+    finished = ct ? 0 : 1;
+
+    if(generator->end_buffer == (int8_t)finished)
+    {
+        DMA_DAC_Halt(generator);
+        return;
+    }
+
+    DMA_DAC_Fill(generator, finished);
+
+    // The hardware switched back to this block before it was complete
+    if((stream->CR & DMA_SxCR_CT) != ct)
+    {
+        generator->underruns++;
+    }
+}
+
+/**
+ * @brief Starts streaming a waveform to the DAC.
+ *
+ * This function claims the stream, fills both blocks from the generator and
+ * configures the stream in double-buffer mode for the channel's data holding
+ * register (`DHR12R1`/`DHR12R2` with half-words, or `DHR12RD` with words in
+ * dual mode). It then selects the trigger of the channel(s), enables them and
+ * enables the DMA request of `channel`; in dual mode both channels share the
+ * trigger so they update on the same edge. The trigger timer is configured and
+ * started by the application.
+ *
+ * @param[in] generator Pointer to the `DMA_DAC_Generator` structure.
+ *
+ * @return int8_t Returns 1 on success, or -1 if the configuration is invalid or the stream is already claimed.
+ */
+int8_t DMA_DAC_Start(DMA_DAC_Generator *generator)
+{
+    DMA_Stream_TypeDef *stream = generator->Request.Stream;
+    volatile uint32_t *flag_clear;
+    uint32_t flag_mask;
+    uint32_t data_register;
+    uint32_t control;
+
+    if((stream == NULL) || (generator->generate == NULL) || (generator->block_samples == 0))
+    {
+        return -1;
+    }
+    if((generator->channel != 1 && generator->channel != 2) || (generator->trigger > 7))
+    {
+        return -1;
+    }
+    if((generator->buffers[0] == NULL) || (generator->buffers[1] == NULL))
+    {
+        return -1;
+    }
+    if(DMA_Stream_Claim(stream) != 1)
+    {
+        return -1;
+    }
+
+    generator->end_buffer = -1;
+    generator->hold = 0;
+    generator->blocks = 0;
+    generator->underruns = 0;
+
+    DMA_DAC_Fill(generator, 0);
+    DMA_DAC_Fill(generator, 1);
+
+    RCC -> APB1ENR |= RCC_APB1ENR_DACEN;
+
+    stream->CR &= ~DMA_SxCR_EN;
+    while(stream->CR & DMA_SxCR_EN) {}
+
+    stream->CR = ((uint32_t)generator->Request.channel << DMA_SxCR_CHSEL_Pos) |
+                 DMA_Configuration.Transfer_Direction.Memory_to_peripheral |
+                 generator->priority_level |
+                 (generator->dual ? DMA_Configuration.Memory_Data_Size.word : DMA_Configuration.Memory_Data_Size.half_word) |
+                 (generator->dual ? DMA_Configuration.Peripheral_Data_Size.word : DMA_Configuration.Peripheral_Data_Size.half_word) |
+                 DMA_Configuration.Memory_Pointer_Increment.Enable |
+                 DMA_Configuration.Circular_Mode.Enable |
+                 DMA_SxCR_DBM |
+                 DMA_Configuration.DMA_Interrupts.Transfer_Complete |
+                 DMA_Configuration.DMA_Interrupts.Transfer_Error;
+    stream->FCR = 0;
+
+    if(generator->dual) data_register = (uint32_t)&(DAC->DHR12RD);
+    else if(generator->channel == 1) data_register = (uint32_t)&(DAC->DHR12R1);
+    else data_register = (uint32_t)&(DAC->DHR12R2);
+
+    stream->PAR = data_register;
+    stream->M0AR = (uint32_t)generator->buffers[0];
+    stream->M1AR = (uint32_t)generator->buffers[1];
+    stream->NDTR = generator->block_samples;
+
+    flag_clear = DMA_Flag_Clear_Register(stream, &flag_mask);
+    *flag_clear = flag_mask;
+
+    generator->running = true;
+    DMA_Register_Callback(stream, DMA_DAC_Callback, generator);
+    DMA_Stream_IRQ_Enable(stream);
+    stream->CR |= DMA_SxCR_EN;
+
+    control = DAC->CR;
+    if(generator->dual || generator->channel == 1)
+    {
+        control = (control & ~DAC_CR_TSEL1) | ((uint32_t)generator->trigger << DAC_CR_TSEL1_Pos) | DAC_CR_TEN1 | DAC_CR_EN1;
+    }
+    if(generator->dual || generator->channel == 2)
+    {
+        control = (control & ~DAC_CR_TSEL2) | ((uint32_t)generator->trigger << DAC_CR_TSEL2_Pos) | DAC_CR_TEN2 | DAC_CR_EN2;
+    }
+    DAC->SR = DAC_SR_DMAUDR1 | DAC_SR_DMAUDR2;
+    DAC->CR = control | ((generator->channel == 1) ? DAC_CR_DMAEN1 : DAC_CR_DMAEN2);
+
+    return 1;
+}
+
+/**
+ * @brief Stops the waveform and releases the stream.
+ *
+ * The DAC channels stay enabled and hold the last converted level.
+ *
+ * @param[in] generator Pointer to the `DMA_DAC_Generator` structure.
+ */
+void DMA_DAC_Stop(DMA_DAC_Generator *generator)
+{
+    DMA_Stream_TypeDef *stream = generator->Request.Stream;
+
+    DMA_DAC_Halt(generator);
+    while(stream->CR & DMA_SxCR_EN) {}
+
+    DMA_Register_Callback(stream, NULL, NULL);
+    DMA_Stream_Release(stream);
+}
+
+/**
+ * @brief Reports whether the waveform is still playing.
+ *
+ * A waveform that ended on its own still holds its stream until `DMA_DAC_Stop`
+ * is called.
+ *
+ * @param[in] generator Pointer to the `DMA_DAC_Generator` structure.
+ *
+ * @return bool `true` until the last block has been played or the generator is stopped.
+ */
+bool DMA_DAC_Busy(DMA_DAC_Generator *generator)
+{
+    return generator->running;
+}
@@ -0,0 +1,78 @@
+/**
+ * @file DMA_DAC.h
+ * @author Kunal Salvi
+ * @brief Header file for the DMA DAC waveform generator.
+ *
+ * This file contains the data structures and function prototypes for streaming
+ * waveforms of any length to the DAC. The stream runs in double-buffer mode on
+ * the DAC's timer trigger; while the hardware plays one block, the application's
+ * generator callback refills the other one from the transfer complete
+ * interrupt, so only two blocks are held in RAM. Both channels can be driven
+ * synchronously from one stream through the dual data register `DHR12RD`.
+ *
+ * @version 1.0
+ * @date 2024-08-22
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef DMA_DAC_H_
+#define DMA_DAC_H_
+
+#include "DMA.h"
+
+/**
+ * @brief DAC waveform generator structure.
+ *
+ * The fields in the first group are set by the application before calling
+ * `DMA_DAC_Start`. In single-channel mode a block holds `block_samples`
+ * right-aligned 12-bit half-words; in dual mode it holds `block_samples` words
+ * with channel 1 in bits 11:0 and channel 2 in bits 27:16. The remaining fields
+ * are managed by the engine.
+ */
+typedef struct DMA_DAC_Generator
+{
+    DMA_Request Request;                /**< Request of the channel that paces the stream (`DMA_Configuration.Request._DAC1` or `_DAC2`) */
+    uint8_t channel;                    /**< DAC channel of the request (1 or 2) */
+    bool dual;                          /**< Drive both channels through `DHR12RD` */
+    uint8_t trigger;                    /**< DAC trigger selection (TSEL: 0 TIM6, 1 TIM8, 2 TIM7, 3 TIM5, 4 TIM2, 5 TIM4) */
+    uint32_t priority_level;            /**< Priority level of the stream */
+    void *buffers[2];                   /**< Sample blocks */
+    uint16_t block_samples;             /**< Samples per block */
+    uint16_t (*generate)(void *block, uint16_t samples, void *context); /**< Fills a block and returns the samples written; fewer than `samples` ends the waveform */
+    void *context;                      /**< User pointer for the generator */
+
+    volatile bool running;              /**< `true` until the last block has been played */
+    int8_t end_buffer;                  /**< Buffer holding the end of the waveform, or -1 */
+    uint32_t hold;                      /**< Last sample generated, repeated after the end of the waveform */
+    volatile uint32_t blocks;           /**< Number of blocks generated */
+    volatile uint32_t underruns;        /**< Blocks the generator did not refill before they were played */
+} DMA_DAC_Generator;
+
+/**
+ * @brief Starts streaming a waveform to the DAC.
+ *
+ * @param[in] generator Pointer to the DMA_DAC_Generator structure.
+ *
+ * @return int8_t Returns 1 on success, or -1 if the configuration is invalid or the stream is already claimed.
+ */
+int8_t DMA_DAC_Start(DMA_DAC_Generator *generator);
+
+/**
+ * @brief Stops the waveform and releases the stream.
+ *
+ * @param[in] generator Pointer to the DMA_DAC_Generator structure.
+ */
+void DMA_DAC_Stop(DMA_DAC_Generator *generator);
+
+/**
+ * @brief Reports whether the waveform is still playing.
+ *
+ * @param[in] generator Pointer to the DMA_DAC_Generator structure.
+ *
+ * @return bool `true` until the last block has been played or the generator is stopped.
+ */
+bool DMA_DAC_Busy(DMA_DAC_Generator *generator);
+
+#endif /* DMA_DAC_H_ */
@@ -0,0 +1,267 @@
+/**
+ * @file DMA_DCMI.c
+ * @brief DMA DCMI Camera Capture Engine Implementation for STM32F407VGT6
+ *
+ * This file implements continuous frame capture into a frame buffer pool. The
+ * stream runs in double-buffer mode over blocks of `lines_per_event` lines:
+ * while the hardware fills the block in one address register, the transfer
+ * complete interrupt loads the block after it into the other one. Two cursors
+ * walk the same sequence of blocks, one for the block the next interrupt
+ * completes and one, two blocks ahead, for the next block to load. When the
+ * load cursor reaches the end of a frame it moves on to a free buffer of the
+ * pool; if none is free, the frame it has just finished loading is dropped and
+ * its buffer is filled again by the next frame.
+ *
+ * @version 1.0
+ * @date 2024-08-22
+ *
+ * @author Kunal Salvi
+ * @copyright Copyright (c) 2024
+ */
+
+#include "DMA_DCMI.h"
+
+#define DMA_DCMI_FREE       0   /**< Frame buffer available for capture */
+#define DMA_DCMI_FILLING    1   /**< Frame buffer targeted by the DMA */
+#define DMA_DCMI_READY      2   /**< Frame buffer delivered and owned by the application */
+
+/**
+ * @brief Returns the address of the next block to load and advances the load cursor.
+ */
+static uint32_t DMA_DCMI_Next_Block(DMA_DCMI_Camera *camera)
+{
+    uint32_t block_bytes = camera->line_bytes * camera->lines_per_event;
+    uint32_t address = (uint32_t)camera->frames[camera->program_frame] + camera->program_block * block_bytes;
+    uint8_t index;
+
+    if(++camera->program_block == camera->blocks)
+    {
+        camera->program_block = 0;
+
+        for(index = 0; index < camera->frame_count; index++)
+        {
+            if(camera->state[index] == DMA_DCMI_FREE)
+            {
+                break;
+            }
+        }
+
+        if(index < camera->frame_count)
+        {
+            camera->state[index] = DMA_DCMI_FILLING;
+        }
+        else
+        {
+            // No free buffer: the frame just loaded is overwritten by the next one
+            index = camera->program_frame;
+            camera->skip[index]++;
+        }
+
+        camera->next[camera->program_frame] = index;
+        camera->program_frame = index;
+    }
+
+    return address;
+}
+
+/**
+ * @brief Stream event callback: loads the next block and reports lines and frames.
+ */
+static void DMA_DCMI_Callback(DMA_Stream_TypeDef *stream, uint32_t event, void *context)
+{
+    DMA_DCMI_Camera *camera = (DMA_DCMI_Camera *)context;
+    uint8_t frame = camera->complete_frame;
+    uint16_t block = camera->complete_block;
+    uint32_t address;
+    bool delivered;
+
+    if(event == DMA_Configuration.DMA_Interrupts.Transfer_Error)
+    {
+        DCMI->CR &= ~DCMI_CR_CAPTURE;
+        camera->errors++;
+        return;
+    }
+    if(event == DMA_Configuration.DMA_Interrupts.Fifo_Error)
+    {
+        camera->errors++;
+        return;
+    }
+    if(event != DMA_Configuration.DMA_Interrupts.Transfer_Complete)
+    {
+        return;
+    }
+
+    // Advance the completion cursor before loading, which may rewrite next[] of the same buffer
+    if(++camera->complete_block == camera->blocks)
+    {
+        camera->complete_block = 0;
+        camera->complete_frame = camera->next[frame];
+    }
+
+    // The register of the finished block is the one the hardware is not using
+    address = DMA_DCMI_Next_Block(camera);
+    if(stream->CR & DMA_SxCR_CT) stream->M0AR = address;
+    else stream->M1AR = address;
+
+    delivered = (camera->skip[frame] == 0);
+
+    if(delivered && (camera->line_event != NULL))
+    {
+        camera->line_event(camera->frames[frame], (uint16_t)((block + 1U) * camera->lines_per_event), camera->context);
+    }
+
+    if(block + 1U == camera->blocks)
+    {
+        if(delivered)
+        {
+            camera->state[frame] = DMA_DCMI_READY;
+            camera->captured++;
+            if(camera->frame_event != NULL)
+            {
+                camera->frame_event(camera->frames[frame], camera->context);
+            }
+        }
+        else
+        {
+            camera->skip[frame]--;
+            camera->dropped++;
+        }
+    }
+}
+
+/**
+ * @brief Starts continuous frame capture.
+ *
+ * This function claims the stream, configures it for word transfers from the
+ * DCMI data register in double-buffer mode with 4-word memory bursts, loads
+ * the first two blocks of the first frame buffer and sets the DCMI to
+ * continuous capture. The DCMI itself (synchronization, polarities, data
+ * width) is configured and enabled by the application.
+ *
+ * @param[in] camera Pointer to the `DMA_DCMI_Camera` structure.
+ *
+ * @return int8_t Returns 1 on success, or -1 if the configuration is invalid or the stream is already claimed.
+ */
+int8_t DMA_DCMI_Start(DMA_DCMI_Camera *camera)
+{
+    DMA_Stream_TypeDef *stream = camera->Request.Stream;
+    uint32_t block_bytes = camera->line_bytes * camera->lines_per_event;
+    volatile uint32_t *flag_clear;
+    uint32_t flag_mask;
+    uint8_t index;
+
+    if((stream == NULL) || (camera->frame_count < 2) || (camera->frame_count > DMA_DCMI_MAX_FRAMES))
+    {
+        return -1;
+    }
+    if((camera->lines_per_event == 0) || (camera->height == 0) || ((camera->height % camera->lines_per_event) != 0))
+    {
+        return -1;
+    }
+    if((block_bytes == 0) || ((block_bytes % 16U) != 0) || ((block_bytes / 4U) > 0xFFFF))
+    {
+        return -1;
+    }
+    for(index = 0; index < camera->frame_count; index++)
+    {
+        if(camera->frames[index] == NULL)
+        {
+            return -1;
+        }
+    }
+    if(DMA_Stream_Claim(stream) != 1)
+    {
+        return -1;
+    }
+
+    for(index = 0; index < camera->frame_count; index++)
+    {
+        camera->state[index] = DMA_DCMI_FREE;
+        camera->skip[index] = 0;
+        camera->next[index] = index;
+    }
+    camera->blocks = camera->height / camera->lines_per_event;
+    camera->state[0] = DMA_DCMI_FILLING;
+    camera->complete_frame = 0;
+    camera->complete_block = 0;
+    camera->program_frame = 0;
+    camera->program_block = 0;
+    camera->captured = 0;
+    camera->dropped = 0;
+    camera->errors = 0;
+
+    stream->CR &= ~DMA_SxCR_EN;
+    while(stream->CR & DMA_SxCR_EN) {}
+
+    stream->CR = ((uint32_t)camera->Request.channel << DMA_SxCR_CHSEL_Pos) |
+                 DMA_Configuration.Transfer_Direction.Peripheral_to_memory |
+                 camera->priority_level |
+                 DMA_Configuration.Memory_Data_Size.word |
+                 DMA_Configuration.Peripheral_Data_Size.word |
+                 DMA_Configuration.Memory_Pointer_Increment.Enable |
+                 DMA_Configuration.Circular_Mode.Enable |
+                 DMA_SxCR_DBM |
+                 DMA_SxCR_MBURST_0 |
+                 DMA_Configuration.DMA_Interrupts.Transfer_Complete |
+                 DMA_Configuration.DMA_Interrupts.Transfer_Error;
+    stream->FCR = DMA_SxFCR_DMDIS | DMA_SxFCR_FTH | DMA_Configuration.DMA_Interrupts.Fifo_Error;
+
+    stream->PAR = (uint32_t)&(DCMI->DR);
+    stream->M0AR = DMA_DCMI_Next_Block(camera);
+    stream->M1AR = DMA_DCMI_Next_Block(camera);
+    stream->NDTR = block_bytes / 4U;
+
+    flag_clear = DMA_Flag_Clear_Register(stream, &flag_mask);
+    *flag_clear = flag_mask;
+
+    DMA_Register_Callback(stream, DMA_DCMI_Callback, camera);
+    DMA_Stream_IRQ_Enable(stream);
+    stream->CR |= DMA_SxCR_EN;
+
+    DCMI->CR = (DCMI->CR & ~DCMI_CR_CM) | DCMI_CR_CAPTURE;
+
+    return 1;
+}
+
+/**
+ * @brief Stops frame capture and releases the stream.
+ *
+ * The frame being captured is discarded; delivered frames stay valid until
+ * they are released.
+ *
+ * @param[in] camera Pointer to the `DMA_DCMI_Camera` structure.
+ */
+void DMA_DCMI_Stop(DMA_DCMI_Camera *camera)
+{
+    DMA_Stream_TypeDef *stream = camera->Request.Stream;
+
+    DCMI->CR &= ~DCMI_CR_CAPTURE;
+
+    stream->CR &= ~DMA_SxCR_EN;
+    while(stream->CR & DMA_SxCR_EN) {}
+
+    DMA_Register_Callback(stream, NULL, NULL);
+    DMA_Stream_Release(stream);
+}
+
+/**
+ * @brief Returns a delivered frame to the pool.
+ *
+ * May be called from any context, including the frame event callback.
+ *
+ * @param[in] camera Pointer to the `DMA_DCMI_Camera` structure.
+ * @param[in] frame Frame buffer passed to `frame_event`.
+ */
+void DMA_DCMI_Release(DMA_DCMI_Camera *camera, void *frame)
+{
+    uint8_t index;
+
+    for(index = 0; index < camera->frame_count; index++)
+    {
+        if((camera->frames[index] == frame) && (camera->state[index] == DMA_DCMI_READY))
+        {
+            camera->state[index] = DMA_DCMI_FREE;
+            return;
+        }
+    }
+}
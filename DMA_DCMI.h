@@ -0,0 +1,88 @@
+/**
+ * @file DMA_DCMI.h
+ * @author Kunal Salvi
+ * @brief Header file for the DMA DCMI camera capture engine.
+ *
+ * This file contains the data structures and function prototypes for capturing
+ * camera frames continuously into a pool of frame buffers. A frame is split
+ * into blocks of a few lines, each well below the 65535-word `NDTR` limit. The
+ * stream runs in double-buffer mode and the transfer complete interrupt points
+ * the idle address register at the next block, moving on to a free frame
+ * buffer of the pool at the end of each frame. The application is notified
+ * every block (a group of lines) and every complete frame, and returns frames
+ * to the pool when it is done with them.
+ *
+ * @version 1.0
+ * @date 2024-08-22
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef DMA_DCMI_H_
+#define DMA_DCMI_H_
+
+#include "DMA.h"
+
+#define DMA_DCMI_MAX_FRAMES     4       /**< Maximum number of frame buffers in the pool */
+
+/**
+ * @brief DCMI camera capture structure.
+ *
+ * The fields in the first group are set by the application before calling
+ * `DMA_DCMI_Start`. A block of `lines_per_event` lines must be a multiple of
+ * 16 bytes (one FIFO burst) and at most 65535 words, and `height` a multiple
+ * of `lines_per_event`. The frame buffers must be word aligned. The remaining
+ * fields are managed by the engine.
+ */
+typedef struct DMA_DCMI_Camera
+{
+    DMA_Request Request;                /**< DCMI request (`DMA_Configuration.Request._DCMI`) */
+    uint32_t priority_level;            /**< Priority level of the stream */
+    void *frames[DMA_DCMI_MAX_FRAMES];  /**< Frame buffer pool */
+    uint8_t frame_count;                /**< Number of frame buffers (at least 2) */
+    uint32_t line_bytes;                /**< Bytes per line as delivered by the DCMI */
+    uint16_t height;                    /**< Lines per frame */
+    uint16_t lines_per_event;           /**< Lines per DMA block and per line event */
+    void (*line_event)(const void *frame, uint16_t lines, void *context); /**< Called from the DMA interrupt when `lines` lines of a frame have arrived (optional) */
+    void (*frame_event)(void *frame, void *context); /**< Called from the DMA interrupt with each complete frame (optional) */
+    void *context;                      /**< User pointer for the callbacks */
+
+    volatile uint8_t state[DMA_DCMI_MAX_FRAMES]; /**< Frame buffer states (free, filling, ready) */
+    uint8_t skip[DMA_DCMI_MAX_FRAMES];  /**< Frames to drop before the buffer's next frame is delivered */
+    uint8_t next[DMA_DCMI_MAX_FRAMES];  /**< Buffer that follows each buffer in capture order */
+    uint16_t blocks;                    /**< Blocks per frame */
+    uint8_t complete_frame;             /**< Buffer of the block the next transfer complete ends */
+    uint16_t complete_block;            /**< Index of that block in its frame */
+    uint8_t program_frame;              /**< Buffer of the next block to load */
+    uint16_t program_block;             /**< Index of that block in its frame */
+    volatile uint32_t captured;         /**< Frames delivered */
+    volatile uint32_t dropped;          /**< Frames overwritten because no buffer was free */
+    volatile uint32_t errors;           /**< Transfer and FIFO errors; capture stops on a transfer error */
+} DMA_DCMI_Camera;
+
+/**
+ * @brief Starts continuous frame capture.
+ *
+ * @param[in] camera Pointer to the DMA_DCMI_Camera structure.
+ *
+ * @return int8_t Returns 1 on success, or -1 if the configuration is invalid or the stream is already claimed.
+ */
+int8_t DMA_DCMI_Start(DMA_DCMI_Camera *camera);
+
+/**
+ * @brief Stops frame capture and releases the stream.
+ *
+ * @param[in] camera Pointer to the DMA_DCMI_Camera structure.
+ */
+void DMA_DCMI_Stop(DMA_DCMI_Camera *camera);
+
+/**
+ * @brief Returns a delivered frame to the pool.
+ *
+ * @param[in] camera Pointer to the DMA_DCMI_Camera structure.
+ * @param[in] frame Frame buffer passed to `frame_event`.
+ */
+void DMA_DCMI_Release(DMA_DCMI_Camera *camera, void *frame);
+
+#endif /* DMA_DCMI_H_ */
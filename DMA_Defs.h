@@ -75,6 +75,10 @@ static const struct DMA_Configuration {
     DMA_Request I2S2_TX;  /**< DMA request for I2S2 TX */
     DMA_Request I2S3_RX;  /**< DMA request for I2S3 RX */
     DMA_Request I2S3_TX;  /**< DMA request for I2S3 TX */
+    DMA_Request I2S2_EXT_RX;  /**< DMA request for I2S2ext RX (full-duplex I2S2) */
+    DMA_Request I2S2_EXT_TX;  /**< DMA request for I2S2ext TX (full-duplex I2S2) */
+    DMA_Request I2S3_EXT_RX;  /**< DMA request for I2S3ext RX (full-duplex I2S3) */
+    DMA_Request I2S3_EXT_TX;  /**< DMA request for I2S3ext TX (full-duplex I2S3) */
     DMA_Request I2C1_RX;  /**< DMA request for I2C1 RX */
     DMA_Request I2C1_TX;  /**< DMA request for I2C1 TX */
     DMA_Request I2C2_RX;  /**< DMA request for I2C2 RX */
@@ -93,10 +97,10 @@ static const struct DMA_Configuration {
     DMA_Request UART5_TX;   /**< DMA request for UART5 TX */
     DMA_Request UART6_RX;   /**< DMA request for UART6 RX */
     DMA_Request UART6_TX;   /**< DMA request for UART6 TX */
-    DMA_Request UART7_RX;   /**< DMA request for UART7 RX */
-    DMA_Request UART7_TX;   /**< DMA request for UART7 TX */
-    DMA_Request UART8_RX;   /**< DMA request for UART8 RX */
-    DMA_Request UART8_TX;   /**< DMA request for UART8 TX */
+    DMA_Request UART7_RX;   /**< DMA request for UART7 RX (STM32F42x/F43x only; the F407 has no UART7) */
+    DMA_Request UART7_TX;   /**< DMA request for UART7 TX (STM32F42x/F43x only; the F407 has no UART7) */
+    DMA_Request UART8_RX;   /**< DMA request for UART8 RX (STM32F42x/F43x only; the F407 has no UART8) */
+    DMA_Request UART8_TX;   /**< DMA request for UART8 TX (STM32F42x/F43x only; the F407 has no UART8) */
     DMA_Request TIM1_UP;    /**< DMA request for TIM1 update */
     DMA_Request TIM1_CH1;   /**< DMA request for TIM1 channel 1 */
     DMA_Request TIM1_CH2;   /**< DMA request for TIM1 channel 2 */
@@ -361,27 +365,51 @@ static const struct DMA_Configuration {
 				.I2S2_RX = {
 						.Controller = DMA1,
 						.Stream = DMA1_Stream3,
-						.channel = 3,
+						.channel = 0,
 				},
 
 				.I2S2_TX = {
 						.Controller = DMA1,
 						.Stream = DMA1_Stream4,
-						.channel = 3,
+						.channel = 0,
 				},
 
 				.I2S3_RX = {
 						.Controller = DMA1,
-						.Stream = DMA1_Stream2,
-						.channel = 2,
+						.Stream = DMA1_Stream0, // DMA1_Stream2
+						.channel = 0,
 				},
 
 				.I2S3_TX = {
 						.Controller = DMA1,
-						.Stream = DMA1_Stream7,
+						.Stream = DMA1_Stream7, // DMA1_Stream5
 						.channel = 0,
 				},
 
+				.I2S2_EXT_RX = {
+						.Controller = DMA1,
+						.Stream = DMA1_Stream3,
+						.channel = 3,
+				},
+
+				.I2S2_EXT_TX = {
+						.Controller = DMA1,
+						.Stream = DMA1_Stream4,
+						.channel = 2,
+				},
+
+				.I2S3_EXT_RX = {
+						.Controller = DMA1,
+						.Stream = DMA1_Stream2, // DMA1_Stream0 (channel 3)
+						.channel = 2,
+				},
+
+				.I2S3_EXT_TX = {
+						.Controller = DMA1,
+						.Stream = DMA1_Stream5,
+						.channel = 2,
+				},
+
 				.I2C1_RX = {
 						.Controller = DMA1,
 						.Stream = DMA1_Stream0, // DMA1_Stream5
@@ -610,7 +638,7 @@ static const struct DMA_Configuration {
 						.channel = 1,
 				},
 
-				._DAC2 = {
+				._DAC1 = {
 						.Controller = DMA1,
 						.Stream = DMA1_Stream5,
 						.channel = 7,
@@ -0,0 +1,537 @@
+/**
+ * @file DMA_Display.c
+ * @brief DMA Display Flush Engine Implementation for STM32F407VGT6
+ *
+ * This file implements dirty-rectangle tracking and DMA streaming of the
+ * changed regions of a framebuffer to an SPI or FSMC display panel. Each flush
+ * runs entirely from DMA interrupts: an optional sync phase copies the flushed
+ * rectangles into the other framebuffer with 2D memory-to-memory transfers, and
+ * a stream phase sends the rectangles to the panel row by row.
+ *
+ * @version 1.0
+ * @date 2024-08-22
+ *
+ * @author Kunal Salvi
+ * @copyright Copyright (c) 2024
+ */
+
+#include "DMA_Display.h"
+
+// Flush states
+#define DMA_DISPLAY_IDLE        0
+#define DMA_DISPLAY_SYNCING     1
+#define DMA_DISPLAY_STREAMING   2
+
+static void DMA_Display_Stream_Next(DMA_Display *display);
+
+/**
+ * @brief Returns the area of a rectangle in pixels.
+ */
+static uint32_t DMA_Display_Area(const DMA_Display_Rect *rect)
+{
+    return (uint32_t)rect->width * rect->height;
+}
+
+/**
+ * @brief Returns the bounding box of two rectangles.
+ */
+static DMA_Display_Rect DMA_Display_Union(const DMA_Display_Rect *a, const DMA_Display_Rect *b)
+{
+    DMA_Display_Rect result;
+    uint32_t right = ((a->x + a->width) > (b->x + b->width)) ? (a->x + a->width) : (b->x + b->width);
+    uint32_t bottom = ((a->y + a->height) > (b->y + b->height)) ? (a->y + a->height) : (b->y + b->height);
+
+    result.x = (a->x < b->x) ? a->x : b->x;
+    result.y = (a->y < b->y) ? a->y : b->y;
+    result.width = (uint16_t)(right - result.x);
+    result.height = (uint16_t)(bottom - result.y);
+
+    return result;
+}
+
+/**
+ * @brief Returns true if the framebuffer has a second buffer to flip to.
+ */
+static bool DMA_Display_Double_Buffered(DMA_Display *display)
+{
+    return display->frame_buffers[1] != NULL;
+}
+
+/**
+ * @brief Returns the framebuffer that is being streamed to the panel.
+ */
+static uint8_t *DMA_Display_Front_Buffer(DMA_Display *display)
+{
+    return display->frame_buffers[DMA_Display_Double_Buffered(display) ? (display->draw_index ^ 1) : 0];
+}
+
+/**
+ * @brief Waits until the last byte of an SPI run has left the shift register.
+ *
+ * The TX stream's transfer complete only means the last byte was written to
+ * DR; that byte and the one being shifted out are still on their way to the
+ * panel. Changing DC/CS for the next window, or reporting the flush complete,
+ * has to wait for TXE and then for BSY to clear.
+ */
+static void DMA_Display_SPI_Drain(DMA_Display *display)
+{
+    if(display->stream == NULL)
+    {
+        return;
+    }
+
+    while((display->SPI->SR & SPI_SR_TXE) == 0) {}
+    while(display->SPI->SR & SPI_SR_BSY) {}
+}
+
+/**
+ * @brief Ends the current flush and notifies the application.
+ */
+static void DMA_Display_Finish(DMA_Display *display)
+{
+    DMA_Display_SPI_Drain(display);
+    display->state = DMA_DISPLAY_IDLE;
+
+    if(display->flush_complete != NULL)
+    {
+        display->flush_complete(display);
+    }
+}
+
+/**
+ * @brief Copies the next flushed rectangle from the front buffer into the draw buffer.
+ *
+ * Once every rectangle has been synced the engine moves on to streaming.
+ */
+static void DMA_Display_Sync_Next(DMA_Display *display)
+{
+    uint32_t pitch = (uint32_t)display->width * display->bytes_per_pixel;
+    DMA_Display_Rect *rect;
+    uint32_t offset;
+
+    if(display->rect_index >= display->flushing_count)
+    {
+        display->rect_index = 0;
+        display->state = DMA_DISPLAY_STREAMING;
+        DMA_Display_Stream_Next(display);
+        return;
+    }
+
+    rect = &display->flushing[display->rect_index++];
+    offset = rect->y * pitch + (uint32_t)rect->x * display->bytes_per_pixel;
+
+    display->blit.source_address = (uint32_t)(DMA_Display_Front_Buffer(display) + offset);
+    display->blit.destination_address = (uint32_t)(display->frame_buffers[display->draw_index] + offset);
+    display->blit.width = rect->width * display->bytes_per_pixel;
+    display->blit.height = rect->height;
+    display->blit.source_stride = pitch;
+    display->blit.destination_stride = pitch;
+    display->blit.data_size = 8;
+    display->blit.source_increment = true;
+    display->blit.destination_increment = true;
+
+    if(DMA_Memory_To_Memory_2D_Transfer(&display->blit) != 1)
+    {
+        DMA_Display_Finish(display);
+    }
+}
+
+/**
+ * @brief 2D transfer completion callback for both the sync phase and FSMC streaming.
+ */
+static void DMA_Display_Blit_Complete(DMA_2D_Config *blit)
+{
+    DMA_Display *display = (DMA_Display *)blit->context;
+
+    if(DMA2_Stream0_Flag.Transfer_Error_Flag)
+    {
+        DMA_Display_Finish(display);
+    }
+    else if(display->state == DMA_DISPLAY_SYNCING)
+    {
+        DMA_Display_Sync_Next(display);
+    }
+    else
+    {
+        DMA_Display_Stream_Next(display);
+    }
+}
+
+/**
+ * @brief Starts one memory-to-peripheral run on the SPI TX stream.
+ */
+static void DMA_Display_Start_Run(DMA_Display *display, uint32_t address, uint16_t length)
+{
+    DMA_Stream_TypeDef *stream = display->stream->Request.Stream;
+
+    stream->M0AR = address;
+    stream->NDTR = length;
+    stream->CR |= DMA_SxCR_EN;
+}
+
+/**
+ * @brief Streams the next run of the flushed rectangles to the panel.
+ *
+ * On SPI, rows that span the full panel width are contiguous in the framebuffer
+ * and are sent as runs of up to 65535 bytes; other rectangles are sent one row
+ * per transfer. On FSMC each rectangle is a single 2D transfer into the fixed
+ * panel data address. The panel window is programmed before each rectangle,
+ * once the SPI has sent the last pixels of the previous one.
+ */
+static void DMA_Display_Stream_Next(DMA_Display *display)
+{
+    uint32_t pitch = (uint32_t)display->width * display->bytes_per_pixel;
+    uint8_t *front = DMA_Display_Front_Buffer(display);
+
+    while(display->rect_index < display->flushing_count)
+    {
+        DMA_Display_Rect *rect = &display->flushing[display->rect_index];
+        uint32_t row_bytes = (uint32_t)rect->width * display->bytes_per_pixel;
+        uint32_t base;
+
+        if((display->row == 0) && (display->run_offset == 0) && (display->set_window != NULL))
+        {
+            DMA_Display_SPI_Drain(display);
+            display->set_window(rect, display->context);
+        }
+
+        if(display->row < rect->height)
+        {
+            base = (uint32_t)front + (rect->y + display->row) * pitch + (uint32_t)rect->x * display->bytes_per_pixel;
+
+            if(display->stream == NULL)
+            {
+                display->blit.source_address = base;
+                display->blit.destination_address = display->fsmc_address;
+                display->blit.height = rect->height;
+                display->blit.source_stride = pitch;
+                display->blit.destination_stride = 0;
+                display->blit.source_increment = true;
+                display->blit.destination_increment = false;
+
+                if(display->bytes_per_pixel == 2)
+                {
+                    display->blit.data_size = 16;
+                    display->blit.width = rect->width;
+                }
+                else if(display->bytes_per_pixel == 4)
+                {
+                    display->blit.data_size = 32;
+                    display->blit.width = rect->width;
+                }
+                else
+                {
+                    display->blit.data_size = 8;
+                    display->blit.width = (uint16_t)row_bytes;
+                }
+
+                display->row = rect->height;
+
+                if(DMA_Memory_To_Memory_2D_Transfer(&display->blit) != 1)
+                {
+                    DMA_Display_Finish(display);
+                }
+            }
+            else if(row_bytes == pitch)
+            {
+                uint32_t total = (rect->height - display->row) * row_bytes;
+                uint32_t length = total - display->run_offset;
+
+                if(length > 0xFFFF)
+                {
+                    length = 0xFFFF;
+                }
+
+                DMA_Display_Start_Run(display, base + display->run_offset, (uint16_t)length);
+
+                display->run_offset += length;
+                if(display->run_offset == total)
+                {
+                    display->row = rect->height;
+                    display->run_offset = 0;
+                }
+            }
+            else
+            {
+                DMA_Display_Start_Run(display, base, (uint16_t)row_bytes);
+                display->row++;
+            }
+            return;
+        }
+
+        display->rect_index++;
+        display->row = 0;
+        display->run_offset = 0;
+    }
+
+    DMA_Display_Finish(display);
+}
+
+/**
+ * @brief SPI TX stream event callback that chains the rows of a flush.
+ */
+static void DMA_Display_Stream_Callback(DMA_Stream_TypeDef *stream, uint32_t event, void *context)
+{
+    DMA_Display *display = (DMA_Display *)context;
+
+    (void)stream;
+
+    if(display->state != DMA_DISPLAY_STREAMING)
+    {
+        return;
+    }
+
+    if(event == DMA_Configuration.DMA_Interrupts.Transfer_Complete)
+    {
+        DMA_Display_Stream_Next(display);
+    }
+    else if(event == DMA_Configuration.DMA_Interrupts.Transfer_Error)
+    {
+        DMA_Display_Finish(display);
+    }
+}
+
+/**
+ * @brief Initializes the display flush engine.
+ *
+ * This function checks the panel geometry, claims and initializes the SPI TX
+ * stream (when one is used) with its transfer error interrupt added, and
+ * registers the engine's stream callback. The whole panel is
+ * marked dirty so that the first flush sends a full frame and brings both
+ * framebuffers in sync. The SPI peripheral itself (including TXDMAEN) is set
+ * up by the application.
+ *
+ * @param[in] display Pointer to the `DMA_Display` structure.
+ *
+ * @return int8_t Returns 1 on success, or -1 if the configuration is invalid (including a
+ *         stream without its SPI) or the stream is already claimed.
+ */
+int8_t DMA_Display_Init(DMA_Display *display)
+{
+    if((display->width == 0) || (display->height == 0) || (display->bytes_per_pixel == 0) ||
+       (display->frame_buffers[0] == NULL) || (((uint32_t)display->width * display->bytes_per_pixel) > 0xFFFF) ||
+       ((display->stream != NULL) && (display->SPI == NULL)))
+    {
+        return -1;
+    }
+
+    display->dirty_count = 0;
+    display->flushing_count = 0;
+    display->draw_index = 0;
+    display->state = DMA_DISPLAY_IDLE;
+    display->blit.callback = DMA_Display_Blit_Complete;
+    display->blit.context = display;
+
+    if(display->stream != NULL)
+    {
+        if(DMA_Stream_Claim(display->stream->Request.Stream) != 1)
+        {
+            return -1;
+        }
+        if(DMA_Init(display->stream) != 1)
+        {
+            DMA_Stream_Release(display->stream->Request.Stream);
+            return -1;
+        }
+
+        // A transfer error ends the flush, so Busy does not stay set on a stopped stream
+        display->stream->Request.Stream->CR |= DMA_Configuration.DMA_Interrupts.Transfer_Error;
+        display->stream->Request.Stream->PAR = display->stream->peripheral_address;
+        DMA_Register_Callback(display->stream->Request.Stream, DMA_Display_Stream_Callback, display);
+    }
+
+    DMA_Display_Mark_Dirty(display, 0, 0, display->width, display->height);
+
+    return 1;
+}
+
+/**
+ * @brief Stops using the SPI TX stream of an idle display.
+ *
+ * Removes the stream callback, drops the clock reference taken by `DMA_Init`
+ * and releases the stream claimed by `DMA_Display_Init`, so the controller can
+ * be gated. A flush must not be running.
+ *
+ * @param[in] display Pointer to the `DMA_Display` structure.
+ */
+void DMA_Display_Deinit(DMA_Display *display)
+{
+    if(display->stream != NULL)
+    {
+        DMA_Register_Callback(display->stream->Request.Stream, NULL, NULL);
+        DMA_Clock_Disable(display->stream);
+        DMA_Stream_Release(display->stream->Request.Stream);
+    }
+}
+
+/**
+ * @brief Marks a rectangle of the draw buffer as changed.
+ *
+ * The rectangle is clipped to the panel and coalesced with the tracked dirty
+ * rectangles: it absorbs every rectangle whose bounding box with it covers no
+ * more than their combined area, which merges overlapping and adjacent regions
+ * without growing the amount of data sent. When the list is full, the
+ * rectangle is merged into the entry whose bounding box grows the least.
+ *
+ * @param[in] display Pointer to the `DMA_Display` structure.
+ * @param[in] x Left column.
+ * @param[in] y Top row.
+ * @param[in] width Width in pixels.
+ * @param[in] height Height in pixels.
+ */
+void DMA_Display_Mark_Dirty(DMA_Display *display, uint16_t x, uint16_t y, uint16_t width, uint16_t height)
+{
+    DMA_Display_Rect rect;
+    uint8_t i;
+
+    if((x >= display->width) || (y >= display->height) || (width == 0) || (height == 0))
+    {
+        return;
+    }
+
+    rect.x = x;
+    rect.y = y;
+    rect.width = ((uint32_t)x + width > display->width) ? (display->width - x) : width;
+    rect.height = ((uint32_t)y + height > display->height) ? (display->height - y) : height;
+
+    i = 0;
+    while(i < display->dirty_count)
+    {
+        DMA_Display_Rect merged = DMA_Display_Union(&rect, &display->dirty[i]);
+
+        if(DMA_Display_Area(&merged) <= DMA_Display_Area(&rect) + DMA_Display_Area(&display->dirty[i]))
+        {
+            // Absorb the entry and rescan, since the grown rectangle may now touch others
+            rect = merged;
+            display->dirty[i] = display->dirty[--display->dirty_count];
+            i = 0;
+        }
+        else
+        {
+            i++;
+        }
+    }
+
+    if(display->dirty_count < DMA_DISPLAY_MAX_DIRTY_RECTS)
+    {
+        display->dirty[display->dirty_count++] = rect;
+    }
+    else
+    {
+        uint8_t best = 0;
+        uint32_t best_growth = 0xFFFFFFFF;
+
+        for(i = 0; i < display->dirty_count; i++)
+        {
+            DMA_Display_Rect merged = DMA_Display_Union(&rect, &display->dirty[i]);
+            uint32_t growth = DMA_Display_Area(&merged) - DMA_Display_Area(&display->dirty[i]);
+
+            if(growth < best_growth)
+            {
+                best_growth = growth;
+                best = i;
+            }
+        }
+
+        display->dirty[best] = DMA_Display_Union(&rect, &display->dirty[best]);
+    }
+}
+
+/**
+ * @brief Returns the framebuffer the application may draw into.
+ *
+ * With double buffering the draw buffer is unavailable while the rectangles of
+ * the previous flush are being copied into it, which takes only as long as the
+ * memory-to-memory transfers. Streaming to the panel continues from the other
+ * buffer in the background.
+ *
+ * @param[in] display Pointer to the `DMA_Display` structure.
+ *
+ * @return uint8_t* Pointer to the draw buffer, or NULL while it is being synced.
+ */
+uint8_t *DMA_Display_Draw_Buffer(DMA_Display *display)
+{
+    if(display->state == DMA_DISPLAY_SYNCING)
+    {
+        return NULL;
+    }
+
+    if(DMA_Display_Double_Buffered(display))
+    {
+        return display->frame_buffers[display->draw_index];
+    }
+
+    return display->frame_buffers[0];
+}
+
+/**
+ * @brief Starts streaming the dirty rectangles to the panel.
+ *
+ * The dirty list is handed over to the flush and cleared, so new changes can be
+ * marked while the flush runs. With double buffering the framebuffers are
+ * swapped first: the buffer that was drawn into becomes the front buffer being
+ * streamed, and the flushed rectangles are copied into the new draw buffer
+ * before streaming starts. The flush completes in the background and reports
+ * through `flush_complete`.
+ *
+ * @param[in] display Pointer to the `DMA_Display` structure.
+ *
+ * @return int8_t Returns 1 if the flush was started (or there was nothing to flush),
+ *         or -1 if the previous flush or another 2D transfer is still running.
+ */
+int8_t DMA_Display_Flush(DMA_Display *display)
+{
+    uint8_t i;
+
+    if(display->state != DMA_DISPLAY_IDLE)
+    {
+        return -1;
+    }
+
+    if(display->dirty_count == 0)
+    {
+        return 1;
+    }
+
+    if((DMA_Display_Double_Buffered(display) || (display->stream == NULL)) && DMA_Memory_To_Memory_2D_Busy())
+    {
+        return -1;
+    }
+
+    for(i = 0; i < display->dirty_count; i++)
+    {
+        display->flushing[i] = display->dirty[i];
+    }
+    display->flushing_count = display->dirty_count;
+    display->dirty_count = 0;
+
+    display->rect_index = 0;
+    display->row = 0;
+    display->run_offset = 0;
+
+    if(DMA_Display_Double_Buffered(display))
+    {
+        display->draw_index ^= 1;
+        display->state = DMA_DISPLAY_SYNCING;
+        DMA_Display_Sync_Next(display);
+    }
+    else
+    {
+        display->state = DMA_DISPLAY_STREAMING;
+        DMA_Display_Stream_Next(display);
+    }
+
+    return 1;
+}
+
+/**
+ * @brief Reports whether a flush is still running.
+ *
+ * @param[in] display Pointer to the `DMA_Display` structure.
+ *
+ * @return bool `true` while the last flush is being synced or streamed.
+ */
+bool DMA_Display_Busy(DMA_Display *display)
+{
+    return display->state != DMA_DISPLAY_IDLE;
+}
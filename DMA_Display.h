@@ -0,0 +1,131 @@
+/**
+ * @file DMA_Display.h
+ * @author Kunal Salvi
+ * @brief Header file for the DMA display flush engine.
+ *
+ * This file contains the data structures and function prototypes for streaming
+ * the changed regions of a framebuffer to an SPI or FSMC display panel. Changed
+ * regions are tracked as a short list of dirty rectangles that are coalesced as
+ * they are marked. A flush streams only those rectangles, row by row, using
+ * chained memory-to-peripheral transfers on the SPI TX stream, or 2D
+ * memory-to-memory transfers into the FSMC data window. With two framebuffers
+ * the engine double buffers: drawing continues in one buffer while the other
+ * is streamed to the panel.
+ *
+ * @version 1.0
+ * @date 2024-08-22
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef DMA_DISPLAY_H_
+#define DMA_DISPLAY_H_
+
+#include "DMA.h"
+
+/** Maximum number of dirty rectangles tracked between two flushes */
+#define DMA_DISPLAY_MAX_DIRTY_RECTS 8
+
+/**
+ * @brief Rectangle on the display, in pixels.
+ */
+typedef struct DMA_Display_Rect
+{
+    uint16_t x;                         /**< Left column */
+    uint16_t y;                         /**< Top row */
+    uint16_t width;                     /**< Width in pixels */
+    uint16_t height;                    /**< Height in pixels */
+} DMA_Display_Rect;
+
+/**
+ * @brief Display flush engine structure.
+ *
+ * The fields in the first group are set by the application before calling
+ * `DMA_Display_Init`. The remaining fields are managed by the engine.
+ */
+typedef struct DMA_Display
+{
+    DMA_Config *stream;                 /**< SPI TX stream (memory-to-peripheral, byte, memory increment, transfer complete interrupt; claimed by the engine), or NULL for FSMC */
+    SPI_TypeDef *SPI;                   /**< SPI peripheral of the panel, drained before the window changes (required with `stream`) */
+    uint32_t fsmc_address;              /**< Panel data address in the FSMC window (used when `stream` is NULL) */
+    uint16_t width;                     /**< Panel width in pixels */
+    uint16_t height;                    /**< Panel height in pixels */
+    uint8_t bytes_per_pixel;            /**< Bytes per pixel in the framebuffers (e.g. 2 for RGB565) */
+    uint8_t *frame_buffers[2];          /**< Framebuffers; set the second to NULL for single buffering */
+    void (*set_window)(const DMA_Display_Rect *rect, void *context); /**< Programs the panel's address window before a rectangle is streamed */
+    void (*flush_complete)(struct DMA_Display *display); /**< Called from the DMA interrupt when a flush has been streamed (optional) */
+    void *context;                      /**< User pointer for the callbacks */
+
+    DMA_Display_Rect dirty[DMA_DISPLAY_MAX_DIRTY_RECTS];    /**< Rectangles changed since the last flush */
+    uint8_t dirty_count;                /**< Number of entries in `dirty` */
+    DMA_Display_Rect flushing[DMA_DISPLAY_MAX_DIRTY_RECTS]; /**< Rectangles of the flush in progress */
+    uint8_t flushing_count;             /**< Number of entries in `flushing` */
+    uint8_t draw_index;                 /**< Index of the framebuffer the application draws into */
+    volatile uint8_t state;             /**< Flush state (idle, syncing, streaming) */
+    uint8_t rect_index;                 /**< Rectangle being streamed */
+    uint16_t row;                       /**< Next row of the rectangle to stream */
+    uint32_t run_offset;                /**< Bytes of the current contiguous run already streamed */
+    DMA_2D_Config blit;                 /**< 2D transfer used for buffer sync and FSMC output */
+} DMA_Display;
+
+/**
+ * @brief Initializes the display flush engine.
+ *
+ * Claims and initializes the SPI TX stream (if any), with its transfer error
+ * interrupt, and marks the whole panel dirty so that the first flush sends a
+ * full frame and brings both framebuffers in sync.
+ *
+ * @param[in] display Pointer to the DMA_Display structure.
+ *
+ * @return int8_t Returns 1 on success, or -1 if the configuration is invalid (including a
+ *         stream without its SPI) or the stream is already claimed.
+ */
+int8_t DMA_Display_Init(DMA_Display *display);
+
+/**
+ * @brief Stops using the SPI TX stream of an idle display and releases it.
+ *
+ * @param[in] display Pointer to the DMA_Display structure.
+ */
+void DMA_Display_Deinit(DMA_Display *display);
+
+/**
+ * @brief Marks a rectangle of the draw buffer as changed.
+ *
+ * @param[in] display Pointer to the DMA_Display structure.
+ * @param[in] x Left column.
+ * @param[in] y Top row.
+ * @param[in] width Width in pixels.
+ * @param[in] height Height in pixels.
+ */
+void DMA_Display_Mark_Dirty(DMA_Display *display, uint16_t x, uint16_t y, uint16_t width, uint16_t height);
+
+/**
+ * @brief Returns the framebuffer the application may draw into.
+ *
+ * @param[in] display Pointer to the DMA_Display structure.
+ *
+ * @return uint8_t* Pointer to the draw buffer, or NULL while it is being synced after a flush.
+ */
+uint8_t *DMA_Display_Draw_Buffer(DMA_Display *display);
+
+/**
+ * @brief Starts streaming the dirty rectangles to the panel.
+ *
+ * @param[in] display Pointer to the DMA_Display structure.
+ *
+ * @return int8_t Returns 1 if the flush was started (or there was nothing to flush), or -1 if a flush is still running.
+ */
+int8_t DMA_Display_Flush(DMA_Display *display);
+
+/**
+ * @brief Reports whether a flush is still running.
+ *
+ * @param[in] display Pointer to the DMA_Display structure.
+ *
+ * @return bool `true` while the last flush is being synced or streamed.
+ */
+bool DMA_Display_Busy(DMA_Display *display);
+
+#endif /* DMA_DISPLAY_H_ */
@@ -0,0 +1,363 @@
+/**
+ * @file DMA_Framing.c
+ * @brief DMA Framing Codec Implementation
+ *
+ * This file implements COBS and SLIP framing over the UART packet receiver's
+ * ring. The decoder runs on the byte views handed over by the receiver and
+ * writes every decoded byte back into the ring at `start + length`, which
+ * always trails the byte being read, so a frame is decoded in place even when
+ * it spans several views or the wrap of the ring. At each delimiter the frame
+ * is handed to the application and the next frame starts right after the
+ * delimiter. The encoders write straight into the caller's TX buffer.
+ *
+ * @version 1.0
+ * @date 2024-08-22
+ *
+ * @author Kunal Salvi
+ * @copyright Copyright (c) 2024
+ */
+
+#include "DMA_Framing.h"
+
+#define DMA_FRAMING_SLIP_END        0xC0    /**< SLIP frame delimiter */
+#define DMA_FRAMING_SLIP_ESC        0xDB    /**< SLIP escape */
+#define DMA_FRAMING_SLIP_ESC_END    0xDC    /**< Escaped delimiter */
+#define DMA_FRAMING_SLIP_ESC_ESC    0xDD    /**< Escaped escape */
+
+/**
+ * @brief Marks the current frame as too long.
+ */
+static void DMA_Framing_Oversize(DMA_Framing_Link *link)
+{
+    if(!link->discard)
+    {
+        link->discard = true;
+        link->rx_oversize++;
+    }
+}
+
+/**
+ * @brief Appends a decoded byte to the current frame, in place in the ring.
+ */
+static void DMA_Framing_Emit(DMA_Framing_Link *link, uint8_t byte)
+{
+    DMA_UART_RX *rx = link->rx;
+    uint32_t index;
+
+    if(link->discard)
+    {
+        return;
+    }
+    if((link->max_frame != 0) && (link->length >= link->max_frame))
+    {
+        DMA_Framing_Oversize(link);
+        return;
+    }
+
+    index = (uint32_t)link->start + link->length;
+    if(index >= rx->ring_size)
+    {
+        index -= rx->ring_size;
+    }
+    rx->ring[index] = byte;
+    link->length++;
+}
+
+/**
+ * @brief Marks the current frame as badly encoded.
+ */
+static void DMA_Framing_Error(DMA_Framing_Link *link)
+{
+    if(!link->discard)
+    {
+        link->discard = true;
+        link->rx_errors++;
+    }
+}
+
+/**
+ * @brief Ends the current frame at a delimiter and starts the next one after it.
+ *
+ * @param[in] link Pointer to the link.
+ * @param[in] valid The frame is complete and correctly encoded.
+ * @param[in] next Ring index of the byte after the delimiter.
+ */
+static void DMA_Framing_End(DMA_Framing_Link *link, bool valid, uint16_t next)
+{
+    DMA_UART_RX *rx = link->rx;
+    DMA_UART_Frame frame;
+
+    if(valid && !link->discard)
+    {
+        frame.first = rx->ring + link->start;
+        frame.complete = true;
+        if((uint32_t)link->start + link->length <= rx->ring_size)
+        {
+            frame.first_length = link->length;
+            frame.second = NULL;
+            frame.second_length = 0;
+        }
+        else
+        {
+            frame.first_length = (uint16_t)(rx->ring_size - link->start);
+            frame.second = rx->ring;
+            frame.second_length = (uint16_t)(link->length - frame.first_length);
+        }
+
+        link->rx_frames++;
+        if(link->frame != NULL)
+        {
+            link->frame(&frame, link->context);
+        }
+    }
+
+    link->start = next;
+    link->length = 0;
+    link->code = 0;
+    link->remaining = 0;
+    link->escape = false;
+    link->discard = false;
+}
+
+/**
+ * @brief Decodes one contiguous segment of received bytes.
+ *
+ * The receiver only keeps the DMA off bytes it has not handed over yet, so
+ * the decoded frame, which lies in the encoded bytes from `start` on, is
+ * safe while those span at most half the ring. Longer frames are discarded.
+ */
+static void DMA_Framing_Decode(DMA_Framing_Link *link, const uint8_t *data, uint16_t count)
+{
+    DMA_UART_RX *rx = link->rx;
+    uint32_t index = (uint32_t)(data - rx->ring);
+    uint8_t delimiter = (link->protocol == DMA_FRAMING_COBS) ? 0x00 : DMA_FRAMING_SLIP_END;
+    uint32_t position;
+    uint32_t span;
+    uint16_t next;
+    uint16_t i;
+    uint8_t byte;
+
+    for(i = 0; i < count; i++)
+    {
+        byte = data[i];
+        position = index + i;
+        next = (uint16_t)((position + 1U == rx->ring_size) ? 0 : (position + 1U));
+
+        // Encoded bytes of the frame before this one
+        if(!link->discard && (byte != delimiter))
+        {
+            span = (position >= link->start) ? (position - link->start) : (position + rx->ring_size - link->start);
+            if(span >= rx->ring_size / 2U)
+            {
+                DMA_Framing_Oversize(link);
+            }
+        }
+
+        if(link->protocol == DMA_FRAMING_COBS)
+        {
+            if(byte == 0x00)
+            {
+                // Repeated delimiters carry no frame; a block cut short is an error
+                if(link->remaining != 0) DMA_Framing_Error(link);
+                DMA_Framing_End(link, (link->code != 0) && (link->remaining == 0), next);
+            }
+            else if(link->remaining == 0)
+            {
+                // Every block but a full one (code 0xFF) stood for a zero in the frame
+                if((link->code != 0) && (link->code != 0xFF))
+                {
+                    DMA_Framing_Emit(link, 0x00);
+                }
+                link->code = byte;
+                link->remaining = (uint8_t)(byte - 1U);
+            }
+            else
+            {
+                DMA_Framing_Emit(link, byte);
+                link->remaining--;
+            }
+        }
+        else
+        {
+            if(byte == DMA_FRAMING_SLIP_END)
+            {
+                if(link->escape) DMA_Framing_Error(link);
+                DMA_Framing_End(link, link->length != 0, next);
+            }
+            else if(link->escape)
+            {
+                link->escape = false;
+                if(byte == DMA_FRAMING_SLIP_ESC_END) DMA_Framing_Emit(link, DMA_FRAMING_SLIP_END);
+                else if(byte == DMA_FRAMING_SLIP_ESC_ESC) DMA_Framing_Emit(link, DMA_FRAMING_SLIP_ESC);
+                else DMA_Framing_Error(link);
+            }
+            else if(byte == DMA_FRAMING_SLIP_ESC)
+            {
+                link->escape = true;
+            }
+            else
+            {
+                DMA_Framing_Emit(link, byte);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Attaches a link to a UART receiver.
+ *
+ * Installs `DMA_Framing_Receive` as the receiver's callback and resets the
+ * decoder and the statistics. Must be called before `DMA_UART_RX_Start`.
+ *
+ * @param[in] link Pointer to the `DMA_Framing_Link` structure.
+ * @param[in] rx Pointer to the receiver, before it is started.
+ *
+ * @return int8_t Returns 1 on success, or -1 if the protocol is unknown.
+ */
+int8_t DMA_Framing_Init(DMA_Framing_Link *link, DMA_UART_RX *rx)
+{
+    if((link->protocol != DMA_FRAMING_COBS) && (link->protocol != DMA_FRAMING_SLIP))
+    {
+        return -1;
+    }
+
+    link->rx = rx;
+    link->start = 0;
+    link->length = 0;
+    link->code = 0;
+    link->remaining = 0;
+    link->escape = false;
+    link->discard = false;
+
+    link->rx_frames = 0;
+    link->rx_errors = 0;
+    link->rx_oversize = 0;
+    link->tx_frames = 0;
+    link->tx_errors = 0;
+
+    rx->frame = DMA_Framing_Receive;
+    rx->context = link;
+
+    return 1;
+}
+
+/**
+ * @brief Decodes received bytes in place; installed as the receiver's callback.
+ *
+ * The receiver's frame boundaries are ignored: only the protocol's delimiters
+ * end a frame, so a frame may arrive in several views and one view may carry
+ * several frames. A decoded frame's view is valid during the link's callback.
+ *
+ * @param[in] frame Bytes handed over by the receiver.
+ * @param[in] context Pointer to the `DMA_Framing_Link` structure.
+ */
+void DMA_Framing_Receive(const DMA_UART_Frame *frame, void *context)
+{
+    DMA_Framing_Link *link = (DMA_Framing_Link *)context;
+
+    DMA_Framing_Decode(link, frame->first, frame->first_length);
+    if(frame->second_length != 0)
+    {
+        DMA_Framing_Decode(link, frame->second, frame->second_length);
+    }
+}
+
+/**
+ * @brief Encodes a frame directly into a TX buffer.
+ *
+ * COBS frames are followed by a 0x00 delimiter. SLIP frames are enclosed in
+ * 0xC0 delimiters; the leading one flushes line noise at the receiver. The
+ * buffer can then be sent as is, e.g. with `DMA_Set_Target` and
+ * `DMA_Set_Trigger`. `DMA_FRAMING_COBS_MAX` and `DMA_FRAMING_SLIP_MAX` give
+ * buffer sizes that fit any frame.
+ *
+ * @param[in] link Pointer to the `DMA_Framing_Link` structure.
+ * @param[in] payload Frame to encode.
+ * @param[in] length Length of the frame.
+ * @param[out] buffer TX buffer.
+ * @param[in] size Size of `buffer`.
+ *
+ * @return uint16_t Encoded length including the delimiter(s), or 0 if the frame does not fit.
+ */
+uint16_t DMA_Framing_Encode(DMA_Framing_Link *link, const uint8_t *payload, uint16_t length, uint8_t *buffer, uint16_t size)
+{
+    uint32_t out = 0;
+    uint32_t code_index;
+    uint8_t code;
+    uint16_t i;
+    uint8_t byte;
+
+    if(link->protocol == DMA_FRAMING_COBS)
+    {
+        code_index = out++;
+        code = 1;
+
+        for(i = 0; (i < length) && (out < size); i++)
+        {
+            byte = payload[i];
+            if(byte == 0x00)
+            {
+                buffer[code_index] = code;
+                code_index = out++;
+                code = 1;
+            }
+            else
+            {
+                buffer[out++] = byte;
+                if(++code == 0xFF)
+                {
+                    buffer[code_index] = code;
+                    code_index = out++;
+                    code = 1;
+                }
+            }
+        }
+
+        if((i < length) || (out + 1U > size))
+        {
+            link->tx_errors++;
+            return 0;
+        }
+        buffer[code_index] = code;
+        buffer[out++] = 0x00;
+    }
+    else
+    {
+        if(size < 2)
+        {
+            link->tx_errors++;
+            return 0;
+        }
+        buffer[out++] = DMA_FRAMING_SLIP_END;
+
+        for(i = 0; (i < length) && (out + 2U <= size); i++)
+        {
+            byte = payload[i];
+            if(byte == DMA_FRAMING_SLIP_END)
+            {
+                buffer[out++] = DMA_FRAMING_SLIP_ESC;
+                buffer[out++] = DMA_FRAMING_SLIP_ESC_END;
+            }
+            else if(byte == DMA_FRAMING_SLIP_ESC)
+            {
+                buffer[out++] = DMA_FRAMING_SLIP_ESC;
+                buffer[out++] = DMA_FRAMING_SLIP_ESC_ESC;
+            }
+            else
+            {
+                buffer[out++] = byte;
+            }
+        }
+
+        if((i < length) || (out + 1U > size))
+        {
+            link->tx_errors++;
+            return 0;
+        }
+        buffer[out++] = DMA_FRAMING_SLIP_END;
+    }
+
+    link->tx_frames++;
+
+    return (uint16_t)out;
+}
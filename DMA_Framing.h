@@ -0,0 +1,96 @@
+/**
+ * @file DMA_Framing.h
+ * @author Kunal Salvi
+ * @brief Header file for the DMA framing codec.
+ *
+ * This file contains the data structures and function prototypes for COBS and
+ * SLIP framed links on top of the UART packet receiver (`DMA_UART.h`). Frames
+ * are decoded in place in the receiver's ring: since a decoded frame is never
+ * longer than its encoding, each decoded byte is written back over bytes that
+ * have already been read, and the frame is handed to the application as a
+ * view into the ring, split at the wrap if needed. Frames are encoded directly
+ * into the buffer a TX stream sends from. Neither direction copies the data
+ * through an intermediate buffer.
+ *
+ * A frame is kept in the ring until its delimiter arrives, so its encoding,
+ * delimiter excluded, may take at most half the ring; longer frames are
+ * discarded. `max_frame` bounds the decoded length further.
+ *
+ * @version 1.0
+ * @date 2024-08-22
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef DMA_FRAMING_H_
+#define DMA_FRAMING_H_
+
+#include "DMA_UART.h"
+
+#define DMA_FRAMING_COBS            0       /**< Consistent Overhead Byte Stuffing, frames end with 0x00 */
+#define DMA_FRAMING_SLIP            1       /**< SLIP (RFC 1055), frames end with 0xC0 */
+
+#define DMA_FRAMING_COBS_MAX(length)    ((length) + ((length) / 254U) + 2U) /**< Largest COBS encoding of `length` bytes */
+#define DMA_FRAMING_SLIP_MAX(length)    (2U * (length) + 2U)                 /**< Largest SLIP encoding of `length` bytes */
+
+/**
+ * @brief Framed link structure.
+ *
+ * The fields in the first group are set by the application before calling
+ * `DMA_Framing_Init`. The remaining fields are managed by the codec.
+ */
+typedef struct DMA_Framing_Link
+{
+    uint8_t protocol;                   /**< `DMA_FRAMING_COBS` or `DMA_FRAMING_SLIP` */
+    uint16_t max_frame;                 /**< Longest decoded frame accepted, 0 for no limit beyond the ring bound */
+    void (*frame)(const DMA_UART_Frame *frame, void *context); /**< Receives each decoded frame */
+    void *context;                      /**< User pointer for the callback */
+
+    DMA_UART_RX *rx;                    /**< Receiver the link decodes from */
+    uint16_t start;                     /**< Ring index of the frame being decoded */
+    uint16_t length;                    /**< Bytes decoded into the current frame */
+    uint8_t code;                       /**< COBS code of the current block */
+    uint8_t remaining;                  /**< COBS data bytes left in the current block */
+    bool escape;                        /**< SLIP escape byte seen */
+    bool discard;                       /**< The current frame is invalid and skipped up to its delimiter */
+
+    volatile uint32_t rx_frames;        /**< Frames decoded */
+    volatile uint32_t rx_errors;        /**< Frames discarded for bad encoding */
+    volatile uint32_t rx_oversize;      /**< Frames discarded for an encoding longer than half the ring or exceeding `max_frame` */
+    volatile uint32_t tx_frames;        /**< Frames encoded */
+    volatile uint32_t tx_errors;        /**< Frames that did not fit their TX buffer */
+} DMA_Framing_Link;
+
+/**
+ * @brief Attaches a link to a UART receiver.
+ *
+ * @param[in] link Pointer to the DMA_Framing_Link structure.
+ * @param[in] rx Pointer to the receiver, before it is started.
+ *
+ * @return int8_t Returns 1 on success, or -1 if the protocol is unknown.
+ */
+int8_t DMA_Framing_Init(DMA_Framing_Link *link, DMA_UART_RX *rx);
+
+/**
+ * @brief Decodes received bytes in place; installed as the receiver's callback.
+ *
+ * @param[in] frame Bytes handed over by the receiver.
+ * @param[in] context Pointer to the DMA_Framing_Link structure.
+ */
+void DMA_Framing_Receive(const DMA_UART_Frame *frame, void *context);
+
+/**
+ * @brief Encodes a frame directly into a TX buffer.
+ *
+ * @param[in] link Pointer to the DMA_Framing_Link structure.
+ * @param[in] payload Frame to encode.
+ * @param[in] length Length of the frame.
+ * @param[out] buffer TX buffer.
+ * @param[in] size Size of `buffer`.
+ *
+ * @return uint16_t Encoded length including the delimiter(s), or 0 if the frame does not fit.
+ */
+uint16_t DMA_Framing_Encode(DMA_Framing_Link *link, const uint8_t *payload, uint16_t length, uint8_t *buffer, uint16_t size);
+
+#endif /* DMA_FRAMING_H_ */
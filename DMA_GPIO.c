@@ -0,0 +1,289 @@
+/**
+ * @file DMA_GPIO.c
+ * @brief DMA Parallel GPIO Port Implementation for STM32F407VGT6
+ *
+ * This file implements timer-paced streaming of a GPIO port. The timer's
+ * update DMA request moves one sample per period between the port and memory;
+ * on each half transfer/transfer complete interrupt (ring) or transfer
+ * complete interrupt (double-buffer mode) the block the DMA has just finished
+ * is passed to the block callback, after being searched for the trigger
+ * pattern in a capture.
+ *
+ * @version 1.0
+ * @date 2024-08-22
+ *
+ * @author Kunal Salvi
+ * @copyright Copyright (c) 2024
+ */
+
+#include "DMA_GPIO.h"
+
+/**
+ * @brief Returns the address of a block.
+ */
+static void *DMA_GPIO_Block(DMA_GPIO_Port *port, uint8_t index)
+{
+    uint32_t size = (port->mode == DMA_GPIO_OUTPUT_BSRR) ? 4U : 2U;
+
+    if(port->buffers[1] != NULL)
+    {
+        return port->buffers[index];
+    }
+    return (uint8_t *)port->buffers[0] + (uint32_t)index * port->block_samples * size;
+}
+
+/**
+ * @brief Stops the timer DMA requests and the stream.
+ */
+static void DMA_GPIO_Halt(DMA_GPIO_Port *port)
+{
+    port->TIM->DIER &= ~TIM_DIER_UDE;
+    port->Request.Stream->CR &= ~DMA_SxCR_EN;
+    port->running = false;
+}
+
+/**
+ * @brief Searches a captured block for the trigger.
+ *
+ * The DMA moves back into a block right after finishing the other one, so a
+ * capture that ran past the trigger block would overwrite its samples before
+ * the trigger. The capture therefore ends with the trigger block: the samples
+ * after the trigger in it are the post-trigger samples, and any part of
+ * `post_trigger_samples` that does not fit is left in `remaining`.
+ *
+ * @return bool `true` if the block holds the trigger and the capture has ended.
+ */
+static bool DMA_GPIO_Trigger(DMA_GPIO_Port *port, const uint16_t *samples)
+{
+    uint16_t count = port->block_samples;
+    uint16_t i;
+
+    if((port->trigger_mask == 0) || port->triggered)
+    {
+        return false;
+    }
+
+    for(i = 0; i < count; i++)
+    {
+        if((samples[i] & port->trigger_mask) == port->trigger_value)
+        {
+            break;
+        }
+    }
+    if(i == count)
+    {
+        return false;
+    }
+
+    port->triggered = true;
+    port->trigger_block = samples;
+    port->trigger_index = i;
+
+    // Only the samples after the trigger sample count towards the post-trigger length
+    count = (uint16_t)(count - i - 1U);
+    port->remaining = (port->post_trigger_samples > count) ? (port->post_trigger_samples - count) : 0;
+
+    return true;
+}
+
+/**
+ * @brief Stream event callback: handles the block the DMA has just finished.
+ *
+ * A capture block is checked for the trigger and delivered; an output block
+ * is refilled. The stream position is then checked: if the DMA has already
+ * moved back into the block, it is counted as an overrun.
+ */
+static void DMA_GPIO_Callback(DMA_Stream_TypeDef *stream, uint32_t event, void *context)
+{
+    DMA_GPIO_Port *port = (DMA_GPIO_Port *)context;
+    uint8_t index;
+    uint32_t ct = 0;
+    bool overrun;
+    bool done = false;
+    void *block;
+
+    if(event == DMA_Configuration.DMA_Interrupts.Transfer_Error)
+    {
+        DMA_GPIO_Halt(port);
+        return;
+    }
+    if(!port->running)
+    {
+        return;
+    }
+
+    if(port->buffers[1] == NULL)
+    {
+        if(event == DMA_Configuration.DMA_Interrupts.Half_Transfer_Complete) index = 0;
+        else if(event == DMA_Configuration.DMA_Interrupts.Transfer_Complete) index = 1;
+        else return;
+    }
+    else
+    {
+        if(event != DMA_Configuration.DMA_Interrupts.Transfer_Complete)
+        {
+            return;
+        }
+        ct = stream->CR & DMA_SxCR_CT;
+        index = ct ? 0 : 1;
+    }
+
+    block = DMA_GPIO_Block(port, index);
+
+    if(port->mode == DMA_GPIO_CAPTURE)
+    {
+        done = DMA_GPIO_Trigger(port, (const uint16_t *)block);
+    }
+    if(port->block != NULL)
+    {
+        port->block(block, port->block_samples, port->context);
+    }
+    port->blocks++;
+
+    if(done)
+    {
+        DMA_GPIO_Halt(port);
+        return;
+    }
+
+    if(port->buffers[1] == NULL)
+    {
+        // The first half is safe while NDTR counts down the second half, and vice versa
+        overrun = (index == 0) ? (stream->NDTR > port->block_samples) : (stream->NDTR <= port->block_samples);
+    }
+    else
+    {
+        overrun = (stream->CR & DMA_SxCR_CT) != ct;
+    }
+    if(overrun)
+    {
+        port->overruns++;
+    }
+}
+
+/**
+ * @brief Starts streaming the port.
+ *
+ * This function claims the stream and configures it in circular (ring) or
+ * double-buffer mode between the buffers and the port's `IDR`, `ODR` or
+ * `BSRR`. For an output with a block callback, both blocks are filled first.
+ * It then enables the timer's update DMA request. The GPIO pin modes and the
+ * timer's period are configured by the application, which starts the counter;
+ * the sample rate is the timer's update rate.
+ *
+ * @param[in] port Pointer to the `DMA_GPIO_Port` structure.
+ *
+ * @return int8_t Returns 1 on success, or -1 if the configuration is invalid or the stream is already claimed.
+ */
+int8_t DMA_GPIO_Start(DMA_GPIO_Port *port)
+{
+    DMA_Stream_TypeDef *stream = port->Request.Stream;
+    bool ring = (port->buffers[1] == NULL);
+    bool word = (port->mode == DMA_GPIO_OUTPUT_BSRR);
+    volatile uint32_t *flag_clear;
+    uint32_t flag_mask;
+    uint32_t data_register;
+    uint32_t interrupts = DMA_Configuration.DMA_Interrupts.Transfer_Complete | DMA_Configuration.DMA_Interrupts.Transfer_Error;
+
+    if((stream == NULL) || (port->GPIO == NULL) || (port->TIM == NULL) || (port->buffers[0] == NULL))
+    {
+        return -1;
+    }
+    if((port->Request.Controller != DMA2) || (port->mode > DMA_GPIO_OUTPUT_BSRR))
+    {
+        return -1;
+    }
+    if((port->block_samples == 0) || ((ring ? 2U * port->block_samples : port->block_samples) > 0xFFFF))
+    {
+        return -1;
+    }
+    if(DMA_Stream_Claim(stream) != 1)
+    {
+        return -1;
+    }
+
+    port->triggered = false;
+    port->trigger_block = NULL;
+    port->trigger_index = 0;
+    port->remaining = 0;
+    port->blocks = 0;
+    port->overruns = 0;
+
+    if((port->mode != DMA_GPIO_CAPTURE) && (port->block != NULL))
+    {
+        port->block(DMA_GPIO_Block(port, 0), port->block_samples, port->context);
+        port->block(DMA_GPIO_Block(port, 1), port->block_samples, port->context);
+    }
+
+    stream->CR &= ~DMA_SxCR_EN;
+    while(stream->CR & DMA_SxCR_EN) {}
+
+    if(ring)
+    {
+        interrupts |= DMA_Configuration.DMA_Interrupts.Half_Transfer_Complete;
+    }
+
+    stream->CR = ((uint32_t)port->Request.channel << DMA_SxCR_CHSEL_Pos) |
+                 ((port->mode == DMA_GPIO_CAPTURE) ? DMA_Configuration.Transfer_Direction.Peripheral_to_memory
+                                                   : DMA_Configuration.Transfer_Direction.Memory_to_peripheral) |
+                 port->priority_level |
+                 (word ? DMA_Configuration.Memory_Data_Size.word : DMA_Configuration.Memory_Data_Size.half_word) |
+                 (word ? DMA_Configuration.Peripheral_Data_Size.word : DMA_Configuration.Peripheral_Data_Size.half_word) |
+                 DMA_Configuration.Memory_Pointer_Increment.Enable |
+                 DMA_Configuration.Circular_Mode.Enable |
+                 (ring ? 0 : DMA_SxCR_DBM) |
+                 interrupts;
+    stream->FCR = 0;
+
+    if(port->mode == DMA_GPIO_CAPTURE) data_register = (uint32_t)&(port->GPIO->IDR);
+    else if(port->mode == DMA_GPIO_OUTPUT) data_register = (uint32_t)&(port->GPIO->ODR);
+    else data_register = (uint32_t)&(port->GPIO->BSRR);
+
+    stream->PAR = data_register;
+    stream->M0AR = (uint32_t)port->buffers[0];
+    stream->M1AR = ring ? 0 : (uint32_t)port->buffers[1];
+    stream->NDTR = ring ? 2U * port->block_samples : port->block_samples;
+
+    flag_clear = DMA_Flag_Clear_Register(stream, &flag_mask);
+    *flag_clear = flag_mask;
+
+    port->running = true;
+    DMA_Register_Callback(stream, DMA_GPIO_Callback, port);
+    DMA_Stream_IRQ_Enable(stream);
+    stream->CR |= DMA_SxCR_EN;
+
+    port->TIM->DIER |= TIM_DIER_UDE;
+
+    return 1;
+}
+
+/**
+ * @brief Stops the port and releases the stream.
+ *
+ * The port pins keep their last level. Must also be called after a triggered
+ * capture has ended, once its data has been read.
+ *
+ * @param[in] port Pointer to the `DMA_GPIO_Port` structure.
+ */
+void DMA_GPIO_Stop(DMA_GPIO_Port *port)
+{
+    DMA_Stream_TypeDef *stream = port->Request.Stream;
+
+    DMA_GPIO_Halt(port);
+    while(stream->CR & DMA_SxCR_EN) {}
+
+    DMA_Register_Callback(stream, NULL, NULL);
+    DMA_Stream_Release(stream);
+}
+
+/**
+ * @brief Reports whether the port is still streaming.
+ *
+ * @param[in] port Pointer to the `DMA_GPIO_Port` structure.
+ *
+ * @return bool `true` until the port is stopped or a triggered capture has ended.
+ */
+bool DMA_GPIO_Busy(DMA_GPIO_Port *port)
+{
+    return port->running;
+}
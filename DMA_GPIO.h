@@ -0,0 +1,95 @@
+/**
+ * @file DMA_GPIO.h
+ * @author Kunal Salvi
+ * @brief Header file for the DMA parallel GPIO port.
+ *
+ * This file contains the data structures and function prototypes for
+ * streaming a whole GPIO port at a timer-set rate without CPU work per sample.
+ * Each update event of TIM1 or TIM8 moves one sample: the port's `IDR` into
+ * memory (logic capture), or memory into `ODR` or `BSRR` (parallel bus or
+ * pattern output). Samples are handled per block, either as the two halves of
+ * a ring buffer or as two separate buffers in double-buffer mode. A capture
+ * can stop itself at the end of the block in which a trigger pattern is
+ * found, leaving the samples before and after the trigger in that block. The
+ * DMA would move back into the trigger block after the other one, so the
+ * post-trigger length is limited to the rest of the trigger block; a larger
+ * `block_samples` keeps more samples on both sides.
+ *
+ * Only DMA2 can reach the GPIO ports, so the update request of TIM1
+ * (`TIM1_UP`) or TIM8 (`TIM8_UP`) must be used.
+ *
+ * @version 1.0
+ * @date 2024-08-22
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef DMA_GPIO_H_
+#define DMA_GPIO_H_
+
+#include "DMA.h"
+
+#define DMA_GPIO_CAPTURE            0       /**< `IDR` to memory, half-word samples */
+#define DMA_GPIO_OUTPUT             1       /**< Memory to `ODR`, half-word samples */
+#define DMA_GPIO_OUTPUT_BSRR        2       /**< Memory to `BSRR`, word samples (set bits 15:0, reset bits 31:16) */
+
+/**
+ * @brief Parallel GPIO port structure.
+ *
+ * The fields in the first group are set by the application before calling
+ * `DMA_GPIO_Start`. With `buffers[1]` set to NULL, `buffers[0]` is a ring of
+ * `2 * block_samples` samples whose halves are handled in turn; otherwise the
+ * stream runs in double-buffer mode over the two buffers. The trigger fields
+ * apply to captures only. The remaining fields are managed by the engine.
+ */
+typedef struct DMA_GPIO_Port
+{
+    GPIO_TypeDef *GPIO;                 /**< GPIO port, configured by the application */
+    TIM_TypeDef *TIM;                   /**< Timer whose update events pace the samples (TIM1 or TIM8) */
+    DMA_Request Request;                /**< Update request of the timer (`DMA_Configuration.Request.TIM1_UP` or `TIM8_UP`) */
+    uint8_t mode;                       /**< `DMA_GPIO_CAPTURE`, `DMA_GPIO_OUTPUT` or `DMA_GPIO_OUTPUT_BSRR` */
+    uint32_t priority_level;            /**< Priority level of the stream */
+    void *buffers[2];                   /**< Sample buffers, `buffers[1]` NULL for a ring in `buffers[0]` */
+    uint16_t block_samples;             /**< Samples per block */
+    void (*block)(void *block, uint16_t samples, void *context); /**< Capture: receives a filled block; output: refills a played block (NULL to repeat the pattern) */
+    void *context;                      /**< User pointer for the callback */
+    uint16_t trigger_mask;              /**< Port pins compared for the trigger, 0 for a free-running capture */
+    uint16_t trigger_value;             /**< Level of the masked pins that triggers */
+    uint32_t post_trigger_samples;      /**< Samples wanted after the trigger, at most the rest of the trigger block */
+
+    volatile bool running;              /**< `true` until the port is stopped or a triggered capture ends */
+    volatile bool triggered;            /**< The trigger pattern has been found */
+    const void *trigger_block;          /**< Block holding the trigger sample */
+    uint16_t trigger_index;             /**< Trigger sample within `trigger_block` */
+    uint32_t remaining;                 /**< Post-trigger samples that did not fit in the trigger block */
+    volatile uint32_t blocks;           /**< Number of blocks handled */
+    volatile uint32_t overruns;         /**< Blocks the DMA re-entered before the callback returned */
+} DMA_GPIO_Port;
+
+/**
+ * @brief Starts streaming the port.
+ *
+ * @param[in] port Pointer to the DMA_GPIO_Port structure.
+ *
+ * @return int8_t Returns 1 on success, or -1 if the configuration is invalid or the stream is already claimed.
+ */
+int8_t DMA_GPIO_Start(DMA_GPIO_Port *port);
+
+/**
+ * @brief Stops the port and releases the stream.
+ *
+ * @param[in] port Pointer to the DMA_GPIO_Port structure.
+ */
+void DMA_GPIO_Stop(DMA_GPIO_Port *port);
+
+/**
+ * @brief Reports whether the port is still streaming.
+ *
+ * @param[in] port Pointer to the DMA_GPIO_Port structure.
+ *
+ * @return bool `true` until the port is stopped or a triggered capture has ended.
+ */
+bool DMA_GPIO_Busy(DMA_GPIO_Port *port);
+
+#endif /* DMA_GPIO_H_ */
@@ -0,0 +1,303 @@
+/**
+ * @file DMA_Graph.c
+ * @brief DMA Transfer Dependency Graph Implementation for STM32F407VGT6
+ *
+ * This file implements the transfer dependency graph. Each node's stream is
+ * claimed and gets the graph's callback, so the stream's handler in DMA.c
+ * reports the node's completion. The callback decrements the pending count
+ * of every successor and arms those that reach zero with `DMA_Set_Target`
+ * and `DMA_Set_Trigger`. Predecessors can finish in interrupts of different
+ * priorities, so the shared counts are updated with exclusive accesses.
+ *
+ * A run ends when no node is armed any more. The arming node counts its
+ * successors as active before it counts itself out, so the count only
+ * reaches zero after the last transfer. After a transfer error no further
+ * nodes are armed; the transfers already running finish first.
+ *
+ * @version 1.0
+ * @date 2024-08-22
+ *
+ * @author Kunal Salvi
+ * @copyright Copyright (c) 2024
+ */
+
+#include "DMA_Graph.h"
+
+/**
+ * @brief Adds to a counter shared between interrupts and returns the new value.
+ */
+static uint32_t DMA_Graph_Count(volatile uint32_t *counter, int32_t value)
+{
+    uint32_t current;
+
+    do
+    {
+        current = __LDREXW(counter) + (uint32_t)value;
+    } while(__STREXW(current, counter) != 0);
+
+    return current;
+}
+
+/**
+ * @brief Starts the transfer of a node.
+ */
+static void DMA_Graph_Arm(DMA_Graph_Node *node)
+{
+    if(node->prepare != NULL)
+    {
+        node->prepare(node);
+    }
+
+    node->state = DMA_GRAPH_ARMED;
+
+    DMA_Set_Target(node->config);
+    node->config->Request.Stream->CR |= DMA_Configuration.DMA_Interrupts.Transfer_Complete |
+                                        DMA_Configuration.DMA_Interrupts.Transfer_Error;
+    DMA_Set_Trigger(node->config);
+}
+
+/**
+ * @brief Stream event callback: finishes a node and arms its ready successors.
+ */
+static void DMA_Graph_Callback(DMA_Stream_TypeDef *stream, uint32_t event, void *context)
+{
+    DMA_Graph_Node *node = (DMA_Graph_Node *)context;
+    DMA_Graph *graph = node->graph;
+    DMA_Graph_Node *successor;
+    uint8_t i;
+
+    if(node->state != DMA_GRAPH_ARMED)
+    {
+        return;
+    }
+
+    if(event == DMA_Configuration.DMA_Interrupts.Transfer_Complete)
+    {
+        node->state = DMA_GRAPH_DONE;
+        if(node->complete != NULL)
+        {
+            node->complete(node);
+        }
+
+        for(i = 0; i < node->successor_count; i++)
+        {
+            successor = node->successors[i];
+            if((DMA_Graph_Count(&successor->pending, -1) == 0) && (graph->status == 0))
+            {
+                DMA_Graph_Count(&graph->active, 1);
+                DMA_Graph_Arm(successor);
+            }
+        }
+    }
+    else if(event == DMA_Configuration.DMA_Interrupts.Transfer_Error)
+    {
+        stream->CR &= ~DMA_SxCR_EN;
+        node->state = DMA_GRAPH_FAILED;
+        graph->status = -1;
+    }
+    else
+    {
+        return;
+    }
+
+    if(DMA_Graph_Count(&graph->active, -1) == 0)
+    {
+        if(graph->status == 0)
+        {
+            graph->status = 1;
+            graph->runs++;
+        }
+        else
+        {
+            graph->errors++;
+        }
+
+        if(graph->complete != NULL)
+        {
+            graph->complete(graph);
+        }
+    }
+}
+
+/**
+ * @brief Adds an edge: `successor` is armed once `node` has completed.
+ *
+ * Edges are added before `DMA_Graph_Init`. A node with several predecessors
+ * is armed when the last of them completes.
+ *
+ * @param[in] node Predecessor node.
+ * @param[in] successor Successor node.
+ *
+ * @return int8_t Returns 1 on success, or -1 if `node` already has `DMA_GRAPH_MAX_SUCCESSORS` edges.
+ */
+int8_t DMA_Graph_Link(DMA_Graph_Node *node, DMA_Graph_Node *successor)
+{
+    if((node->successor_count >= DMA_GRAPH_MAX_SUCCESSORS) || (successor->predecessors == 0xFF))
+    {
+        return -1;
+    }
+
+    node->successors[node->successor_count++] = successor;
+    successor->predecessors++;
+
+    return 1;
+}
+
+/**
+ * @brief Checks the graph and takes the streams of its nodes.
+ *
+ * Nodes that were never linked must have `successor_count` and
+ * `predecessors` zeroed. The graph is walked in dependency order to reject
+ * cycles, which would never run. Each node's stream is then claimed, gets
+ * the graph's callback and has its interrupt enabled.
+ *
+ * @param[in] graph Pointer to the `DMA_Graph` structure.
+ *
+ * @return int8_t Returns 1 on success, or -1 if the graph has a cycle or a stream is already claimed.
+ */
+int8_t DMA_Graph_Init(DMA_Graph *graph)
+{
+    DMA_Graph_Node *node;
+    uint8_t visited = 0;
+    bool progress = true;
+    uint8_t i;
+    uint8_t j;
+
+    if((graph->nodes == NULL) || (graph->node_count == 0))
+    {
+        return -1;
+    }
+
+    // Remove nodes whose predecessors are all removed until none is left
+    for(i = 0; i < graph->node_count; i++)
+    {
+        graph->nodes[i]->graph = graph;
+        graph->nodes[i]->pending = graph->nodes[i]->predecessors;
+        graph->nodes[i]->state = DMA_GRAPH_IDLE;
+    }
+    while(progress)
+    {
+        progress = false;
+        for(i = 0; i < graph->node_count; i++)
+        {
+            node = graph->nodes[i];
+            if((node->state == DMA_GRAPH_IDLE) && (node->pending == 0))
+            {
+                node->state = DMA_GRAPH_DONE;
+                for(j = 0; j < node->successor_count; j++)
+                {
+                    node->successors[j]->pending--;
+                }
+                visited++;
+                progress = true;
+            }
+        }
+    }
+    if(visited != graph->node_count)
+    {
+        return -1;
+    }
+
+    for(i = 0; i < graph->node_count; i++)
+    {
+        if(DMA_Stream_Claim(graph->nodes[i]->config->Request.Stream) != 1)
+        {
+            while(i-- > 0)
+            {
+                DMA_Stream_Release(graph->nodes[i]->config->Request.Stream);
+            }
+            return -1;
+        }
+    }
+
+    for(i = 0; i < graph->node_count; i++)
+    {
+        node = graph->nodes[i];
+        node->state = DMA_GRAPH_IDLE;
+        DMA_Register_Callback(node->config->Request.Stream, DMA_Graph_Callback, node);
+        DMA_Stream_IRQ_Enable(node->config->Request.Stream);
+    }
+
+    graph->active = 0;
+    graph->status = 1;
+    graph->runs = 0;
+    graph->errors = 0;
+
+    return 1;
+}
+
+/**
+ * @brief Releases the streams of an idle graph.
+ *
+ * @param[in] graph Pointer to the `DMA_Graph` structure.
+ */
+void DMA_Graph_Deinit(DMA_Graph *graph)
+{
+    uint8_t i;
+
+    for(i = 0; i < graph->node_count; i++)
+    {
+        DMA_Register_Callback(graph->nodes[i]->config->Request.Stream, NULL, NULL);
+        DMA_Stream_Release(graph->nodes[i]->config->Request.Stream);
+    }
+}
+
+/**
+ * @brief Starts a run of the graph by arming the nodes without predecessors.
+ *
+ * The rest of the run proceeds from the stream interrupts. Completion is
+ * signalled through `graph->complete` and `graph->status`.
+ *
+ * @param[in] graph Pointer to the `DMA_Graph` structure.
+ *
+ * @return int8_t Returns 1 if the run was started, or -1 if a run is in progress.
+ */
+int8_t DMA_Graph_Start(DMA_Graph *graph)
+{
+    DMA_Graph_Node *node;
+    uint32_t roots = 0;
+    uint8_t i;
+
+    if(graph->active != 0)
+    {
+        return -1;
+    }
+
+    for(i = 0; i < graph->node_count; i++)
+    {
+        node = graph->nodes[i];
+        node->pending = node->predecessors;
+        node->state = DMA_GRAPH_IDLE;
+        if(node->predecessors == 0)
+        {
+            roots++;
+        }
+    }
+
+    // All roots count as active before any of them can complete
+    graph->status = 0;
+    graph->active = roots;
+
+    for(i = 0; i < graph->node_count; i++)
+    {
+        node = graph->nodes[i];
+        if(node->predecessors == 0)
+        {
+            DMA_Graph_Arm(node);
+        }
+    }
+
+    return 1;
+}
+
+/**
+ * @brief Reports whether a run is in progress.
+ *
+ * @param[in] graph Pointer to the `DMA_Graph` structure.
+ *
+ * @return bool `true` while transfers of the run are active.
+ */
+bool DMA_Graph_Busy(DMA_Graph *graph)
+{
+    return graph->active != 0;
+}
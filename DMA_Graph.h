@@ -0,0 +1,124 @@
+/**
+ * @file DMA_Graph.h
+ * @author Kunal Salvi
+ * @brief Header file for the DMA transfer dependency graph.
+ *
+ * This file contains the data structures and function prototypes for running
+ * DMA transfers on different streams in dependency order. The F4 DMA cannot
+ * start one stream from another's completion, so the graph does it in
+ * software: every node is a transfer, every edge says that a node waits for
+ * another one, and a node whose predecessors have all completed is armed
+ * straight from the transfer complete interrupt of the last of them. A
+ * pipeline such as "ADC block → memory-to-memory copy → UART TX" then runs
+ * without the main loop between the stages.
+ *
+ * @version 1.0
+ * @date 2024-08-22
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef DMA_GRAPH_H_
+#define DMA_GRAPH_H_
+
+#include "DMA.h"
+
+#define DMA_GRAPH_MAX_SUCCESSORS    4   /**< Maximum number of edges leaving a node */
+
+#define DMA_GRAPH_IDLE              0   /**< Node waits for its predecessors */
+#define DMA_GRAPH_ARMED             1   /**< Node's transfer is running */
+#define DMA_GRAPH_DONE              2   /**< Node's transfer completed */
+#define DMA_GRAPH_FAILED            3   /**< Node's transfer ended with a transfer error */
+
+typedef struct DMA_Graph DMA_Graph;
+typedef struct DMA_Graph_Node DMA_Graph_Node;
+
+/**
+ * @brief Graph node: one transfer.
+ *
+ * `config`, `prepare`, `complete` and `context` are set by the application;
+ * the remaining fields are managed by the graph. `config` describes a normal
+ * (not circular) transfer and has been initialized with `DMA_Init`, with the
+ * peripheral's DMA requests enabled by the application.
+ */
+struct DMA_Graph_Node
+{
+    DMA_Config *config;                 /**< Transfer of the node; its stream is used by no other node */
+    void (*prepare)(DMA_Graph_Node *node); /**< Called before the node is armed, e.g. to update `config`'s addresses (optional) */
+    void (*complete)(DMA_Graph_Node *node); /**< Called when the node's transfer completed (optional) */
+    void *context;                      /**< User pointer */
+
+    DMA_Graph *graph;                   /**< Graph of the node */
+    DMA_Graph_Node *successors[DMA_GRAPH_MAX_SUCCESSORS]; /**< Nodes waiting for this one */
+    uint8_t successor_count;            /**< Number of successors */
+    uint8_t predecessors;               /**< Number of nodes this one waits for */
+    volatile uint32_t pending;          /**< Predecessors still to complete in the current run */
+    volatile uint8_t state;             /**< One of the `DMA_GRAPH_` node states */
+};
+
+/**
+ * @brief Dependency graph structure.
+ *
+ * `nodes`, `node_count`, `complete` and `context` are set by the application
+ * before calling `DMA_Graph_Init`. The remaining fields are managed by the
+ * graph.
+ */
+struct DMA_Graph
+{
+    DMA_Graph_Node **nodes;             /**< Nodes of the graph */
+    uint8_t node_count;                 /**< Number of nodes */
+    void (*complete)(DMA_Graph *graph); /**< Called from the interrupt of the last transfer of a run (optional) */
+    void *context;                      /**< User pointer */
+
+    volatile uint32_t active;           /**< Nodes armed and not finished */
+    volatile int8_t status;             /**< 0 while running, 1 when every node completed, -1 after a transfer error */
+    volatile uint32_t runs;             /**< Completed runs */
+    volatile uint32_t errors;           /**< Runs ended by a transfer error */
+};
+
+/**
+ * @brief Adds an edge: `successor` is armed once `node` has completed.
+ *
+ * @param[in] node Predecessor node.
+ * @param[in] successor Successor node.
+ *
+ * @return int8_t Returns 1 on success, or -1 if `node` already has `DMA_GRAPH_MAX_SUCCESSORS` edges.
+ */
+int8_t DMA_Graph_Link(DMA_Graph_Node *node, DMA_Graph_Node *successor);
+
+/**
+ * @brief Checks the graph and takes the streams of its nodes.
+ *
+ * @param[in] graph Pointer to the DMA_Graph structure.
+ *
+ * @return int8_t Returns 1 on success, or -1 if the graph has a cycle or a stream is already claimed.
+ */
+int8_t DMA_Graph_Init(DMA_Graph *graph);
+
+/**
+ * @brief Releases the streams of an idle graph.
+ *
+ * @param[in] graph Pointer to the DMA_Graph structure.
+ */
+void DMA_Graph_Deinit(DMA_Graph *graph);
+
+/**
+ * @brief Starts a run of the graph by arming the nodes without predecessors.
+ *
+ * @param[in] graph Pointer to the DMA_Graph structure.
+ *
+ * @return int8_t Returns 1 if the run was started, or -1 if a run is in progress.
+ */
+int8_t DMA_Graph_Start(DMA_Graph *graph);
+
+/**
+ * @brief Reports whether a run is in progress.
+ *
+ * @param[in] graph Pointer to the DMA_Graph structure.
+ *
+ * @return bool `true` while transfers of the run are active.
+ */
+bool DMA_Graph_Busy(DMA_Graph *graph);
+
+#endif /* DMA_GRAPH_H_ */
@@ -0,0 +1,151 @@
+/**
+ * @file DMA_Group.c
+ * @brief DMA Synchronized Stream Start Implementation for STM32F407VGT6
+ *
+ * This file implements the group start. Everything that varies per stream is
+ * done while arming: the targets are written, the enabled control words are
+ * precomputed and the flag masks are merged per flag clear register. The
+ * start itself then consists of at most four flag clear writes followed by
+ * one plain store per stream, with no read-modify-write and no branches in
+ * between, inside a section with interrupts masked.
+ *
+ * @version 1.0
+ * @date 2024-08-22
+ *
+ * @author Kunal Salvi
+ * @copyright Copyright (c) 2024
+ */
+
+#include "DMA_Group.h"
+
+/**
+ * @brief Programs the streams of a group for a synchronized start.
+ *
+ * Writes each transfer's target with `DMA_Set_Target` and records the stream
+ * control word with EN set. The streams must be disabled; a group is armed
+ * again before every start, as a start consumes the programmed lengths. The
+ * DWT cycle counter is enabled for the skew measurement.
+ *
+ * @param[in] group Pointer to the `DMA_Group` structure.
+ *
+ * @return int8_t Returns 1 on success, or -1 if the group is invalid or a stream is enabled or repeated.
+ */
+int8_t DMA_Group_Arm(DMA_Group *group)
+{
+    DMA_Stream_TypeDef *stream;
+    volatile uint32_t *flag_clear;
+    uint32_t flag_mask;
+    uint32_t start;
+    uint8_t i;
+    uint8_t j;
+
+    group->armed = false;
+
+    if((group->configs == NULL) || (group->stream_count == 0) || (group->stream_count > DMA_GROUP_MAX_STREAMS))
+    {
+        return -1;
+    }
+
+    group->flag_registers = 0;
+
+    for(i = 0; i < group->stream_count; i++)
+    {
+        stream = group->configs[i]->Request.Stream;
+        flag_clear = DMA_Flag_Clear_Register(stream, &flag_mask);
+        if((flag_clear == NULL) || (stream->CR & DMA_SxCR_EN))
+        {
+            return -1;
+        }
+        for(j = 0; j < i; j++)
+        {
+            if(group->streams[j] == stream)
+            {
+                return -1;
+            }
+        }
+
+        DMA_Set_Target(group->configs[i]);
+
+        group->streams[i] = stream;
+        group->enable[i] = stream->CR | DMA_SxCR_EN;
+
+        for(j = 0; (j < group->flag_registers) && (group->flag_clear[j] != flag_clear); j++) {}
+        if(j == group->flag_registers)
+        {
+            group->flag_clear[j] = flag_clear;
+            group->flag_mask[j] = 0;
+            group->flag_registers++;
+        }
+        group->flag_mask[j] |= flag_mask;
+    }
+
+    DMA_Timestamp_Enable();
+    start = DMA_Timestamp();
+    group->overhead = DMA_Timestamp() - start;
+
+    group->armed = true;
+
+    return 1;
+}
+
+/**
+ * @brief Starts the streams of an armed group together.
+ *
+ * The streams are enabled in the order of `configs`. The skew is the number
+ * of cycles from just before the first enable to just after the last one,
+ * less the cost of reading the cycle counter, and so bounds the spread of
+ * the enables.
+ *
+ * @param[in] group Pointer to the `DMA_Group` structure.
+ *
+ * @return int8_t Returns 1 if the streams were started, or -1 if the group is not armed.
+ */
+int8_t DMA_Group_Start(DMA_Group *group)
+{
+    DMA_Stream_TypeDef *const *streams = group->streams;
+    const uint32_t *enable = group->enable;
+    uint8_t count = group->stream_count;
+    uint32_t primask;
+    uint32_t start;
+    uint32_t end;
+    uint8_t i;
+
+    if(!group->armed)
+    {
+        return -1;
+    }
+    group->armed = false;
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+
+    for(i = 0; i < group->flag_registers; i++)
+    {
+        *group->flag_clear[i] = group->flag_mask[i];
+    }
+
+    start = DMA_Timestamp();
+    for(i = 0; i < count; i++)
+    {
+        streams[i]->CR = enable[i];
+    }
+    end = DMA_Timestamp();
+
+    __set_PRIMASK(primask);
+
+    group->skew = ((end - start) > group->overhead) ? (end - start - group->overhead) : 0;
+
+    return 1;
+}
+
+/**
+ * @brief Returns the skew of the last start.
+ *
+ * @param[in] group Pointer to the `DMA_Group` structure.
+ *
+ * @return uint32_t CPU cycles between the first and the last stream enable.
+ */
+uint32_t DMA_Group_Skew(DMA_Group *group)
+{
+    return group->skew;
+}
@@ -0,0 +1,81 @@
+/**
+ * @file DMA_Group.h
+ * @author Kunal Salvi
+ * @brief Header file for synchronized multi-stream start.
+ *
+ * This file contains the data structure and function prototypes for starting
+ * several DMA streams, on DMA1 and DMA2, as close together as possible.
+ * `DMA_Group_Arm` programs every stream and precomputes its enabled control
+ * word and the flags to clear. `DMA_Group_Start` then clears the flags with
+ * one write per flag clear register and enables the streams with
+ * back-to-back register writes while interrupts are masked, and reports the
+ * measured skew between the first and the last enable.
+ *
+ * The streams start moving data on their peripherals' requests. For
+ * sample-aligned stimulus and response, e.g. DAC playback and ADC capture,
+ * start the group first and then the timer that triggers both peripherals.
+ *
+ * @version 1.0
+ * @date 2024-08-22
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef DMA_GROUP_H_
+#define DMA_GROUP_H_
+
+#include "DMA.h"
+
+#define DMA_GROUP_MAX_STREAMS   16  /**< Maximum number of streams in a group */
+
+/**
+ * @brief Stream group structure.
+ *
+ * `configs` and `stream_count` are set by the application; every
+ * configuration has been initialized with `DMA_Init`. The remaining fields
+ * are managed by the group.
+ */
+typedef struct DMA_Group
+{
+    DMA_Config **configs;               /**< Transfers of the group, one per stream */
+    uint8_t stream_count;               /**< Number of transfers */
+
+    DMA_Stream_TypeDef *streams[DMA_GROUP_MAX_STREAMS]; /**< Streams in start order */
+    uint32_t enable[DMA_GROUP_MAX_STREAMS]; /**< Control register of each stream with EN set */
+    volatile uint32_t *flag_clear[4];   /**< Flag clear registers involved (LIFCR/HIFCR of DMA1/DMA2) */
+    uint32_t flag_mask[4];              /**< Flags to clear in each register */
+    uint8_t flag_registers;             /**< Number of flag clear registers involved */
+    bool armed;                         /**< The group is armed and not started yet */
+    uint32_t overhead;                  /**< Cycles of the timestamp reads, subtracted from the skew */
+    uint32_t skew;                      /**< Cycles between the first and the last enable of the last start */
+} DMA_Group;
+
+/**
+ * @brief Programs the streams of a group for a synchronized start.
+ *
+ * @param[in] group Pointer to the DMA_Group structure.
+ *
+ * @return int8_t Returns 1 on success, or -1 if the group is invalid or a stream is enabled or repeated.
+ */
+int8_t DMA_Group_Arm(DMA_Group *group);
+
+/**
+ * @brief Starts the streams of an armed group together.
+ *
+ * @param[in] group Pointer to the DMA_Group structure.
+ *
+ * @return int8_t Returns 1 if the streams were started, or -1 if the group is not armed.
+ */
+int8_t DMA_Group_Start(DMA_Group *group);
+
+/**
+ * @brief Returns the skew of the last start.
+ *
+ * @param[in] group Pointer to the DMA_Group structure.
+ *
+ * @return uint32_t CPU cycles between the first and the last stream enable.
+ */
+uint32_t DMA_Group_Skew(DMA_Group *group);
+
+#endif /* DMA_GROUP_H_ */
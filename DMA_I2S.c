@@ -0,0 +1,339 @@
+/**
+ * @file DMA_I2S.c
+ * @brief DMA I2S Audio Streaming Engine Implementation for STM32F407VGT6
+ *
+ * This file implements double-buffered I2S audio streaming. Each direction
+ * runs on one stream in double-buffer mode (M0AR/M1AR), so the hardware
+ * switches between the two period buffers on its own and no register is
+ * rewritten per period. The period callback runs from the transfer complete
+ * interrupt of the capture stream (or of the playback stream when there is no
+ * capture) and works on the buffers the hardware is not currently using, as
+ * selected by the streams' current-target (CT) bits.
+ *
+ * @version 1.0
+ * @date 2024-08-22
+ *
+ * @author Kunal Salvi
+ * @copyright Copyright (c) 2024
+ */
+
+#include "DMA_I2S.h"
+#include <string.h>
+
+/**
+ * @brief Configures one direction of the audio stream in double-buffer mode.
+ *
+ * @param[in] request The DMA request of the direction.
+ * @param[in] direction `DMA_Configuration.Transfer_Direction` value.
+ * @param[in] spi The SPI/I2S block whose data register is transferred.
+ * @param[in] buffers The two period buffers.
+ * @param[in] length Number of 16-bit samples per period.
+ * @param[in] priority_level `DMA_Configuration.Priority_Level` value.
+ * @param[in] interrupts Interrupt enable bits for the stream.
+ */
+static void DMA_I2S_Configure(DMA_Request *request, uint32_t direction, SPI_TypeDef *spi,
+                              int16_t *buffers[2], uint16_t length, uint32_t priority_level, uint32_t interrupts)
+{
+    DMA_Stream_TypeDef *stream = request->Stream;
+    volatile uint32_t *flag_clear;
+    uint32_t flag_mask;
+
+    stream->CR &= ~DMA_SxCR_EN;
+    while(stream->CR & DMA_SxCR_EN) {}
+
+    stream->CR = ((uint32_t)request->channel << DMA_SxCR_CHSEL_Pos) |
+                 direction |
+                 priority_level |
+                 DMA_Configuration.Memory_Data_Size.half_word |
+                 DMA_Configuration.Peripheral_Data_Size.half_word |
+                 DMA_Configuration.Memory_Pointer_Increment.Enable |
+                 DMA_Configuration.Circular_Mode.Enable |
+                 DMA_SxCR_DBM |
+                 interrupts;
+    stream->FCR = 0;
+
+    stream->PAR = (uint32_t)&(spi->DR);
+    stream->M0AR = (uint32_t)buffers[0];
+    stream->M1AR = (uint32_t)buffers[1];
+    stream->NDTR = length;
+
+    flag_clear = DMA_Flag_Clear_Register(stream, &flag_mask);
+    *flag_clear = flag_mask;
+}
+
+/**
+ * @brief Returns the period buffer the hardware is not using.
+ */
+static int16_t *DMA_I2S_Idle_Buffer(int16_t *buffers[2], uint32_t ct)
+{
+    return buffers[ct ? 0 : 1];
+}
+
+/**
+ * @brief Stops both directions: the I2S blocks, their DMA requests and the streams.
+ *
+ * Waits for each stream's EN bit to read 0, so the streams are idle once this
+ * returns. The streams stay claimed.
+ */
+static void DMA_I2S_Halt(DMA_I2S_Stream *audio)
+{
+    DMA_Stream_TypeDef *tx = audio->TX_Request.Stream;
+    DMA_Stream_TypeDef *rx = audio->RX_Request.Stream;
+
+    if(tx != NULL)
+    {
+        audio->TX_SPI->I2SCFGR &= ~SPI_I2SCFGR_I2SE;
+        audio->TX_SPI->CR2 &= ~SPI_CR2_TXDMAEN;
+        tx->CR &= ~DMA_SxCR_EN;
+        while(tx->CR & DMA_SxCR_EN) {}
+    }
+    if(rx != NULL)
+    {
+        audio->RX_SPI->I2SCFGR &= ~SPI_I2SCFGR_I2SE;
+        audio->RX_SPI->CR2 &= ~SPI_CR2_RXDMAEN;
+        rx->CR &= ~DMA_SxCR_EN;
+        while(rx->CR & DMA_SxCR_EN) {}
+    }
+}
+
+/**
+ * @brief Period interrupt: runs the callback on the idle buffers and checks its deadline.
+ *
+ * Periods are missed in two ways. If a stream's current target changes while
+ * the callback runs, the hardware has moved on to the buffer the callback was
+ * working on. If the interrupt itself is serviced late, whole periods can pass
+ * before the callback starts, and their transfer complete events merge into
+ * one. With `period_cycles` set, the boundary that raised the interrupt is
+ * located from the driving stream's NDTR (how far it is into the new period)
+ * and the periods since the last serviced boundary are counted, so late
+ * service is always seen. Without it, only the CT bit is known, which toggles
+ * once per period: an odd number of missed periods is counted as one. Each
+ * missed period is an underrun for playback (stale samples are played) and
+ * an overrun for capture (samples are overwritten before they are read).
+ *
+ * The slack is measured from the period boundary, so it includes the
+ * interrupt latency: it is the time left before the next boundary when the
+ * callback returns.
+ *
+ * A transfer error on either stream has already cleared that stream's EN bit,
+ * which would leave the other direction running out of step. Both directions
+ * are stopped, the error is counted and reported through `error`.
+ */
+static void DMA_I2S_Callback(DMA_Stream_TypeDef *stream, uint32_t event, void *context)
+{
+    DMA_I2S_Stream *audio = (DMA_I2S_Stream *)context;
+    DMA_Stream_TypeDef *tx = audio->TX_Request.Stream;
+    DMA_Stream_TypeDef *rx = audio->RX_Request.Stream;
+    uint32_t length = (uint32_t)audio->period_frames * audio->channels;
+    uint32_t tx_ct = 0;
+    uint32_t rx_ct = 0;
+    uint32_t driver_ct;
+    uint32_t position;
+    uint32_t boundary = 0;
+    uint32_t missed = 0;
+    const int16_t *input = NULL;
+    int16_t *output = NULL;
+    int32_t slack;
+
+    if(event == DMA_Configuration.DMA_Interrupts.Transfer_Error)
+    {
+        DMA_I2S_Halt(audio);
+        audio->errors++;
+        if(audio->error != NULL)
+        {
+            audio->error(audio->context);
+        }
+        return;
+    }
+    if(event != DMA_Configuration.DMA_Interrupts.Transfer_Complete)
+    {
+        return;
+    }
+
+    // Position of the driving stream in its current period, read together with the time
+    position = length - stream->NDTR;
+    driver_ct = stream->CR & DMA_SxCR_CT;
+
+    if(audio->period_cycles != 0)
+    {
+        boundary = DMA_Timestamp() - (uint32_t)(((uint64_t)position * audio->period_cycles) / length);
+        if(audio->periods != 0)
+        {
+            // Whole periods since the last serviced boundary, rounded against jitter; all but one were missed
+            missed = (boundary - audio->last_boundary + (audio->period_cycles / 2U)) / audio->period_cycles;
+            missed = (missed > 1U) ? (missed - 1U) : 0;
+        }
+        audio->last_boundary = boundary;
+    }
+    else if((audio->periods != 0) && (driver_ct == audio->last_ct))
+    {
+        missed = 1;
+    }
+    audio->last_ct = driver_ct;
+
+    if(rx != NULL)
+    {
+        rx_ct = rx->CR & DMA_SxCR_CT;
+        input = DMA_I2S_Idle_Buffer(audio->rx_buffers, rx_ct);
+    }
+    if(tx != NULL)
+    {
+        tx_ct = tx->CR & DMA_SxCR_CT;
+        output = DMA_I2S_Idle_Buffer(audio->tx_buffers, tx_ct);
+    }
+
+    if(audio->process != NULL)
+    {
+        audio->process(input, output, audio->period_frames, audio->context);
+    }
+
+    if(tx != NULL) audio->underruns += missed + (((tx->CR & DMA_SxCR_CT) != tx_ct) ? 1U : 0U);
+    if(rx != NULL) audio->overruns += missed + (((rx->CR & DMA_SxCR_CT) != rx_ct) ? 1U : 0U);
+
+    if(audio->period_cycles != 0)
+    {
+        slack = (int32_t)(audio->period_cycles - (DMA_Timestamp() - boundary));
+        audio->last_slack = slack;
+        if(slack < audio->min_slack)
+        {
+            audio->min_slack = slack;
+        }
+    }
+
+    audio->periods++;
+}
+
+/**
+ * @brief Starts an I2S audio stream.
+ *
+ * This function claims the configured streams, sets them up in double-buffer
+ * mode with one period per buffer, clears the playback buffers to silence and
+ * enables the DMA requests and the I2S blocks. In full-duplex mode the I2Sxext
+ * block is enabled before the main block, as required for both to start on the
+ * same frame. The I2S blocks themselves (mode, standard, clock) are configured
+ * by the application beforehand.
+ *
+ * With `period_frames` frames per period, the period callback must return
+ * within one period; `period_cycles` (CPU cycles per period, i.e.
+ * `SystemCoreClock * period_frames / sample_rate`) enables slack measurement
+ * and the counting of periods missed through late interrupt service, which
+ * use `DMA_Timestamp`.
+ *
+ * @param[in] audio Pointer to the `DMA_I2S_Stream` structure.
+ *
+ * @return int8_t Returns 1 on success, or -1 if the configuration is invalid or a stream is already claimed.
+ */
+int8_t DMA_I2S_Start(DMA_I2S_Stream *audio)
+{
+    DMA_Stream_TypeDef *tx = audio->TX_Request.Stream;
+    DMA_Stream_TypeDef *rx = audio->RX_Request.Stream;
+    DMA_Stream_TypeDef *driver = (rx != NULL) ? rx : tx;
+    uint32_t length = (uint32_t)audio->period_frames * audio->channels;
+    uint32_t interrupts = DMA_Configuration.DMA_Interrupts.Transfer_Complete | DMA_Configuration.DMA_Interrupts.Transfer_Error;
+    bool tx_is_extension;
+
+    if((driver == NULL) || (length == 0) || (length > 0xFFFF))
+    {
+        return -1;
+    }
+    if((tx != NULL) && ((audio->TX_SPI == NULL) || (audio->tx_buffers[0] == NULL) || (audio->tx_buffers[1] == NULL)))
+    {
+        return -1;
+    }
+    if((rx != NULL) && ((audio->RX_SPI == NULL) || (audio->rx_buffers[0] == NULL) || (audio->rx_buffers[1] == NULL)))
+    {
+        return -1;
+    }
+
+    if((tx != NULL) && (DMA_Stream_Claim(tx) != 1))
+    {
+        return -1;
+    }
+    if((rx != NULL) && (DMA_Stream_Claim(rx) != 1))
+    {
+        if(tx != NULL) DMA_Stream_Release(tx);
+        return -1;
+    }
+
+    audio->periods = 0;
+    audio->underruns = 0;
+    audio->overruns = 0;
+    audio->last_slack = 0;
+    audio->min_slack = INT32_MAX;
+    audio->last_boundary = 0;
+    audio->last_ct = 0;
+    audio->errors = 0;
+
+    if(audio->period_cycles != 0)
+    {
+        DMA_Timestamp_Enable();
+    }
+
+    if(tx != NULL)
+    {
+        memset(audio->tx_buffers[0], 0, length * sizeof(int16_t));
+        memset(audio->tx_buffers[1], 0, length * sizeof(int16_t));
+        DMA_I2S_Configure(&audio->TX_Request, DMA_Configuration.Transfer_Direction.Memory_to_peripheral, audio->TX_SPI,
+                          audio->tx_buffers, (uint16_t)length, audio->priority_level,
+                          (driver == tx) ? interrupts : DMA_Configuration.DMA_Interrupts.Transfer_Error);
+    }
+    if(rx != NULL)
+    {
+        DMA_I2S_Configure(&audio->RX_Request, DMA_Configuration.Transfer_Direction.Peripheral_to_memory, audio->RX_SPI,
+                          audio->rx_buffers, (uint16_t)length, audio->priority_level, interrupts);
+    }
+
+    // Both streams report transfer errors; only the driving one raises transfer complete
+    if(tx != NULL) DMA_Register_Callback(tx, DMA_I2S_Callback, audio);
+    if(rx != NULL) DMA_Register_Callback(rx, DMA_I2S_Callback, audio);
+    if(tx != NULL) DMA_Stream_IRQ_Enable(tx);
+    if(rx != NULL) DMA_Stream_IRQ_Enable(rx);
+
+    if(rx != NULL) rx->CR |= DMA_SxCR_EN;
+    if(tx != NULL) tx->CR |= DMA_SxCR_EN;
+
+    if(rx != NULL) audio->RX_SPI->CR2 |= SPI_CR2_RXDMAEN;
+    if(tx != NULL) audio->TX_SPI->CR2 |= SPI_CR2_TXDMAEN;
+
+    // The extension block must be running before the main block starts the clock
+    tx_is_extension = (audio->TX_SPI == I2S2ext) || (audio->TX_SPI == I2S3ext);
+    if(tx_is_extension)
+    {
+        audio->TX_SPI->I2SCFGR |= SPI_I2SCFGR_I2SE;
+        if(rx != NULL) audio->RX_SPI->I2SCFGR |= SPI_I2SCFGR_I2SE;
+    }
+    else
+    {
+        if(rx != NULL) audio->RX_SPI->I2SCFGR |= SPI_I2SCFGR_I2SE;
+        if(tx != NULL) audio->TX_SPI->I2SCFGR |= SPI_I2SCFGR_I2SE;
+    }
+
+    return 1;
+}
+
+/**
+ * @brief Stops an I2S audio stream and releases its DMA streams.
+ *
+ * The streams are released only once they have stopped. Also called after a
+ * transfer error has stopped the stream, to release its DMA streams.
+ *
+ * @param[in] audio Pointer to the `DMA_I2S_Stream` structure.
+ */
+void DMA_I2S_Stop(DMA_I2S_Stream *audio)
+{
+    DMA_Stream_TypeDef *tx = audio->TX_Request.Stream;
+    DMA_Stream_TypeDef *rx = audio->RX_Request.Stream;
+
+    DMA_I2S_Halt(audio);
+
+    if(tx != NULL)
+    {
+        DMA_Register_Callback(tx, NULL, NULL);
+        DMA_Stream_Release(tx);
+    }
+    if(rx != NULL)
+    {
+        DMA_Register_Callback(rx, NULL, NULL);
+        DMA_Stream_Release(rx);
+    }
+}
@@ -0,0 +1,78 @@
+/**
+ * @file DMA_I2S.h
+ * @author Kunal Salvi
+ * @brief Header file for the DMA I2S audio streaming engine.
+ *
+ * This file contains the data structures and function prototypes for streaming
+ * audio through I2S2 or I2S3 with double-buffered DMA. Playback, capture and
+ * full-duplex operation (I2Sx together with its I2Sxext block) are supported.
+ * Each period, the application's callback receives the period of captured
+ * samples and fills the next period of playback samples. The engine measures
+ * how much of the period is left when the callback returns, counted from the
+ * period boundary (its deadline slack), and counts the periods it misses,
+ * whether the callback ran too long or its interrupt was serviced late.
+ *
+ * @version 1.0
+ * @date 2024-08-22
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef DMA_I2S_H_
+#define DMA_I2S_H_
+
+#include "DMA.h"
+
+/**
+ * @brief I2S audio stream structure.
+ *
+ * The fields in the first group are set by the application before calling
+ * `DMA_I2S_Start`. Leave a request's `Stream` NULL to run without that
+ * direction. The remaining fields are managed by the engine.
+ */
+typedef struct DMA_I2S_Stream
+{
+    SPI_TypeDef *TX_SPI;                /**< Block that transmits (e.g. SPI2 or I2S2ext), configured for I2S by the application */
+    SPI_TypeDef *RX_SPI;                /**< Block that receives (e.g. I2S2ext or SPI2), configured for I2S by the application */
+    DMA_Request TX_Request;             /**< Playback stream (e.g. `DMA_Configuration.Request.I2S2_TX`) */
+    DMA_Request RX_Request;             /**< Capture stream (e.g. `DMA_Configuration.Request.I2S2_EXT_RX`) */
+    uint32_t priority_level;            /**< Priority level of the streams */
+    int16_t *tx_buffers[2];             /**< Playback period buffers */
+    int16_t *rx_buffers[2];             /**< Capture period buffers */
+    uint16_t period_frames;             /**< Frames per period */
+    uint8_t channels;                   /**< 16-bit samples per frame (2 for stereo) */
+    uint32_t period_cycles;             /**< Length of a period in CPU cycles, for slack measurement (0 to disable) */
+    void (*process)(const int16_t *input, int16_t *output, uint16_t frames, void *context); /**< Period callback, called from the DMA interrupt */
+    void (*error)(void *context);       /**< Called from the DMA interrupt when a transfer error has stopped the stream (optional) */
+    void *context;                      /**< User pointer for the callbacks */
+
+    volatile uint32_t periods;          /**< Number of periods processed */
+    volatile uint32_t underruns;        /**< Periods whose playback buffer was not ready in time, including periods skipped by late interrupts */
+    volatile uint32_t overruns;         /**< Periods whose capture buffer was overwritten before it was processed */
+    volatile int32_t last_slack;        /**< Cycles left before the next period boundary after the last callback */
+    volatile int32_t min_slack;         /**< Smallest slack seen since the stream was started */
+    volatile uint32_t errors;           /**< Transfer errors; both directions stop on a transfer error */
+    uint32_t last_boundary;             /**< Time of the last serviced period boundary */
+    uint32_t last_ct;                   /**< CT bit of the driving stream at the last serviced boundary */
+} DMA_I2S_Stream;
+
+/**
+ * @brief Starts an I2S audio stream.
+ *
+ * @param[in] audio Pointer to the DMA_I2S_Stream structure.
+ *
+ * @return int8_t Returns 1 on success, or -1 if the configuration is invalid or a stream is already claimed.
+ */
+int8_t DMA_I2S_Start(DMA_I2S_Stream *audio);
+
+/**
+ * @brief Stops an I2S audio stream and releases its DMA streams.
+ *
+ * Also releases the streams of an audio stream stopped by a transfer error.
+ *
+ * @param[in] audio Pointer to the DMA_I2S_Stream structure.
+ */
+void DMA_I2S_Stop(DMA_I2S_Stream *audio);
+
+#endif /* DMA_I2S_H_ */
@@ -0,0 +1,316 @@
+/**
+ * @file DMA_Log.c
+ * @brief DMA Log Backend Implementation for STM32F407VGT6
+ *
+ * This file implements a lock-free multi-producer log ring drained by a USART
+ * TX stream. Writers use LDREX/STREX on one state word holding the number of
+ * writers in progress and the reserved position, so reserving space never
+ * masks interrupts and an interrupted writer is simply nested by the
+ * interrupting one. A writer that brings the writer count back to zero knows
+ * every reservation up to the reserved position is filled and publishes it.
+ * The consumer side is serialized by the `busy` flag: whoever sets it starts
+ * the next chunk, and the transfer complete interrupt releases the sent bytes
+ * and starts the following one.
+ *
+ * @version 1.0
+ * @date 2024-08-22
+ *
+ * @author Kunal Salvi
+ * @copyright Copyright (c) 2024
+ */
+
+#include "DMA_Log.h"
+#include <string.h>
+
+#define DMA_LOG_POSITION_MASK   0x00FFFFFFU     /**< Ring positions are 24-bit byte counts */
+#define DMA_LOG_WRITER          0x01000000U     /**< One writer in the state word */
+
+/**
+ * @brief Adds to a counter shared between tasks and interrupts.
+ */
+static void DMA_Log_Count(volatile uint32_t *counter, uint32_t value)
+{
+    uint32_t current;
+
+    do
+    {
+        current = __LDREXW(counter);
+    } while(__STREXW(current + value, counter) != 0);
+}
+
+/**
+ * @brief Moves the committed position forward to `position`, never backwards.
+ *
+ * A writer preempted between finishing and publishing may carry an older
+ * position than a nested writer that published after it.
+ */
+static void DMA_Log_Publish(DMA_Log *log, uint32_t position)
+{
+    uint32_t current;
+
+    do
+    {
+        current = __LDREXW(&log->committed);
+        if(((position - current) & DMA_LOG_POSITION_MASK) >= (DMA_LOG_POSITION_MASK / 2U))
+        {
+            __CLREX();
+            return;
+        }
+    } while(__STREXW(position, &log->committed) != 0);
+}
+
+/**
+ * @brief Starts sending the largest contiguous chunk of published bytes.
+ *
+ * Called with `busy` held.
+ *
+ * @return bool `true` if a chunk was started.
+ */
+static bool DMA_Log_Send(DMA_Log *log)
+{
+    DMA_Stream_TypeDef *stream = log->Request.Stream;
+    volatile uint32_t *flag_clear;
+    uint32_t flag_mask;
+    uint32_t offset = log->tail & (log->ring_size - 1U);
+    uint32_t length = (log->committed - log->tail) & DMA_LOG_POSITION_MASK;
+
+    if(length == 0)
+    {
+        return false;
+    }
+    if(length > log->ring_size - offset)
+    {
+        length = log->ring_size - offset;
+    }
+    if(length > 0xFFFF)
+    {
+        length = 0xFFFF;
+    }
+
+    log->chunk = length;
+    log->chunks++;
+
+    flag_clear = DMA_Flag_Clear_Register(stream, &flag_mask);
+    *flag_clear = flag_mask;
+    stream->M0AR = (uint32_t)(log->ring + offset);
+    stream->NDTR = length;
+    stream->CR |= DMA_SxCR_EN;
+
+    return true;
+}
+
+/**
+ * @brief Starts the stream if it is idle and bytes are waiting.
+ *
+ * After releasing `busy`, the published position is checked again so bytes
+ * published by a writer that found the stream busy are never left behind.
+ */
+static void DMA_Log_Kick(DMA_Log *log)
+{
+    for(;;)
+    {
+        if(__LDREXW(&log->busy) != 0)
+        {
+            __CLREX();
+            return;
+        }
+        if(__STREXW(1, &log->busy) != 0)
+        {
+            continue;
+        }
+
+        if(DMA_Log_Send(log))
+        {
+            return;
+        }
+
+        log->busy = 0;
+        if(((log->committed - log->tail) & DMA_LOG_POSITION_MASK) == 0)
+        {
+            return;
+        }
+    }
+}
+
+/**
+ * @brief Stream event callback: releases the sent chunk and sends the next one.
+ */
+static void DMA_Log_Callback(DMA_Stream_TypeDef *stream, uint32_t event, void *context)
+{
+    DMA_Log *log = (DMA_Log *)context;
+
+    if((event != DMA_Configuration.DMA_Interrupts.Transfer_Complete) &&
+       (event != DMA_Configuration.DMA_Interrupts.Transfer_Error))
+    {
+        return;
+    }
+
+    // On a transfer error the chunk is lost rather than retried forever
+    log->tail = (log->tail + log->chunk) & DMA_LOG_POSITION_MASK;
+    log->chunk = 0;
+
+    if(!DMA_Log_Send(log))
+    {
+        log->busy = 0;
+        DMA_Log_Kick(log);
+    }
+}
+
+/**
+ * @brief Initializes the log backend on its TX stream.
+ *
+ * This function claims the stream, configures it once for byte transfers
+ * from memory to the USART's `DR` with transfer complete and error interrupts
+ * and enables the USART's DMA transmitter. Sending a chunk then only reloads
+ * `M0AR` and `NDTR`. The USART is configured by the application.
+ *
+ * @param[in] log Pointer to the `DMA_Log` structure.
+ *
+ * @return int8_t Returns 1 on success, or -1 if the configuration is invalid or the stream is already claimed.
+ */
+int8_t DMA_Log_Init(DMA_Log *log)
+{
+    DMA_Stream_TypeDef *stream = log->Request.Stream;
+
+    if((stream == NULL) || (log->USART == NULL) || (log->ring == NULL))
+    {
+        return -1;
+    }
+    if((log->ring_size < 16) || (log->ring_size > 65536) || ((log->ring_size & (log->ring_size - 1U)) != 0))
+    {
+        return -1;
+    }
+    if(DMA_Stream_Claim(stream) != 1)
+    {
+        return -1;
+    }
+
+    log->state = 0;
+    log->committed = 0;
+    log->tail = 0;
+    log->busy = 0;
+    log->chunk = 0;
+    log->bytes = 0;
+    log->dropped = 0;
+    log->dropped_bytes = 0;
+    log->chunks = 0;
+
+    stream->CR &= ~DMA_SxCR_EN;
+    while(stream->CR & DMA_SxCR_EN) {}
+
+    stream->CR = ((uint32_t)log->Request.channel << DMA_SxCR_CHSEL_Pos) |
+                 DMA_Configuration.Transfer_Direction.Memory_to_peripheral |
+                 log->priority_level |
+                 DMA_Configuration.Memory_Data_Size.byte |
+                 DMA_Configuration.Peripheral_Data_Size.byte |
+                 DMA_Configuration.Memory_Pointer_Increment.Enable |
+                 DMA_Configuration.DMA_Interrupts.Transfer_Complete |
+                 DMA_Configuration.DMA_Interrupts.Transfer_Error;
+    stream->FCR = 0;
+    stream->PAR = (uint32_t)&(log->USART->DR);
+
+    DMA_Register_Callback(stream, DMA_Log_Callback, log);
+    DMA_Stream_IRQ_Enable(stream);
+
+    log->USART->CR3 |= USART_CR3_DMAT;
+
+    return 1;
+}
+
+/**
+ * @brief Queues a message; never blocks.
+ *
+ * Safe from any task or interrupt. The message is reserved, copied into the
+ * ring and published; it goes out when the stream reaches it. Messages are
+ * published once no writer is inside its copy, so a writer preempted for a
+ * long time delays (but does not lose) the messages queued after it.
+ *
+ * @param[in] log Pointer to the `DMA_Log` structure.
+ * @param[in] data Message bytes.
+ * @param[in] length Number of bytes.
+ *
+ * @return int8_t Returns 1 if the message was queued, or -1 if it was dropped.
+ */
+int8_t DMA_Log_Write(DMA_Log *log, const void *data, uint32_t length)
+{
+    uint32_t state;
+    uint32_t position;
+    uint32_t offset;
+    uint32_t first;
+
+    if(length == 0)
+    {
+        return 1;
+    }
+
+    // Reserve: count this writer in and move the reserved position past the message
+    do
+    {
+        state = __LDREXW(&log->state);
+        position = state & DMA_LOG_POSITION_MASK;
+
+        if(length > log->ring_size - ((position - log->tail) & DMA_LOG_POSITION_MASK))
+        {
+            __CLREX();
+            DMA_Log_Count(&log->dropped, 1);
+            DMA_Log_Count(&log->dropped_bytes, length);
+            return -1;
+        }
+    } while(__STREXW((state & ~DMA_LOG_POSITION_MASK) + DMA_LOG_WRITER + ((position + length) & DMA_LOG_POSITION_MASK), &log->state) != 0);
+
+    offset = position & (log->ring_size - 1U);
+    first = log->ring_size - offset;
+    if(first >= length)
+    {
+        memcpy(log->ring + offset, data, length);
+    }
+    else
+    {
+        memcpy(log->ring + offset, data, first);
+        memcpy(log->ring, (const uint8_t *)data + first, length - first);
+    }
+
+    // Finish: the last writer out publishes everything reserved so far
+    do
+    {
+        state = __LDREXW(&log->state) - DMA_LOG_WRITER;
+    } while(__STREXW(state, &log->state) != 0);
+
+    if((state & ~DMA_LOG_POSITION_MASK) == 0)
+    {
+        DMA_Log_Publish(log, state & DMA_LOG_POSITION_MASK);
+    }
+
+    DMA_Log_Count(&log->bytes, length);
+    DMA_Log_Kick(log);
+
+    return 1;
+}
+
+/**
+ * @brief Queues a zero-terminated string; never blocks.
+ *
+ * Also suited as the body of a retargeted `_write` so `printf` output goes
+ * through the log ring.
+ *
+ * @param[in] log Pointer to the `DMA_Log` structure.
+ * @param[in] text String to log.
+ *
+ * @return int8_t Returns 1 if the string was queued, or -1 if it was dropped.
+ */
+int8_t DMA_Log_Print(DMA_Log *log, const char *text)
+{
+    return DMA_Log_Write(log, text, strlen(text));
+}
+
+/**
+ * @brief Waits until every queued message has been sent.
+ *
+ * Must not be called from an interrupt with a priority at or above the stream's.
+ *
+ * @param[in] log Pointer to the `DMA_Log` structure.
+ */
+void DMA_Log_Flush(DMA_Log *log)
+{
+    while((log->busy != 0) || (((log->state & DMA_LOG_POSITION_MASK) - log->tail) & DMA_LOG_POSITION_MASK) != 0) {}
+}
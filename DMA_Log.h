@@ -0,0 +1,90 @@
+/**
+ * @file DMA_Log.h
+ * @author Kunal Salvi
+ * @brief Header file for the DMA log backend.
+ *
+ * This file contains the data structures and function prototypes for a
+ * non-blocking log sink on a USART TX stream. Any number of tasks and
+ * interrupts write messages into a shared byte ring without locks: a message
+ * reserves its space with one exclusive update of a packed state word, copies
+ * itself in, and the last writer to finish publishes all completed messages.
+ * The stream sends the published bytes in the largest contiguous chunks and
+ * re-arms itself from its transfer complete interrupt. A message that does
+ * not fit is dropped and counted instead of blocking the caller.
+ *
+ * @version 1.0
+ * @date 2024-08-22
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef DMA_LOG_H_
+#define DMA_LOG_H_
+
+#include "DMA.h"
+
+/**
+ * @brief Log backend structure.
+ *
+ * The fields in the first group are set by the application before calling
+ * `DMA_Log_Init`. Ring positions are free-running 24-bit byte counts. The
+ * remaining fields are managed by the backend.
+ */
+typedef struct DMA_Log
+{
+    USART_TypeDef *USART;               /**< USART, configured and enabled by the application */
+    DMA_Request Request;                /**< TX request of the USART (e.g. `DMA_Configuration.Request.USART2_TX`) */
+    uint32_t priority_level;            /**< Priority level of the stream */
+    uint8_t *ring;                      /**< Log ring */
+    uint32_t ring_size;                 /**< Size of the ring, a power of two from 16 to 65536 */
+
+    volatile uint32_t state;            /**< Writers in progress (bits 31:24) and reserved position (bits 23:0) */
+    volatile uint32_t committed;        /**< Position up to which messages are complete */
+    volatile uint32_t tail;             /**< Position up to which bytes have been sent */
+    volatile uint32_t busy;             /**< The stream is sending a chunk */
+    uint32_t chunk;                     /**< Length of the chunk being sent */
+    volatile uint32_t bytes;            /**< Bytes accepted */
+    volatile uint32_t dropped;          /**< Messages dropped because the ring was full */
+    volatile uint32_t dropped_bytes;    /**< Bytes of the dropped messages */
+    volatile uint32_t chunks;           /**< Chunks sent */
+} DMA_Log;
+
+/**
+ * @brief Initializes the log backend on its TX stream.
+ *
+ * @param[in] log Pointer to the DMA_Log structure.
+ *
+ * @return int8_t Returns 1 on success, or -1 if the configuration is invalid or the stream is already claimed.
+ */
+int8_t DMA_Log_Init(DMA_Log *log);
+
+/**
+ * @brief Queues a message; never blocks.
+ *
+ * @param[in] log Pointer to the DMA_Log structure.
+ * @param[in] data Message bytes.
+ * @param[in] length Number of bytes.
+ *
+ * @return int8_t Returns 1 if the message was queued, or -1 if it was dropped.
+ */
+int8_t DMA_Log_Write(DMA_Log *log, const void *data, uint32_t length);
+
+/**
+ * @brief Queues a zero-terminated string; never blocks.
+ *
+ * @param[in] log Pointer to the DMA_Log structure.
+ * @param[in] text String to log.
+ *
+ * @return int8_t Returns 1 if the string was queued, or -1 if it was dropped.
+ */
+int8_t DMA_Log_Print(DMA_Log *log, const char *text);
+
+/**
+ * @brief Waits until every queued message has been sent.
+ *
+ * @param[in] log Pointer to the DMA_Log structure.
+ */
+void DMA_Log_Flush(DMA_Log *log);
+
+#endif /* DMA_LOG_H_ */
@@ -0,0 +1,351 @@
+/**
+ * @file DMA_Pipeline.c
+ * @brief DMA Block Pipeline Implementation
+ *
+ * This file implements the block hand-off between a producer and a consumer
+ * stage. Free blocks are kept on a stack and filled blocks in a FIFO; every
+ * completion moves one block between them in a short critical section and
+ * then starts the stages that became ready, outside of it. The file uses no
+ * peripheral, so it builds unchanged on a host when
+ * `DMA_PIPELINE_CRITICAL_ENTER`/`DMA_PIPELINE_CRITICAL_EXIT` are defined by the
+ * build; `main.h` is then not included (see `host/Host_Critical.h`).
+ *
+ * @version 1.0
+ * @date 2024-08-22
+ *
+ * @author Kunal Salvi
+ * @copyright Copyright (c) 2024
+ */
+
+#include "DMA_Pipeline.h"
+
+#ifndef DMA_PIPELINE_CRITICAL_ENTER
+#include "main.h"
+#define DMA_PIPELINE_CRITICAL_ENTER(state)  do { (state) = __get_PRIMASK(); __disable_irq(); } while(0)
+#define DMA_PIPELINE_CRITICAL_EXIT(state)   __set_PRIMASK(state)
+#endif
+
+#define DMA_PIPELINE_IDLE       (-1)    /**< Stage has no block */
+#define DMA_PIPELINE_SCRATCH    (-2)    /**< Producer is filling the scratch block */
+
+/**
+ * @brief Returns the address of a block.
+ */
+static uint8_t *DMA_Pipeline_Block(DMA_Pipeline *pipeline, int8_t index)
+{
+    if(index == DMA_PIPELINE_SCRATCH)
+    {
+        return pipeline->scratch;
+    }
+    return pipeline->pool + (uint32_t)index * pipeline->block_size;
+}
+
+/**
+ * @brief Assigns the producer its next block; called in the critical section.
+ *
+ * @return bool `true` if the producer must be started.
+ */
+static bool DMA_Pipeline_Next_Producer(DMA_Pipeline *pipeline)
+{
+    if(!pipeline->running || (pipeline->producing != DMA_PIPELINE_IDLE))
+    {
+        return false;
+    }
+
+    if(pipeline->free_count != 0)
+    {
+        pipeline->producing = (int8_t)pipeline->free_blocks[--pipeline->free_count];
+    }
+    else if(pipeline->scratch != NULL)
+    {
+        pipeline->producing = DMA_PIPELINE_SCRATCH;
+    }
+    else
+    {
+        pipeline->stalls++;
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Assigns the consumer the oldest filled block; called in the critical section.
+ *
+ * @return bool `true` if the consumer must be started.
+ */
+static bool DMA_Pipeline_Next_Consumer(DMA_Pipeline *pipeline)
+{
+    if((pipeline->consuming != DMA_PIPELINE_IDLE) || (pipeline->ready_count == 0))
+    {
+        return false;
+    }
+
+    pipeline->consuming = (int8_t)pipeline->ready_blocks[pipeline->ready_head];
+    pipeline->ready_head = (uint8_t)((pipeline->ready_head + 1U) % pipeline->block_count);
+    pipeline->ready_count--;
+
+    return true;
+}
+
+/**
+ * @brief Starts the stages assigned a block, outside the critical section.
+ */
+static void DMA_Pipeline_Dispatch(DMA_Pipeline *pipeline, bool produce, bool consume)
+{
+    uint32_t state;
+    int8_t index;
+
+    if(produce)
+    {
+        index = pipeline->producing;
+        if(pipeline->producer.start(DMA_Pipeline_Block(pipeline, index), pipeline->block_size, pipeline->producer.context) != 1)
+        {
+            DMA_PIPELINE_CRITICAL_ENTER(state);
+            if(index >= 0)
+            {
+                pipeline->free_blocks[pipeline->free_count++] = (uint8_t)index;
+            }
+            pipeline->producing = DMA_PIPELINE_IDLE;
+            pipeline->running = false;
+            pipeline->errors++;
+            DMA_PIPELINE_CRITICAL_EXIT(state);
+        }
+    }
+
+    if(consume)
+    {
+        index = pipeline->consuming;
+        if(pipeline->consumer.start(DMA_Pipeline_Block(pipeline, index), pipeline->ready_length[index], pipeline->consumer.context) != 1)
+        {
+            DMA_Pipeline_Consumed(pipeline, -1);
+        }
+    }
+}
+
+/**
+ * @brief Initializes a pipeline and fills its free list.
+ *
+ * @param[in] pipeline Pointer to the `DMA_Pipeline` structure.
+ *
+ * @return int8_t Returns 1 on success, or -1 if the configuration is invalid.
+ */
+int8_t DMA_Pipeline_Init(DMA_Pipeline *pipeline)
+{
+    uint8_t index;
+
+    if((pipeline->pool == NULL) || (pipeline->block_size == 0) ||
+       (pipeline->block_count == 0) || (pipeline->block_count > DMA_PIPELINE_MAX_BLOCKS) ||
+       (pipeline->producer.start == NULL) || (pipeline->consumer.start == NULL))
+    {
+        return -1;
+    }
+
+    // Stacked in reverse so block 0 is used first
+    for(index = 0; index < pipeline->block_count; index++)
+    {
+        pipeline->free_blocks[index] = (uint8_t)(pipeline->block_count - 1U - index);
+    }
+    pipeline->free_count = pipeline->block_count;
+    pipeline->ready_head = 0;
+    pipeline->ready_count = 0;
+    pipeline->producing = DMA_PIPELINE_IDLE;
+    pipeline->consuming = DMA_PIPELINE_IDLE;
+    pipeline->running = false;
+
+    pipeline->produced = 0;
+    pipeline->consumed = 0;
+    pipeline->bytes = 0;
+    pipeline->dropped = 0;
+    pipeline->stalls = 0;
+    pipeline->errors = 0;
+    pipeline->max_depth = 0;
+    pipeline->last_latency = 0;
+    pipeline->max_latency = 0;
+
+    return 1;
+}
+
+/**
+ * @brief Starts the producer on the first free block.
+ *
+ * @param[in] pipeline Pointer to the `DMA_Pipeline` structure.
+ *
+ * @return int8_t Returns 1 on success, or -1 if the producer could not be started.
+ */
+int8_t DMA_Pipeline_Start(DMA_Pipeline *pipeline)
+{
+    uint32_t state;
+    bool produce;
+
+    DMA_PIPELINE_CRITICAL_ENTER(state);
+    pipeline->running = true;
+    pipeline->start_time = (pipeline->timestamp != NULL) ? pipeline->timestamp() : 0;
+    produce = DMA_Pipeline_Next_Producer(pipeline);
+    DMA_PIPELINE_CRITICAL_EXIT(state);
+
+    DMA_Pipeline_Dispatch(pipeline, produce, false);
+
+    return pipeline->running ? 1 : -1;
+}
+
+/**
+ * @brief Stops restarting the producer; queued blocks are still consumed.
+ *
+ * The block the producer is filling is completed and queued as usual.
+ *
+ * @param[in] pipeline Pointer to the `DMA_Pipeline` structure.
+ */
+void DMA_Pipeline_Stop(DMA_Pipeline *pipeline)
+{
+    pipeline->running = false;
+}
+
+/**
+ * @brief Reports that the producer has finished its block.
+ *
+ * Called by the producer stage, usually from its interrupt. The block is
+ * queued for the consumer (or dropped if it was the scratch block), and the
+ * producer is restarted on the next free block.
+ *
+ * @param[in] pipeline Pointer to the `DMA_Pipeline` structure.
+ * @param[in] length Number of bytes produced into the block.
+ */
+void DMA_Pipeline_Produced(DMA_Pipeline *pipeline, uint32_t length)
+{
+    uint32_t state;
+    int8_t index;
+    bool produce;
+    bool consume;
+
+    DMA_PIPELINE_CRITICAL_ENTER(state);
+
+    index = pipeline->producing;
+    pipeline->producing = DMA_PIPELINE_IDLE;
+
+    if(index == DMA_PIPELINE_SCRATCH)
+    {
+        pipeline->dropped++;
+    }
+    else if(index >= 0)
+    {
+        pipeline->ready_length[index] = length;
+        pipeline->ready_time[index] = (pipeline->timestamp != NULL) ? pipeline->timestamp() : 0;
+        pipeline->ready_blocks[(pipeline->ready_head + pipeline->ready_count) % pipeline->block_count] = (uint8_t)index;
+        pipeline->ready_count++;
+        pipeline->produced++;
+
+        if(pipeline->ready_count > pipeline->max_depth)
+        {
+            pipeline->max_depth = pipeline->ready_count;
+        }
+    }
+
+    produce = DMA_Pipeline_Next_Producer(pipeline);
+    consume = DMA_Pipeline_Next_Consumer(pipeline);
+
+    DMA_PIPELINE_CRITICAL_EXIT(state);
+
+    DMA_Pipeline_Dispatch(pipeline, produce, consume);
+}
+
+/**
+ * @brief Reports that the consumer has finished its block.
+ *
+ * Called by the consumer stage, usually from its interrupt. The block returns
+ * to the free list, the consumer is started on the next filled block and a
+ * stalled producer is restarted.
+ *
+ * @param[in] pipeline Pointer to the `DMA_Pipeline` structure.
+ * @param[in] status 1 if the block was consumed, -1 on error (the block is released either way).
+ */
+void DMA_Pipeline_Consumed(DMA_Pipeline *pipeline, int8_t status)
+{
+    uint32_t state;
+    uint32_t latency;
+    int8_t index;
+    bool produce;
+    bool consume;
+
+    DMA_PIPELINE_CRITICAL_ENTER(state);
+
+    index = pipeline->consuming;
+    if(index < 0)
+    {
+        DMA_PIPELINE_CRITICAL_EXIT(state);
+        return;
+    }
+    pipeline->consuming = DMA_PIPELINE_IDLE;
+
+    if(status == 1)
+    {
+        pipeline->consumed++;
+        pipeline->bytes += pipeline->ready_length[index];
+
+        if(pipeline->timestamp != NULL)
+        {
+            latency = pipeline->timestamp() - pipeline->ready_time[index];
+            pipeline->last_latency = latency;
+            if(latency > pipeline->max_latency)
+            {
+                pipeline->max_latency = latency;
+            }
+        }
+    }
+    else
+    {
+        pipeline->errors++;
+    }
+
+    pipeline->free_blocks[pipeline->free_count++] = (uint8_t)index;
+
+    consume = DMA_Pipeline_Next_Consumer(pipeline);
+    produce = DMA_Pipeline_Next_Producer(pipeline);
+
+    DMA_PIPELINE_CRITICAL_EXIT(state);
+
+    DMA_Pipeline_Dispatch(pipeline, produce, consume);
+}
+
+/**
+ * @brief Reports whether blocks are still being produced or consumed.
+ *
+ * @param[in] pipeline Pointer to the `DMA_Pipeline` structure.
+ *
+ * @return bool `true` while a stage is active or blocks are waiting.
+ */
+bool DMA_Pipeline_Busy(DMA_Pipeline *pipeline)
+{
+    return (pipeline->producing != DMA_PIPELINE_IDLE) ||
+           (pipeline->consuming != DMA_PIPELINE_IDLE) ||
+           (pipeline->ready_count != 0);
+}
+
+/**
+ * @brief Returns the consumed data rate since the pipeline was started.
+ *
+ * With `DMA_Timestamp` as time source the measurement window must stay below
+ * one wrap of the cycle counter (about 25 s at 168 MHz).
+ *
+ * @param[in] pipeline Pointer to the `DMA_Pipeline` structure.
+ * @param[in] ticks_per_second Rate of the `timestamp` source (e.g. `SystemCoreClock`).
+ *
+ * @return uint32_t Bytes per second, or 0 without a time source.
+ */
+uint32_t DMA_Pipeline_Throughput(DMA_Pipeline *pipeline, uint32_t ticks_per_second)
+{
+    uint32_t elapsed;
+
+    if(pipeline->timestamp == NULL)
+    {
+        return 0;
+    }
+
+    elapsed = pipeline->timestamp() - pipeline->start_time;
+    if(elapsed == 0)
+    {
+        return 0;
+    }
+
+    return (uint32_t)(((uint64_t)pipeline->bytes * ticks_per_second) / elapsed);
+}
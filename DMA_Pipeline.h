@@ -0,0 +1,149 @@
+/**
+ * @file DMA_Pipeline.h
+ * @author Kunal Salvi
+ * @brief Header file for the DMA block pipeline.
+ *
+ * This file contains the data structures and function prototypes for moving
+ * data from a producer stage (e.g. ADC or SPI capture) through a pool of
+ * fixed-size RAM blocks to a consumer stage (e.g. SD card writes). Each stage
+ * is started on one block at a time and reports completion from its interrupt
+ * with `DMA_Pipeline_Produced` / `DMA_Pipeline_Consumed`; the pipeline hands
+ * the block over to the other side in the same interrupt. When the consumer
+ * falls behind and the pool runs empty, the producer is either stalled or kept
+ * running into a scratch block whose data is dropped, and both cases are
+ * counted.
+ *
+ * The pipeline itself does not access any peripheral, so it can be built and
+ * exercised on a host with simulated stages; the critical section macros can
+ * be overridden for that purpose, as `host/DMA_Pipeline_Host.c` does. Stages for DMA streams, SPI and SDIO are
+ * provided in `DMA_Pipeline_Stages.h`.
+ *
+ * @version 1.0
+ * @date 2024-08-22
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef DMA_PIPELINE_H_
+#define DMA_PIPELINE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#define DMA_PIPELINE_MAX_BLOCKS     16      /**< Maximum number of blocks in the pool */
+
+/**
+ * @brief Pipeline stage.
+ *
+ * `start` begins filling (producer) or draining (consumer) one block and
+ * returns 1, or -1 if it could not be started. Completion is reported by the
+ * stage through `DMA_Pipeline_Produced` or `DMA_Pipeline_Consumed`.
+ */
+typedef struct DMA_Pipeline_Stage
+{
+    int8_t (*start)(uint8_t *block, uint32_t length, void *context); /**< Starts the stage on a block of `length` bytes */
+    void *context;                      /**< User pointer for the stage */
+} DMA_Pipeline_Stage;
+
+/**
+ * @brief Pipeline structure.
+ *
+ * The fields in the first group are set by the application before calling
+ * `DMA_Pipeline_Init`. The remaining fields are managed by the pipeline.
+ */
+typedef struct DMA_Pipeline
+{
+    uint8_t *pool;                      /**< `block_count * block_size` bytes of blocks */
+    uint32_t block_size;                /**< Bytes per block */
+    uint8_t block_count;                /**< Number of blocks (at most `DMA_PIPELINE_MAX_BLOCKS`) */
+    uint8_t *scratch;                   /**< Block the producer fills while the pool is empty, or NULL to stall it instead */
+    DMA_Pipeline_Stage producer;        /**< Stage that fills blocks */
+    DMA_Pipeline_Stage consumer;        /**< Stage that drains blocks */
+    uint32_t (*timestamp)(void);        /**< Time source for latency and throughput (e.g. `DMA_Timestamp`), or NULL */
+
+    uint8_t free_blocks[DMA_PIPELINE_MAX_BLOCKS];   /**< Stack of free block indices */
+    uint8_t free_count;                 /**< Number of free blocks */
+    uint8_t ready_blocks[DMA_PIPELINE_MAX_BLOCKS];  /**< FIFO of filled block indices */
+    uint8_t ready_head;                 /**< Oldest filled block in `ready_blocks` */
+    uint8_t ready_count;                /**< Number of filled blocks waiting for the consumer */
+    uint32_t ready_length[DMA_PIPELINE_MAX_BLOCKS]; /**< Bytes produced into each block */
+    uint32_t ready_time[DMA_PIPELINE_MAX_BLOCKS];   /**< Time each block was produced */
+    int8_t producing;                   /**< Block being filled, -2 for the scratch block, -1 when the producer is idle */
+    int8_t consuming;                   /**< Block being drained, -1 when the consumer is idle */
+    volatile bool running;              /**< Producer is restarted after each block */
+    uint32_t start_time;                /**< Time the pipeline was started */
+
+    volatile uint32_t produced;         /**< Blocks handed to the consumer */
+    volatile uint32_t consumed;         /**< Blocks drained by the consumer */
+    volatile uint32_t bytes;            /**< Bytes drained by the consumer */
+    volatile uint32_t dropped;          /**< Blocks produced into the scratch block and discarded */
+    volatile uint32_t stalls;           /**< Times the producer was stalled for lack of a free block */
+    volatile uint32_t errors;           /**< Stage start failures and consumer errors */
+    uint8_t max_depth;                  /**< Largest number of blocks waiting for the consumer */
+    uint32_t last_latency;              /**< Time from production to consumption of the last block */
+    uint32_t max_latency;               /**< Largest production-to-consumption time */
+} DMA_Pipeline;
+
+/**
+ * @brief Initializes a pipeline and fills its free list.
+ *
+ * @param[in] pipeline Pointer to the DMA_Pipeline structure.
+ *
+ * @return int8_t Returns 1 on success, or -1 if the configuration is invalid.
+ */
+int8_t DMA_Pipeline_Init(DMA_Pipeline *pipeline);
+
+/**
+ * @brief Starts the producer on the first free block.
+ *
+ * @param[in] pipeline Pointer to the DMA_Pipeline structure.
+ *
+ * @return int8_t Returns 1 on success, or -1 if the producer could not be started.
+ */
+int8_t DMA_Pipeline_Start(DMA_Pipeline *pipeline);
+
+/**
+ * @brief Stops restarting the producer; queued blocks are still consumed.
+ *
+ * @param[in] pipeline Pointer to the DMA_Pipeline structure.
+ */
+void DMA_Pipeline_Stop(DMA_Pipeline *pipeline);
+
+/**
+ * @brief Reports that the producer has finished its block.
+ *
+ * @param[in] pipeline Pointer to the DMA_Pipeline structure.
+ * @param[in] length Number of bytes produced into the block.
+ */
+void DMA_Pipeline_Produced(DMA_Pipeline *pipeline, uint32_t length);
+
+/**
+ * @brief Reports that the consumer has finished its block.
+ *
+ * @param[in] pipeline Pointer to the DMA_Pipeline structure.
+ * @param[in] status 1 if the block was consumed, -1 on error (the block is released either way).
+ */
+void DMA_Pipeline_Consumed(DMA_Pipeline *pipeline, int8_t status);
+
+/**
+ * @brief Reports whether blocks are still being produced or consumed.
+ *
+ * @param[in] pipeline Pointer to the DMA_Pipeline structure.
+ *
+ * @return bool `true` while a stage is active or blocks are waiting.
+ */
+bool DMA_Pipeline_Busy(DMA_Pipeline *pipeline);
+
+/**
+ * @brief Returns the consumed data rate since the pipeline was started.
+ *
+ * @param[in] pipeline Pointer to the DMA_Pipeline structure.
+ * @param[in] ticks_per_second Rate of the `timestamp` source (e.g. `SystemCoreClock`).
+ *
+ * @return uint32_t Bytes per second, or 0 without a time source.
+ */
+uint32_t DMA_Pipeline_Throughput(DMA_Pipeline *pipeline, uint32_t ticks_per_second);
+
+#endif /* DMA_PIPELINE_H_ */
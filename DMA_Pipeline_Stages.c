@@ -0,0 +1,212 @@
+/**
+ * @file DMA_Pipeline_Stages.c
+ * @brief DMA Pipeline Stages Implementation for STM32F407VGT6
+ *
+ * This file implements the pipeline stages for DMA streams, SPI buses and SDIO
+ * hosts. Each stage starts its transfer on the block it is given and reports
+ * completion to the pipeline from the transfer's interrupt.
+ *
+ * @version 1.0
+ * @date 2024-08-22
+ *
+ * @author Kunal Salvi
+ * @copyright Copyright (c) 2024
+ */
+
+#include "DMA_Pipeline_Stages.h"
+
+/**
+ * @brief Returns the size in bytes of the stream's peripheral data items.
+ */
+static uint32_t DMA_Pipeline_Item_Size(DMA_Config *config)
+{
+    if(config->peripheral_data_size == DMA_Configuration.Peripheral_Data_Size.word) return 4;
+    if(config->peripheral_data_size == DMA_Configuration.Peripheral_Data_Size.half_word) return 2;
+    return 1;
+}
+
+/**
+ * @brief Stream stage event callback: reports the block to the pipeline.
+ *
+ * On a transfer error a producer reports the bytes transferred so far and a
+ * consumer reports a failed block.
+ */
+static void DMA_Pipeline_Stream_Callback(DMA_Stream_TypeDef *stream, uint32_t event, void *context)
+{
+    DMA_Pipeline_Stream_Stage *stage = (DMA_Pipeline_Stream_Stage *)context;
+    uint32_t remaining;
+
+    if(event == DMA_Configuration.DMA_Interrupts.Transfer_Complete)
+    {
+        if(stage->producer) DMA_Pipeline_Produced(stage->pipeline, stage->length);
+        else DMA_Pipeline_Consumed(stage->pipeline, 1);
+    }
+    else if(event == DMA_Configuration.DMA_Interrupts.Transfer_Error)
+    {
+        remaining = stream->NDTR * DMA_Pipeline_Item_Size(&stage->config);
+
+        if(stage->producer) DMA_Pipeline_Produced(stage->pipeline, stage->length - remaining);
+        else DMA_Pipeline_Consumed(stage->pipeline, -1);
+    }
+}
+
+/**
+ * @brief Starts a DMA stream stage on a block.
+ *
+ * The first call claims the stream and initializes it with `DMA_Init`; each
+ * call then loads the block with `DMA_Set_Target` and starts it with
+ * `DMA_Set_Trigger`.
+ *
+ * @param[in] block Block to fill or drain.
+ * @param[in] length Number of bytes.
+ * @param[in] context Pointer to a `DMA_Pipeline_Stream_Stage` structure.
+ *
+ * @return int8_t Returns 1 on success, or -1 if the stream is claimed elsewhere, still enabled or the length is invalid.
+ */
+int8_t DMA_Pipeline_Stream_Start(uint8_t *block, uint32_t length, void *context)
+{
+    DMA_Pipeline_Stream_Stage *stage = (DMA_Pipeline_Stream_Stage *)context;
+    DMA_Stream_TypeDef *stream = stage->config.Request.Stream;
+    uint32_t items = length / DMA_Pipeline_Item_Size(&stage->config);
+
+    if((items == 0) || (items > 0xFFFF) || (items * DMA_Pipeline_Item_Size(&stage->config) != length))
+    {
+        return -1;
+    }
+
+    if(!stage->initialized)
+    {
+        if(DMA_Stream_Claim(stream) != 1)
+        {
+            return -1;
+        }
+
+        stage->config.circular_mode = DMA_Configuration.Circular_Mode.Disable;
+        stage->config.interrupts = DMA_Configuration.DMA_Interrupts.Transfer_Complete;
+        stream->CR = 0;
+        DMA_Register_Callback(stream, DMA_Pipeline_Stream_Callback, stage);
+        DMA_Init(&stage->config);
+        stream->CR |= DMA_Configuration.DMA_Interrupts.Transfer_Error;
+        stage->initialized = true;
+    }
+
+    // Starts come from the stages' interrupts: fail instead of waiting for the stream to stop
+    if(stream->CR & DMA_SxCR_EN)
+    {
+        return -1;
+    }
+
+    stage->length = length;
+    stage->config.memory_address = (uint32_t)block;
+    stage->config.buffer_length = (uint16_t)items;
+    DMA_Set_Target(&stage->config);
+    DMA_Set_Trigger(&stage->config);
+
+    return 1;
+}
+
+/**
+ * @brief Releases the stream of an idle DMA stream stage.
+ *
+ * @param[in] stage Pointer to the `DMA_Pipeline_Stream_Stage` structure.
+ */
+void DMA_Pipeline_Stream_Release(DMA_Pipeline_Stream_Stage *stage)
+{
+    if(stage->initialized)
+    {
+        DMA_Register_Callback(stage->config.Request.Stream, NULL, NULL);
+        DMA_Clock_Disable(&stage->config);
+        DMA_Stream_Release(stage->config.Request.Stream);
+        stage->initialized = false;
+    }
+}
+
+/**
+ * @brief SPI stage completion: reports the block to the pipeline.
+ */
+static void DMA_Pipeline_SPI_Complete(DMA_SPI_Transaction *transaction)
+{
+    DMA_Pipeline_SPI_Stage *stage = (DMA_Pipeline_SPI_Stage *)transaction;
+
+    if(stage->producer)
+    {
+        DMA_Pipeline_Produced(stage->pipeline, (transaction->status == 1) ? transaction->length : 0);
+    }
+    else
+    {
+        DMA_Pipeline_Consumed(stage->pipeline, transaction->status);
+    }
+}
+
+/**
+ * @brief Starts an SPI stage on a block.
+ *
+ * @param[in] block Block to fill or drain.
+ * @param[in] length Number of bytes (at most 65535).
+ * @param[in] context Pointer to a `DMA_Pipeline_SPI_Stage` structure.
+ *
+ * @return int8_t Returns 1 on success, or -1 if the length is invalid.
+ */
+int8_t DMA_Pipeline_SPI_Start(uint8_t *block, uint32_t length, void *context)
+{
+    DMA_Pipeline_SPI_Stage *stage = (DMA_Pipeline_SPI_Stage *)context;
+
+    if(length > 0xFFFF)
+    {
+        return -1;
+    }
+
+    stage->transaction.tx_buffer = stage->producer ? NULL : block;
+    stage->transaction.rx_buffer = stage->producer ? block : NULL;
+    stage->transaction.length = (uint16_t)length;
+    stage->transaction.complete = DMA_Pipeline_SPI_Complete;
+
+    return DMA_SPI_Submit(stage->bus, &stage->transaction);
+}
+
+/**
+ * @brief SDIO stage completion: advances the card position and reports the block.
+ */
+static void DMA_Pipeline_SDIO_Complete(DMA_SDIO_Request *request)
+{
+    DMA_Pipeline_SDIO_Stage *stage = (DMA_Pipeline_SDIO_Stage *)request;
+
+    if(request->status == 1)
+    {
+        stage->next_block += request->count;
+    }
+
+    DMA_Pipeline_Consumed(stage->pipeline, request->status);
+}
+
+/**
+ * @brief Starts an SDIO consumer stage on a block.
+ *
+ * The block is written with one multi-block write at `next_block`. A failed
+ * write is reported to the pipeline and the same card blocks are used for the
+ * next pipeline block.
+ *
+ * @param[in] block Block to write.
+ * @param[in] length Number of bytes, a multiple of `DMA_SDIO_BLOCK_SIZE`.
+ * @param[in] context Pointer to a `DMA_Pipeline_SDIO_Stage` structure.
+ *
+ * @return int8_t Returns 1 on success, or -1 if the length is invalid.
+ */
+int8_t DMA_Pipeline_SDIO_Start(uint8_t *block, uint32_t length, void *context)
+{
+    DMA_Pipeline_SDIO_Stage *stage = (DMA_Pipeline_SDIO_Stage *)context;
+
+    if((length == 0) || ((length % DMA_SDIO_BLOCK_SIZE) != 0) || ((length / DMA_SDIO_BLOCK_SIZE) > 0xFFFF))
+    {
+        return -1;
+    }
+
+    stage->request.block = stage->next_block;
+    stage->request.count = (uint16_t)(length / DMA_SDIO_BLOCK_SIZE);
+    stage->request.buffer = block;
+    stage->request.write = true;
+    stage->request.complete = DMA_Pipeline_SDIO_Complete;
+    stage->request.context = stage;
+
+    return DMA_SDIO_Submit(stage->host, &stage->request);
+}
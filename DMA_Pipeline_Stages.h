@@ -0,0 +1,117 @@
+/**
+ * @file DMA_Pipeline_Stages.h
+ * @author Kunal Salvi
+ * @brief Header file for the DMA pipeline stages.
+ *
+ * This file contains ready-made pipeline stages: a single DMA stream (e.g. an
+ * ADC or a peripheral TX), SPI transactions on a `DMA_SPI_Bus`, and sequential
+ * block writes on a `DMA_SDIO_Host`. A stage structure is passed as the
+ * `context` of its `DMA_Pipeline_Stage`, with the matching start function.
+ *
+ * @version 1.0
+ * @date 2024-08-22
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef DMA_PIPELINE_STAGES_H_
+#define DMA_PIPELINE_STAGES_H_
+
+#include "DMA.h"
+#include "DMA_SPI.h"
+#include "DMA_SDIO.h"
+#include "DMA_Pipeline.h"
+
+/**
+ * @brief DMA stream stage.
+ *
+ * `config` describes the stream as for `DMA_Init`; its memory address, length
+ * and interrupts are set by the stage. Blocks must be a whole number of
+ * peripheral data items. The stream is restarted for every block, so a source
+ * that cannot pause between blocks (such as a free-running ADC) may lose data
+ * while the next block is started; such sources are better served by the
+ * double-buffered engines.
+ */
+typedef struct DMA_Pipeline_Stream_Stage
+{
+    DMA_Config config;                  /**< Stream configuration */
+    DMA_Pipeline *pipeline;             /**< Pipeline the stage reports to */
+    bool producer;                      /**< `true` for a producer, `false` for a consumer */
+
+    bool initialized;                   /**< The stream is claimed and configured */
+    uint32_t length;                    /**< Bytes of the current block */
+} DMA_Pipeline_Stream_Stage;
+
+/**
+ * @brief SPI stage.
+ *
+ * A producer reads blocks (sending the bus's fill value), a consumer writes
+ * them. `transaction.chip_select`, `hold_chip_select` and `context` are set by
+ * the application; the other transaction fields are managed by the stage.
+ */
+typedef struct DMA_Pipeline_SPI_Stage
+{
+    DMA_SPI_Transaction transaction;    /**< Transaction used for each block (must stay the first member) */
+    DMA_SPI_Bus *bus;                   /**< Initialized SPI bus */
+    DMA_Pipeline *pipeline;             /**< Pipeline the stage reports to */
+    bool producer;                      /**< `true` for a producer, `false` for a consumer */
+} DMA_Pipeline_SPI_Stage;
+
+/**
+ * @brief SDIO consumer stage: writes blocks to consecutive card blocks.
+ *
+ * The pipeline block size must be a multiple of `DMA_SDIO_BLOCK_SIZE`. Writes
+ * are started and stopped, and end while the card is programming, in
+ * `DMA_SDIO_Process`, so the application keeps calling it while the pipeline
+ * runs.
+ */
+typedef struct DMA_Pipeline_SDIO_Stage
+{
+    DMA_SDIO_Request request;           /**< Request used for each block (must stay the first member) */
+    DMA_SDIO_Host *host;                /**< Initialized SDIO host */
+    DMA_Pipeline *pipeline;             /**< Pipeline the stage reports to */
+    uint32_t next_block;                /**< Card block the next pipeline block is written to */
+} DMA_Pipeline_SDIO_Stage;
+
+/**
+ * @brief Starts a DMA stream stage on a block.
+ *
+ * @param[in] block Block to fill or drain.
+ * @param[in] length Number of bytes.
+ * @param[in] context Pointer to a DMA_Pipeline_Stream_Stage structure.
+ *
+ * @return int8_t Returns 1 on success, or -1 on error.
+ */
+int8_t DMA_Pipeline_Stream_Start(uint8_t *block, uint32_t length, void *context);
+
+/**
+ * @brief Releases the stream of an idle DMA stream stage.
+ *
+ * @param[in] stage Pointer to the DMA_Pipeline_Stream_Stage structure.
+ */
+void DMA_Pipeline_Stream_Release(DMA_Pipeline_Stream_Stage *stage);
+
+/**
+ * @brief Starts an SPI stage on a block.
+ *
+ * @param[in] block Block to fill or drain.
+ * @param[in] length Number of bytes.
+ * @param[in] context Pointer to a DMA_Pipeline_SPI_Stage structure.
+ *
+ * @return int8_t Returns 1 on success, or -1 on error.
+ */
+int8_t DMA_Pipeline_SPI_Start(uint8_t *block, uint32_t length, void *context);
+
+/**
+ * @brief Starts an SDIO consumer stage on a block.
+ *
+ * @param[in] block Block to write.
+ * @param[in] length Number of bytes.
+ * @param[in] context Pointer to a DMA_Pipeline_SDIO_Stage structure.
+ *
+ * @return int8_t Returns 1 on success, or -1 on error.
+ */
+int8_t DMA_Pipeline_SDIO_Start(uint8_t *block, uint32_t length, void *context);
+
+#endif /* DMA_PIPELINE_STAGES_H_ */
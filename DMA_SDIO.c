@@ -0,0 +1,583 @@
+/**
+ * @file DMA_SDIO.c
+ * @brief DMA SDIO Block Transfer Layer Implementation for STM32F407VGT6
+ *
+ * This file implements queued multi-block SD card transfers. The stream runs
+ * with the SDIO as flow controller, so the SDIO data length alone decides when
+ * the transfer ends and any number of blocks moves in one command, and with
+ * word transfers in 4-beat bursts through the stream FIFO on both sides, as
+ * the SDIO FIFO requires. A request completes once both the stream (all data
+ * in memory or in the SDIO FIFO) and the SDIO data path (DATAEND) are done;
+ * multi-block commands are then ended with STOP_TRANSMISSION.
+ *
+ * Card commands wait for their response, so they are only issued from
+ * `DMA_SDIO_Process`, never from an interrupt or with interrupts masked.
+ * Submitting to an idle host and ending a transfer in the interrupt only
+ * update the queue state in short critical sections and leave the data
+ * command, STOP_TRANSMISSION and the wait for the card's programming (busy,
+ * D0 held low after a write or a STOP_TRANSMISSION) to `DMA_SDIO_Process`.
+ *
+ * @version 1.0
+ * @date 2024-08-22
+ *
+ * @author Kunal Salvi
+ * @copyright Copyright (c) 2024
+ */
+
+#include "DMA_SDIO.h"
+#include <string.h>
+
+#define DMA_SDIO_PENDING_DMA        (1U << 0)   /**< Stream transfer complete awaited */
+#define DMA_SDIO_PENDING_DATAEND    (1U << 1)   /**< SDIO data end awaited */
+
+#define DMA_SDIO_DATA_ERRORS        (SDIO_STA_DCRCFAIL | SDIO_STA_DTIMEOUT | SDIO_STA_TXUNDERR | SDIO_STA_RXOVERR | SDIO_STA_STBITERR)
+#define DMA_SDIO_DATA_FLAGS         (DMA_SDIO_DATA_ERRORS | SDIO_STA_DATAEND | SDIO_STA_DBCKEND)
+#define DMA_SDIO_DATA_INTERRUPTS    (SDIO_MASK_DATAENDIE | SDIO_MASK_DCRCFAILIE | SDIO_MASK_DTIMEOUTIE | SDIO_MASK_TXUNDERRIE | SDIO_MASK_RXOVERRIE | SDIO_MASK_STBITERRIE)
+
+#define DMA_SDIO_CMD_READ_SINGLE_BLOCK      17
+#define DMA_SDIO_CMD_READ_MULTIPLE_BLOCK    18
+#define DMA_SDIO_CMD_WRITE_BLOCK            24
+#define DMA_SDIO_CMD_WRITE_MULTIPLE_BLOCK   25
+#define DMA_SDIO_CMD_STOP_TRANSMISSION      12
+
+#define DMA_SDIO_D0_PORT            GPIOC       /**< SDIO_D0 is on PC8 on the F407 */
+#define DMA_SDIO_D0_PIN             8U
+
+/**
+ * @brief Reports whether the card holds D0 low to signal programming.
+ *
+ * The input data register follows the pin in alternate function mode too.
+ */
+static bool DMA_SDIO_Card_Busy(void)
+{
+    return (DMA_SDIO_D0_PORT->IDR & (1U << DMA_SDIO_D0_PIN)) == 0;
+}
+
+/**
+ * @brief Reports whether a read is fully held by the read-ahead buffer.
+ */
+static bool DMA_SDIO_Cached(DMA_SDIO_Host *host, uint32_t block, uint16_t count)
+{
+    return (host->cache_count != 0) &&
+           (block >= host->cache_block) &&
+           ((block - host->cache_block) + count <= host->cache_count);
+}
+
+/**
+ * @brief Stops the SDIO data path and the stream.
+ */
+static void DMA_SDIO_Stop_Data(DMA_SDIO_Host *host)
+{
+    DMA_Stream_TypeDef *stream = host->Request.Stream;
+
+    SDIO->DCTRL = 0;
+    SDIO->MASK &= ~DMA_SDIO_DATA_INTERRUPTS;
+    SDIO->ICR = DMA_SDIO_DATA_FLAGS;
+
+    stream->CR &= ~DMA_SxCR_EN;
+    while(stream->CR & DMA_SxCR_EN) {}
+
+    host->pending = 0;
+}
+
+/**
+ * @brief Programs the stream and the SDIO data path and issues the data command.
+ *
+ * For reads the data path is armed before the command so no data is lost;
+ * for writes it is armed once the card has accepted the command.
+ *
+ * @return int8_t 1 if the transfer is running, -1 if the command failed.
+ */
+static int8_t DMA_SDIO_Start(DMA_SDIO_Host *host, DMA_SDIO_Request *request)
+{
+    DMA_Stream_TypeDef *stream = host->Request.Stream;
+    volatile uint32_t *flag_clear;
+    uint32_t flag_mask;
+    uint32_t address = host->high_capacity ? request->block : request->block * DMA_SDIO_BLOCK_SIZE;
+    uint32_t control = (9U << SDIO_DCTRL_DBLOCKSIZE_Pos) | SDIO_DCTRL_DMAEN | SDIO_DCTRL_DTEN;
+    bool multiple = (request->count > 1);
+    int8_t status;
+
+    // The SDIO is the flow controller: NDTR is not used and the stream ends on the SDIO's last request
+    stream->CR = ((uint32_t)host->Request.channel << DMA_SxCR_CHSEL_Pos) |
+                 (request->write ? DMA_Configuration.Transfer_Direction.Memory_to_peripheral : DMA_Configuration.Transfer_Direction.Peripheral_to_memory) |
+                 DMA_Configuration.Flow_Control.Peripheral_Control |
+                 host->priority_level |
+                 DMA_Configuration.Memory_Data_Size.word |
+                 DMA_Configuration.Peripheral_Data_Size.word |
+                 DMA_Configuration.Memory_Pointer_Increment.Enable |
+                 DMA_SxCR_MBURST_0 |
+                 DMA_SxCR_PBURST_0 |
+                 DMA_Configuration.DMA_Interrupts.Transfer_Complete |
+                 DMA_Configuration.DMA_Interrupts.Transfer_Error;
+    stream->FCR = DMA_SxFCR_DMDIS | DMA_SxFCR_FTH;
+    stream->PAR = (uint32_t)&(SDIO->FIFO);
+    stream->M0AR = (uint32_t)request->buffer;
+
+    flag_clear = DMA_Flag_Clear_Register(stream, &flag_mask);
+    *flag_clear = flag_mask;
+
+    SDIO->ICR = DMA_SDIO_DATA_FLAGS;
+    SDIO->DTIMER = host->data_timeout;
+    SDIO->DLEN = (uint32_t)request->count * DMA_SDIO_BLOCK_SIZE;
+    SDIO->MASK |= DMA_SDIO_DATA_INTERRUPTS;
+
+    host->pending = DMA_SDIO_PENDING_DMA | DMA_SDIO_PENDING_DATAEND;
+    stream->CR |= DMA_SxCR_EN;
+
+    if(!request->write)
+    {
+        SDIO->DCTRL = control | SDIO_DCTRL_DTDIR;
+        status = host->command(multiple ? DMA_SDIO_CMD_READ_MULTIPLE_BLOCK : DMA_SDIO_CMD_READ_SINGLE_BLOCK, address, host->context);
+    }
+    else
+    {
+        status = host->command(multiple ? DMA_SDIO_CMD_WRITE_MULTIPLE_BLOCK : DMA_SDIO_CMD_WRITE_BLOCK, address, host->context);
+        if(status == 1)
+        {
+            SDIO->DCTRL = control;
+        }
+    }
+
+    if(status != 1)
+    {
+        DMA_SDIO_Stop_Data(host);
+        return -1;
+    }
+
+    return 1;
+}
+
+/**
+ * @brief Removes the active request from the queue and reports its result.
+ */
+static void DMA_SDIO_Finish(DMA_SDIO_Host *host, int8_t status)
+{
+    DMA_SDIO_Request *request = host->head;
+    uint32_t primask;
+
+    // Submit appends to the queue from any context
+    primask = __get_PRIMASK();
+    __disable_irq();
+
+    host->head = request->next;
+    if(host->head == NULL)
+    {
+        host->tail = NULL;
+    }
+
+    // A write submitted meanwhile may have changed the prefetched blocks
+    if((request == &host->prefetch) && (status == 1) && (host->prefetch_generation == host->cache_generation))
+    {
+        host->cache_block = request->block;
+        host->cache_count = request->count;
+    }
+
+    __set_PRIMASK(primask);
+
+    if(request == &host->prefetch)
+    {
+        return;
+    }
+
+    if(status == 1) host->completed++;
+    else host->errors++;
+
+    if(!request->write && (status == 1))
+    {
+        host->read_ahead_armed = true;
+        host->read_ahead_next = request->block + request->count;
+    }
+
+    request->status = status;
+    if(request->complete != NULL)
+    {
+        request->complete(request);
+    }
+}
+
+/**
+ * @brief Starts queued requests until one runs on the card, then reads ahead when idle.
+ *
+ * Reads held by the read-ahead buffer are completed by copying, without using
+ * the card. Called from `DMA_SDIO_Process` only, with interrupts enabled;
+ * requests submitted meanwhile, also from completion callbacks, are only
+ * queued and picked up here.
+ */
+static void DMA_SDIO_Start_Next(DMA_SDIO_Host *host)
+{
+    DMA_SDIO_Request *request;
+    uint32_t primask;
+
+    for(;;)
+    {
+        request = host->head;
+
+        if(request != NULL)
+        {
+            if(!request->write && DMA_SDIO_Cached(host, request->block, request->count))
+            {
+                memcpy(request->buffer,
+                       host->read_ahead_buffer + (request->block - host->cache_block) * DMA_SDIO_BLOCK_SIZE,
+                       (uint32_t)request->count * DMA_SDIO_BLOCK_SIZE);
+                host->cache_hits++;
+                DMA_SDIO_Finish(host, 1);
+            }
+            else if(DMA_SDIO_Start(host, request) == 1)
+            {
+                return;
+            }
+            else
+            {
+                DMA_SDIO_Finish(host, -1);
+            }
+            continue;
+        }
+
+        primask = __get_PRIMASK();
+        __disable_irq();
+
+        if(host->head != NULL)
+        {
+            // Submitted after the check above
+            __set_PRIMASK(primask);
+            continue;
+        }
+
+        if(host->read_ahead_armed && (host->read_ahead_blocks != 0) && (host->read_ahead_buffer != NULL) &&
+           !DMA_SDIO_Cached(host, host->read_ahead_next, 1))
+        {
+            host->read_ahead_armed = false;
+
+            host->prefetch.block = host->read_ahead_next;
+            host->prefetch.count = host->read_ahead_blocks;
+            host->prefetch.buffer = host->read_ahead_buffer;
+            host->prefetch.write = false;
+            host->prefetch.complete = NULL;
+            host->prefetch.next = NULL;
+
+            host->cache_count = 0;
+            host->prefetch_generation = host->cache_generation;
+            host->head = &host->prefetch;
+            host->tail = &host->prefetch;
+
+            __set_PRIMASK(primask);
+
+            if(DMA_SDIO_Start(host, &host->prefetch) == 1)
+            {
+                return;
+            }
+            DMA_SDIO_Finish(host, -1);
+            continue;
+        }
+
+        host->read_ahead_armed = false;
+        host->active = false;
+
+        __set_PRIMASK(primask);
+        return;
+    }
+}
+
+/**
+ * @brief Stops the ended request and finishes it once the card has left the busy state.
+ *
+ * Sends STOP_TRANSMISSION for a multi-block command first, once. While D0 is
+ * low the request stays at the head of the queue, marked as `stopping`,
+ * until `DMA_SDIO_Process` calls this again.
+ */
+static void DMA_SDIO_Resume(DMA_SDIO_Host *host)
+{
+    // Multi-block commands run until stopped, also after an error
+    if(host->stop_command)
+    {
+        host->stop_command = false;
+        if(host->command(DMA_SDIO_CMD_STOP_TRANSMISSION, 0, host->context) != 1)
+        {
+            host->stop_status = -1;
+        }
+    }
+
+    if(DMA_SDIO_Card_Busy())
+    {
+        host->stopping = true;
+        return;
+    }
+
+    DMA_SDIO_Finish(host, host->stop_status);
+    DMA_SDIO_Start_Next(host);
+}
+
+/**
+ * @brief Ends the data transfer of the active request.
+ *
+ * Called from the interrupts. STOP_TRANSMISSION, the programming time that
+ * follows and the start of the next request are left to `DMA_SDIO_Process`.
+ *
+ * @param[in] host Pointer to the host.
+ * @param[in] status 1 for a completed transfer, -1 for an error.
+ */
+static void DMA_SDIO_Complete(DMA_SDIO_Host *host, int8_t status)
+{
+    DMA_SDIO_Stop_Data(host);
+
+    host->stop_command = (host->head->count > 1);
+    host->stop_status = status;
+    host->stopping = true;
+}
+
+/**
+ * @brief Records a completion event of the active request; completes it when none is left.
+ */
+static void DMA_SDIO_Event(DMA_SDIO_Host *host, uint8_t event)
+{
+    uint32_t primask = __get_PRIMASK();
+    bool done = false;
+
+    __disable_irq();
+    if(host->pending & event)
+    {
+        host->pending &= (uint8_t)~event;
+        done = (host->pending == 0);
+    }
+    __set_PRIMASK(primask);
+
+    if(done)
+    {
+        DMA_SDIO_Complete(host, 1);
+    }
+}
+
+/**
+ * @brief Stream event callback.
+ *
+ * FIFO errors are not treated as failures: with the SDIO as flow controller
+ * the SDIO's own underrun/overrun flags report lost data.
+ */
+static void DMA_SDIO_Callback(DMA_Stream_TypeDef *stream, uint32_t event, void *context)
+{
+    DMA_SDIO_Host *host = (DMA_SDIO_Host *)context;
+
+    (void)stream;
+
+    if(event == DMA_Configuration.DMA_Interrupts.Transfer_Complete)
+    {
+        DMA_SDIO_Event(host, DMA_SDIO_PENDING_DMA);
+    }
+    else if((event == DMA_Configuration.DMA_Interrupts.Transfer_Error) && (host->pending != 0))
+    {
+        DMA_SDIO_Complete(host, -1);
+    }
+}
+
+/**
+ * @brief Initializes the SDIO block transfer layer.
+ *
+ * This function claims the stream, registers its callback and enables the
+ * stream and SDIO interrupts. The SDIO clock, bus width and the card itself
+ * are initialized by the application, which calls `DMA_SDIO_IRQ_Handler` from
+ * `SDIO_IRQHandler`.
+ *
+ * @param[in] host Pointer to the `DMA_SDIO_Host` structure.
+ *
+ * @return int8_t Returns 1 on success, or -1 if the stream is already claimed or no command hook is set.
+ */
+int8_t DMA_SDIO_Init(DMA_SDIO_Host *host)
+{
+    if((host->command == NULL) || (DMA_Stream_Claim(host->Request.Stream) != 1))
+    {
+        return -1;
+    }
+
+    host->head = NULL;
+    host->tail = NULL;
+    host->active = false;
+    host->starting = false;
+    host->stopping = false;
+    host->stop_command = false;
+    host->pending = 0;
+    host->read_ahead_armed = false;
+    host->cache_count = 0;
+    host->cache_generation = 0;
+    host->completed = 0;
+    host->errors = 0;
+    host->cache_hits = 0;
+
+    DMA_Register_Callback(host->Request.Stream, DMA_SDIO_Callback, host);
+    DMA_Stream_IRQ_Enable(host->Request.Stream);
+    NVIC_EnableIRQ(SDIO_IRQn);
+
+    return 1;
+}
+
+/**
+ * @brief Releases the stream of an idle SDIO host.
+ *
+ * @param[in] host Pointer to the `DMA_SDIO_Host` structure.
+ */
+void DMA_SDIO_Deinit(DMA_SDIO_Host *host)
+{
+    SDIO->MASK &= ~DMA_SDIO_DATA_INTERRUPTS;
+
+    DMA_Register_Callback(host->Request.Stream, NULL, NULL);
+    DMA_Stream_Release(host->Request.Stream);
+}
+
+/**
+ * @brief Queues a block request; it is started by the next `DMA_SDIO_Process`.
+ *
+ * Safe to call from tasks and from interrupts, including from a request's
+ * `complete` callback, as no card command is issued here. The request is
+ * queued with interrupts masked; if the card was idle the queue is marked for
+ * `DMA_SDIO_Process` to start, where a read held by the read-ahead buffer
+ * also completes. Submitting a write discards the read-ahead buffer.
+ *
+ * @param[in] host Pointer to the `DMA_SDIO_Host` structure.
+ * @param[in] request Pointer to the request; must stay valid until it completes.
+ *
+ * @return int8_t Returns 1 if the request was queued, or -1 if it is invalid.
+ */
+int8_t DMA_SDIO_Submit(DMA_SDIO_Host *host, DMA_SDIO_Request *request)
+{
+    uint32_t primask;
+
+    if((request->count == 0) || (request->buffer == NULL) || (((uint32_t)request->buffer & 3U) != 0))
+    {
+        return -1;
+    }
+
+    request->status = 0;
+    request->next = NULL;
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+
+    if(request->write)
+    {
+        host->cache_count = 0;
+        host->cache_generation++;
+    }
+
+    if(host->tail != NULL)
+    {
+        host->tail->next = request;
+    }
+    else
+    {
+        host->head = request;
+    }
+    host->tail = request;
+
+    // The submission that finds the card idle hands the queue to DMA_SDIO_Process
+    if(!host->active)
+    {
+        host->active = true;
+        host->starting = true;
+    }
+
+    __set_PRIMASK(primask);
+
+    return 1;
+}
+
+/**
+ * @brief Queues a block request and waits for it to complete.
+ *
+ * @param[in] host Pointer to the `DMA_SDIO_Host` structure.
+ * @param[in] request Pointer to the request.
+ *
+ * @return int8_t Returns 1 on success, or -1 if the request was invalid or failed.
+ */
+int8_t DMA_SDIO_Transfer(DMA_SDIO_Host *host, DMA_SDIO_Request *request)
+{
+    if(DMA_SDIO_Submit(host, request) != 1)
+    {
+        return -1;
+    }
+
+    while(request->status == 0)
+    {
+        DMA_SDIO_Process(host);
+    }
+
+    return request->status;
+}
+
+/**
+ * @brief Reports whether the host has an active or queued request.
+ *
+ * @param[in] host Pointer to the `DMA_SDIO_Host` structure.
+ *
+ * @return bool `true` while requests (including a read-ahead) are pending.
+ */
+bool DMA_SDIO_Busy(DMA_SDIO_Host *host)
+{
+    return host->active;
+}
+
+/**
+ * @brief Issues the card commands of the queue: starts requests and stops ended ones.
+ *
+ * Starts the queue after a submission to an idle host. Once a transfer has
+ * ended in the interrupt, sends STOP_TRANSMISSION for a multi-block command
+ * and checks D0 once per call; when the card has left the busy state after a
+ * write or STOP_TRANSMISSION, which can take milliseconds, the request is
+ * completed and the next one started. Call it from the main loop, a task or a
+ * low-priority periodic interrupt while `DMA_SDIO_Busy` reports work; it
+ * returns immediately otherwise. The command hook is only called from here.
+ *
+ * @param[in] host Pointer to the `DMA_SDIO_Host` structure.
+ */
+void DMA_SDIO_Process(DMA_SDIO_Host *host)
+{
+    uint32_t primask;
+    bool starting;
+    bool stopping;
+
+    // Only one caller takes the deferred work
+    primask = __get_PRIMASK();
+    __disable_irq();
+    starting = host->starting;
+    host->starting = false;
+    stopping = host->stopping;
+    host->stopping = false;
+    __set_PRIMASK(primask);
+
+    if(stopping)
+    {
+        DMA_SDIO_Resume(host);
+    }
+    else if(starting)
+    {
+        DMA_SDIO_Start_Next(host);
+    }
+}
+
+/**
+ * @brief Handles the SDIO data path interrupt; call from `SDIO_IRQHandler`.
+ *
+ * A data error ends the active request with an error; DATAEND is one of the
+ * two events that complete it.
+ *
+ * @param[in] host Pointer to the `DMA_SDIO_Host` structure.
+ */
+void DMA_SDIO_IRQ_Handler(DMA_SDIO_Host *host)
+{
+    uint32_t status = SDIO->STA;
+
+    if(status & DMA_SDIO_DATA_ERRORS)
+    {
+        SDIO->ICR = DMA_SDIO_DATA_FLAGS;
+        if(host->pending != 0)
+        {
+            DMA_SDIO_Complete(host, -1);
+        }
+        return;
+    }
+
+    if(status & SDIO_STA_DATAEND)
+    {
+        SDIO->ICR = SDIO_ICR_DATAENDC;
+        DMA_SDIO_Event(host, DMA_SDIO_PENDING_DATAEND);
+    }
+}
@@ -0,0 +1,147 @@
+/**
+ * @file DMA_SDIO.h
+ * @author Kunal Salvi
+ * @brief Header file for the DMA SDIO block transfer layer.
+ *
+ * This file contains the data structures and function prototypes for reading
+ * and writing 512-byte SD card blocks through the SDIO data path. Transfers run
+ * with the SDIO as the flow controller and 4-beat FIFO bursts on both sides,
+ * so any number of blocks moves in one multi-block command. Requests are
+ * queued and completed asynchronously; sequential reads can be served from a
+ * read-ahead buffer that is refilled while the card is otherwise idle.
+ *
+ * The card protocol (initialization, command/response handling) stays with
+ * the application, which provides a command hook. The layer polls the card's
+ * busy signal on D0 itself. Commands wait for their response, so requests are
+ * started and stopped by `DMA_SDIO_Process`, called outside the DMA and SDIO
+ * interrupts; the interrupts only move the data.
+ *
+ * @version 1.0
+ * @date 2024-08-22
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef DMA_SDIO_H_
+#define DMA_SDIO_H_
+
+#include "DMA.h"
+
+#define DMA_SDIO_BLOCK_SIZE     512     /**< Bytes per SD card block */
+
+/**
+ * @brief SDIO block request structure.
+ *
+ * The buffer must be word aligned. The structure is owned by the layer from
+ * submission until `status` leaves 0.
+ */
+typedef struct DMA_SDIO_Request
+{
+    uint32_t block;                     /**< First block number */
+    uint16_t count;                     /**< Number of blocks */
+    uint8_t *buffer;                    /**< Data, `count * DMA_SDIO_BLOCK_SIZE` bytes */
+    bool write;                         /**< `true` to write the buffer to the card, `false` to read into it */
+    void (*complete)(struct DMA_SDIO_Request *request); /**< Called on completion, usually from an interrupt (optional) */
+    void *context;                      /**< User pointer for the callback */
+    volatile int8_t status;             /**< 0 while pending, 1 when complete, -1 on error */
+    struct DMA_SDIO_Request *next;      /**< Queue link, managed by the layer */
+} DMA_SDIO_Request;
+
+/**
+ * @brief SDIO host structure.
+ *
+ * The fields in the first group are set by the application before calling
+ * `DMA_SDIO_Init`. The remaining fields are managed by the layer.
+ */
+typedef struct DMA_SDIO_Host
+{
+    DMA_Request Request;                /**< SDIO request (`DMA_Configuration.Request.SDIO_RXTX`) */
+    uint32_t priority_level;            /**< Priority level of the stream */
+    uint32_t data_timeout;              /**< Data timeout in card bus clock cycles (SDIO_DTIMER) */
+    bool high_capacity;                 /**< Card is addressed in blocks (SDHC/SDXC) rather than bytes */
+    int8_t (*command)(uint8_t index, uint32_t argument, void *context); /**< Sends a command and waits for its response only, not for busy; returns 1 on success. Called from `DMA_SDIO_Process` only, never with interrupts masked by the layer */
+    void *context;                      /**< User pointer for the command hook */
+    uint8_t *read_ahead_buffer;         /**< Word-aligned buffer of `read_ahead_blocks` blocks, or NULL */
+    uint16_t read_ahead_blocks;         /**< Blocks read ahead after a sequential read (0 disables read-ahead) */
+
+    DMA_SDIO_Request *volatile head;    /**< Active request, followed by the queued ones */
+    DMA_SDIO_Request *tail;             /**< Last queued request */
+    DMA_SDIO_Request prefetch;          /**< Internal read-ahead request */
+    volatile bool active;               /**< A request is being started or is running on the card */
+    volatile bool starting;             /**< The queue waits for `DMA_SDIO_Process` to start it */
+    volatile bool stopping;             /**< The active request has ended and waits for its stop and for the card to leave busy */
+    bool stop_command;                  /**< STOP_TRANSMISSION is still to be sent for the ended request */
+    int8_t stop_status;                 /**< Result of the request waiting in `stopping` */
+    volatile uint8_t pending;           /**< Completion events still awaited by the active request */
+    bool read_ahead_armed;              /**< A read has completed and the next blocks may be prefetched */
+    uint32_t read_ahead_next;           /**< Block following the last read */
+    uint32_t cache_block;               /**< First block held by the read-ahead buffer */
+    uint16_t cache_count;               /**< Blocks held by the read-ahead buffer (0 when empty) */
+    uint32_t cache_generation;          /**< Incremented by writes, to discard stale prefetches */
+    uint32_t prefetch_generation;       /**< Generation the active prefetch was started in */
+    uint32_t completed;                 /**< Number of completed requests */
+    uint32_t errors;                    /**< Number of failed requests */
+    uint32_t cache_hits;                /**< Number of reads served from the read-ahead buffer */
+} DMA_SDIO_Host;
+
+/**
+ * @brief Initializes the SDIO block transfer layer.
+ *
+ * @param[in] host Pointer to the DMA_SDIO_Host structure.
+ *
+ * @return int8_t Returns 1 on success, or -1 if the stream is already claimed or no command hook is set.
+ */
+int8_t DMA_SDIO_Init(DMA_SDIO_Host *host);
+
+/**
+ * @brief Releases the stream of an idle SDIO host.
+ *
+ * @param[in] host Pointer to the DMA_SDIO_Host structure.
+ */
+void DMA_SDIO_Deinit(DMA_SDIO_Host *host);
+
+/**
+ * @brief Queues a block request; it is started by the next `DMA_SDIO_Process`.
+ *
+ * @param[in] host Pointer to the DMA_SDIO_Host structure.
+ * @param[in] request Pointer to the request; must stay valid until it completes.
+ *
+ * @return int8_t Returns 1 if the request was queued, or -1 if it is invalid.
+ */
+int8_t DMA_SDIO_Submit(DMA_SDIO_Host *host, DMA_SDIO_Request *request);
+
+/**
+ * @brief Queues a block request and waits for it to complete.
+ *
+ * @param[in] host Pointer to the DMA_SDIO_Host structure.
+ * @param[in] request Pointer to the request.
+ *
+ * @return int8_t Returns 1 on success, or -1 on error.
+ */
+int8_t DMA_SDIO_Transfer(DMA_SDIO_Host *host, DMA_SDIO_Request *request);
+
+/**
+ * @brief Reports whether the host has an active or queued request.
+ *
+ * @param[in] host Pointer to the DMA_SDIO_Host structure.
+ *
+ * @return bool `true` while requests (including a read-ahead) are pending.
+ */
+bool DMA_SDIO_Busy(DMA_SDIO_Host *host);
+
+/**
+ * @brief Issues the card commands of the queue: starts requests and stops ended ones.
+ *
+ * @param[in] host Pointer to the DMA_SDIO_Host structure.
+ */
+void DMA_SDIO_Process(DMA_SDIO_Host *host);
+
+/**
+ * @brief Handles the SDIO data path interrupt; call from `SDIO_IRQHandler`.
+ *
+ * @param[in] host Pointer to the DMA_SDIO_Host structure.
+ */
+void DMA_SDIO_IRQ_Handler(DMA_SDIO_Host *host);
+
+#endif /* DMA_SDIO_H_ */
@@ -0,0 +1,373 @@
+/**
+ * @file DMA_SPI.c
+ * @brief DMA SPI Transaction Engine Implementation for STM32F407VGT6
+ *
+ * This file implements queued full-duplex SPI transactions on a claimed pair
+ * of RX/TX DMA streams. The stream control registers are written once at
+ * initialization; starting a transaction only clears the stream flags and
+ * reloads M0AR and NDTR of both streams. RX is always enabled before TX so no
+ * received byte can be missed, and a transaction completes on the RX
+ * transfer complete interrupt, after the last byte has been clocked in. A
+ * transfer error on either stream stops both and drains the SPI before the
+ * next queued transaction is started.
+ *
+ * @version 1.0
+ * @date 2024-08-22
+ *
+ * @author Kunal Salvi
+ * @copyright Copyright (c) 2024
+ */
+
+#include "DMA_SPI.h"
+
+/**
+ * @brief Starts a transaction on the bus.
+ *
+ * Called with the queue protected, either with interrupts masked or from the
+ * RX stream interrupt.
+ */
+static void DMA_SPI_Start(DMA_SPI_Bus *bus, DMA_SPI_Transaction *transaction)
+{
+    DMA_Stream_TypeDef *rx = bus->RX_Request.Stream;
+    DMA_Stream_TypeDef *tx = bus->TX_Request.Stream;
+
+    if(transaction->chip_select != NULL)
+    {
+        transaction->chip_select(true, transaction->context);
+    }
+
+    // Clear the flags of both streams, in one write when they share a register
+    *bus->rx_flag_clear = bus->rx_flag_mask;
+    if(bus->tx_flag_clear != NULL)
+    {
+        *bus->tx_flag_clear = bus->tx_flag_mask;
+    }
+
+    // A missing buffer is replaced by the bus's dummy byte with memory increment off,
+    // so reads need no TX buffer and writes no RX buffer, whatever the length
+    if(transaction->rx_buffer != NULL)
+    {
+        rx->CR |= DMA_SxCR_MINC;
+        rx->M0AR = (uint32_t)transaction->rx_buffer;
+    }
+    else
+    {
+        rx->CR &= ~DMA_SxCR_MINC;
+        rx->M0AR = (uint32_t)&bus->dummy_rx;
+    }
+    rx->NDTR = transaction->length;
+
+    if(transaction->tx_buffer != NULL)
+    {
+        tx->CR |= DMA_SxCR_MINC;
+        tx->M0AR = (uint32_t)transaction->tx_buffer;
+    }
+    else
+    {
+        tx->CR &= ~DMA_SxCR_MINC;
+        tx->M0AR = (uint32_t)&bus->fill_value;
+    }
+    tx->NDTR = transaction->length;
+
+    // Arm RX before TX so the first received byte always finds its request serviced
+    rx->CR |= DMA_SxCR_EN;
+    tx->CR |= DMA_SxCR_EN;
+}
+
+/**
+ * @brief Ends the active transaction and starts the next queued one.
+ *
+ * @param[in] bus Pointer to the bus.
+ * @param[in] status 1 for a completed transaction, -1 for a transfer error.
+ */
+static void DMA_SPI_Finish(DMA_SPI_Bus *bus, int8_t status)
+{
+    DMA_SPI_Transaction *transaction = bus->head;
+    bool start_next;
+
+    if(transaction == NULL)
+    {
+        return;
+    }
+
+    bus->head = transaction->next;
+    if(bus->head == NULL)
+    {
+        bus->tail = NULL;
+    }
+
+    // A transaction submitted from the callback onto an empty queue is started by DMA_SPI_Submit
+    start_next = (bus->head != NULL);
+
+    if((transaction->chip_select != NULL) && (!transaction->hold_chip_select || (status != 1)))
+    {
+        transaction->chip_select(false, transaction->context);
+    }
+
+    if(status == 1) bus->completed++;
+    else bus->errors++;
+
+    transaction->status = status;
+    if(transaction->complete != NULL)
+    {
+        transaction->complete(transaction);
+    }
+
+    if(start_next)
+    {
+        DMA_SPI_Start(bus, bus->head);
+    }
+}
+
+/**
+ * @brief Stops both streams after a transfer error and leaves the bus ready for the next transaction.
+ *
+ * M0AR, NDTR and MINC can only be written once EN reads 0, so both streams are
+ * waited for before their flags are cleared. The byte still shifting out is
+ * let finish, and DR and SR are read to clear RXNE and OVR, so the next
+ * transaction does not receive stale data.
+ */
+static void DMA_SPI_Abort(DMA_SPI_Bus *bus)
+{
+    DMA_Stream_TypeDef *rx = bus->RX_Request.Stream;
+    DMA_Stream_TypeDef *tx = bus->TX_Request.Stream;
+
+    tx->CR &= ~DMA_SxCR_EN;
+    rx->CR &= ~DMA_SxCR_EN;
+    while((tx->CR & DMA_SxCR_EN) || (rx->CR & DMA_SxCR_EN)) {}
+
+    *bus->rx_flag_clear = bus->rx_flag_mask;
+    if(bus->tx_flag_clear != NULL)
+    {
+        *bus->tx_flag_clear = bus->tx_flag_mask;
+    }
+
+    while(bus->SPI->SR & SPI_SR_BSY) {}
+    (void)bus->SPI->DR;
+    (void)bus->SPI->SR;
+}
+
+/**
+ * @brief RX stream event callback: completes the transaction on transfer complete.
+ */
+static void DMA_SPI_RX_Callback(DMA_Stream_TypeDef *stream, uint32_t event, void *context)
+{
+    DMA_SPI_Bus *bus = (DMA_SPI_Bus *)context;
+
+    (void)stream;
+
+    if(event == DMA_Configuration.DMA_Interrupts.Transfer_Complete)
+    {
+        DMA_SPI_Finish(bus, 1);
+    }
+    else if(event == DMA_Configuration.DMA_Interrupts.Transfer_Error)
+    {
+        DMA_SPI_Abort(bus);
+        DMA_SPI_Finish(bus, -1);
+    }
+}
+
+/**
+ * @brief TX stream event callback: aborts the transaction on a transfer error.
+ *
+ * Without this the RX stream would never complete after a TX error.
+ */
+static void DMA_SPI_TX_Callback(DMA_Stream_TypeDef *stream, uint32_t event, void *context)
+{
+    DMA_SPI_Bus *bus = (DMA_SPI_Bus *)context;
+
+    (void)stream;
+
+    if(event == DMA_Configuration.DMA_Interrupts.Transfer_Error)
+    {
+        DMA_SPI_Abort(bus);
+        DMA_SPI_Finish(bus, -1);
+    }
+}
+
+/**
+ * @brief Initializes an SPI bus for DMA transactions.
+ *
+ * This function claims the RX and TX streams, configures them once for byte
+ * transfers with memory increment (RX peripheral-to-memory with transfer
+ * complete and error interrupts, TX memory-to-peripheral with the error
+ * interrupt), looks up their flag clear registers and enables the SPI DMA
+ * requests. The SPI peripheral itself is configured and enabled by the
+ * application.
+ *
+ * @param[in] bus Pointer to the `DMA_SPI_Bus` structure.
+ *
+ * @return int8_t Returns 1 on success, or -1 if one of the streams is already claimed.
+ */
+int8_t DMA_SPI_Init(DMA_SPI_Bus *bus)
+{
+    DMA_Config rx_config;
+    DMA_Config tx_config;
+
+    if(DMA_Stream_Claim(bus->RX_Request.Stream) != 1)
+    {
+        return -1;
+    }
+    if(DMA_Stream_Claim(bus->TX_Request.Stream) != 1)
+    {
+        DMA_Stream_Release(bus->RX_Request.Stream);
+        return -1;
+    }
+
+    rx_config.Request = bus->RX_Request;
+    rx_config.flow_control = DMA_Configuration.Flow_Control.DMA_Control;
+    rx_config.transfer_direction = DMA_Configuration.Transfer_Direction.Peripheral_to_memory;
+    rx_config.priority_level = bus->priority_level;
+    rx_config.circular_mode = DMA_Configuration.Circular_Mode.Disable;
+    rx_config.interrupts = DMA_Configuration.DMA_Interrupts.Transfer_Complete;
+    rx_config.memory_pointer_increment = DMA_Configuration.Memory_Pointer_Increment.Enable;
+    rx_config.peripheral_pointer_increment = DMA_Configuration.Peripheral_Pointer_Increment.Disable;
+    rx_config.peripheral_data_size = DMA_Configuration.Peripheral_Data_Size.byte;
+    rx_config.memory_data_size = DMA_Configuration.Memory_Data_Size.byte;
+    rx_config.peripheral_address = (uint32_t)&(bus->SPI->DR);
+    rx_config.memory_address = 0;
+    rx_config.buffer_length = 0;
+
+    tx_config = rx_config;
+    tx_config.Request = bus->TX_Request;
+    tx_config.transfer_direction = DMA_Configuration.Transfer_Direction.Memory_to_peripheral;
+    tx_config.interrupts = DMA_Configuration.DMA_Interrupts.Transfer_Error;
+
+    bus->head = NULL;
+    bus->tail = NULL;
+    bus->completed = 0;
+    bus->errors = 0;
+
+    // Start both streams from a clean control register
+    bus->RX_Request.Stream->CR = 0;
+    bus->TX_Request.Stream->CR = 0;
+
+    DMA_Register_Callback(bus->RX_Request.Stream, DMA_SPI_RX_Callback, bus);
+    DMA_Register_Callback(bus->TX_Request.Stream, DMA_SPI_TX_Callback, bus);
+
+    DMA_Init(&rx_config);
+    DMA_Init(&tx_config);
+    bus->RX_Request.Stream->CR |= DMA_Configuration.DMA_Interrupts.Transfer_Error;
+    bus->RX_Request.Stream->PAR = rx_config.peripheral_address;
+    bus->TX_Request.Stream->PAR = tx_config.peripheral_address;
+
+    bus->rx_flag_clear = DMA_Flag_Clear_Register(bus->RX_Request.Stream, &bus->rx_flag_mask);
+    bus->tx_flag_clear = DMA_Flag_Clear_Register(bus->TX_Request.Stream, &bus->tx_flag_mask);
+    if(bus->tx_flag_clear == bus->rx_flag_clear)
+    {
+        bus->rx_flag_mask |= bus->tx_flag_mask;
+        bus->tx_flag_clear = NULL;
+    }
+
+    bus->SPI->CR2 |= SPI_CR2_RXDMAEN | SPI_CR2_TXDMAEN;
+
+    return 1;
+}
+
+/**
+ * @brief Releases the streams of an idle SPI bus.
+ *
+ * Disables the SPI DMA requests, removes the stream callbacks, drops the
+ * clock references of both streams and releases them. Pending transactions
+ * must have completed.
+ *
+ * @param[in] bus Pointer to the `DMA_SPI_Bus` structure.
+ */
+void DMA_SPI_Deinit(DMA_SPI_Bus *bus)
+{
+    DMA_Config config;
+
+    bus->SPI->CR2 &= ~(SPI_CR2_RXDMAEN | SPI_CR2_TXDMAEN);
+
+    DMA_Register_Callback(bus->RX_Request.Stream, NULL, NULL);
+    DMA_Register_Callback(bus->TX_Request.Stream, NULL, NULL);
+
+    // Drop the clock references taken by DMA_Init
+    config.Request = bus->RX_Request;
+    DMA_Clock_Disable(&config);
+    config.Request = bus->TX_Request;
+    DMA_Clock_Disable(&config);
+
+    DMA_Stream_Release(bus->RX_Request.Stream);
+    DMA_Stream_Release(bus->TX_Request.Stream);
+}
+
+/**
+ * @brief Queues a transaction; it starts immediately if the bus is idle.
+ *
+ * Safe to call from tasks and from interrupts, including from a transaction's
+ * `complete` callback. Queued transactions are started back-to-back from the
+ * RX stream interrupt without returning to the caller.
+ *
+ * Either buffer may be NULL. Without a TX buffer the bus's `fill_value` is sent
+ * for every byte (a read); without an RX buffer the received bytes are
+ * discarded (a write).
+ *
+ * @param[in] bus Pointer to the `DMA_SPI_Bus` structure.
+ * @param[in] transaction Pointer to the transaction; must stay valid until it completes.
+ *
+ * @return int8_t Returns 1 if the transaction was queued, or -1 if it is invalid.
+ */
+int8_t DMA_SPI_Submit(DMA_SPI_Bus *bus, DMA_SPI_Transaction *transaction)
+{
+    uint32_t primask;
+
+    if(transaction->length == 0)
+    {
+        return -1;
+    }
+
+    transaction->status = 0;
+    transaction->next = NULL;
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+
+    if(bus->tail != NULL)
+    {
+        bus->tail->next = transaction;
+        bus->tail = transaction;
+    }
+    else
+    {
+        bus->head = transaction;
+        bus->tail = transaction;
+        DMA_SPI_Start(bus, transaction);
+    }
+
+    __set_PRIMASK(primask);
+
+    return 1;
+}
+
+/**
+ * @brief Queues a transaction and waits for it to complete.
+ *
+ * @param[in] bus Pointer to the `DMA_SPI_Bus` structure.
+ * @param[in] transaction Pointer to the transaction.
+ *
+ * @return int8_t Returns 1 on success, or -1 if the transaction was invalid or ended with an error.
+ */
+int8_t DMA_SPI_Transfer(DMA_SPI_Bus *bus, DMA_SPI_Transaction *transaction)
+{
+    if(DMA_SPI_Submit(bus, transaction) != 1)
+    {
+        return -1;
+    }
+
+    while(transaction->status == 0) {}
+
+    return transaction->status;
+}
+
+/**
+ * @brief Reports whether the bus has an active or queued transaction.
+ *
+ * @param[in] bus Pointer to the `DMA_SPI_Bus` structure.
+ *
+ * @return bool `true` while transactions are pending.
+ */
+bool DMA_SPI_Busy(DMA_SPI_Bus *bus)
+{
+    return bus->head != NULL;
+}
@@ -0,0 +1,114 @@
+/**
+ * @file DMA_SPI.h
+ * @author Kunal Salvi
+ * @brief Header file for the DMA SPI transaction engine.
+ *
+ * This file contains the data structures and function prototypes for running
+ * full-duplex SPI transfers on a pair of RX/TX DMA streams. A bus claims both
+ * streams once; each transaction then only reloads the buffer addresses and
+ * lengths, arms RX before TX and completes on the RX transfer complete
+ * interrupt. Transactions are queued and started back-to-back from the
+ * interrupt, with an optional chip-select hook per transaction.
+ *
+ * @version 1.0
+ * @date 2024-08-22
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef DMA_SPI_H_
+#define DMA_SPI_H_
+
+#include "DMA.h"
+
+/**
+ * @brief SPI transaction structure.
+ *
+ * A transaction transfers `length` bytes in both directions. The structure is
+ * owned by the engine from submission until `status` leaves 0.
+ */
+typedef struct DMA_SPI_Transaction
+{
+    const uint8_t *tx_buffer;           /**< Bytes to send, or NULL to send the bus's `fill_value` */
+    uint8_t *rx_buffer;                 /**< Buffer for the received bytes, or NULL to discard them */
+    uint16_t length;                    /**< Number of bytes to transfer */
+    void (*chip_select)(bool select, void *context); /**< Asserts (true) or releases (false) the device's chip select (optional) */
+    bool hold_chip_select;              /**< Keep chip select asserted after completion, e.g. between a command and its data phase */
+    void (*complete)(struct DMA_SPI_Transaction *transaction); /**< Called from the DMA interrupt on completion (optional) */
+    void *context;                      /**< User pointer for the callbacks */
+    volatile int8_t status;             /**< 0 while pending, 1 when complete, -1 on a transfer error */
+    struct DMA_SPI_Transaction *next;   /**< Queue link, managed by the engine */
+} DMA_SPI_Transaction;
+
+/**
+ * @brief SPI bus structure.
+ *
+ * The fields in the first group are set by the application before calling
+ * `DMA_SPI_Init`. The remaining fields are managed by the engine.
+ */
+typedef struct DMA_SPI_Bus
+{
+    SPI_TypeDef *SPI;                   /**< SPI peripheral, configured and enabled by the application */
+    DMA_Request RX_Request;             /**< RX stream (e.g. `DMA_Configuration.Request.SPI1_RX`) */
+    DMA_Request TX_Request;             /**< TX stream (e.g. `DMA_Configuration.Request.SPI1_TX`) */
+    uint32_t priority_level;            /**< Priority level of both streams */
+    uint8_t fill_value;                 /**< Byte sent when a transaction has no TX buffer (usually 0xFF) */
+    uint8_t dummy_rx;                   /**< Sink for received bytes when a transaction has no RX buffer */
+
+    DMA_SPI_Transaction *volatile head; /**< Active transaction, followed by the queued ones */
+    DMA_SPI_Transaction *tail;          /**< Last queued transaction */
+    volatile uint32_t *rx_flag_clear;   /**< Flag clear register of the RX stream */
+    volatile uint32_t *tx_flag_clear;   /**< Flag clear register of the TX stream, or NULL if shared with RX */
+    uint32_t rx_flag_mask;              /**< Flags of the RX stream (and the TX stream when the register is shared) */
+    uint32_t tx_flag_mask;              /**< Flags of the TX stream */
+    uint32_t completed;                 /**< Number of completed transactions */
+    uint32_t errors;                    /**< Number of transactions ended by a transfer error */
+} DMA_SPI_Bus;
+
+/**
+ * @brief Initializes an SPI bus for DMA transactions.
+ *
+ * @param[in] bus Pointer to the DMA_SPI_Bus structure.
+ *
+ * @return int8_t Returns 1 on success, or -1 if one of the streams is already claimed.
+ */
+int8_t DMA_SPI_Init(DMA_SPI_Bus *bus);
+
+/**
+ * @brief Releases the streams of an idle SPI bus.
+ *
+ * @param[in] bus Pointer to the DMA_SPI_Bus structure.
+ */
+void DMA_SPI_Deinit(DMA_SPI_Bus *bus);
+
+/**
+ * @brief Queues a transaction; it starts immediately if the bus is idle.
+ *
+ * @param[in] bus Pointer to the DMA_SPI_Bus structure.
+ * @param[in] transaction Pointer to the transaction; must stay valid until it completes.
+ *
+ * @return int8_t Returns 1 if the transaction was queued, or -1 if it is invalid.
+ */
+int8_t DMA_SPI_Submit(DMA_SPI_Bus *bus, DMA_SPI_Transaction *transaction);
+
+/**
+ * @brief Queues a transaction and waits for it to complete.
+ *
+ * @param[in] bus Pointer to the DMA_SPI_Bus structure.
+ * @param[in] transaction Pointer to the transaction.
+ *
+ * @return int8_t Returns 1 on success, or -1 on error.
+ */
+int8_t DMA_SPI_Transfer(DMA_SPI_Bus *bus, DMA_SPI_Transaction *transaction);
+
+/**
+ * @brief Reports whether the bus has an active or queued transaction.
+ *
+ * @param[in] bus Pointer to the DMA_SPI_Bus structure.
+ *
+ * @return bool `true` while transactions are pending.
+ */
+bool DMA_SPI_Busy(DMA_SPI_Bus *bus);
+
+#endif /* DMA_SPI_H_ */
@@ -0,0 +1,141 @@
+/**
+ * @file DMA_SPI_Flash.c
+ * @brief SPI Flash Cache Backend Implementation for STM32F407VGT6
+ *
+ * This file implements cache block fills from a serial NOR flash. The
+ * command transaction holds chip select so the data transaction continues
+ * the same read; both are queued in one critical section, so no transaction
+ * submitted from an interrupt can run between them while the flash is
+ * selected, and run back-to-back from the SPI engine's interrupt. The data
+ * transaction's completion reports the block to the cache, which may queue
+ * the next fill from within that callback.
+ *
+ * @version 1.0
+ * @date 2024-08-22
+ *
+ * @author Kunal Salvi
+ * @copyright Copyright (c) 2024
+ */
+
+#include "DMA_SPI_Flash.h"
+
+#define DMA_SPI_FLASH_READ          0x03    /**< READ command */
+#define DMA_SPI_FLASH_FAST_READ     0x0B    /**< FAST READ command, followed by one dummy byte */
+
+/**
+ * @brief Chip select hook of both transactions.
+ */
+static void DMA_SPI_Flash_Select(bool select, void *context)
+{
+    DMA_SPI_Flash *flash = (DMA_SPI_Flash *)context;
+
+    flash->chip_select(select, flash->context);
+}
+
+/**
+ * @brief Data transaction completion: reports the block to the cache.
+ */
+static void DMA_SPI_Flash_Complete(DMA_SPI_Transaction *transaction)
+{
+    DMA_SPI_Flash *flash = (DMA_SPI_Flash *)transaction->context;
+    int8_t status = ((flash->command_phase.status == 1) && (transaction->status == 1)) ? 1 : -1;
+
+    DMA_Cache_Fill_Complete(flash->cache, flash->block, status);
+}
+
+/**
+ * @brief Command transaction completion after the data transaction could not be queued.
+ */
+static void DMA_SPI_Flash_Abort(DMA_SPI_Transaction *transaction)
+{
+    DMA_SPI_Flash *flash = (DMA_SPI_Flash *)transaction->context;
+
+    DMA_Cache_Fill_Complete(flash->cache, flash->block, -1);
+}
+
+/**
+ * @brief Attaches the backend to the cache it fills.
+ *
+ * The block size of the cache must fit a single SPI transaction (at most
+ * 32768 bytes as a power of two).
+ *
+ * @param[in] flash Pointer to the `DMA_SPI_Flash` structure.
+ * @param[in] cache Pointer to the cache, with `fill` set to `DMA_SPI_Flash_Fill` and `device` to `flash`.
+ *
+ * @return int8_t Returns 1 on success, or -1 if the configuration is invalid.
+ */
+int8_t DMA_SPI_Flash_Init(DMA_SPI_Flash *flash, DMA_Cache *cache)
+{
+    if((flash->bus == NULL) || (flash->chip_select == NULL) || (cache->block_size == 0) || (cache->block_size > 0xFFFF))
+    {
+        return -1;
+    }
+
+    flash->cache = cache;
+    flash->block = NULL;
+
+    flash->command_phase.tx_buffer = flash->command;
+    flash->command_phase.rx_buffer = NULL;
+    flash->command_phase.length = flash->fast_read ? 5 : 4;
+    flash->command_phase.chip_select = DMA_SPI_Flash_Select;
+    flash->command_phase.hold_chip_select = true;
+    flash->command_phase.complete = NULL;
+    flash->command_phase.context = flash;
+
+    flash->data_phase.tx_buffer = NULL;
+    flash->data_phase.length = (uint16_t)cache->block_size;
+    flash->data_phase.chip_select = DMA_SPI_Flash_Select;
+    flash->data_phase.hold_chip_select = false;
+    flash->data_phase.complete = DMA_SPI_Flash_Complete;
+    flash->data_phase.context = flash;
+
+    return 1;
+}
+
+/**
+ * @brief Cache fill function: reads a block from the flash.
+ *
+ * Called by the cache, from a task or from the previous fill's completion.
+ * Both transactions are queued with interrupts masked. Should the data
+ * transaction be refused, the command transaction is turned into the last
+ * one of the read: it releases chip select and fails the fill when it
+ * completes, so the cache still sees exactly one completion.
+ *
+ * @param[in] cache Pointer to the cache.
+ * @param[in] block Block to fill.
+ *
+ * @return int8_t Returns 1 if the read was queued, or -1 otherwise.
+ */
+int8_t DMA_SPI_Flash_Fill(DMA_Cache *cache, DMA_Cache_Block *block)
+{
+    DMA_SPI_Flash *flash = (DMA_SPI_Flash *)cache->device;
+    uint32_t primask;
+    int8_t status;
+
+    flash->block = block;
+
+    flash->command[0] = flash->fast_read ? DMA_SPI_FLASH_FAST_READ : DMA_SPI_FLASH_READ;
+    flash->command[1] = (uint8_t)(block->address >> 16);
+    flash->command[2] = (uint8_t)(block->address >> 8);
+    flash->command[3] = (uint8_t)block->address;
+    flash->command[4] = 0x00;
+
+    flash->data_phase.rx_buffer = block->data;
+    flash->command_phase.hold_chip_select = true;
+    flash->command_phase.complete = NULL;
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+
+    status = DMA_SPI_Submit(flash->bus, &flash->command_phase);
+    if((status == 1) && (DMA_SPI_Submit(flash->bus, &flash->data_phase) != 1))
+    {
+        // The command transaction cannot have completed yet with interrupts masked
+        flash->command_phase.hold_chip_select = false;
+        flash->command_phase.complete = DMA_SPI_Flash_Abort;
+    }
+
+    __set_PRIMASK(primask);
+
+    return status;
+}
@@ -0,0 +1,74 @@
+/**
+ * @file DMA_SPI_Flash.h
+ * @author Kunal Salvi
+ * @brief Header file for the SPI flash cache backend.
+ *
+ * This file contains the data structure and function prototypes for filling
+ * the blocks of a `DMA_Cache` from a serial NOR flash on a `DMA_SPI_Bus`.
+ * A fill is two queued transactions: the read command with its 24-bit
+ * address, keeping chip select asserted, then the block itself received by
+ * DMA straight into the cache's memory. The next fill is started from the
+ * completion of the previous one, so read-ahead streams without the CPU.
+ *
+ * @code
+ * static DMA_SPI_Flash flash = { .bus = &bus, .chip_select = Flash_Select, .fast_read = true };
+ * static DMA_Cache cache = { .fill = DMA_SPI_Flash_Fill, .device = &flash, ... };
+ *
+ * DMA_SPI_Flash_Init(&flash, &cache);
+ * DMA_Cache_Init(&cache);
+ * @endcode
+ *
+ * @version 1.0
+ * @date 2024-08-22
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef DMA_SPI_FLASH_H_
+#define DMA_SPI_FLASH_H_
+
+#include "DMA_SPI.h"
+#include "DMA_Cache.h"
+
+/**
+ * @brief SPI flash backend structure.
+ *
+ * The fields in the first group are set by the application before calling
+ * `DMA_SPI_Flash_Init`. The remaining fields are managed by the backend.
+ */
+typedef struct DMA_SPI_Flash
+{
+    DMA_SPI_Bus *bus;                   /**< Initialized SPI bus of the flash */
+    void (*chip_select)(bool select, void *context); /**< Asserts (true) or releases (false) the flash's chip select */
+    void *context;                      /**< User pointer for `chip_select` */
+    bool fast_read;                     /**< Use FAST READ (0x0B, one dummy byte) instead of READ (0x03) */
+
+    DMA_Cache *cache;                   /**< Cache served by the backend */
+    DMA_Cache_Block *block;             /**< Block being filled */
+    uint8_t command[5];                 /**< Command, address and dummy bytes */
+    DMA_SPI_Transaction command_phase;  /**< Command transaction */
+    DMA_SPI_Transaction data_phase;     /**< Data transaction */
+} DMA_SPI_Flash;
+
+/**
+ * @brief Attaches the backend to the cache it fills.
+ *
+ * @param[in] flash Pointer to the DMA_SPI_Flash structure.
+ * @param[in] cache Pointer to the cache, with `fill` set to `DMA_SPI_Flash_Fill` and `device` to `flash`.
+ *
+ * @return int8_t Returns 1 on success, or -1 if the configuration is invalid.
+ */
+int8_t DMA_SPI_Flash_Init(DMA_SPI_Flash *flash, DMA_Cache *cache);
+
+/**
+ * @brief Cache fill function: reads a block from the flash.
+ *
+ * @param[in] cache Pointer to the cache.
+ * @param[in] block Block to fill.
+ *
+ * @return int8_t Returns 1 if the read was queued, or -1 otherwise.
+ */
+int8_t DMA_SPI_Flash_Fill(DMA_Cache *cache, DMA_Cache_Block *block);
+
+#endif /* DMA_SPI_FLASH_H_ */
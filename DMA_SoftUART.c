@@ -0,0 +1,517 @@
+/**
+ * @file DMA_SoftUART.c
+ * @brief DMA Software UART Implementation for STM32F407VGT6
+ *
+ * This file implements UART channels as GPIO bit streams. The TX stream runs
+ * in double-buffer mode and plays one `BSRR` word per bit period; on each
+ * transfer complete interrupt the block that has just been played is
+ * re-encoded from the channels' TX queues, with idle channels held high. The
+ * RX stream samples `IDR` into a ring; on each half transfer/transfer complete
+ * interrupt every channel's receiver runs over the finished half, finds start
+ * bits, samples each bit near its middle and queues the received bytes. A
+ * transfer error stops the direction it occurred on and is counted.
+ *
+ * @version 1.0
+ * @date 2024-08-22
+ *
+ * @author Kunal Salvi
+ * @copyright Copyright (c) 2024
+ */
+
+#include "DMA_SoftUART.h"
+
+#define DMA_SOFTUART_RX_IDLE    0       /**< Waiting for a start bit */
+#define DMA_SOFTUART_RX_START   1       /**< Confirming the start bit at its middle */
+#define DMA_SOFTUART_RX_DATA    2       /**< Sampling the data bits */
+#define DMA_SOFTUART_RX_STOP    3       /**< Checking the stop bit */
+#define DMA_SOFTUART_RX_BREAK   4       /**< Waiting for the line to return high after a framing error */
+
+/**
+ * @brief Encodes the next bit periods of all channels into a TX block.
+ */
+static void DMA_SoftUART_Encode(DMA_SoftUART *uart, uint32_t *block)
+{
+    DMA_SoftUART_Channel *channel;
+    uint32_t idle = 0;
+    uint32_t word;
+    bool active = false;
+    bool high;
+    uint16_t i;
+    uint8_t c;
+
+    for(c = 0; c < uart->channel_count; c++)
+    {
+        channel = &uart->channels[c];
+        if(channel->tx_pin == DMA_SOFTUART_NO_PIN)
+        {
+            continue;
+        }
+        idle |= 1U << channel->tx_pin;
+        if((channel->tx_bits != 0) || (channel->tx_tail != channel->tx_head))
+        {
+            active = true;
+        }
+    }
+
+    // Nothing to send: every line stays high for the whole block
+    if(!active)
+    {
+        for(i = 0; i < uart->tx_block_bits; i++)
+        {
+            block[i] = idle;
+        }
+        return;
+    }
+
+    for(i = 0; i < uart->tx_block_bits; i++)
+    {
+        word = 0;
+
+        for(c = 0; c < uart->channel_count; c++)
+        {
+            channel = &uart->channels[c];
+            if(channel->tx_pin == DMA_SOFTUART_NO_PIN)
+            {
+                continue;
+            }
+
+            if((channel->tx_bits == 0) && (channel->tx_tail != channel->tx_head))
+            {
+                // Start bit (0), 8 data bits LSB first, stop bit (1)
+                channel->tx_frame = (uint16_t)(0x200U | ((uint32_t)channel->tx_queue[channel->tx_tail] << 1));
+                channel->tx_bits = 10;
+                channel->tx_tail = (uint16_t)((channel->tx_tail + 1U) % channel->tx_size);
+            }
+
+            if(channel->tx_bits != 0)
+            {
+                high = (channel->tx_frame & 1U) != 0;
+                channel->tx_frame >>= 1;
+                channel->tx_bits--;
+            }
+            else
+            {
+                high = true;
+            }
+
+            word |= high ? (1U << channel->tx_pin) : (1U << (channel->tx_pin + 16U));
+        }
+
+        block[i] = word;
+    }
+}
+
+/**
+ * @brief Runs one channel's receiver over a block of RX samples.
+ *
+ * Idle and break periods are skipped with a plain scan for the next edge;
+ * inside a frame only the sampling points are looked at.
+ */
+static void DMA_SoftUART_Receive(DMA_SoftUART *uart, DMA_SoftUART_Channel *channel, const uint16_t *samples)
+{
+    uint16_t count = uart->rx_block_samples;
+    uint16_t mask = (uint16_t)(1U << channel->rx_pin);
+    uint16_t next;
+    uint16_t i = 0;
+    bool level;
+
+    while(i < count)
+    {
+        if(channel->rx_state == DMA_SOFTUART_RX_IDLE)
+        {
+            while((i < count) && (samples[i] & mask)) i++;
+            if(i == count)
+            {
+                break;
+            }
+
+            // First low sample: the middle of the start bit is half a bit later
+            channel->rx_state = DMA_SOFTUART_RX_START;
+            channel->rx_wait = (uint8_t)(uart->oversampling / 2U - 1U);
+            i++;
+            continue;
+        }
+
+        if(channel->rx_state == DMA_SOFTUART_RX_BREAK)
+        {
+            while((i < count) && !(samples[i] & mask)) i++;
+            if(i == count)
+            {
+                break;
+            }
+            channel->rx_state = DMA_SOFTUART_RX_IDLE;
+            continue;
+        }
+
+        if((uint32_t)i + channel->rx_wait >= count)
+        {
+            channel->rx_wait = (uint8_t)(channel->rx_wait - (count - i));
+            break;
+        }
+        i = (uint16_t)(i + channel->rx_wait);
+        level = (samples[i] & mask) != 0;
+        i++;
+        channel->rx_wait = (uint8_t)(uart->oversampling - 1U);
+
+        if(channel->rx_state == DMA_SOFTUART_RX_START)
+        {
+            if(level)
+            {
+                // Glitch shorter than half a bit
+                channel->rx_state = DMA_SOFTUART_RX_IDLE;
+            }
+            else
+            {
+                channel->rx_state = DMA_SOFTUART_RX_DATA;
+                channel->rx_bit = 0;
+                channel->rx_shift = 0;
+            }
+        }
+        else if(channel->rx_state == DMA_SOFTUART_RX_DATA)
+        {
+            channel->rx_shift = (uint8_t)((channel->rx_shift >> 1) | (level ? 0x80U : 0U));
+            if(++channel->rx_bit == 8)
+            {
+                channel->rx_state = DMA_SOFTUART_RX_STOP;
+            }
+        }
+        else
+        {
+            if(level)
+            {
+                next = (uint16_t)((channel->rx_head + 1U) % channel->rx_size);
+                if(next != channel->rx_tail)
+                {
+                    channel->rx_queue[channel->rx_head] = channel->rx_shift;
+                    channel->rx_head = next;
+                }
+                else
+                {
+                    channel->overflows++;
+                }
+                channel->rx_state = DMA_SOFTUART_RX_IDLE;
+            }
+            else
+            {
+                channel->framing_errors++;
+                channel->rx_state = DMA_SOFTUART_RX_BREAK;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Stops a direction after a transfer error and counts the error.
+ *
+ * The stream has already cleared EN; the timer's update request is turned off
+ * so no request is left pending, and the stream stays claimed until
+ * `DMA_SoftUART_Stop`.
+ */
+static void DMA_SoftUART_Halt(DMA_SoftUART *uart, TIM_TypeDef *tim, DMA_Stream_TypeDef *stream)
+{
+    tim->DIER &= ~TIM_DIER_UDE;
+    stream->CR &= ~DMA_SxCR_EN;
+    uart->errors++;
+}
+
+/**
+ * @brief TX stream event callback: re-encodes the block that has just been played.
+ */
+static void DMA_SoftUART_TX_Callback(DMA_Stream_TypeDef *stream, uint32_t event, void *context)
+{
+    DMA_SoftUART *uart = (DMA_SoftUART *)context;
+    uint32_t ct;
+
+    if(event == DMA_Configuration.DMA_Interrupts.Transfer_Error)
+    {
+        DMA_SoftUART_Halt(uart, uart->TX_TIM, stream);
+        return;
+    }
+    if(event != DMA_Configuration.DMA_Interrupts.Transfer_Complete)
+    {
+        return;
+    }
+
+    ct = stream->CR & DMA_SxCR_CT;
+    DMA_SoftUART_Encode(uart, uart->tx_buffers[ct ? 0 : 1]);
+    uart->tx_blocks++;
+
+    // The hardware switched back to this block before it was complete
+    if((stream->CR & DMA_SxCR_CT) != ct)
+    {
+        uart->underruns++;
+    }
+}
+
+/**
+ * @brief RX stream event callback: decodes the finished half of the sample ring.
+ */
+static void DMA_SoftUART_RX_Callback(DMA_Stream_TypeDef *stream, uint32_t event, void *context)
+{
+    DMA_SoftUART *uart = (DMA_SoftUART *)context;
+    const uint16_t *block;
+    bool overrun;
+    uint8_t c;
+
+    if(event == DMA_Configuration.DMA_Interrupts.Transfer_Error)
+    {
+        DMA_SoftUART_Halt(uart, uart->RX_TIM, stream);
+        return;
+    }
+
+    if(event == DMA_Configuration.DMA_Interrupts.Half_Transfer_Complete) block = uart->rx_ring;
+    else if(event == DMA_Configuration.DMA_Interrupts.Transfer_Complete) block = uart->rx_ring + uart->rx_block_samples;
+    else return;
+
+    for(c = 0; c < uart->channel_count; c++)
+    {
+        if(uart->channels[c].rx_pin != DMA_SOFTUART_NO_PIN)
+        {
+            DMA_SoftUART_Receive(uart, &uart->channels[c], block);
+        }
+    }
+    uart->rx_blocks++;
+
+    // The first half is safe while NDTR counts down the second half, and vice versa
+    overrun = (block == uart->rx_ring) ? (stream->NDTR > uart->rx_block_samples) : (stream->NDTR <= uart->rx_block_samples);
+    if(overrun)
+    {
+        uart->overruns++;
+    }
+}
+
+/**
+ * @brief Configures and enables one timer-paced GPIO stream.
+ */
+static void DMA_SoftUART_Stream(DMA_SoftUART *uart, DMA_Request *request, bool transmit, uint32_t peripheral,
+                                void (*callback)(DMA_Stream_TypeDef *, uint32_t, void *))
+{
+    DMA_Stream_TypeDef *stream = request->Stream;
+    volatile uint32_t *flag_clear;
+    uint32_t flag_mask;
+
+    stream->CR &= ~DMA_SxCR_EN;
+    while(stream->CR & DMA_SxCR_EN) {}
+
+    stream->CR = ((uint32_t)request->channel << DMA_SxCR_CHSEL_Pos) |
+                 (transmit ? DMA_Configuration.Transfer_Direction.Memory_to_peripheral
+                           : DMA_Configuration.Transfer_Direction.Peripheral_to_memory) |
+                 uart->priority_level |
+                 (transmit ? DMA_Configuration.Memory_Data_Size.word : DMA_Configuration.Memory_Data_Size.half_word) |
+                 (transmit ? DMA_Configuration.Peripheral_Data_Size.word : DMA_Configuration.Peripheral_Data_Size.half_word) |
+                 DMA_Configuration.Memory_Pointer_Increment.Enable |
+                 DMA_Configuration.Circular_Mode.Enable |
+                 (transmit ? DMA_SxCR_DBM : DMA_Configuration.DMA_Interrupts.Half_Transfer_Complete) |
+                 DMA_Configuration.DMA_Interrupts.Transfer_Complete |
+                 DMA_Configuration.DMA_Interrupts.Transfer_Error;
+    stream->FCR = 0;
+
+    stream->PAR = peripheral;
+    if(transmit)
+    {
+        stream->M0AR = (uint32_t)uart->tx_buffers[0];
+        stream->M1AR = (uint32_t)uart->tx_buffers[1];
+        stream->NDTR = uart->tx_block_bits;
+    }
+    else
+    {
+        stream->M0AR = (uint32_t)uart->rx_ring;
+        stream->NDTR = 2U * uart->rx_block_samples;
+    }
+
+    flag_clear = DMA_Flag_Clear_Register(stream, &flag_mask);
+    *flag_clear = flag_mask;
+
+    DMA_Register_Callback(stream, callback, uart);
+    DMA_Stream_IRQ_Enable(stream);
+    stream->CR |= DMA_SxCR_EN;
+}
+
+/**
+ * @brief Starts the TX and RX streams of a group.
+ *
+ * This function claims the streams, resets the channels, encodes the first
+ * two TX blocks (idle high) and starts both streams, then enables the update
+ * DMA requests of the two timers. The pins are configured by the application,
+ * which also sets the timer rates (`TX_TIM` at the baud rate, `RX_TIM` at
+ * `oversampling` times the baud rate) and starts the counters.
+ *
+ * @param[in] uart Pointer to the `DMA_SoftUART` structure.
+ *
+ * @return int8_t Returns 1 on success, or -1 if the configuration is invalid or a stream is already claimed.
+ */
+int8_t DMA_SoftUART_Start(DMA_SoftUART *uart)
+{
+    bool transmit = (uart->TX_Request.Stream != NULL);
+    bool receive = (uart->RX_Request.Stream != NULL);
+    DMA_SoftUART_Channel *channel;
+    uint8_t c;
+
+    if((uart->channels == NULL) || (uart->channel_count == 0) || (!transmit && !receive))
+    {
+        return -1;
+    }
+    if(transmit && ((uart->TX_Request.Controller != DMA2) || (uart->TX_GPIO == NULL) || (uart->TX_TIM == NULL) ||
+                    (uart->tx_buffers[0] == NULL) || (uart->tx_buffers[1] == NULL) || (uart->tx_block_bits == 0)))
+    {
+        return -1;
+    }
+    if(receive && ((uart->RX_Request.Controller != DMA2) || (uart->RX_GPIO == NULL) || (uart->RX_TIM == NULL) ||
+                   (uart->rx_ring == NULL) || (uart->rx_block_samples == 0) || (uart->rx_block_samples > 0x7FFF) ||
+                   (uart->oversampling < 3) || (uart->oversampling > 16)))
+    {
+        return -1;
+    }
+
+    for(c = 0; c < uart->channel_count; c++)
+    {
+        channel = &uart->channels[c];
+        if((channel->tx_pin != DMA_SOFTUART_NO_PIN) && (!transmit || (channel->tx_pin > 15) || (channel->tx_queue == NULL) || (channel->tx_size < 2)))
+        {
+            return -1;
+        }
+        if((channel->rx_pin != DMA_SOFTUART_NO_PIN) && (!receive || (channel->rx_pin > 15) || (channel->rx_queue == NULL) || (channel->rx_size < 2)))
+        {
+            return -1;
+        }
+    }
+
+    if(transmit && (DMA_Stream_Claim(uart->TX_Request.Stream) != 1))
+    {
+        return -1;
+    }
+    if(receive && (DMA_Stream_Claim(uart->RX_Request.Stream) != 1))
+    {
+        if(transmit) DMA_Stream_Release(uart->TX_Request.Stream);
+        return -1;
+    }
+
+    for(c = 0; c < uart->channel_count; c++)
+    {
+        channel = &uart->channels[c];
+        channel->tx_head = 0;
+        channel->tx_tail = 0;
+        channel->rx_head = 0;
+        channel->rx_tail = 0;
+        channel->tx_bits = 0;
+        channel->rx_state = DMA_SOFTUART_RX_IDLE;
+        channel->overflows = 0;
+        channel->framing_errors = 0;
+    }
+    uart->tx_blocks = 0;
+    uart->rx_blocks = 0;
+    uart->underruns = 0;
+    uart->overruns = 0;
+    uart->errors = 0;
+
+    if(transmit)
+    {
+        DMA_SoftUART_Encode(uart, uart->tx_buffers[0]);
+        DMA_SoftUART_Encode(uart, uart->tx_buffers[1]);
+        DMA_SoftUART_Stream(uart, &uart->TX_Request, true, (uint32_t)&(uart->TX_GPIO->BSRR), DMA_SoftUART_TX_Callback);
+        uart->TX_TIM->DIER |= TIM_DIER_UDE;
+    }
+    if(receive)
+    {
+        DMA_SoftUART_Stream(uart, &uart->RX_Request, false, (uint32_t)&(uart->RX_GPIO->IDR), DMA_SoftUART_RX_Callback);
+        uart->RX_TIM->DIER |= TIM_DIER_UDE;
+    }
+
+    return 1;
+}
+
+/**
+ * @brief Stops both streams of a group and releases them.
+ *
+ * A frame being sent is cut off; the TX lines keep their last level. Also
+ * releases the streams of a direction stopped by a transfer error.
+ *
+ * @param[in] uart Pointer to the `DMA_SoftUART` structure.
+ */
+void DMA_SoftUART_Stop(DMA_SoftUART *uart)
+{
+    DMA_Stream_TypeDef *stream;
+
+    if(uart->TX_Request.Stream != NULL)
+    {
+        stream = uart->TX_Request.Stream;
+        uart->TX_TIM->DIER &= ~TIM_DIER_UDE;
+        stream->CR &= ~DMA_SxCR_EN;
+        while(stream->CR & DMA_SxCR_EN) {}
+        DMA_Register_Callback(stream, NULL, NULL);
+        DMA_Stream_Release(stream);
+    }
+    if(uart->RX_Request.Stream != NULL)
+    {
+        stream = uart->RX_Request.Stream;
+        uart->RX_TIM->DIER &= ~TIM_DIER_UDE;
+        stream->CR &= ~DMA_SxCR_EN;
+        while(stream->CR & DMA_SxCR_EN) {}
+        DMA_Register_Callback(stream, NULL, NULL);
+        DMA_Stream_Release(stream);
+    }
+}
+
+/**
+ * @brief Queues bytes for transmission on a channel.
+ *
+ * Safe to call while the group is running; a queued byte goes out within two
+ * TX blocks.
+ *
+ * @param[in] uart Pointer to the `DMA_SoftUART` structure.
+ * @param[in] channel Index of the channel.
+ * @param[in] data Bytes to send.
+ * @param[in] length Number of bytes.
+ *
+ * @return uint16_t Number of bytes queued, fewer than `length` if the queue is full.
+ */
+uint16_t DMA_SoftUART_Write(DMA_SoftUART *uart, uint8_t channel, const uint8_t *data, uint16_t length)
+{
+    DMA_SoftUART_Channel *link = &uart->channels[channel];
+    uint16_t head = link->tx_head;
+    uint16_t next;
+    uint16_t written = 0;
+
+    while(written < length)
+    {
+        next = (uint16_t)((head + 1U) % link->tx_size);
+        if(next == link->tx_tail)
+        {
+            break;
+        }
+        link->tx_queue[head] = data[written++];
+        head = next;
+    }
+
+    // Publish the bytes to the TX interrupt only once they are stored
+    link->tx_head = head;
+
+    return written;
+}
+
+/**
+ * @brief Reads received bytes from a channel.
+ *
+ * @param[in] uart Pointer to the `DMA_SoftUART` structure.
+ * @param[in] channel Index of the channel.
+ * @param[out] data Buffer for the bytes.
+ * @param[in] length Size of `data`.
+ *
+ * @return uint16_t Number of bytes read.
+ */
+uint16_t DMA_SoftUART_Read(DMA_SoftUART *uart, uint8_t channel, uint8_t *data, uint16_t length)
+{
+    DMA_SoftUART_Channel *link = &uart->channels[channel];
+    uint16_t tail = link->rx_tail;
+    uint16_t read = 0;
+
+    while((read < length) && (tail != link->rx_head))
+    {
+        data[read++] = link->rx_queue[tail];
+        tail = (uint16_t)((tail + 1U) % link->rx_size);
+    }
+
+    link->rx_tail = tail;
+
+    return read;
+}
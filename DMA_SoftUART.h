@@ -0,0 +1,137 @@
+/**
+ * @file DMA_SoftUART.h
+ * @author Kunal Salvi
+ * @brief Header file for the DMA software UART.
+ *
+ * This file contains the data structures and function prototypes for extra
+ * UART links on plain GPIO pins. All TX pins of a group share one GPIO port and
+ * one stream: a timer running at the baud rate moves one word per bit period
+ * into the port's `BSRR`, each word holding the next bit of every channel. All
+ * RX pins share another port and stream: a second timer running at a multiple
+ * of the baud rate samples the port's `IDR` into a ring. Bytes are encoded
+ * into and decoded from these bit streams once per block, so the CPU cost is
+ * one interrupt per block on each side instead of one per bit.
+ *
+ * Only DMA2 can reach the GPIO ports, so the update requests of TIM1
+ * (`TIM1_UP`) and TIM8 (`TIM8_UP`) pace the two sides. All channels of a group
+ * run at the same baud rate with 8 data bits, no parity and 1 stop bit.
+ *
+ * @version 1.0
+ * @date 2024-08-22
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef DMA_SOFTUART_H_
+#define DMA_SOFTUART_H_
+
+#include "DMA.h"
+
+#define DMA_SOFTUART_NO_PIN         0xFF    /**< Channel has no TX or no RX pin */
+
+/**
+ * @brief Software UART channel.
+ *
+ * The fields in the first group are set by the application before calling
+ * `DMA_SoftUART_Start`; the byte queues are rings with one slot kept free. The
+ * remaining fields are managed by the engine.
+ */
+typedef struct DMA_SoftUART_Channel
+{
+    uint8_t tx_pin;                     /**< Pin of the TX port, or `DMA_SOFTUART_NO_PIN` */
+    uint8_t rx_pin;                     /**< Pin of the RX port, or `DMA_SOFTUART_NO_PIN` */
+    uint8_t *tx_queue;                  /**< Bytes waiting to be sent */
+    uint16_t tx_size;                   /**< Size of `tx_queue` */
+    uint8_t *rx_queue;                  /**< Bytes received and not yet read */
+    uint16_t rx_size;                   /**< Size of `rx_queue` */
+
+    volatile uint16_t tx_head;          /**< Next free slot of `tx_queue` */
+    volatile uint16_t tx_tail;          /**< Next byte of `tx_queue` to send */
+    volatile uint16_t rx_head;          /**< Next free slot of `rx_queue` */
+    volatile uint16_t rx_tail;          /**< Next byte of `rx_queue` to read */
+    uint16_t tx_frame;                  /**< Remaining bits of the frame being sent, LSB first */
+    uint8_t tx_bits;                    /**< Number of bits left in `tx_frame` */
+    uint8_t rx_state;                   /**< Receiver state */
+    uint8_t rx_bit;                     /**< Data bits received of the current frame */
+    uint8_t rx_shift;                   /**< Data bits of the current frame */
+    uint8_t rx_wait;                    /**< Samples until the next bit sampling point */
+    volatile uint32_t overflows;        /**< Bytes lost because `rx_queue` was full */
+    volatile uint32_t framing_errors;   /**< Frames without a valid stop bit */
+} DMA_SoftUART_Channel;
+
+/**
+ * @brief Software UART group structure.
+ *
+ * The fields in the first group are set by the application before calling
+ * `DMA_SoftUART_Start`. Set `TX_Request.Stream` or `RX_Request.Stream` to NULL
+ * for a receive-only or transmit-only group. The remaining fields are managed
+ * by the engine.
+ */
+typedef struct DMA_SoftUART
+{
+    DMA_SoftUART_Channel *channels;     /**< Channels of the group */
+    uint8_t channel_count;              /**< Number of channels */
+    uint32_t priority_level;            /**< Priority level of both streams */
+
+    GPIO_TypeDef *TX_GPIO;              /**< Port of all TX pins, configured as outputs by the application */
+    TIM_TypeDef *TX_TIM;                /**< Timer updating at the baud rate */
+    DMA_Request TX_Request;             /**< Update request of `TX_TIM` (`TIM1_UP` or `TIM8_UP`) */
+    uint32_t *tx_buffers[2];            /**< `BSRR` word blocks */
+    uint16_t tx_block_bits;             /**< Bit periods per TX block */
+
+    GPIO_TypeDef *RX_GPIO;              /**< Port of all RX pins, configured as inputs by the application */
+    TIM_TypeDef *RX_TIM;                /**< Timer updating at `oversampling` times the baud rate */
+    DMA_Request RX_Request;             /**< Update request of `RX_TIM` (`TIM1_UP` or `TIM8_UP`) */
+    uint16_t *rx_ring;                  /**< `IDR` sample ring of `2 * rx_block_samples` half-words */
+    uint16_t rx_block_samples;          /**< Samples per RX block */
+    uint8_t oversampling;               /**< Samples per bit (3 to 16) */
+
+    volatile uint32_t tx_blocks;        /**< TX blocks encoded */
+    volatile uint32_t rx_blocks;        /**< RX blocks decoded */
+    volatile uint32_t underruns;        /**< TX blocks not refilled before they were played */
+    volatile uint32_t overruns;         /**< RX blocks the DMA re-entered before they were decoded */
+    volatile uint32_t errors;           /**< Transfer errors; the direction with the error stops */
+} DMA_SoftUART;
+
+/**
+ * @brief Starts the TX and RX streams of a group.
+ *
+ * @param[in] uart Pointer to the DMA_SoftUART structure.
+ *
+ * @return int8_t Returns 1 on success, or -1 if the configuration is invalid or a stream is already claimed.
+ */
+int8_t DMA_SoftUART_Start(DMA_SoftUART *uart);
+
+/**
+ * @brief Stops both streams of a group and releases them.
+ *
+ * @param[in] uart Pointer to the DMA_SoftUART structure.
+ */
+void DMA_SoftUART_Stop(DMA_SoftUART *uart);
+
+/**
+ * @brief Queues bytes for transmission on a channel.
+ *
+ * @param[in] uart Pointer to the DMA_SoftUART structure.
+ * @param[in] channel Index of the channel.
+ * @param[in] data Bytes to send.
+ * @param[in] length Number of bytes.
+ *
+ * @return uint16_t Number of bytes queued, fewer than `length` if the queue is full.
+ */
+uint16_t DMA_SoftUART_Write(DMA_SoftUART *uart, uint8_t channel, const uint8_t *data, uint16_t length);
+
+/**
+ * @brief Reads received bytes from a channel.
+ *
+ * @param[in] uart Pointer to the DMA_SoftUART structure.
+ * @param[in] channel Index of the channel.
+ * @param[out] data Buffer for the bytes.
+ * @param[in] length Size of `data`.
+ *
+ * @return uint16_t Number of bytes read.
+ */
+uint16_t DMA_SoftUART_Read(DMA_SoftUART *uart, uint8_t channel, uint8_t *data, uint16_t length);
+
+#endif /* DMA_SOFTUART_H_ */
@@ -0,0 +1,219 @@
+/**
+ * @file DMA_Startup.c
+ * @brief DMA Startup Helper Implementation for STM32F407VGT6
+ *
+ * This file implements `.data` and `.bss` initialization with DMA2 Stream 0
+ * in memory-to-memory mode, polled so no interrupt vector or driver state is
+ * needed. Word items go through the FIFO with 4-beat bursts on the memory
+ * port, and on the source port when the source is incremented and aligned
+ * the same way. The CPU moves the up to 3 words before the destination
+ * reaches a 16-byte boundary, so a burst never crosses a 1 KB boundary, and
+ * the up to 3 words left after the last burst. A fill reads its value from a
+ * stack word with the source address fixed.
+ *
+ * Nothing here lives in `.data` or `.bss` except `DMA_Startup_Cycles`, which
+ * is written only once `.bss` has been zeroed. `DMA_Configuration` is a
+ * constant and is read from flash.
+ *
+ * @version 1.0
+ * @date 2024-08-22
+ *
+ * @author Kunal Salvi
+ * @copyright Copyright (c) 2024
+ */
+
+#include "DMA_Startup.h"
+
+#define DMA_STARTUP_STREAM      DMA2_Stream0    /**< Stream used for the transfers, as `DMA_Memory_To_Memory_Transfer` */
+#define DMA_STARTUP_BURST       4U              /**< Words per burst */
+#define DMA_STARTUP_MAX_RUN     0xFFFCU         /**< Largest NDTR that is a whole number of bursts */
+#define DMA_STARTUP_FLAGS       (DMA_LIFCR_CFEIF0 | DMA_LIFCR_CDMEIF0 | DMA_LIFCR_CTEIF0 | DMA_LIFCR_CHTIF0 | DMA_LIFCR_CTCIF0)
+
+// Section boundaries from the linker script
+extern uint32_t _sidata;
+extern uint32_t _sdata;
+extern uint32_t _edata;
+extern uint32_t _sbss;
+extern uint32_t _ebss;
+
+uint32_t DMA_Startup_Cycles;                    /**< Cycles taken by `DMA_Startup_Init` */
+
+/**
+ * @brief Enables DMA2 and waits for the stream to be idle.
+ */
+static void DMA_Startup_Prepare(void)
+{
+    RCC -> AHB1ENR |= RCC_AHB1ENR_DMA2EN;
+    (void)RCC -> AHB1ENR;
+
+    DMA_STARTUP_STREAM->CR &= ~DMA_SxCR_EN;
+    while(DMA_STARTUP_STREAM->CR & DMA_SxCR_EN) {}
+}
+
+/**
+ * @brief Runs one transfer of whole bursts and waits for it.
+ *
+ * @return bool `true` if the transfer completed, `false` on a transfer error.
+ */
+static bool DMA_Startup_Run(uint32_t *destination, const uint32_t *source, bool source_increment, uint32_t words)
+{
+    DMA_Stream_TypeDef *stream = DMA_STARTUP_STREAM;
+    uint32_t status;
+
+    stream->CR = DMA_Configuration.Transfer_Direction.Memory_to_memory |
+                 DMA_Configuration.Priority_Level.Very_high |
+                 DMA_Configuration.Memory_Data_Size.word |
+                 DMA_Configuration.Peripheral_Data_Size.word |
+                 DMA_Configuration.Memory_Pointer_Increment.Enable |
+                 DMA_SxCR_MBURST_0;
+    if(source_increment)
+    {
+        stream->CR |= DMA_Configuration.Peripheral_Pointer_Increment.Enable;
+        if(((uint32_t)source & ((DMA_STARTUP_BURST * 4U) - 1U)) == 0)
+        {
+            stream->CR |= DMA_SxCR_PBURST_0;
+        }
+    }
+
+    // Memory-to-memory transfers always go through the FIFO
+    stream->FCR = DMA_SxFCR_DMDIS | DMA_SxFCR_FTH;
+    stream->PAR = (uint32_t)source;
+    stream->M0AR = (uint32_t)destination;
+    stream->NDTR = words;
+
+    DMA2->LIFCR = DMA_STARTUP_FLAGS;
+    stream->CR |= DMA_SxCR_EN;
+
+    do
+    {
+        status = DMA2->LISR & (DMA_LISR_TCIF0 | DMA_LISR_TEIF0);
+    } while(status == 0);
+
+    DMA2->LIFCR = DMA_STARTUP_FLAGS;
+
+    return (status & DMA_LISR_TEIF0) == 0;
+}
+
+/**
+ * @brief Moves words, the whole bursts by DMA and the rest by the CPU.
+ */
+static void DMA_Startup_Transfer(uint32_t *destination, const uint32_t *source, bool source_increment, uint32_t words)
+{
+    uint32_t run;
+    uint32_t i;
+
+    DMA_Startup_Prepare();
+
+    while((words != 0) && (((uint32_t)destination & ((DMA_STARTUP_BURST * 4U) - 1U)) != 0))
+    {
+        *destination++ = *source;
+        if(source_increment) source++;
+        words--;
+    }
+
+    while(words >= DMA_STARTUP_BURST)
+    {
+        run = words & ~(DMA_STARTUP_BURST - 1U);
+        if(run > DMA_STARTUP_MAX_RUN)
+        {
+            run = DMA_STARTUP_MAX_RUN;
+        }
+
+        if(!DMA_Startup_Run(destination, source, source_increment, run))
+        {
+            for(i = 0; i < run; i++)
+            {
+                destination[i] = source_increment ? source[i] : *source;
+            }
+        }
+
+        destination += run;
+        if(source_increment) source += run;
+        words -= run;
+    }
+
+    while(words != 0)
+    {
+        *destination++ = *source;
+        if(source_increment) source++;
+        words--;
+    }
+
+    DMA_STARTUP_STREAM->CR = 0;
+}
+
+/**
+ * @brief Copies words with DMA2 Stream 0.
+ *
+ * Only for the pre-main path: the stream is taken without `DMA_Stream_Claim`,
+ * whose state lives in `.bss`, and is left with a cleared control register,
+ * which would break a driver owning it after startup. The DMA2 clock is left
+ * on; `DMA_Startup_Init` gates it again.
+ *
+ * @param[out] destination Word-aligned destination.
+ * @param[in] source Word-aligned source.
+ * @param[in] words Number of 32-bit words.
+ */
+static void DMA_Startup_Copy(uint32_t *destination, const uint32_t *source, uint32_t words)
+{
+    DMA_Startup_Transfer(destination, source, true, words);
+}
+
+/**
+ * @brief Fills words with a value using DMA2 Stream 0.
+ *
+ * The value is read from the stack, so the stack must be in SRAM for the DMA
+ * to be used; with the stack in CCM RAM the CPU does the fill. Only for the
+ * pre-main path, as `DMA_Startup_Copy`.
+ *
+ * @param[out] destination Word-aligned destination.
+ * @param[in] value Value written to every word.
+ * @param[in] words Number of 32-bit words.
+ */
+static void DMA_Startup_Fill(uint32_t *destination, uint32_t value, uint32_t words)
+{
+    volatile uint32_t pattern = value;
+
+    DMA_Startup_Transfer(destination, (const uint32_t *)&pattern, false, words);
+}
+
+/**
+ * @brief Copies `.data` from flash and zeroes `.bss` before the C runtime starts.
+ *
+ * Uses the `_sidata`, `_sdata`, `_edata`, `_sbss` and `_ebss` symbols of the
+ * usual STM32 linker scripts, which are word aligned. The time is measured
+ * with the DWT cycle counter, which is left running, and is kept in
+ * `DMA_Startup_Cycles` once `.bss` is zeroed. DMA2 is gated again at the
+ * end, as no driver uses it yet.
+ *
+ * @return uint32_t CPU cycles taken, also kept for `DMA_Startup_Time`.
+ */
+uint32_t DMA_Startup_Init(void)
+{
+    uint32_t start;
+    uint32_t cycles;
+
+    DMA_Timestamp_Enable();
+    start = DMA_Timestamp();
+
+    DMA_Startup_Copy(&_sdata, &_sidata, (uint32_t)(&_edata - &_sdata));
+    DMA_Startup_Fill(&_sbss, 0, (uint32_t)(&_ebss - &_sbss));
+
+    cycles = DMA_Timestamp() - start;
+    DMA_Startup_Cycles = cycles;
+
+    // The reference counts live in .bss and are valid from here on
+    DMA_Clock_Power_Down();
+
+    return cycles;
+}
+
+/**
+ * @brief Returns the time taken by `DMA_Startup_Init`.
+ *
+ * @return uint32_t CPU cycles, or 0 if `DMA_Startup_Init` was not called.
+ */
+uint32_t DMA_Startup_Time(void)
+{
+    return DMA_Startup_Cycles;
+}
@@ -0,0 +1,55 @@
+/**
+ * @file DMA_Startup.h
+ * @author Kunal Salvi
+ * @brief Header file for the DMA startup helper.
+ *
+ * This file contains the function prototypes for initializing `.data` and
+ * `.bss` with DMA2 memory-to-memory transfers instead of the CPU loops of the
+ * startup code. The transfers use 32-bit items and 4-beat bursts, so large
+ * static buffers are initialized at bus speed. The functions use no
+ * initialized or zeroed variables and can be called from the reset handler
+ * before the C runtime is set up, e.g. in place of the copy and fill loops of
+ * `startup_stm32f407xx.s`:
+ *
+ * @code
+ * Reset_Handler:
+ *     ldr   sp, =_estack
+ *     bl    SystemInit
+ *     bl    DMA_Startup_Init
+ *     bl    __libc_init_array
+ *     bl    main
+ * @endcode
+ *
+ * The CCM RAM (0x10000000) is not reachable by the DMA controllers: sections
+ * placed there must still be initialized by the CPU. A transfer that fails,
+ * e.g. because an address is in CCM RAM, is completed by the CPU instead.
+ * DMA2 Stream 0 is used without being claimed, so the helper is only meant
+ * for the reset handler, before any driver owns the stream.
+ *
+ * @version 1.0
+ * @date 2024-08-22
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef DMA_STARTUP_H_
+#define DMA_STARTUP_H_
+
+#include "DMA.h"
+
+/**
+ * @brief Copies `.data` from flash and zeroes `.bss` before the C runtime starts.
+ *
+ * @return uint32_t CPU cycles taken, also kept for `DMA_Startup_Time`.
+ */
+uint32_t DMA_Startup_Init(void);
+
+/**
+ * @brief Returns the time taken by `DMA_Startup_Init`.
+ *
+ * @return uint32_t CPU cycles, or 0 if `DMA_Startup_Init` was not called.
+ */
+uint32_t DMA_Startup_Time(void);
+
+#endif /* DMA_STARTUP_H_ */
@@ -0,0 +1,308 @@
+/**
+ * @file DMA_Timer.c
+ * @brief DMA Timer Burst Engine Implementation for STM32F407VGT6
+ *
+ * This file implements multi-register timer updates through the DMA burst
+ * interface. `DCR` selects the first register and the burst length; every
+ * update event then requests `registers` transfers to `DMAR`, which the timer
+ * redirects to consecutive registers. The stream runs in double-buffer mode
+ * and the block that has just been played is refilled by the generator on each
+ * transfer complete interrupt. When the generator ends the waveform, the rest
+ * of its last block repeats the final frame and the stream is stopped once
+ * that block has been played.
+ *
+ * @version 1.0
+ * @date 2024-08-22
+ *
+ * @author Kunal Salvi
+ * @copyright Copyright (c) 2024
+ */
+
+#include "DMA_Timer.h"
+#include <string.h>
+
+/**
+ * @brief Fills one block from the generator, repeating the last frame past the end of the waveform.
+ */
+static void DMA_Timer_Fill(DMA_Timer_Burst *burst, uint8_t index)
+{
+    uint32_t frame_size = (uint32_t)burst->registers * (burst->word ? 4U : 2U);
+    uint8_t *block = (uint8_t *)burst->buffers[index];
+    uint16_t frames = burst->block_frames;
+    uint16_t produced = 0;
+    const uint8_t *hold;
+    uint16_t i;
+
+    if(burst->end_buffer < 0)
+    {
+        produced = burst->generate(block, frames, burst->context);
+        if(produced > frames)
+        {
+            produced = frames;
+        }
+        if(produced < frames)
+        {
+            burst->end_buffer = (int8_t)index;
+        }
+        burst->blocks++;
+    }
+
+    // Without a frame of its own the block repeats the last frame of the other one
+    if(produced > 0) hold = block + (uint32_t)(produced - 1) * frame_size;
+    else hold = (const uint8_t *)burst->buffers[index ^ 1U] + (uint32_t)(frames - 1) * frame_size;
+
+    for(i = produced; i < frames; i++)
+    {
+        memcpy(block + (uint32_t)i * frame_size, hold, frame_size);
+    }
+}
+
+/**
+ * @brief Stops the timer DMA requests and the stream; the timer keeps its last frame.
+ */
+static void DMA_Timer_Halt(DMA_Timer_Burst *burst)
+{
+    burst->TIM->DIER &= ~TIM_DIER_UDE;
+    burst->Request.Stream->CR &= ~DMA_SxCR_EN;
+    burst->running = false;
+}
+
+/**
+ * @brief Stream event callback: refills the block that has just been played.
+ */
+static void DMA_Timer_Callback(DMA_Stream_TypeDef *stream, uint32_t event, void *context)
+{
+    DMA_Timer_Burst *burst = (DMA_Timer_Burst *)context;
+    uint32_t ct;
+    uint8_t finished;
+
+    if(event == DMA_Configuration.DMA_Interrupts.Transfer_Error)
+    {
+        DMA_Timer_Halt(burst);
+        return;
+    }
+    if((event != DMA_Configuration.DMA_Interrupts.Transfer_Complete) || !burst->running)
+    {
+        return;
+    }
+
+    ct = stream->CR & DMA_SxCR_CT;
+    finished = ct ? 0 : 1;
+
+    if(burst->end_buffer == (int8_t)finished)
+    {
+        DMA_Timer_Halt(burst);
+        return;
+    }
+
+    DMA_Timer_Fill(burst, finished);
+
+    // The hardware switched back to this block before it was complete
+    if((stream->CR & DMA_SxCR_CT) != ct)
+    {
+        burst->underruns++;
+    }
+}
+
+/**
+ * @brief Starts streaming register frames to the timer.
+ *
+ * This function claims the stream, fills both blocks from the generator and
+ * configures the stream in double-buffer mode for `DMAR`. It then programs the
+ * burst (`DBA` = `base_register`, `DBL` = `registers` - 1) and enables the
+ * update DMA request. The timer's mode, period, outputs and register preload
+ * are configured by the application, which also starts the counter; with
+ * preload enabled each frame takes effect at the update event after the one
+ * that requested it.
+ *
+ * @param[in] burst Pointer to the `DMA_Timer_Burst` structure.
+ *
+ * @return int8_t Returns 1 on success, or -1 if the configuration is invalid or the stream is already claimed.
+ */
+int8_t DMA_Timer_Start(DMA_Timer_Burst *burst)
+{
+    DMA_Stream_TypeDef *stream = burst->Request.Stream;
+    volatile uint32_t *flag_clear;
+    uint32_t flag_mask;
+    uint32_t items = (uint32_t)burst->block_frames * burst->registers;
+    uint32_t frame_size = (uint32_t)burst->registers * (burst->word ? 4U : 2U);
+
+    if((stream == NULL) || (burst->TIM == NULL) || (burst->generate == NULL))
+    {
+        return -1;
+    }
+    if((burst->registers == 0) || (burst->registers > DMA_TIMER_MAX_REGISTERS) || (burst->base_register > 0x1F))
+    {
+        return -1;
+    }
+    if((burst->block_frames == 0) || (items > 0xFFFF) || (burst->buffers[0] == NULL) || (burst->buffers[1] == NULL))
+    {
+        return -1;
+    }
+    if(DMA_Stream_Claim(stream) != 1)
+    {
+        return -1;
+    }
+
+    burst->end_buffer = -1;
+    burst->blocks = 0;
+    burst->underruns = 0;
+
+    // A waveform without any frame holds all registers at 0
+    memset((uint8_t *)burst->buffers[1] + (uint32_t)(burst->block_frames - 1) * frame_size, 0, frame_size);
+    DMA_Timer_Fill(burst, 0);
+    DMA_Timer_Fill(burst, 1);
+
+    stream->CR &= ~DMA_SxCR_EN;
+    while(stream->CR & DMA_SxCR_EN) {}
+
+    stream->CR = ((uint32_t)burst->Request.channel << DMA_SxCR_CHSEL_Pos) |
+                 DMA_Configuration.Transfer_Direction.Memory_to_peripheral |
+                 burst->priority_level |
+                 (burst->word ? DMA_Configuration.Memory_Data_Size.word : DMA_Configuration.Memory_Data_Size.half_word) |
+                 (burst->word ? DMA_Configuration.Peripheral_Data_Size.word : DMA_Configuration.Peripheral_Data_Size.half_word) |
+                 DMA_Configuration.Memory_Pointer_Increment.Enable |
+                 DMA_Configuration.Circular_Mode.Enable |
+                 DMA_SxCR_DBM |
+                 DMA_Configuration.DMA_Interrupts.Transfer_Complete |
+                 DMA_Configuration.DMA_Interrupts.Transfer_Error;
+    stream->FCR = 0;
+
+    stream->PAR = (uint32_t)&(burst->TIM->DMAR);
+    stream->M0AR = (uint32_t)burst->buffers[0];
+    stream->M1AR = (uint32_t)burst->buffers[1];
+    stream->NDTR = items;
+
+    flag_clear = DMA_Flag_Clear_Register(stream, &flag_mask);
+    *flag_clear = flag_mask;
+
+    burst->running = true;
+    DMA_Register_Callback(stream, DMA_Timer_Callback, burst);
+    DMA_Stream_IRQ_Enable(stream);
+    stream->CR |= DMA_SxCR_EN;
+
+    burst->TIM->DCR = ((uint32_t)(burst->registers - 1U) << TIM_DCR_DBL_Pos) |
+                      ((uint32_t)burst->base_register << TIM_DCR_DBA_Pos);
+    burst->TIM->DIER |= TIM_DIER_UDE;
+
+    return 1;
+}
+
+/**
+ * @brief Stops the waveform and releases the stream.
+ *
+ * The timer keeps running with the registers of the last frame written.
+ *
+ * @param[in] burst Pointer to the `DMA_Timer_Burst` structure.
+ */
+void DMA_Timer_Stop(DMA_Timer_Burst *burst)
+{
+    DMA_Stream_TypeDef *stream = burst->Request.Stream;
+
+    DMA_Timer_Halt(burst);
+    while(stream->CR & DMA_SxCR_EN) {}
+
+    DMA_Register_Callback(stream, NULL, NULL);
+    DMA_Stream_Release(stream);
+}
+
+/**
+ * @brief Reports whether the waveform is still playing.
+ *
+ * A waveform that ended on its own still holds its stream until
+ * `DMA_Timer_Stop` is called.
+ *
+ * @param[in] burst Pointer to the `DMA_Timer_Burst` structure.
+ *
+ * @return bool `true` until the last block has been played or the burst is stopped.
+ */
+bool DMA_Timer_Busy(DMA_Timer_Burst *burst)
+{
+    return burst->running;
+}
+
+/**
+ * @brief Encoder generator: fills a block with bit frames.
+ *
+ * Runs in the transfer complete interrupt, so the work per frame is kept to
+ * one bit test per channel.
+ *
+ * @param[in] block Block to fill.
+ * @param[in] frames Number of frames in the block.
+ * @param[in] context Pointer to a `DMA_Timer_Encoder` structure.
+ *
+ * @return uint16_t Number of frames written; fewer than `frames` once the data and reset frames are done.
+ */
+uint16_t DMA_Timer_Encode(void *block, uint16_t frames, void *context)
+{
+    DMA_Timer_Encoder *encoder = (DMA_Timer_Encoder *)context;
+    uint16_t *half_words = (uint16_t *)block;
+    uint32_t *words = (uint32_t *)block;
+    uint32_t bits = encoder->length * 8U;
+    uint32_t total = bits + encoder->reset_frames;
+    uint32_t position = encoder->position;
+    uint32_t slot = 0;
+    uint32_t byte;
+    uint32_t value;
+    uint16_t frame;
+    uint8_t mask;
+    uint8_t channel;
+
+    for(frame = 0; (frame < frames) && (position < total); frame++, position++)
+    {
+        byte = position >> 3;
+        mask = (uint8_t)(0x80U >> (position & 7U));
+
+        for(channel = 0; channel < encoder->channels; channel++)
+        {
+            if(position < bits) value = (encoder->data[channel][byte] & mask) ? encoder->one : encoder->zero;
+            else value = 0;
+
+            if(encoder->word) words[slot++] = value;
+            else half_words[slot++] = (uint16_t)value;
+        }
+    }
+
+    encoder->position = position;
+
+    return frame;
+}
+
+/**
+ * @brief Packs 0xRRGGBB pixels into the GRB byte order of WS2812 LEDs.
+ *
+ * @param[in] pixels Pixel colors.
+ * @param[in] count Number of pixels.
+ * @param[out] bytes Output of `3 * count` bytes.
+ */
+void DMA_Timer_WS2812_Pack(const uint32_t *pixels, uint16_t count, uint8_t *bytes)
+{
+    uint16_t i;
+
+    for(i = 0; i < count; i++)
+    {
+        *bytes++ = (uint8_t)(pixels[i] >> 8);
+        *bytes++ = (uint8_t)(pixels[i] >> 16);
+        *bytes++ = (uint8_t)pixels[i];
+    }
+}
+
+/**
+ * @brief Packs a DShot command into its two-byte frame.
+ *
+ * The frame is the 11-bit value, the telemetry request bit and a 4-bit
+ * checksum (XOR of the three nibbles of the first 12 bits).
+ *
+ * @param[in] value Throttle (48 to 2047) or command (0 to 47).
+ * @param[in] telemetry Requests telemetry from the ESC.
+ * @param[out] bytes Output of 2 bytes, most significant first.
+ */
+void DMA_Timer_DShot_Pack(uint16_t value, bool telemetry, uint8_t *bytes)
+{
+    uint16_t packet = (uint16_t)(((value & 0x7FFU) << 1) | (telemetry ? 1U : 0U));
+    uint16_t checksum = (packet ^ (packet >> 4) ^ (packet >> 8)) & 0x0FU;
+
+    packet = (uint16_t)((packet << 4) | checksum);
+    bytes[0] = (uint8_t)(packet >> 8);
+    bytes[1] = (uint8_t)packet;
+}
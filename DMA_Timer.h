@@ -0,0 +1,140 @@
+/**
+ * @file DMA_Timer.h
+ * @author Kunal Salvi
+ * @brief Header file for the DMA timer burst engine.
+ *
+ * This file contains the data structures and function prototypes for updating
+ * several timer registers on every update event through the timer's DMA burst
+ * interface (`TIMx->DCR`/`TIMx->DMAR`). Each update event moves one frame of
+ * consecutive register values (e.g. `CCR1`..`CCR4`, or `ARR` together with the
+ * compare registers) into the timer. Frames are streamed in double-buffer mode
+ * from two blocks that a generator callback refills from the transfer complete
+ * interrupt, so waveforms of any length need only two blocks of RAM.
+ *
+ * A bit encoder is provided as generator for one-wire PWM protocols such as
+ * WS2812 LEDs and DShot: every bit becomes one PWM period whose compare value
+ * selects the high time, and up to four outputs of the timer are driven in
+ * parallel from separate byte arrays.
+ *
+ * @version 1.0
+ * @date 2024-08-22
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef DMA_TIMER_H_
+#define DMA_TIMER_H_
+
+#include "DMA.h"
+
+#define DMA_TIMER_ARR               11      /**< Burst base register (`DBA`) of `ARR` */
+#define DMA_TIMER_RCR               12      /**< Burst base register (`DBA`) of `RCR` */
+#define DMA_TIMER_CCR1              13      /**< Burst base register (`DBA`) of `CCR1` */
+#define DMA_TIMER_MAX_REGISTERS     18      /**< Maximum registers per frame (`DBL` + 1) */
+#define DMA_TIMER_MAX_CHANNELS      4       /**< Maximum outputs driven by one encoder */
+
+/**
+ * @brief Timer burst structure.
+ *
+ * The fields in the first group are set by the application before calling
+ * `DMA_Timer_Start`. A block holds `block_frames` frames of `registers` values,
+ * stored as half-words, or as words when `word` is set (32-bit registers of
+ * TIM2 and TIM5). The remaining fields are managed by the engine.
+ */
+typedef struct DMA_Timer_Burst
+{
+    TIM_TypeDef *TIM;                   /**< Timer, configured by the application */
+    DMA_Request Request;                /**< Update request of the timer (e.g. `DMA_Configuration.Request.TIM1_UP`) */
+    uint8_t base_register;              /**< First register written by each frame (e.g. `DMA_TIMER_CCR1`) */
+    uint8_t registers;                  /**< Consecutive registers per frame (1 to `DMA_TIMER_MAX_REGISTERS`) */
+    bool word;                          /**< Frames hold words instead of half-words */
+    uint32_t priority_level;            /**< Priority level of the stream */
+    void *buffers[2];                   /**< Frame blocks */
+    uint16_t block_frames;              /**< Frames per block */
+    uint16_t (*generate)(void *block, uint16_t frames, void *context); /**< Fills a block and returns the frames written; fewer than `frames` ends the waveform */
+    void *context;                      /**< User pointer for the generator */
+
+    volatile bool running;              /**< `true` until the last block has been played */
+    int8_t end_buffer;                  /**< Buffer holding the end of the waveform, or -1 */
+    volatile uint32_t blocks;           /**< Number of blocks generated */
+    volatile uint32_t underruns;        /**< Blocks the generator did not refill before they were played */
+} DMA_Timer_Burst;
+
+/**
+ * @brief Bit encoder for one-wire PWM protocols.
+ *
+ * Used as `generate` with the encoder as `context`. Each frame carries one bit
+ * of every channel: `one` or `zero` is written to the channel's compare
+ * register depending on the bit, most significant bit of each byte first. The
+ * bits are followed by `reset_frames` frames with a compare value of 0 (output
+ * held low), which also end the waveform on a low level.
+ */
+typedef struct DMA_Timer_Encoder
+{
+    const uint8_t *data[DMA_TIMER_MAX_CHANNELS]; /**< Bytes sent on each channel */
+    uint8_t channels;                   /**< Number of channels, equal to the burst's `registers` */
+    uint32_t length;                    /**< Bytes per channel */
+    uint32_t one;                       /**< Compare value of a 1 bit */
+    uint32_t zero;                      /**< Compare value of a 0 bit */
+    uint16_t reset_frames;              /**< Low frames after the data (latch or inter-frame gap) */
+    bool word;                          /**< Equal to the burst's `word` */
+
+    uint32_t position;                  /**< Next frame to encode; set to 0 before each start */
+} DMA_Timer_Encoder;
+
+/**
+ * @brief Starts streaming register frames to the timer.
+ *
+ * @param[in] burst Pointer to the DMA_Timer_Burst structure.
+ *
+ * @return int8_t Returns 1 on success, or -1 if the configuration is invalid or the stream is already claimed.
+ */
+int8_t DMA_Timer_Start(DMA_Timer_Burst *burst);
+
+/**
+ * @brief Stops the waveform and releases the stream.
+ *
+ * @param[in] burst Pointer to the DMA_Timer_Burst structure.
+ */
+void DMA_Timer_Stop(DMA_Timer_Burst *burst);
+
+/**
+ * @brief Reports whether the waveform is still playing.
+ *
+ * @param[in] burst Pointer to the DMA_Timer_Burst structure.
+ *
+ * @return bool `true` until the last block has been played or the burst is stopped.
+ */
+bool DMA_Timer_Busy(DMA_Timer_Burst *burst);
+
+/**
+ * @brief Encoder generator: fills a block with bit frames.
+ *
+ * @param[in] block Block to fill.
+ * @param[in] frames Number of frames in the block.
+ * @param[in] context Pointer to a DMA_Timer_Encoder structure.
+ *
+ * @return uint16_t Number of frames written.
+ */
+uint16_t DMA_Timer_Encode(void *block, uint16_t frames, void *context);
+
+/**
+ * @brief Packs 0xRRGGBB pixels into the GRB byte order of WS2812 LEDs.
+ *
+ * @param[in] pixels Pixel colors.
+ * @param[in] count Number of pixels.
+ * @param[out] bytes Output of `3 * count` bytes.
+ */
+void DMA_Timer_WS2812_Pack(const uint32_t *pixels, uint16_t count, uint8_t *bytes);
+
+/**
+ * @brief Packs a DShot command into its two-byte frame.
+ *
+ * @param[in] value Throttle (48 to 2047) or command (0 to 47).
+ * @param[in] telemetry Requests telemetry from the ESC.
+ * @param[out] bytes Output of 2 bytes, most significant first.
+ */
+void DMA_Timer_DShot_Pack(uint16_t value, bool telemetry, uint8_t *bytes);
+
+#endif /* DMA_TIMER_H_ */
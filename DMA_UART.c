@@ -0,0 +1,209 @@
+/**
+ * @file DMA_UART.c
+ * @brief DMA UART Packet Receiver Implementation for STM32F407VGT6
+ *
+ * This file implements idle-line framed reception. The stream writes every
+ * received byte into the ring in circular mode. The DMA write position is
+ * `ring_size - NDTR`; everything between the read index and that position is
+ * handed to the callback when the line goes idle (a complete frame) and at the
+ * ring's half transfer and transfer complete events (part of a longer frame),
+ * after which the read index moves up to the write position.
+ *
+ * @version 1.0
+ * @date 2024-08-22
+ *
+ * @author Kunal Salvi
+ * @copyright Copyright (c) 2024
+ */
+
+#include "DMA_UART.h"
+
+/**
+ * @brief Hands the bytes received since the last call to the callback.
+ *
+ * Called from the USART and the stream interrupts, which must have the same
+ * priority so the two calls cannot interleave.
+ *
+ * @param[in] rx Pointer to the receiver.
+ * @param[in] complete `true` when the line went idle.
+ */
+static void DMA_UART_RX_Deliver(DMA_UART_RX *rx, bool complete)
+{
+    DMA_UART_Frame frame;
+    uint32_t write = rx->ring_size - rx->Request.Stream->NDTR;
+
+    // NDTR reads 0 for an instant before the circular reload
+    if(write >= rx->ring_size)
+    {
+        write = 0;
+    }
+
+    // An idle line right after a part was handed over still ends that frame, with an empty view
+    if((write == rx->read) && !(complete && rx->partial))
+    {
+        return;
+    }
+
+    frame.first = rx->ring + rx->read;
+    frame.complete = complete;
+    if(write >= rx->read)
+    {
+        frame.first_length = (uint16_t)(write - rx->read);
+        frame.second = NULL;
+        frame.second_length = 0;
+    }
+    else
+    {
+        frame.first_length = (uint16_t)(rx->ring_size - rx->read);
+        frame.second = rx->ring;
+        frame.second_length = (uint16_t)write;
+    }
+
+    rx->read = (uint16_t)write;
+    rx->partial = !complete;
+    rx->bytes += (uint32_t)frame.first_length + frame.second_length;
+    if(complete)
+    {
+        rx->frames++;
+    }
+
+    if(rx->frame != NULL)
+    {
+        rx->frame(&frame, rx->context);
+    }
+}
+
+/**
+ * @brief Stream event callback: hands over the first or second half of the ring.
+ */
+static void DMA_UART_RX_Callback(DMA_Stream_TypeDef *stream, uint32_t event, void *context)
+{
+    DMA_UART_RX *rx = (DMA_UART_RX *)context;
+
+    if((event == DMA_Configuration.DMA_Interrupts.Half_Transfer_Complete) ||
+       (event == DMA_Configuration.DMA_Interrupts.Transfer_Complete))
+    {
+        DMA_UART_RX_Deliver(rx, false);
+    }
+    else if(event == DMA_Configuration.DMA_Interrupts.Transfer_Error)
+    {
+        rx->errors++;
+    }
+}
+
+/**
+ * @brief Starts receiving frames.
+ *
+ * This function claims the stream, configures it in circular mode for bytes
+ * from the USART's `DR` into the ring with half transfer, transfer complete
+ * and error interrupts, then enables the USART's DMA receiver and IDLE-line
+ * interrupt and the USART interrupt in the NVIC. The USART's baud rate and
+ * frame format are configured by the application.
+ *
+ * @param[in] rx Pointer to the `DMA_UART_RX` structure.
+ *
+ * @return int8_t Returns 1 on success, or -1 if the configuration is invalid or the stream is already claimed.
+ */
+int8_t DMA_UART_RX_Start(DMA_UART_RX *rx)
+{
+    DMA_Stream_TypeDef *stream = rx->Request.Stream;
+    volatile uint32_t *flag_clear;
+    uint32_t flag_mask;
+
+    if((stream == NULL) || (rx->USART == NULL) || (rx->ring == NULL) || (rx->ring_size < 2) || ((rx->ring_size & 1U) != 0))
+    {
+        return -1;
+    }
+    if(DMA_Stream_Claim(stream) != 1)
+    {
+        return -1;
+    }
+
+    rx->read = 0;
+    rx->partial = false;
+    rx->frames = 0;
+    rx->bytes = 0;
+    rx->errors = 0;
+
+    stream->CR &= ~DMA_SxCR_EN;
+    while(stream->CR & DMA_SxCR_EN) {}
+
+    stream->CR = ((uint32_t)rx->Request.channel << DMA_SxCR_CHSEL_Pos) |
+                 DMA_Configuration.Transfer_Direction.Peripheral_to_memory |
+                 rx->priority_level |
+                 DMA_Configuration.Memory_Data_Size.byte |
+                 DMA_Configuration.Peripheral_Data_Size.byte |
+                 DMA_Configuration.Memory_Pointer_Increment.Enable |
+                 DMA_Configuration.Circular_Mode.Enable |
+                 DMA_Configuration.DMA_Interrupts.Half_Transfer_Complete |
+                 DMA_Configuration.DMA_Interrupts.Transfer_Complete |
+                 DMA_Configuration.DMA_Interrupts.Transfer_Error;
+    stream->FCR = 0;
+
+    stream->PAR = (uint32_t)&(rx->USART->DR);
+    stream->M0AR = (uint32_t)rx->ring;
+    stream->NDTR = rx->ring_size;
+
+    flag_clear = DMA_Flag_Clear_Register(stream, &flag_mask);
+    *flag_clear = flag_mask;
+
+    DMA_Register_Callback(stream, DMA_UART_RX_Callback, rx);
+    DMA_Stream_IRQ_Enable(stream);
+    stream->CR |= DMA_SxCR_EN;
+
+    // Reading SR then DR clears a stale IDLE flag and any pending error
+    (void)rx->USART->SR;
+    (void)rx->USART->DR;
+    rx->USART->CR3 |= USART_CR3_DMAR;
+    rx->USART->CR1 |= USART_CR1_IDLEIE;
+    NVIC_EnableIRQ(rx->IRQn);
+
+    return 1;
+}
+
+/**
+ * @brief Stops receiving and releases the stream.
+ *
+ * Bytes received since the last frame are discarded.
+ *
+ * @param[in] rx Pointer to the `DMA_UART_RX` structure.
+ */
+void DMA_UART_RX_Stop(DMA_UART_RX *rx)
+{
+    DMA_Stream_TypeDef *stream = rx->Request.Stream;
+
+    rx->USART->CR1 &= ~USART_CR1_IDLEIE;
+    rx->USART->CR3 &= ~USART_CR3_DMAR;
+    stream->CR &= ~DMA_SxCR_EN;
+    while(stream->CR & DMA_SxCR_EN) {}
+
+    DMA_Register_Callback(stream, NULL, NULL);
+    DMA_Stream_Release(stream);
+}
+
+/**
+ * @brief Handles the USART interrupt; to be called from the USART's IRQ handler.
+ *
+ * Counts receive errors and, when the line has gone idle, hands the frame to
+ * the callback. The IDLE and error flags are cleared by reading `SR` then
+ * `DR`; with the DMA receiver enabled `DR` holds no unread byte at that point.
+ *
+ * @param[in] rx Pointer to the `DMA_UART_RX` structure.
+ */
+void DMA_UART_RX_IRQ_Handler(DMA_UART_RX *rx)
+{
+    uint32_t status = rx->USART->SR;
+
+    if(status & (USART_SR_IDLE | USART_SR_ORE | USART_SR_FE | USART_SR_NE))
+    {
+        (void)rx->USART->DR;
+    }
+    if(status & (USART_SR_ORE | USART_SR_FE | USART_SR_NE))
+    {
+        rx->errors++;
+    }
+    if(status & USART_SR_IDLE)
+    {
+        DMA_UART_RX_Deliver(rx, true);
+    }
+}
@@ -0,0 +1,90 @@
+/**
+ * @file DMA_UART.h
+ * @author Kunal Salvi
+ * @brief Header file for the DMA UART packet receiver.
+ *
+ * This file contains the data structures and function prototypes for
+ * receiving variable-length frames on a USART. The RX stream runs in circular
+ * mode over a ring and never stops; the USART's IDLE-line interrupt marks the
+ * end of a frame one character time after its last byte, at any baud rate. The
+ * frame extent is taken from the stream's `NDTR` and handed to a callback as a
+ * zero-copy view into the ring, split in two parts when the frame wraps around
+ * the end of the ring. Data of frames longer than half the ring is also handed
+ * over at the ring's half and end so the DMA never overwrites unread bytes.
+ *
+ * @version 1.0
+ * @date 2024-08-22
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef DMA_UART_H_
+#define DMA_UART_H_
+
+#include "DMA.h"
+
+/**
+ * @brief Zero-copy view of received bytes in the ring.
+ *
+ * The bytes are `first[0 .. first_length - 1]` followed by
+ * `second[0 .. second_length - 1]`; `second_length` is 0 unless the bytes wrap
+ * around the end of the ring. The view is only valid during the callback.
+ */
+typedef struct DMA_UART_Frame
+{
+    const uint8_t *first;               /**< First part of the bytes */
+    uint16_t first_length;              /**< Length of the first part */
+    const uint8_t *second;              /**< Second part, from the start of the ring */
+    uint16_t second_length;             /**< Length of the second part */
+    bool complete;                      /**< `true` if the line went idle after these bytes, `false` for part of a longer frame */
+} DMA_UART_Frame;
+
+/**
+ * @brief UART packet receiver structure.
+ *
+ * The fields in the first group are set by the application before calling
+ * `DMA_UART_RX_Start`. The remaining fields are managed by the receiver.
+ */
+typedef struct DMA_UART_RX
+{
+    USART_TypeDef *USART;               /**< USART, configured and enabled by the application */
+    IRQn_Type IRQn;                     /**< Interrupt of the USART (e.g. `USART2_IRQn`) */
+    DMA_Request Request;                /**< RX request of the USART (e.g. `DMA_Configuration.Request.USART2_RX`) */
+    uint32_t priority_level;            /**< Priority level of the stream */
+    uint8_t *ring;                      /**< Receive ring */
+    uint16_t ring_size;                 /**< Size of the ring in bytes (even) */
+    void (*frame)(const DMA_UART_Frame *frame, void *context); /**< Receives each frame or part of a frame */
+    void *context;                      /**< User pointer for the callback */
+
+    uint16_t read;                      /**< Ring index of the first byte not yet handed over */
+    bool partial;                       /**< Part of a frame has been handed over and its end is pending */
+    volatile uint32_t frames;           /**< Complete frames received */
+    volatile uint32_t bytes;            /**< Bytes received */
+    volatile uint32_t errors;           /**< Overrun, framing and noise errors reported by the USART */
+} DMA_UART_RX;
+
+/**
+ * @brief Starts receiving frames.
+ *
+ * @param[in] rx Pointer to the DMA_UART_RX structure.
+ *
+ * @return int8_t Returns 1 on success, or -1 if the configuration is invalid or the stream is already claimed.
+ */
+int8_t DMA_UART_RX_Start(DMA_UART_RX *rx);
+
+/**
+ * @brief Stops receiving and releases the stream.
+ *
+ * @param[in] rx Pointer to the DMA_UART_RX structure.
+ */
+void DMA_UART_RX_Stop(DMA_UART_RX *rx);
+
+/**
+ * @brief Handles the USART interrupt; to be called from the USART's IRQ handler.
+ *
+ * @param[in] rx Pointer to the DMA_UART_RX structure.
+ */
+void DMA_UART_RX_IRQ_Handler(DMA_UART_RX *rx);
+
+#endif /* DMA_UART_H_ */
@@ -0,0 +1,400 @@
+/**
+ * @file DMA_Cache_Host.c
+ * @brief Host harness for the flash block cache
+ *
+ * Replays sequential, strided and random read patterns through `DMA_Cache`
+ * filled by the file-backed backend, for a range of block sizes and prefetch
+ * depths. Every read is checked against the image and the cache counters are
+ * printed per configuration, which is how the block size and the read-ahead
+ * depth of a target are tuned. An image file can be given as the first
+ * argument; otherwise a generated one is used.
+ *
+ * Fills complete later, as over DMA, against a simulated clock: each read
+ * is followed by the application's work on its data, during which the fill
+ * in flight and the read-ahead behind it go on, and a read that waits for a
+ * block has the fills in flight ended by a timer signal standing in for the
+ * backend's interrupt. The time spent waiting is printed as the stall, so
+ * read-ahead that overlaps the work shows.
+ *
+ * @version 1.0
+ * @date 2024-08-22
+ *
+ * @author Kunal Salvi
+ * @copyright Copyright (c) 2024
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "DMA_Cache.h"
+#include "DMA_Cache_File.h"
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define HOST_IMAGE_SIZE     (256U * 1024U)  /**< Size of the generated image */
+#define HOST_MEMORY_SIZE    (8U * 1024U)    /**< Cache memory of every configuration */
+#define HOST_READS          4000U           /**< Reads per pattern */
+#define HOST_WORK_NS        4000U           /**< Application time spent on the data of each read */
+#define HOST_SETUP_NS       1000U           /**< Command and address phase of a flash read */
+#define HOST_BYTE_NS        40U             /**< Transfer time per byte, quad SPI at 25 MB/s */
+#define HOST_IRQ_NS         20000L          /**< Period of the timer signal */
+
+/**
+ * @brief Simulated flash: the fill in flight and the clock it ends against.
+ *
+ * The timer signal is only unblocked during `DMA_Cache_Read`, as the
+ * backend's interrupt would only matter there; the reader ends fills itself
+ * with the signal blocked.
+ */
+typedef struct Host_Flash
+{
+    DMA_Cache *cache;
+    DMA_Cache_Block *volatile filling;  /**< Block whose fill is in flight, or NULL; written after `done` */
+    volatile uint64_t done;             /**< Time the fill in flight ends */
+    uint64_t now;                       /**< Simulated time in nanoseconds */
+    uint64_t stall;                     /**< Time the reader waited for fills */
+    uint32_t first;                     /**< First block of the read in progress */
+    uint32_t last;                      /**< Last block of the read in progress */
+    uint32_t seen;                      /**< Cache clock and lookups at the previous signal */
+    uint64_t spun;                      /**< CPU time of the harness at the previous signal */
+    sigset_t irq;                       /**< The timer signal */
+} Host_Flash;
+
+static uint8_t *Host_Image;
+static uint32_t Host_Image_Size;
+static Host_Flash Host_Bus;
+
+/**
+ * @brief Loads the image into memory as the reference for the checks.
+ */
+static int Host_Load(const char *path)
+{
+    FILE *file = fopen(path, "rb");
+    long size;
+
+    if(file == NULL)
+    {
+        return -1;
+    }
+    fseek(file, 0, SEEK_END);
+    size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    Host_Image = malloc((size_t)size);
+    Host_Image_Size = (uint32_t)size;
+    if((Host_Image == NULL) || (fread(Host_Image, 1, (size_t)size, file) != (size_t)size))
+    {
+        fclose(file);
+        return -1;
+    }
+    fclose(file);
+
+    return 0;
+}
+
+/**
+ * @brief Writes a generated image to a temporary file.
+ */
+static const char *Host_Generate(void)
+{
+    static char path[] = "dma_cache_host.bin";
+    FILE *file = fopen(path, "wb");
+    uint32_t i;
+
+    if(file == NULL)
+    {
+        return NULL;
+    }
+    for(i = 0; i < HOST_IMAGE_SIZE; i++)
+    {
+        fputc((int)((i * 2654435761U) >> 24), file);
+    }
+    fclose(file);
+
+    return path;
+}
+
+/**
+ * @brief Cache fill function: starts the fill, which ends `done` later.
+ */
+static int8_t Host_Fill(DMA_Cache *cache, DMA_Cache_Block *block)
+{
+    Host_Bus.done = Host_Bus.now + HOST_SETUP_NS + ((uint64_t)cache->block_size * HOST_BYTE_NS);
+    Host_Bus.filling = block;
+
+    return 1;
+}
+
+/**
+ * @brief Ends the fill in flight at its time, which starts the next queued fill.
+ *
+ * @param[in] waited The reader was waiting for the fill.
+ */
+static void Host_Complete(bool waited)
+{
+    DMA_Cache_Block *block = Host_Bus.filling;
+
+    if(Host_Bus.done > Host_Bus.now)
+    {
+        if(waited)
+        {
+            Host_Bus.stall += Host_Bus.done - Host_Bus.now;
+        }
+        Host_Bus.now = Host_Bus.done;
+    }
+    Host_Bus.filling = NULL;
+    DMA_Cache_File_Fill(Host_Bus.cache, block);
+}
+
+/**
+ * @brief Returns true if the read in progress waits for a fill.
+ *
+ * It does once one of its blocks is filling or queued for it, or while it
+ * looks for a block to fill and all of them are queued or filling.
+ */
+static bool Host_Waiting(void)
+{
+    DMA_Cache *cache = Host_Bus.cache;
+    DMA_Cache_Block *block;
+    bool missing = false;
+    bool spare = false;
+    uint32_t address;
+    uint32_t i;
+
+    for(address = Host_Bus.first; address <= Host_Bus.last; address += cache->block_size)
+    {
+        for(i = 0; i < cache->block_count; i++)
+        {
+            block = &cache->blocks[i];
+            if((block->address != address) || (block->state == DMA_CACHE_EMPTY) || (block->state == DMA_CACHE_FAILED))
+            {
+                continue;
+            }
+            if((block->state == DMA_CACHE_FILLING) || ((block->state == DMA_CACHE_QUEUED) && block->demand))
+            {
+                return true;
+            }
+            break;
+        }
+        missing |= (i == cache->block_count);
+    }
+
+    for(i = 0; i < cache->block_count; i++)
+    {
+        spare |= (cache->blocks[i].state != DMA_CACHE_QUEUED) && (cache->blocks[i].state != DMA_CACHE_FILLING);
+    }
+
+    return missing && !spare;
+}
+
+/**
+ * @brief Timer signal: ends the fills the read in progress waits for.
+ *
+ * Only once the read has run for a whole period without moving, so it is
+ * spinning and has queued all it will before waiting; otherwise the results
+ * would depend on where the signal lands.
+ */
+static void Host_IRQ(int signal)
+{
+    DMA_Cache *cache = Host_Bus.cache;
+    uint32_t seen = cache->clock + cache->hits + cache->misses;
+    struct timespec now;
+    uint64_t spun;
+
+    (void)signal;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &now);
+    spun = ((uint64_t)now.tv_sec * 1000000000ULL) + (uint64_t)now.tv_nsec;
+    if(seen != Host_Bus.seen)
+    {
+        Host_Bus.seen = seen;
+        Host_Bus.spun = spun;
+        return;
+    }
+    if((spun - Host_Bus.spun) < (uint64_t)HOST_IRQ_NS)
+    {
+        // Signals delivered back to back, e.g. after the harness was descheduled
+        return;
+    }
+    while((Host_Bus.filling != NULL) && Host_Waiting())
+    {
+        Host_Complete(true);
+    }
+    Host_Bus.seen = ~seen;
+}
+
+/**
+ * @brief Reads through the cache, then spends the work time with fills going on.
+ */
+static int8_t Host_Read(DMA_Cache *cache, uint32_t address, uint8_t *buffer, uint32_t length)
+{
+    uint64_t until;
+    int8_t status;
+
+    Host_Bus.first = address & ~(cache->block_size - 1U);
+    Host_Bus.last = (address + length - 1U) & ~(cache->block_size - 1U);
+    Host_Bus.seen = ~(cache->clock + cache->hits + cache->misses);
+
+    sigprocmask(SIG_UNBLOCK, &Host_Bus.irq, NULL);
+    status = DMA_Cache_Read(cache, address, buffer, length);
+    sigprocmask(SIG_BLOCK, &Host_Bus.irq, NULL);
+
+    until = Host_Bus.now + HOST_WORK_NS;
+    while((Host_Bus.filling != NULL) && (Host_Bus.done <= until))
+    {
+        Host_Complete(false);
+    }
+    Host_Bus.now = until;
+
+    return status;
+}
+
+/**
+ * @brief Returns the address and length of read `i` of a pattern.
+ */
+static void Host_Access(int pattern, uint32_t i, uint32_t *address, uint32_t *length)
+{
+    switch(pattern)
+    {
+        case 0:     // Sequential stream of 100-byte records
+            *length = 100;
+            *address = (i * 100U) % (Host_Image_Size - 100U);
+            break;
+        case 1:     // Two interleaved sequential streams
+            *length = 64;
+            *address = ((i & 1U) ? (Host_Image_Size / 2U) : 0) + ((i / 2U) * 64U) % (Host_Image_Size / 2U - 64U);
+            break;
+        default:    // Random small reads
+            *length = 1U + (uint32_t)(rand() % 48);
+            *address = (uint32_t)rand() % (Host_Image_Size - *length);
+            break;
+    }
+}
+
+/**
+ * @brief Runs every pattern on one configuration and prints the counters.
+ */
+static int Host_Run(DMA_Cache_File *file, uint32_t block_size, uint32_t prefetch_depth)
+{
+    static const char *names[] = { "sequential", "interleaved", "random" };
+    static uint8_t memory[HOST_MEMORY_SIZE];
+    static DMA_Cache_Block blocks[HOST_MEMORY_SIZE / 64U];
+    uint8_t buffer[128];
+    DMA_Cache cache;
+    uint32_t address;
+    uint32_t length;
+    uint32_t i;
+    int pattern;
+
+    for(pattern = 0; pattern < 3; pattern++)
+    {
+        memset(&cache, 0, sizeof(cache));
+        cache.fill = Host_Fill;
+        cache.device = file;
+        cache.memory = memory;
+        cache.blocks = blocks;
+        cache.block_count = HOST_MEMORY_SIZE / block_size;
+        cache.block_size = block_size;
+        cache.prefetch_depth = prefetch_depth;
+        cache.flash_size = Host_Image_Size;
+        if(DMA_Cache_Init(&cache) != 1)
+        {
+            printf("invalid configuration %u/%u\n", block_size, prefetch_depth);
+            return -1;
+        }
+
+        srand(1);
+        file->fills = 0;
+        file->bytes = 0;
+        Host_Bus.cache = &cache;
+        Host_Bus.now = 0;
+        Host_Bus.stall = 0;
+
+        for(i = 0; i < HOST_READS; i++)
+        {
+            Host_Access(pattern, i, &address, &length);
+            if((Host_Read(&cache, address, buffer, length) != 1) || (memcmp(buffer, Host_Image + address, length) != 0))
+            {
+                printf("mismatch at 0x%08X (%u bytes), block %u, depth %u, %s\n", address, length, block_size, prefetch_depth, names[pattern]);
+                return -1;
+            }
+        }
+
+        // Let the read-ahead still in flight end before the cache goes away
+        while(Host_Bus.filling != NULL)
+        {
+            Host_Complete(false);
+        }
+
+        printf("%6u %6u  %-12s %8u %8u %10u %9u %10u %9u\n", block_size, prefetch_depth, names[pattern],
+               cache.hits, cache.misses, cache.prefetches, cache.prefetch_hits, file->bytes,
+               (uint32_t)(Host_Bus.stall / 1000U));
+    }
+
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    static const uint32_t block_sizes[] = { 256, 512, 1024 };
+    static const uint32_t depths[] = { 0, 1, 2, 4 };
+    struct sigaction action;
+    struct sigevent event;
+    struct itimerspec period;
+    timer_t timer;
+    DMA_Cache_File file;
+    const char *path = (argc > 1) ? argv[1] : Host_Generate();
+    unsigned b;
+    unsigned d;
+
+    memset(&file, 0, sizeof(file));
+    file.path = path;
+    if((path == NULL) || (Host_Load(path) != 0) || (DMA_Cache_File_Open(&file) != 1) || (Host_Image_Size < 4096U))
+    {
+        printf("cannot use image %s\n", (path != NULL) ? path : "(none)");
+        return 1;
+    }
+
+    // The timer signal stays blocked outside the reads
+    sigemptyset(&Host_Bus.irq);
+    sigaddset(&Host_Bus.irq, SIGALRM);
+    sigprocmask(SIG_BLOCK, &Host_Bus.irq, NULL);
+
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = Host_IRQ;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGALRM, &action, NULL);
+
+    memset(&event, 0, sizeof(event));
+    event.sigev_notify = SIGEV_SIGNAL;
+    event.sigev_signo = SIGALRM;
+    memset(&period, 0, sizeof(period));
+    period.it_value.tv_nsec = HOST_IRQ_NS;
+    period.it_interval.tv_nsec = HOST_IRQ_NS;
+    if((timer_create(CLOCK_MONOTONIC, &event, &timer) != 0) || (timer_settime(timer, 0, &period, NULL) != 0))
+    {
+        printf("cannot start the timer signal\n");
+        return 1;
+    }
+
+    printf(" block  depth  pattern          hits   misses prefetches  pf. hits flash read  stall us\n");
+    for(b = 0; b < sizeof(block_sizes) / sizeof(block_sizes[0]); b++)
+    {
+        for(d = 0; d < sizeof(depths) / sizeof(depths[0]); d++)
+        {
+            if(Host_Run(&file, block_sizes[b], depths[d]) != 0)
+            {
+                timer_delete(timer);
+                DMA_Cache_File_Close(&file);
+                return 1;
+            }
+        }
+    }
+
+    timer_delete(timer);
+    DMA_Cache_File_Close(&file);
+    free(Host_Image);
+
+    return 0;
+}
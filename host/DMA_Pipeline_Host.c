@@ -0,0 +1,366 @@
+/**
+ * @file DMA_Pipeline_Host.c
+ * @brief Host harness for the DMA block pipeline
+ *
+ * Runs `DMA_Pipeline.c` with the critical section override of
+ * `Host_Critical.h` between a simulated producer and consumer, each a thread
+ * standing in for a DMA stage and its interrupt. The producer stamps every
+ * block with a sequence number and a pattern; the consumer checks the pattern
+ * before and after its transfer time, so a block handed out twice or reused
+ * while queued shows up as a mismatch. The consumer has periodic slow blocks,
+ * as an SD card has write latency spikes, so the pool runs empty and the
+ * producer is stalled or runs into the scratch block. Each scenario checks the
+ * counters against what the stages saw and prints them.
+ *
+ * @version 1.0
+ * @date 2024-08-22
+ *
+ * @author Kunal Salvi
+ * @copyright Copyright (c) 2024
+ */
+
+#include "DMA_Pipeline.h"
+#include "Host_Critical.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <time.h>
+
+#define HOST_BLOCK_SIZE     256U    /**< Bytes per block */
+#define HOST_BLOCK_COUNT    4U      /**< Blocks in the pool */
+#define HOST_BLOCKS         1000U   /**< Blocks filled by the producer per scenario */
+#define HOST_STAGE_US       100U    /**< Transfer time of a block in either stage */
+#define HOST_SLOW_EVERY     16U     /**< Every n-th consumed block is slow */
+#define HOST_SLOW_US        2000U   /**< Transfer time of a slow block */
+
+/**
+ * @brief Simulated stage: a thread that runs one block at a time.
+ */
+typedef struct Host_Stage
+{
+    DMA_Pipeline *pipeline;
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t started;
+    uint8_t *block;                     /**< Block of the pending start */
+    uint32_t length;
+    bool pending;                       /**< Started and not yet completed */
+    bool quit;
+    uint32_t error_every;               /**< Consumer: every n-th block fails, 0 for none */
+
+    uint32_t count;                     /**< Blocks run */
+    uint32_t double_starts;             /**< Starts while a block was still running */
+    uint32_t mismatches;                /**< Consumer: blocks whose pattern was wrong */
+    uint32_t gaps;                      /**< Consumer: sequence numbers skipped */
+    uint32_t failed;                    /**< Consumer: blocks reported as failed */
+    int64_t last;                       /**< Consumer: last sequence number seen */
+} Host_Stage;
+
+static pthread_mutex_t Host_Critical_Lock;
+static volatile uint32_t Host_Critical_Depth;
+static uint32_t Host_Critical_Nested;
+static uint32_t Host_Critical_Entries;
+
+static uint32_t Host_Sequence;
+static int Host_Failures;
+
+void Host_Critical_Enter(uint32_t *state)
+{
+    pthread_mutex_lock(&Host_Critical_Lock);
+    if(Host_Critical_Depth != 0)
+    {
+        Host_Critical_Nested++;
+    }
+    Host_Critical_Depth++;
+    Host_Critical_Entries++;
+    *state = 0;
+}
+
+void Host_Critical_Exit(uint32_t state)
+{
+    (void)state;
+    Host_Critical_Depth--;
+    pthread_mutex_unlock(&Host_Critical_Lock);
+}
+
+static void Host_Sleep(uint32_t microseconds)
+{
+    struct timespec delay;
+
+    delay.tv_sec = microseconds / 1000000U;
+    delay.tv_nsec = (long)(microseconds % 1000000U) * 1000L;
+    nanosleep(&delay, NULL);
+}
+
+/**
+ * @brief Pipeline time source, in microseconds.
+ */
+static uint32_t Host_Time(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint32_t)(((uint64_t)now.tv_sec * 1000000U) + ((uint64_t)now.tv_nsec / 1000U));
+}
+
+static uint8_t Host_Pattern(uint32_t sequence, uint32_t i)
+{
+    return (uint8_t)((sequence * 31U) + i);
+}
+
+/**
+ * @brief Returns the sequence number of a block, or -1 if its pattern is wrong.
+ */
+static int64_t Host_Check_Block(const uint8_t *block, uint32_t length)
+{
+    uint32_t sequence = (uint32_t)block[0] | ((uint32_t)block[1] << 8) | ((uint32_t)block[2] << 16) | ((uint32_t)block[3] << 24);
+    uint32_t i;
+
+    for(i = 4; i < length; i++)
+    {
+        if(block[i] != Host_Pattern(sequence, i))
+        {
+            return -1;
+        }
+    }
+    return sequence;
+}
+
+/**
+ * @brief Stage start function: hands the block to the stage's thread.
+ */
+static int8_t Host_Start(uint8_t *block, uint32_t length, void *context)
+{
+    Host_Stage *stage = (Host_Stage *)context;
+
+    pthread_mutex_lock(&stage->lock);
+    if(stage->pending)
+    {
+        stage->double_starts++;
+        pthread_mutex_unlock(&stage->lock);
+        return -1;
+    }
+    stage->block = block;
+    stage->length = length;
+    stage->pending = true;
+    pthread_cond_signal(&stage->started);
+    pthread_mutex_unlock(&stage->lock);
+
+    return 1;
+}
+
+/**
+ * @brief Waits for the next start; returns false when the stage is shut down.
+ */
+static bool Host_Next(Host_Stage *stage)
+{
+    pthread_mutex_lock(&stage->lock);
+    while(!stage->pending && !stage->quit)
+    {
+        pthread_cond_wait(&stage->started, &stage->lock);
+    }
+    pthread_mutex_unlock(&stage->lock);
+
+    return stage->pending;
+}
+
+/**
+ * @brief Marks the running block done, so the stage can be started again from the completion.
+ */
+static void Host_Done(Host_Stage *stage)
+{
+    pthread_mutex_lock(&stage->lock);
+    stage->pending = false;
+    stage->count++;
+    pthread_mutex_unlock(&stage->lock);
+}
+
+/**
+ * @brief Producer: fills each block with its sequence number and pattern.
+ */
+static void *Host_Producer(void *argument)
+{
+    Host_Stage *stage = (Host_Stage *)argument;
+    uint32_t sequence;
+    uint32_t i;
+
+    while(Host_Next(stage))
+    {
+        sequence = Host_Sequence++;
+        stage->block[0] = (uint8_t)sequence;
+        stage->block[1] = (uint8_t)(sequence >> 8);
+        stage->block[2] = (uint8_t)(sequence >> 16);
+        stage->block[3] = (uint8_t)(sequence >> 24);
+        for(i = 4; i < stage->length; i++)
+        {
+            stage->block[i] = Host_Pattern(sequence, i);
+        }
+        Host_Sleep(HOST_STAGE_US);
+
+        Host_Done(stage);
+        DMA_Pipeline_Produced(stage->pipeline, stage->length);
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Consumer: checks each block before and after its transfer time.
+ */
+static void *Host_Consumer(void *argument)
+{
+    Host_Stage *stage = (Host_Stage *)argument;
+    int64_t sequence;
+    int8_t status;
+
+    while(Host_Next(stage))
+    {
+        sequence = Host_Check_Block(stage->block, stage->length);
+        Host_Sleep(((stage->count % HOST_SLOW_EVERY) == (HOST_SLOW_EVERY - 1U)) ? HOST_SLOW_US : HOST_STAGE_US);
+
+        if((sequence < 0) || (Host_Check_Block(stage->block, stage->length) != sequence) || (sequence <= stage->last))
+        {
+            stage->mismatches++;
+        }
+        else
+        {
+            stage->gaps += (uint32_t)(sequence - stage->last - 1);
+            stage->last = sequence;
+        }
+
+        status = 1;
+        if((stage->error_every != 0) && ((stage->count % stage->error_every) == (stage->error_every - 1U)))
+        {
+            status = -1;
+            stage->failed++;
+        }
+
+        Host_Done(stage);
+        DMA_Pipeline_Consumed(stage->pipeline, status);
+    }
+
+    return NULL;
+}
+
+static void Host_Check(const char *name, const char *check, int condition)
+{
+    if(!condition)
+    {
+        printf("%s: %s FAILED\n", name, check);
+        Host_Failures++;
+    }
+}
+
+static void Host_Stage_Init(Host_Stage *stage, DMA_Pipeline *pipeline, void *(*run)(void *))
+{
+    stage->pipeline = pipeline;
+    pthread_mutex_init(&stage->lock, NULL);
+    pthread_cond_init(&stage->started, NULL);
+    stage->pending = false;
+    stage->quit = false;
+    stage->count = 0;
+    stage->double_starts = 0;
+    stage->mismatches = 0;
+    stage->gaps = 0;
+    stage->failed = 0;
+    stage->last = -1;
+    pthread_create(&stage->thread, NULL, run, stage);
+}
+
+static void Host_Stage_Quit(Host_Stage *stage)
+{
+    pthread_mutex_lock(&stage->lock);
+    stage->quit = true;
+    pthread_cond_signal(&stage->started);
+    pthread_mutex_unlock(&stage->lock);
+    pthread_join(stage->thread, NULL);
+}
+
+/**
+ * @brief Runs one scenario and checks the pipeline counters against the stages.
+ */
+static void Host_Run(const char *name, bool scratch, uint32_t error_every)
+{
+    static uint8_t pool[HOST_BLOCK_COUNT * HOST_BLOCK_SIZE];
+    static uint8_t scratch_block[HOST_BLOCK_SIZE];
+    DMA_Pipeline pipeline = { 0 };
+    Host_Stage producer = { 0 };
+    Host_Stage consumer = { 0 };
+
+    pipeline.pool = pool;
+    pipeline.block_size = HOST_BLOCK_SIZE;
+    pipeline.block_count = HOST_BLOCK_COUNT;
+    pipeline.scratch = scratch ? scratch_block : NULL;
+    pipeline.producer.start = Host_Start;
+    pipeline.producer.context = &producer;
+    pipeline.consumer.start = Host_Start;
+    pipeline.consumer.context = &consumer;
+    pipeline.timestamp = Host_Time;
+
+    Host_Sequence = 0;
+    Host_Critical_Entries = 0;
+    Host_Critical_Nested = 0;
+
+    if(DMA_Pipeline_Init(&pipeline) != 1)
+    {
+        Host_Check(name, "init", 0);
+        return;
+    }
+    Host_Stage_Init(&producer, &pipeline, Host_Producer);
+    consumer.error_every = error_every;
+    Host_Stage_Init(&consumer, &pipeline, Host_Consumer);
+    Host_Check(name, "start", DMA_Pipeline_Start(&pipeline) == 1);
+
+    while(producer.count < HOST_BLOCKS)
+    {
+        Host_Sleep(1000U);
+    }
+    DMA_Pipeline_Stop(&pipeline);
+    while(DMA_Pipeline_Busy(&pipeline))
+    {
+        Host_Sleep(1000U);
+    }
+
+    Host_Stage_Quit(&producer);
+    Host_Stage_Quit(&consumer);
+
+    printf("%-10s %6u %8u %8u %7u %6u %6u %5u %8u %10u\n", name, producer.count, pipeline.produced, pipeline.consumed,
+           pipeline.dropped, pipeline.stalls, pipeline.errors, pipeline.max_depth, pipeline.max_latency,
+           DMA_Pipeline_Throughput(&pipeline, 1000000U));
+
+    Host_Check(name, "critical sections entered", Host_Critical_Entries != 0);
+    Host_Check(name, "no nested critical sections", Host_Critical_Nested == 0);
+    Host_Check(name, "no stage started twice", (producer.double_starts == 0) && (consumer.double_starts == 0));
+    Host_Check(name, "no block reused while queued", consumer.mismatches == 0);
+    Host_Check(name, "every fill queued or dropped", producer.count == pipeline.produced + pipeline.dropped);
+    Host_Check(name, "every queued block drained", consumer.count == pipeline.produced);
+    Host_Check(name, "failures counted", (pipeline.errors == consumer.failed) && (pipeline.consumed == pipeline.produced - consumer.failed));
+    Host_Check(name, "bytes counted", pipeline.bytes == pipeline.consumed * HOST_BLOCK_SIZE);
+    if(scratch)
+    {
+        Host_Check(name, "drops when the pool runs empty", (pipeline.dropped != 0) && (pipeline.stalls == 0));
+        Host_Check(name, "only dropped blocks skipped", consumer.gaps <= pipeline.dropped);
+    }
+    else
+    {
+        Host_Check(name, "stalls when the pool runs empty", (pipeline.stalls != 0) && (pipeline.dropped == 0));
+        Host_Check(name, "no block skipped", consumer.gaps == 0);
+    }
+    Host_Check(name, "pool bounds the queue", pipeline.max_depth <= HOST_BLOCK_COUNT);
+}
+
+int main(void)
+{
+    pthread_mutexattr_t attributes;
+
+    // Recursive, so a nested critical section is counted instead of deadlocking
+    pthread_mutexattr_init(&attributes);
+    pthread_mutexattr_settype(&attributes, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&Host_Critical_Lock, &attributes);
+
+    printf("scenario    fills   queued  drained dropped stalls errors depth  max lat  bytes/s\n");
+    Host_Run("stall", false, 0);
+    Host_Run("scratch", true, 0);
+    Host_Run("errors", false, 50);
+
+    return (Host_Failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,191 @@
+/**
+ * @file DMA_Wait_Host.c
+ * @brief Host harness for DMA_Wait and the memory-to-memory timeout
+ *
+ * Runs `DMA.c` on the simulated core of `Host_MCU.h`. A hardware thread ends
+ * the transfer of a stream after a delay, with a transfer complete or a
+ * transfer error, or never; `DMA_Wait` is checked in each case with the
+ * POSIX threads shim and with the WFE default, as are the rejection of
+ * circular and double buffer streams and the timeout and abort of
+ * `DMA_Memory_To_Memory_Transfer` and its rejection of a claimed stream.
+ *
+ * @version 1.0
+ * @date 2024-08-22
+ *
+ * @author Kunal Salvi
+ * @copyright Copyright (c) 2024
+ */
+
+#include "DMA.h"
+#include "DMA_Wait_Pthread.h"
+#include "Host_MCU.h"
+#include <stdio.h>
+
+#define HOST_STREAM         DMA2_Stream1                /**< Stream used for the DMA_Wait cases */
+#define HOST_MS             (SystemCoreClock / 1000U)   /**< CPU cycles per millisecond */
+#define HOST_NEVER          0xFFFFFFFFU                 /**< Delay of a transfer that never ends */
+#define HOST_M2M_LENGTH     20000U                      /**< Items of the memory-to-memory cases, about 9 ms of timeout */
+
+/**
+ * @brief Event the hardware thread raises once the stream is enabled.
+ */
+typedef struct Host_Event
+{
+    DMA_Stream_TypeDef *stream;
+    uint32_t flags;
+    uint32_t delay;                     /**< Microseconds after the stream is enabled, or HOST_NEVER */
+} Host_Event;
+
+static int Host_Failures;
+
+/**
+ * @brief Hardware thread: ends the transfer once it has run for the delay.
+ */
+static void *Host_Hardware(void *argument)
+{
+    Host_Event *event = (Host_Event *)argument;
+    uint32_t waited;
+
+    for(waited = 0; ((event->stream->CR & DMA_SxCR_EN) == 0) && (waited < 100000U); waited += 50U)
+    {
+        Host_Sleep(50U);
+    }
+    if(event->delay != HOST_NEVER)
+    {
+        Host_Sleep(event->delay);
+        Host_DMA_Raise(event->stream, event->flags);
+    }
+
+    return NULL;
+}
+
+static void Host_Check(const char *name, int condition)
+{
+    printf("%-52s %s\n", name, condition ? "ok" : "FAIL");
+    if(!condition)
+    {
+        Host_Failures++;
+    }
+}
+
+/**
+ * @brief Starts HOST_STREAM as a normal transfer with its TC and TE interrupts.
+ */
+static void Host_Start_Stream(uint32_t mode)
+{
+    HOST_STREAM->CR = DMA_SxCR_TCIE | DMA_SxCR_TEIE | mode | DMA_SxCR_EN;
+}
+
+/**
+ * @brief Runs DMA_Wait against a hardware thread and returns its result.
+ */
+static int8_t Host_Wait(uint32_t flags, uint32_t delay, uint32_t timeout, uint32_t *cycles)
+{
+    Host_Event event = { HOST_STREAM, flags, delay };
+    pthread_t hardware;
+    uint32_t start;
+    int8_t result;
+
+    Host_Start_Stream(0);
+    pthread_create(&hardware, NULL, Host_Hardware, &event);
+    start = DMA_Timestamp();
+    result = DMA_Wait(HOST_STREAM, timeout);
+    *cycles = DMA_Timestamp() - start;
+    pthread_join(hardware, NULL);
+
+    return result;
+}
+
+/**
+ * @brief Checks DMA_Wait with the installed sleep primitive.
+ */
+static void Host_Wait_Cases(const char *mode)
+{
+    char name[64];
+    uint32_t cycles;
+    int8_t result;
+
+    snprintf(name, sizeof(name), "%s: completion, no timeout", mode);
+    Host_Check(name, Host_Wait(DMA_LISR_TCIF0, 2000U, 0, &cycles) == 1);
+
+    snprintf(name, sizeof(name), "%s: completion before the timeout", mode);
+    Host_Check(name, Host_Wait(DMA_LISR_TCIF0, 2000U, 50U * HOST_MS, &cycles) == 1);
+
+    snprintf(name, sizeof(name), "%s: transfer error", mode);
+    Host_Check(name, Host_Wait(DMA_LISR_TEIF0, 2000U, 50U * HOST_MS, &cycles) == -1);
+
+    Host_DMA_Cleared(HOST_STREAM);
+    result = Host_Wait(0, HOST_NEVER, 5U * HOST_MS, &cycles);
+    snprintf(name, sizeof(name), "%s: timeout aborts and clears the stream", mode);
+    Host_Check(name, (result == 0) && (cycles >= 5U * HOST_MS) && ((HOST_STREAM->CR & DMA_SxCR_EN) == 0) &&
+                     (Host_DMA_Cleared(HOST_STREAM) == 0x3DU));
+
+    HOST_STREAM->CR = 0;
+    snprintf(name, sizeof(name), "%s: transfer already ended", mode);
+    Host_Check(name, DMA_Wait(HOST_STREAM, 0) == 1);
+}
+
+/**
+ * @brief Runs a memory-to-memory transfer against a hardware thread.
+ */
+static int8_t Host_M2M(uint32_t flags, uint32_t delay, uint32_t *cycles)
+{
+    static uint32_t source[HOST_M2M_LENGTH];
+    static uint32_t destination[HOST_M2M_LENGTH];
+    Host_Event event = { DMA2_Stream0, flags, delay };
+    pthread_t hardware;
+    uint32_t start;
+    int8_t result;
+
+    Host_DMA_Cleared(DMA2_Stream0);
+    pthread_create(&hardware, NULL, Host_Hardware, &event);
+    start = DMA_Timestamp();
+    result = DMA_Memory_To_Memory_Transfer(source, 32, 32, destination, true, true, HOST_M2M_LENGTH);
+    *cycles = DMA_Timestamp() - start;
+    pthread_join(hardware, NULL);
+
+    return result;
+}
+
+int main(void)
+{
+    static DMA_Wait_Pthread threads;
+    static DMA_Wait_Shim shim;
+    uint32_t cycles;
+    int8_t result;
+
+    Host_MCU_Start();
+    DMA_Timestamp_Enable();
+    DMA_Stream_IRQ_Enable(HOST_STREAM);
+
+    Host_Wait_Cases("wfe");
+
+    DMA_Wait_Pthread_Init(&threads, &shim);
+    DMA_Wait_Set_Shim(&shim);
+    Host_Wait_Cases("pthread");
+    Host_Check("pthread: waits were signalled", (threads.waits != 0) && (threads.signals != 0));
+    DMA_Wait_Set_Shim(NULL);
+
+    Host_Start_Stream(DMA_SxCR_CIRC);
+    Host_Check("circular stream rejected and left running", (DMA_Wait(HOST_STREAM, 0) == -1) && (HOST_STREAM->CR & DMA_SxCR_EN));
+    Host_Start_Stream(DMA_SxCR_DBM);
+    Host_Check("double buffer stream rejected and left running", (DMA_Wait(HOST_STREAM, 0) == -1) && (HOST_STREAM->CR & DMA_SxCR_EN));
+    HOST_STREAM->CR = 0;
+
+    Host_Check("m2m: completion", Host_M2M(DMA_LISR_TCIF0, 200U, &cycles) == 1);
+    Host_Check("m2m: transfer error", Host_M2M(DMA_LISR_TEIF0, 200U, &cycles) == -1);
+
+    result = Host_M2M(0, HOST_NEVER, &cycles);
+    Host_Check("m2m: timeout aborts and clears the stream", (result == 0) && ((DMA2_Stream0->CR & DMA_SxCR_EN) == 0) &&
+                                                            (Host_DMA_Cleared(DMA2_Stream0) == 0x3DU));
+    Host_Check("m2m: timeout bounded by the length", (cycles >= (HOST_M2M_LENGTH * 64U) + HOST_MS) && (cycles < 100U * HOST_MS));
+    Host_Check("m2m: DMA2 clock gated again", (RCC->AHB1ENR & RCC_AHB1ENR_DMA2EN) == 0);
+
+    DMA_Stream_Claim(DMA2_Stream0);
+    Host_Check("m2m: claimed stream rejected", Host_M2M(DMA_LISR_TCIF0, 200U, &cycles) == -1);
+    DMA_Stream_Release(DMA2_Stream0);
+
+    Host_MCU_Stop();
+
+    return (Host_Failures == 0) ? 0 : 1;
+}
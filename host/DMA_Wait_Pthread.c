@@ -0,0 +1,82 @@
+/**
+ * @file DMA_Wait_Pthread.c
+ * @brief POSIX Threads Shim of DMA_Wait Implementation for host builds
+ *
+ * This file implements the sleep primitive of `DMA_Wait` with one condition
+ * variable shared by all streams and a pending bit per stream index. The
+ * timeout is converted from CPU cycles at `SystemCoreClock`.
+ *
+ * @version 1.0
+ * @date 2024-08-22
+ *
+ * @author Kunal Salvi
+ * @copyright Copyright (c) 2024
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "DMA_Wait_Pthread.h"
+#include <time.h>
+
+/**
+ * @brief Blocks until the stream is signalled or `timeout` cycles have passed.
+ */
+static void DMA_Wait_Pthread_Wait(uint8_t index, uint32_t timeout, void *context)
+{
+    DMA_Wait_Pthread *threads = (DMA_Wait_Pthread *)context;
+    uint64_t nanoseconds = ((uint64_t)timeout * 1000000000ULL) / SystemCoreClock;
+    struct timespec until;
+    int result = 0;
+
+    clock_gettime(CLOCK_REALTIME, &until);
+    until.tv_sec += (time_t)(nanoseconds / 1000000000ULL);
+    until.tv_nsec += (long)(nanoseconds % 1000000000ULL);
+    if(until.tv_nsec >= 1000000000L)
+    {
+        until.tv_sec++;
+        until.tv_nsec -= 1000000000L;
+    }
+
+    pthread_mutex_lock(&threads->lock);
+    threads->waits++;
+    while(((threads->pending & (1U << index)) == 0) && (result == 0))
+    {
+        if(timeout == 0) result = pthread_cond_wait(&threads->signalled, &threads->lock);
+        else result = pthread_cond_timedwait(&threads->signalled, &threads->lock, &until);
+    }
+    threads->pending &= (uint16_t)~(1U << index);
+    pthread_mutex_unlock(&threads->lock);
+}
+
+/**
+ * @brief Wakes the waiter of a stream; called from the stream's interrupt handler.
+ */
+static void DMA_Wait_Pthread_Signal(uint8_t index, void *context)
+{
+    DMA_Wait_Pthread *threads = (DMA_Wait_Pthread *)context;
+
+    pthread_mutex_lock(&threads->lock);
+    threads->pending |= (uint16_t)(1U << index);
+    threads->signals++;
+    pthread_cond_broadcast(&threads->signalled);
+    pthread_mutex_unlock(&threads->lock);
+}
+
+/**
+ * @brief Initializes the shim and fills in a `DMA_Wait_Shim` for it.
+ *
+ * @param[in] threads Pointer to the `DMA_Wait_Pthread` structure.
+ * @param[out] shim Shim to pass to `DMA_Wait_Set_Shim`.
+ */
+void DMA_Wait_Pthread_Init(DMA_Wait_Pthread *threads, DMA_Wait_Shim *shim)
+{
+    pthread_mutex_init(&threads->lock, NULL);
+    pthread_cond_init(&threads->signalled, NULL);
+    threads->pending = 0;
+    threads->waits = 0;
+    threads->signals = 0;
+
+    shim->wait = DMA_Wait_Pthread_Wait;
+    shim->signal = DMA_Wait_Pthread_Signal;
+    shim->context = threads;
+}
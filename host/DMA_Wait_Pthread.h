@@ -0,0 +1,53 @@
+/**
+ * @file DMA_Wait_Pthread.h
+ * @author Kunal Salvi
+ * @brief Header file for the POSIX threads shim of DMA_Wait.
+ *
+ * This file contains the data structure and function prototypes of a
+ * `DMA_Wait_Shim` built on a mutex and a condition variable. It stands in for
+ * an RTOS semaphore per stream on a host: `wait` blocks the calling thread
+ * until the stream's interrupt signals it or the timeout passes, and a signal
+ * that arrives before the wait is kept, as a binary semaphore keeps a give.
+ *
+ * @code
+ * static DMA_Wait_Pthread threads;
+ * static DMA_Wait_Shim shim;
+ *
+ * DMA_Wait_Pthread_Init(&threads, &shim);
+ * DMA_Wait_Set_Shim(&shim);
+ * @endcode
+ *
+ * @version 1.0
+ * @date 2024-08-22
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef DMA_WAIT_PTHREAD_H_
+#define DMA_WAIT_PTHREAD_H_
+
+#include <pthread.h>
+#include "DMA.h"
+
+/**
+ * @brief POSIX threads shim structure.
+ */
+typedef struct DMA_Wait_Pthread
+{
+    pthread_mutex_t lock;               /**< Protects `pending` */
+    pthread_cond_t signalled;           /**< Broadcast by `signal` */
+    uint16_t pending;                   /**< Signals not yet taken, one bit per stream index */
+    uint32_t waits;                     /**< Calls of `wait` */
+    uint32_t signals;                   /**< Calls of `signal` */
+} DMA_Wait_Pthread;
+
+/**
+ * @brief Initializes the shim and fills in a DMA_Wait_Shim for it.
+ *
+ * @param[in] threads Pointer to the DMA_Wait_Pthread structure.
+ * @param[out] shim Shim to pass to DMA_Wait_Set_Shim.
+ */
+void DMA_Wait_Pthread_Init(DMA_Wait_Pthread *threads, DMA_Wait_Shim *shim);
+
+#endif /* DMA_WAIT_PTHREAD_H_ */
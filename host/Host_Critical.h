@@ -0,0 +1,41 @@
+/**
+ * @file Host_Critical.h
+ * @author Kunal Salvi
+ * @brief Critical section override for host builds of the block pipeline.
+ *
+ * This file is force-included (`-include Host_Critical.h`) when
+ * `DMA_Pipeline.c` is built on a host, so the pipeline takes a mutex instead
+ * of masking interrupts and does not include `main.h`. The simulated stages of
+ * the harness report completions from their own threads, which the mutex
+ * serializes as the interrupt mask does on the target.
+ *
+ * @version 1.0
+ * @date 2024-08-22
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef HOST_CRITICAL_H_
+#define HOST_CRITICAL_H_
+
+#include <stdint.h>
+
+#define DMA_PIPELINE_CRITICAL_ENTER(state)  Host_Critical_Enter(&(state))
+#define DMA_PIPELINE_CRITICAL_EXIT(state)   Host_Critical_Exit(state)
+
+/**
+ * @brief Enters the critical section.
+ *
+ * @param[out] state Saved state, passed back to Host_Critical_Exit.
+ */
+void Host_Critical_Enter(uint32_t *state);
+
+/**
+ * @brief Leaves the critical section.
+ *
+ * @param[in] state State saved by Host_Critical_Enter.
+ */
+void Host_Critical_Exit(uint32_t state);
+
+#endif /* HOST_CRITICAL_H_ */
@@ -0,0 +1,333 @@
+/**
+ * @file Host_MCU.c
+ * @brief Simulated Core and DMA Hardware Implementation for host builds
+ *
+ * This file implements the peripherals and the CMSIS intrinsics declared by
+ * the host `main.h` with POSIX threads, and the DMA events raised by host
+ * harnesses. A status flag stays set until the driver writes it to
+ * LIFCR/HIFCR; the writes are applied whenever the simulated hardware runs,
+ * because the registers in host memory cannot clear themselves.
+ *
+ * @version 1.0
+ * @date 2024-08-22
+ *
+ * @author Kunal Salvi
+ * @copyright Copyright (c) 2024
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "Host_MCU.h"
+#include <pthread.h>
+#include <time.h>
+
+#define HOST_TICK_US            20U     /**< Update period of the cycle counter */
+#define HOST_WFE_US             1000U   /**< Longest WFE sleep without an event, standing in for SysTick */
+#define HOST_IRQ_COUNT          96      /**< Number of NVIC lines tracked */
+#define HOST_STREAM_FLAGS       0x3DUL  /**< FEIF, DMEIF, TEIF, HTIF and TCIF of stream 0 */
+
+DMA_TypeDef Host_DMA[2];
+DMA_Stream_TypeDef Host_DMA_Stream[16];
+RCC_TypeDef Host_RCC;
+DWT_Type Host_DWT;
+CoreDebug_Type Host_CoreDebug;
+SCB_Type Host_SCB;
+
+uint32_t SystemCoreClock = 168000000U;
+
+void DMA1_Stream0_IRQHandler(void);
+void DMA1_Stream1_IRQHandler(void);
+void DMA1_Stream2_IRQHandler(void);
+void DMA1_Stream3_IRQHandler(void);
+void DMA1_Stream4_IRQHandler(void);
+void DMA1_Stream5_IRQHandler(void);
+void DMA1_Stream6_IRQHandler(void);
+void DMA1_Stream7_IRQHandler(void);
+void DMA2_Stream0_IRQHandler(void);
+void DMA2_Stream1_IRQHandler(void);
+void DMA2_Stream2_IRQHandler(void);
+void DMA2_Stream3_IRQHandler(void);
+void DMA2_Stream4_IRQHandler(void);
+void DMA2_Stream5_IRQHandler(void);
+void DMA2_Stream6_IRQHandler(void);
+void DMA2_Stream7_IRQHandler(void);
+
+static void (*const Host_Handlers[16])(void) = {
+    DMA1_Stream0_IRQHandler, DMA1_Stream1_IRQHandler, DMA1_Stream2_IRQHandler, DMA1_Stream3_IRQHandler,
+    DMA1_Stream4_IRQHandler, DMA1_Stream5_IRQHandler, DMA1_Stream6_IRQHandler, DMA1_Stream7_IRQHandler,
+    DMA2_Stream0_IRQHandler, DMA2_Stream1_IRQHandler, DMA2_Stream2_IRQHandler, DMA2_Stream3_IRQHandler,
+    DMA2_Stream4_IRQHandler, DMA2_Stream5_IRQHandler, DMA2_Stream6_IRQHandler, DMA2_Stream7_IRQHandler
+};
+
+static const IRQn_Type Host_IRQs[16] = {
+    DMA1_Stream0_IRQn, DMA1_Stream1_IRQn, DMA1_Stream2_IRQn, DMA1_Stream3_IRQn,
+    DMA1_Stream4_IRQn, DMA1_Stream5_IRQn, DMA1_Stream6_IRQn, DMA1_Stream7_IRQn,
+    DMA2_Stream0_IRQn, DMA2_Stream1_IRQn, DMA2_Stream2_IRQn, DMA2_Stream3_IRQn,
+    DMA2_Stream4_IRQn, DMA2_Stream5_IRQn, DMA2_Stream6_IRQn, DMA2_Stream7_IRQn
+};
+
+// Interrupt mask, held by the masked thread or by a running handler
+static pthread_mutex_t Host_Mask = PTHREAD_MUTEX_INITIALIZER;
+static __thread uint32_t Host_Masked;
+
+// WFE event flag
+static pthread_mutex_t Host_Event_Lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t Host_Event_Cond = PTHREAD_COND_INITIALIZER;
+static bool Host_Event;
+
+// Flag clears applied so far, per controller: LIFCR in the low and HIFCR in the high word
+static uint64_t Host_Cleared[2];
+static pthread_mutex_t Host_Register_Lock = PTHREAD_MUTEX_INITIALIZER;
+
+static volatile bool Host_IRQ_Enabled[HOST_IRQ_COUNT];
+static volatile bool Host_Running;
+static pthread_t Host_Ticker;
+
+/**
+ * @brief Returns the monotonic time in nanoseconds.
+ */
+static uint64_t Host_Now(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((uint64_t)now.tv_sec * 1000000000ULL) + (uint64_t)now.tv_nsec;
+}
+
+/**
+ * @brief Advances DWT->CYCCNT at SystemCoreClock while the counter is enabled.
+ */
+static void *Host_Tick(void *argument)
+{
+    uint64_t last = Host_Now();
+    uint64_t now;
+
+    (void)argument;
+    while(Host_Running)
+    {
+        Host_Sleep(HOST_TICK_US);
+        now = Host_Now();
+        if((Host_DWT.CTRL & DWT_CTRL_CYCCNTENA_Msk) && (Host_CoreDebug.DEMCR & CoreDebug_DEMCR_TRCENA_Msk))
+        {
+            Host_DWT.CYCCNT += (uint32_t)(((now - last) * SystemCoreClock) / 1000000000ULL);
+        }
+        last = now;
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Applies the writes to LIFCR/HIFCR of a controller to its status registers.
+ */
+static void Host_DMA_Apply(int controller)
+{
+    DMA_TypeDef *dma = &Host_DMA[controller];
+
+    pthread_mutex_lock(&Host_Register_Lock);
+    dma->LISR &= ~dma->LIFCR;
+    dma->HISR &= ~dma->HIFCR;
+    Host_Cleared[controller] |= (uint64_t)dma->LIFCR | ((uint64_t)dma->HIFCR << 32);
+    dma->LIFCR = 0;
+    dma->HIFCR = 0;
+    pthread_mutex_unlock(&Host_Register_Lock);
+}
+
+/**
+ * @brief Returns the status register and bit shift of a stream index.
+ */
+static volatile uint32_t *Host_DMA_Status(int index, uint32_t *shift)
+{
+    static const uint8_t Shifts[4] = {0, 6, 16, 22};
+    DMA_TypeDef *dma = &Host_DMA[index / 8];
+
+    *shift = Shifts[index & 3];
+    return ((index & 4) == 0) ? &dma->LISR : &dma->HISR;
+}
+
+/**
+ * @brief Returns the flags of a stream whose interrupt is enabled, in stream 0 positions.
+ */
+static uint32_t Host_DMA_Enabled(DMA_Stream_TypeDef *stream)
+{
+    uint32_t enabled = 0;
+
+    if(stream->CR & DMA_SxCR_TCIE)  enabled |= DMA_LISR_TCIF0;
+    if(stream->CR & DMA_SxCR_HTIE)  enabled |= DMA_LISR_HTIF0;
+    if(stream->CR & DMA_SxCR_TEIE)  enabled |= DMA_LISR_TEIF0;
+    if(stream->CR & DMA_SxCR_DMEIE) enabled |= DMA_LISR_DMEIF0;
+    if(stream->FCR & DMA_SxFCR_FEIE) enabled |= DMA_LISR_FEIF0;
+
+    return enabled;
+}
+
+void Host_MCU_Start(void)
+{
+    Host_Running = true;
+    pthread_create(&Host_Ticker, NULL, Host_Tick, NULL);
+}
+
+void Host_MCU_Stop(void)
+{
+    Host_Running = false;
+    pthread_join(Host_Ticker, NULL);
+}
+
+void Host_DMA_Raise(DMA_Stream_TypeDef *stream, uint32_t flags)
+{
+    int index = (int)(stream - Host_DMA_Stream);
+    volatile uint32_t *status;
+    uint32_t shift;
+    int calls;
+
+    Host_DMA_Apply(index / 8);
+    status = Host_DMA_Status(index, &shift);
+
+    pthread_mutex_lock(&Host_Register_Lock);
+    if((stream->CR & DMA_SxCR_EN) == 0)
+    {
+        // A disabled stream transfers nothing and raises no events
+        pthread_mutex_unlock(&Host_Register_Lock);
+        return;
+    }
+    *status |= (flags & HOST_STREAM_FLAGS) << shift;
+    if((flags & DMA_LISR_TEIF0) || ((flags & DMA_LISR_TCIF0) && !(stream->CR & (DMA_SxCR_CIRC | DMA_SxCR_DBM))))
+    {
+        stream->CR &= ~DMA_SxCR_EN;
+    }
+    pthread_mutex_unlock(&Host_Register_Lock);
+
+    // The handler clears one flag per call; run it while an enabled flag is pending
+    for(calls = 0; calls < 5; calls++)
+    {
+        if(!Host_IRQ_Enabled[Host_IRQs[index]] || (((*status >> shift) & Host_DMA_Enabled(stream)) == 0))
+        {
+            break;
+        }
+        pthread_mutex_lock(&Host_Mask);
+        Host_Handlers[index]();
+        pthread_mutex_unlock(&Host_Mask);
+        Host_DMA_Apply(index / 8);
+    }
+}
+
+uint32_t Host_DMA_Cleared(DMA_Stream_TypeDef *stream)
+{
+    int index = (int)(stream - Host_DMA_Stream);
+    uint32_t shift;
+    uint64_t mask;
+    uint32_t cleared;
+
+    Host_DMA_Apply(index / 8);
+    Host_DMA_Status(index, &shift);
+    if(index & 4)
+    {
+        shift += 32;
+    }
+
+    pthread_mutex_lock(&Host_Register_Lock);
+    mask = (uint64_t)HOST_STREAM_FLAGS << shift;
+    cleared = (uint32_t)((Host_Cleared[index / 8] & mask) >> shift);
+    Host_Cleared[index / 8] &= ~mask;
+    pthread_mutex_unlock(&Host_Register_Lock);
+
+    return cleared;
+}
+
+void Host_Sleep(uint32_t microseconds)
+{
+    struct timespec delay;
+
+    delay.tv_sec = microseconds / 1000000U;
+    delay.tv_nsec = (long)(microseconds % 1000000U) * 1000L;
+    nanosleep(&delay, NULL);
+}
+
+void NVIC_EnableIRQ(IRQn_Type irq)
+{
+    Host_IRQ_Enabled[irq] = true;
+}
+
+void NVIC_DisableIRQ(IRQn_Type irq)
+{
+    Host_IRQ_Enabled[irq] = false;
+}
+
+uint32_t __get_PRIMASK(void)
+{
+    return Host_Masked;
+}
+
+void __set_PRIMASK(uint32_t primask)
+{
+    if(primask != 0) __disable_irq();
+    else __enable_irq();
+}
+
+void __disable_irq(void)
+{
+    if(Host_Masked == 0)
+    {
+        pthread_mutex_lock(&Host_Mask);
+        Host_Masked = 1;
+    }
+}
+
+void __enable_irq(void)
+{
+    if(Host_Masked != 0)
+    {
+        Host_Masked = 0;
+        pthread_mutex_unlock(&Host_Mask);
+    }
+}
+
+void __WFE(void)
+{
+    struct timespec until;
+
+    // Condition variables time out against the realtime clock
+    clock_gettime(CLOCK_REALTIME, &until);
+    until.tv_nsec += (long)HOST_WFE_US * 1000L;
+    if(until.tv_nsec >= 1000000000L)
+    {
+        until.tv_sec++;
+        until.tv_nsec -= 1000000000L;
+    }
+
+    pthread_mutex_lock(&Host_Event_Lock);
+    if(!Host_Event)
+    {
+        pthread_cond_timedwait(&Host_Event_Cond, &Host_Event_Lock, &until);
+    }
+    Host_Event = false;
+    pthread_mutex_unlock(&Host_Event_Lock);
+}
+
+void __WFI(void)
+{
+    __WFE();
+}
+
+void __SEV(void)
+{
+    pthread_mutex_lock(&Host_Event_Lock);
+    Host_Event = true;
+    pthread_cond_broadcast(&Host_Event_Cond);
+    pthread_mutex_unlock(&Host_Event_Lock);
+}
+
+void __DSB(void)
+{
+    __sync_synchronize();
+}
+
+void __ISB(void)
+{
+    __sync_synchronize();
+}
+
+void __DMB(void)
+{
+    __sync_synchronize();
+}
@@ -0,0 +1,70 @@
+/**
+ * @file Host_MCU.h
+ * @author Kunal Salvi
+ * @brief Header file for the simulated core and DMA hardware of host builds.
+ *
+ * This file contains the functions a host harness uses to play the part of
+ * the hardware under `DMA.c`. The interrupt mask is a mutex: code between
+ * `__disable_irq` and `__set_PRIMASK` holds it, and a simulated interrupt
+ * takes it before running the handler, so a handler never runs inside a
+ * critical section, as on the core. The DWT cycle counter is advanced from the
+ * host's monotonic clock at `SystemCoreClock` while it is enabled, and WFE/SEV
+ * are an event flag with a condition variable.
+ *
+ * @version 1.0
+ * @date 2024-08-22
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef HOST_MCU_H_
+#define HOST_MCU_H_
+
+#include "main.h"
+
+/**
+ * @brief Starts the simulated core: the cycle counter and the interrupt mask.
+ */
+void Host_MCU_Start(void);
+
+/**
+ * @brief Stops the cycle counter thread.
+ */
+void Host_MCU_Stop(void);
+
+/**
+ * @brief Raises events of a DMA stream as its controller would.
+ *
+ * The flags are given in stream 0 positions (e.g. `DMA_LISR_TCIF0`) and set in
+ * the stream's status register; a disabled stream raises nothing. A transfer
+ * complete of a normal stream and every transfer error also clear EN, as the
+ * controller does at the end of a transfer. The stream's interrupt handler is then run as an interrupt until
+ * the flags are cleared, with the writes to LIFCR/HIFCR applied in between.
+ *
+ * @param[in] stream Pointer to the DMA stream.
+ * @param[in] flags Flags to raise, in stream 0 positions.
+ */
+void Host_DMA_Raise(DMA_Stream_TypeDef *stream, uint32_t flags);
+
+/**
+ * @brief Returns the flags of a DMA stream that were written to its clear register.
+ *
+ * The writes are applied to the status register first. A harness calls this
+ * between transfers that poll the status register without an interrupt, so
+ * the next transfer does not see the flags of the previous one.
+ *
+ * @param[in] stream Pointer to the DMA stream.
+ *
+ * @return uint32_t Cleared flags in stream 0 positions; reading resets them.
+ */
+uint32_t Host_DMA_Cleared(DMA_Stream_TypeDef *stream);
+
+/**
+ * @brief Sleeps the calling thread.
+ *
+ * @param[in] microseconds Time to sleep.
+ */
+void Host_Sleep(uint32_t microseconds);
+
+#endif /* HOST_MCU_H_ */
@@ -0,0 +1,380 @@
+/**
+ * @file main.h
+ * @author Kunal Salvi
+ * @brief Host stand-in for the STM32CubeIDE `main.h`.
+ *
+ * This file provides the part of the device header that `DMA.c` uses, so the
+ * DMA core builds on a PC. The DMA controllers, RCC and the core debug blocks
+ * are plain structures in host memory; the stream and flag registers hold
+ * whatever the driver and the simulated hardware of `Host_MCU.h` write, and
+ * the CMSIS intrinsics are implemented there on top of POSIX threads. Register
+ * layouts and bit positions follow the STM32F4 reference manual.
+ *
+ * @version 1.0
+ * @date 2024-08-22
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+
+#ifndef MAIN_H
+#define MAIN_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#define __IO volatile
+#define __I volatile const
+
+typedef struct { __IO uint32_t CR, NDTR, PAR, M0AR, M1AR, FCR; } DMA_Stream_TypeDef;
+typedef struct { __IO uint32_t LISR, HISR, LIFCR, HIFCR; } DMA_TypeDef;
+typedef struct { __IO uint32_t CR, PLLCFGR, CFGR, CIR, AHB1RSTR, AHB2RSTR, AHB3RSTR, R0, APB1RSTR, APB2RSTR, R1[2], AHB1ENR, AHB2ENR, AHB3ENR, R2, APB1ENR, APB2ENR, R3[2], AHB1LPENR; } RCC_TypeDef;
+typedef struct { __IO uint32_t CTRL, CYCCNT; } DWT_Type;
+typedef struct { __IO uint32_t DHCSR, DCRSR, DCRDR, DEMCR; } CoreDebug_Type;
+typedef struct { __IO uint32_t CPUID, ICSR, VTOR, AIRCR, SCR, CCR; } SCB_Type;
+
+// Peripherals in host memory, defined in Host_MCU.c
+extern DMA_TypeDef Host_DMA[2];
+extern DMA_Stream_TypeDef Host_DMA_Stream[16];
+extern RCC_TypeDef Host_RCC;
+extern DWT_Type Host_DWT;
+extern CoreDebug_Type Host_CoreDebug;
+extern SCB_Type Host_SCB;
+
+#define DMA1 (&Host_DMA[0])
+#define DMA2 (&Host_DMA[1])
+#define DMA1_Stream0 (&Host_DMA_Stream[0])
+#define DMA1_Stream1 (&Host_DMA_Stream[1])
+#define DMA1_Stream2 (&Host_DMA_Stream[2])
+#define DMA1_Stream3 (&Host_DMA_Stream[3])
+#define DMA1_Stream4 (&Host_DMA_Stream[4])
+#define DMA1_Stream5 (&Host_DMA_Stream[5])
+#define DMA1_Stream6 (&Host_DMA_Stream[6])
+#define DMA1_Stream7 (&Host_DMA_Stream[7])
+#define DMA2_Stream0 (&Host_DMA_Stream[8])
+#define DMA2_Stream1 (&Host_DMA_Stream[9])
+#define DMA2_Stream2 (&Host_DMA_Stream[10])
+#define DMA2_Stream3 (&Host_DMA_Stream[11])
+#define DMA2_Stream4 (&Host_DMA_Stream[12])
+#define DMA2_Stream5 (&Host_DMA_Stream[13])
+#define DMA2_Stream6 (&Host_DMA_Stream[14])
+#define DMA2_Stream7 (&Host_DMA_Stream[15])
+#define RCC (&Host_RCC)
+#define DWT (&Host_DWT)
+#define CoreDebug (&Host_CoreDebug)
+#define SCB (&Host_SCB)
+
+#define DWT_CTRL_CYCCNTENA_Msk (1UL)
+#define CoreDebug_DEMCR_TRCENA_Msk (1UL<<24)
+#define SCB_SCR_SEVONPEND_Msk (1UL<<4)
+
+typedef enum { DMA1_Stream0_IRQn=11, DMA1_Stream1_IRQn, DMA1_Stream2_IRQn, DMA1_Stream3_IRQn, DMA1_Stream4_IRQn, DMA1_Stream5_IRQn, DMA1_Stream6_IRQn, DMA1_Stream7_IRQn=47, DMA2_Stream0_IRQn=56, DMA2_Stream1_IRQn, DMA2_Stream2_IRQn, DMA2_Stream3_IRQn, DMA2_Stream4_IRQn, DMA2_Stream5_IRQn=68, DMA2_Stream6_IRQn, DMA2_Stream7_IRQn } IRQn_Type;
+
+void NVIC_EnableIRQ(IRQn_Type irq);
+void NVIC_DisableIRQ(IRQn_Type irq);
+uint32_t __get_PRIMASK(void);
+void __set_PRIMASK(uint32_t primask);
+void __disable_irq(void);
+void __enable_irq(void);
+void __WFI(void);
+void __WFE(void);
+void __SEV(void);
+void __DSB(void);
+void __ISB(void);
+void __DMB(void);
+
+extern uint32_t SystemCoreClock;
+
+#define RCC_AHB1ENR_DMA1EN (1UL<<21)
+#define RCC_AHB1ENR_DMA2EN (1UL<<22)
+#define RCC_AHB1RSTR_DMA1RST (1UL<<21)
+#define RCC_AHB1RSTR_DMA2RST (1UL<<22)
+#define RCC_AHB1LPENR_DMA1LPEN (1UL<<21)
+#define RCC_AHB1LPENR_DMA2LPEN (1UL<<22)
+
+#define DMA_SxCR_CHSEL_Pos 25
+#define DMA_SxCR_CHSEL (7UL<<25)
+#define DMA_SxCR_MBURST_Pos 23
+#define DMA_SxCR_MBURST (3UL<<23)
+#define DMA_SxCR_MBURST_0 (1UL<<23)
+#define DMA_SxCR_PBURST_Pos 21
+#define DMA_SxCR_PBURST (3UL<<21)
+#define DMA_SxCR_PBURST_0 (1UL<<21)
+#define DMA_SxCR_CT_Pos 19
+#define DMA_SxCR_CT (1UL<<19)
+#define DMA_SxCR_DBM_Pos 18
+#define DMA_SxCR_DBM (1UL<<18)
+#define DMA_SxCR_PL_Pos 16
+#define DMA_SxCR_PL (3UL<<16)
+#define DMA_SxCR_PINCOS (1UL<<15)
+#define DMA_SxCR_MSIZE_Pos 13
+#define DMA_SxCR_MSIZE (3UL<<13)
+#define DMA_SxCR_MSIZE_0 (1UL<<13)
+#define DMA_SxCR_MSIZE_1 (2UL<<13)
+#define DMA_SxCR_PSIZE_Pos 11
+#define DMA_SxCR_PSIZE (3UL<<11)
+#define DMA_SxCR_PSIZE_0 (1UL<<11)
+#define DMA_SxCR_PSIZE_1 (2UL<<11)
+#define DMA_SxCR_MINC (1UL<<10)
+#define DMA_SxCR_PINC (1UL<<9)
+#define DMA_SxCR_CIRC_Pos 8
+#define DMA_SxCR_CIRC (1UL<<8)
+#define DMA_SxCR_DIR_Pos 6
+#define DMA_SxCR_DIR (3UL<<6)
+#define DMA_SxCR_DIR_0 (1UL<<6)
+#define DMA_SxCR_DIR_1 (2UL<<6)
+#define DMA_SxCR_PFCTRL (1UL<<5)
+#define DMA_SxCR_TCIE (1UL<<4)
+#define DMA_SxCR_HTIE (1UL<<3)
+#define DMA_SxCR_TEIE (1UL<<2)
+#define DMA_SxCR_DMEIE (1UL<<1)
+#define DMA_SxCR_EN (1UL<<0)
+#define DMA_SxFCR_FEIE (1UL<<7)
+#define DMA_SxFCR_FS (7UL<<3)
+#define DMA_SxFCR_DMDIS (1UL<<2)
+#define DMA_SxFCR_FTH (3UL<<0)
+#define DMA_SxFCR_FTH_0 (1UL<<0)
+#define DMA_SxFCR_FTH_1 (2UL<<0)
+#define DMA_LISR_FEIF0_Pos 0
+#define DMA_LISR_FEIF0_Msk (1UL<<0)
+#define DMA_LISR_FEIF0 (1UL<<0)
+#define DMA_LISR_DMEIF0_Pos 2
+#define DMA_LISR_DMEIF0_Msk (1UL<<2)
+#define DMA_LISR_DMEIF0 (1UL<<2)
+#define DMA_LISR_TEIF0_Pos 3
+#define DMA_LISR_TEIF0_Msk (1UL<<3)
+#define DMA_LISR_TEIF0 (1UL<<3)
+#define DMA_LISR_HTIF0_Pos 4
+#define DMA_LISR_HTIF0_Msk (1UL<<4)
+#define DMA_LISR_HTIF0 (1UL<<4)
+#define DMA_LISR_TCIF0_Pos 5
+#define DMA_LISR_TCIF0_Msk (1UL<<5)
+#define DMA_LISR_TCIF0 (1UL<<5)
+#define DMA_LISR_FEIF1_Pos 6
+#define DMA_LISR_FEIF1_Msk (1UL<<6)
+#define DMA_LISR_FEIF1 (1UL<<6)
+#define DMA_LISR_DMEIF1_Pos 8
+#define DMA_LISR_DMEIF1_Msk (1UL<<8)
+#define DMA_LISR_DMEIF1 (1UL<<8)
+#define DMA_LISR_TEIF1_Pos 9
+#define DMA_LISR_TEIF1_Msk (1UL<<9)
+#define DMA_LISR_TEIF1 (1UL<<9)
+#define DMA_LISR_HTIF1_Pos 10
+#define DMA_LISR_HTIF1_Msk (1UL<<10)
+#define DMA_LISR_HTIF1 (1UL<<10)
+#define DMA_LISR_TCIF1_Pos 11
+#define DMA_LISR_TCIF1_Msk (1UL<<11)
+#define DMA_LISR_TCIF1 (1UL<<11)
+#define DMA_LISR_FEIF2_Pos 16
+#define DMA_LISR_FEIF2_Msk (1UL<<16)
+#define DMA_LISR_FEIF2 (1UL<<16)
+#define DMA_LISR_DMEIF2_Pos 18
+#define DMA_LISR_DMEIF2_Msk (1UL<<18)
+#define DMA_LISR_DMEIF2 (1UL<<18)
+#define DMA_LISR_TEIF2_Pos 19
+#define DMA_LISR_TEIF2_Msk (1UL<<19)
+#define DMA_LISR_TEIF2 (1UL<<19)
+#define DMA_LISR_HTIF2_Pos 20
+#define DMA_LISR_HTIF2_Msk (1UL<<20)
+#define DMA_LISR_HTIF2 (1UL<<20)
+#define DMA_LISR_TCIF2_Pos 21
+#define DMA_LISR_TCIF2_Msk (1UL<<21)
+#define DMA_LISR_TCIF2 (1UL<<21)
+#define DMA_LISR_FEIF3_Pos 22
+#define DMA_LISR_FEIF3_Msk (1UL<<22)
+#define DMA_LISR_FEIF3 (1UL<<22)
+#define DMA_LISR_DMEIF3_Pos 24
+#define DMA_LISR_DMEIF3_Msk (1UL<<24)
+#define DMA_LISR_DMEIF3 (1UL<<24)
+#define DMA_LISR_TEIF3_Pos 25
+#define DMA_LISR_TEIF3_Msk (1UL<<25)
+#define DMA_LISR_TEIF3 (1UL<<25)
+#define DMA_LISR_HTIF3_Pos 26
+#define DMA_LISR_HTIF3_Msk (1UL<<26)
+#define DMA_LISR_HTIF3 (1UL<<26)
+#define DMA_LISR_TCIF3_Pos 27
+#define DMA_LISR_TCIF3_Msk (1UL<<27)
+#define DMA_LISR_TCIF3 (1UL<<27)
+#define DMA_HISR_FEIF4_Pos 0
+#define DMA_HISR_FEIF4_Msk (1UL<<0)
+#define DMA_HISR_FEIF4 (1UL<<0)
+#define DMA_HISR_DMEIF4_Pos 2
+#define DMA_HISR_DMEIF4_Msk (1UL<<2)
+#define DMA_HISR_DMEIF4 (1UL<<2)
+#define DMA_HISR_TEIF4_Pos 3
+#define DMA_HISR_TEIF4_Msk (1UL<<3)
+#define DMA_HISR_TEIF4 (1UL<<3)
+#define DMA_HISR_HTIF4_Pos 4
+#define DMA_HISR_HTIF4_Msk (1UL<<4)
+#define DMA_HISR_HTIF4 (1UL<<4)
+#define DMA_HISR_TCIF4_Pos 5
+#define DMA_HISR_TCIF4_Msk (1UL<<5)
+#define DMA_HISR_TCIF4 (1UL<<5)
+#define DMA_HISR_FEIF5_Pos 6
+#define DMA_HISR_FEIF5_Msk (1UL<<6)
+#define DMA_HISR_FEIF5 (1UL<<6)
+#define DMA_HISR_DMEIF5_Pos 8
+#define DMA_HISR_DMEIF5_Msk (1UL<<8)
+#define DMA_HISR_DMEIF5 (1UL<<8)
+#define DMA_HISR_TEIF5_Pos 9
+#define DMA_HISR_TEIF5_Msk (1UL<<9)
+#define DMA_HISR_TEIF5 (1UL<<9)
+#define DMA_HISR_HTIF5_Pos 10
+#define DMA_HISR_HTIF5_Msk (1UL<<10)
+#define DMA_HISR_HTIF5 (1UL<<10)
+#define DMA_HISR_TCIF5_Pos 11
+#define DMA_HISR_TCIF5_Msk (1UL<<11)
+#define DMA_HISR_TCIF5 (1UL<<11)
+#define DMA_HISR_FEIF6_Pos 16
+#define DMA_HISR_FEIF6_Msk (1UL<<16)
+#define DMA_HISR_FEIF6 (1UL<<16)
+#define DMA_HISR_DMEIF6_Pos 18
+#define DMA_HISR_DMEIF6_Msk (1UL<<18)
+#define DMA_HISR_DMEIF6 (1UL<<18)
+#define DMA_HISR_TEIF6_Pos 19
+#define DMA_HISR_TEIF6_Msk (1UL<<19)
+#define DMA_HISR_TEIF6 (1UL<<19)
+#define DMA_HISR_HTIF6_Pos 20
+#define DMA_HISR_HTIF6_Msk (1UL<<20)
+#define DMA_HISR_HTIF6 (1UL<<20)
+#define DMA_HISR_TCIF6_Pos 21
+#define DMA_HISR_TCIF6_Msk (1UL<<21)
+#define DMA_HISR_TCIF6 (1UL<<21)
+#define DMA_HISR_FEIF7_Pos 22
+#define DMA_HISR_FEIF7_Msk (1UL<<22)
+#define DMA_HISR_FEIF7 (1UL<<22)
+#define DMA_HISR_DMEIF7_Pos 24
+#define DMA_HISR_DMEIF7_Msk (1UL<<24)
+#define DMA_HISR_DMEIF7 (1UL<<24)
+#define DMA_HISR_TEIF7_Pos 25
+#define DMA_HISR_TEIF7_Msk (1UL<<25)
+#define DMA_HISR_TEIF7 (1UL<<25)
+#define DMA_HISR_HTIF7_Pos 26
+#define DMA_HISR_HTIF7_Msk (1UL<<26)
+#define DMA_HISR_HTIF7 (1UL<<26)
+#define DMA_HISR_TCIF7_Pos 27
+#define DMA_HISR_TCIF7_Msk (1UL<<27)
+#define DMA_HISR_TCIF7 (1UL<<27)
+#define DMA_LIFCR_CFEIF0_Pos 0
+#define DMA_LIFCR_CFEIF0_Msk (1UL<<0)
+#define DMA_LIFCR_CFEIF0 (1UL<<0)
+#define DMA_LIFCR_CDMEIF0_Pos 2
+#define DMA_LIFCR_CDMEIF0_Msk (1UL<<2)
+#define DMA_LIFCR_CDMEIF0 (1UL<<2)
+#define DMA_LIFCR_CTEIF0_Pos 3
+#define DMA_LIFCR_CTEIF0_Msk (1UL<<3)
+#define DMA_LIFCR_CTEIF0 (1UL<<3)
+#define DMA_LIFCR_CHTIF0_Pos 4
+#define DMA_LIFCR_CHTIF0_Msk (1UL<<4)
+#define DMA_LIFCR_CHTIF0 (1UL<<4)
+#define DMA_LIFCR_CTCIF0_Pos 5
+#define DMA_LIFCR_CTCIF0_Msk (1UL<<5)
+#define DMA_LIFCR_CTCIF0 (1UL<<5)
+#define DMA_LIFCR_CFEIF1_Pos 6
+#define DMA_LIFCR_CFEIF1_Msk (1UL<<6)
+#define DMA_LIFCR_CFEIF1 (1UL<<6)
+#define DMA_LIFCR_CDMEIF1_Pos 8
+#define DMA_LIFCR_CDMEIF1_Msk (1UL<<8)
+#define DMA_LIFCR_CDMEIF1 (1UL<<8)
+#define DMA_LIFCR_CTEIF1_Pos 9
+#define DMA_LIFCR_CTEIF1_Msk (1UL<<9)
+#define DMA_LIFCR_CTEIF1 (1UL<<9)
+#define DMA_LIFCR_CHTIF1_Pos 10
+#define DMA_LIFCR_CHTIF1_Msk (1UL<<10)
+#define DMA_LIFCR_CHTIF1 (1UL<<10)
+#define DMA_LIFCR_CTCIF1_Pos 11
+#define DMA_LIFCR_CTCIF1_Msk (1UL<<11)
+#define DMA_LIFCR_CTCIF1 (1UL<<11)
+#define DMA_LIFCR_CFEIF2_Pos 16
+#define DMA_LIFCR_CFEIF2_Msk (1UL<<16)
+#define DMA_LIFCR_CFEIF2 (1UL<<16)
+#define DMA_LIFCR_CDMEIF2_Pos 18
+#define DMA_LIFCR_CDMEIF2_Msk (1UL<<18)
+#define DMA_LIFCR_CDMEIF2 (1UL<<18)
+#define DMA_LIFCR_CTEIF2_Pos 19
+#define DMA_LIFCR_CTEIF2_Msk (1UL<<19)
+#define DMA_LIFCR_CTEIF2 (1UL<<19)
+#define DMA_LIFCR_CHTIF2_Pos 20
+#define DMA_LIFCR_CHTIF2_Msk (1UL<<20)
+#define DMA_LIFCR_CHTIF2 (1UL<<20)
+#define DMA_LIFCR_CTCIF2_Pos 21
+#define DMA_LIFCR_CTCIF2_Msk (1UL<<21)
+#define DMA_LIFCR_CTCIF2 (1UL<<21)
+#define DMA_LIFCR_CFEIF3_Pos 22
+#define DMA_LIFCR_CFEIF3_Msk (1UL<<22)
+#define DMA_LIFCR_CFEIF3 (1UL<<22)
+#define DMA_LIFCR_CDMEIF3_Pos 24
+#define DMA_LIFCR_CDMEIF3_Msk (1UL<<24)
+#define DMA_LIFCR_CDMEIF3 (1UL<<24)
+#define DMA_LIFCR_CTEIF3_Pos 25
+#define DMA_LIFCR_CTEIF3_Msk (1UL<<25)
+#define DMA_LIFCR_CTEIF3 (1UL<<25)
+#define DMA_LIFCR_CHTIF3_Pos 26
+#define DMA_LIFCR_CHTIF3_Msk (1UL<<26)
+#define DMA_LIFCR_CHTIF3 (1UL<<26)
+#define DMA_LIFCR_CTCIF3_Pos 27
+#define DMA_LIFCR_CTCIF3_Msk (1UL<<27)
+#define DMA_LIFCR_CTCIF3 (1UL<<27)
+#define DMA_HIFCR_CFEIF4_Pos 0
+#define DMA_HIFCR_CFEIF4_Msk (1UL<<0)
+#define DMA_HIFCR_CFEIF4 (1UL<<0)
+#define DMA_HIFCR_CDMEIF4_Pos 2
+#define DMA_HIFCR_CDMEIF4_Msk (1UL<<2)
+#define DMA_HIFCR_CDMEIF4 (1UL<<2)
+#define DMA_HIFCR_CTEIF4_Pos 3
+#define DMA_HIFCR_CTEIF4_Msk (1UL<<3)
+#define DMA_HIFCR_CTEIF4 (1UL<<3)
+#define DMA_HIFCR_CHTIF4_Pos 4
+#define DMA_HIFCR_CHTIF4_Msk (1UL<<4)
+#define DMA_HIFCR_CHTIF4 (1UL<<4)
+#define DMA_HIFCR_CTCIF4_Pos 5
+#define DMA_HIFCR_CTCIF4_Msk (1UL<<5)
+#define DMA_HIFCR_CTCIF4 (1UL<<5)
+#define DMA_HIFCR_CFEIF5_Pos 6
+#define DMA_HIFCR_CFEIF5_Msk (1UL<<6)
+#define DMA_HIFCR_CFEIF5 (1UL<<6)
+#define DMA_HIFCR_CDMEIF5_Pos 8
+#define DMA_HIFCR_CDMEIF5_Msk (1UL<<8)
+#define DMA_HIFCR_CDMEIF5 (1UL<<8)
+#define DMA_HIFCR_CTEIF5_Pos 9
+#define DMA_HIFCR_CTEIF5_Msk (1UL<<9)
+#define DMA_HIFCR_CTEIF5 (1UL<<9)
+#define DMA_HIFCR_CHTIF5_Pos 10
+#define DMA_HIFCR_CHTIF5_Msk (1UL<<10)
+#define DMA_HIFCR_CHTIF5 (1UL<<10)
+#define DMA_HIFCR_CTCIF5_Pos 11
+#define DMA_HIFCR_CTCIF5_Msk (1UL<<11)
+#define DMA_HIFCR_CTCIF5 (1UL<<11)
+#define DMA_HIFCR_CFEIF6_Pos 16
+#define DMA_HIFCR_CFEIF6_Msk (1UL<<16)
+#define DMA_HIFCR_CFEIF6 (1UL<<16)
+#define DMA_HIFCR_CDMEIF6_Pos 18
+#define DMA_HIFCR_CDMEIF6_Msk (1UL<<18)
+#define DMA_HIFCR_CDMEIF6 (1UL<<18)
+#define DMA_HIFCR_CTEIF6_Pos 19
+#define DMA_HIFCR_CTEIF6_Msk (1UL<<19)
+#define DMA_HIFCR_CTEIF6 (1UL<<19)
+#define DMA_HIFCR_CHTIF6_Pos 20
+#define DMA_HIFCR_CHTIF6_Msk (1UL<<20)
+#define DMA_HIFCR_CHTIF6 (1UL<<20)
+#define DMA_HIFCR_CTCIF6_Pos 21
+#define DMA_HIFCR_CTCIF6_Msk (1UL<<21)
+#define DMA_HIFCR_CTCIF6 (1UL<<21)
+#define DMA_HIFCR_CFEIF7_Pos 22
+#define DMA_HIFCR_CFEIF7_Msk (1UL<<22)
+#define DMA_HIFCR_CFEIF7 (1UL<<22)
+#define DMA_HIFCR_CDMEIF7_Pos 24
+#define DMA_HIFCR_CDMEIF7_Msk (1UL<<24)
+#define DMA_HIFCR_CDMEIF7 (1UL<<24)
+#define DMA_HIFCR_CTEIF7_Pos 25
+#define DMA_HIFCR_CTEIF7_Msk (1UL<<25)
+#define DMA_HIFCR_CTEIF7 (1UL<<25)
+#define DMA_HIFCR_CHTIF7_Pos 26
+#define DMA_HIFCR_CHTIF7_Msk (1UL<<26)
+#define DMA_HIFCR_CHTIF7 (1UL<<26)
+#define DMA_HIFCR_CTCIF7_Pos 27
+#define DMA_HIFCR_CTCIF7_Msk (1UL<<27)
+#define DMA_HIFCR_CTCIF7 (1UL<<27)
+
+#endif /* MAIN_H */